@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/app/account_name_index.hpp>
+
+#include <graphene/chain/account_object.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace app {
+
+namespace {
+
+bool closer_match( const account_name_match& a, const account_name_match& b )
+{
+   return a.distance < b.distance || ( a.distance == b.distance && a.name < b.name );
+}
+
+}
+
+name_trie::name_trie()
+{
+   clear();
+}
+
+void name_trie::clear()
+{
+   _nodes.clear();
+   _nodes.emplace_back();
+   _free.clear();
+   _size = 0;
+}
+
+std::vector<uint32_t>::const_iterator name_trie::find_child( const node& parent, char c )const
+{
+   auto itr = std::lower_bound( parent.children.begin(), parent.children.end(), c,
+                                [this]( uint32_t child, char c ) { return _nodes[child].label[0] < c; } );
+   if( itr != parent.children.end() && _nodes[*itr].label[0] == c )
+      return itr;
+   return parent.children.end();
+}
+
+uint32_t name_trie::new_node()
+{
+   if( !_free.empty() )
+   {
+      uint32_t n = _free.back();
+      _free.pop_back();
+      return n;
+   }
+   _nodes.emplace_back();
+   return _nodes.size() - 1;
+}
+
+void name_trie::free_node( uint32_t n )
+{
+   _nodes[n] = node();
+   _free.push_back( n );
+}
+
+void name_trie::insert( const std::string& name, account_uid_type uid )
+{
+   if( name.empty() )
+      return;
+   uint32_t cur = 0;
+   size_t pos = 0;
+   while( pos < name.size() )
+   {
+      auto itr = find_child( _nodes[cur], name[pos] );
+      if( itr == _nodes[cur].children.end() )
+      {
+         // no name shares the next byte, add the rest as a leaf
+         const uint32_t leaf = new_node();
+         _nodes[leaf].label = name.substr( pos );
+         _nodes[leaf].uid = uid;
+         _nodes[leaf].terminal = true;
+         auto& children = _nodes[cur].children;
+         children.insert( std::upper_bound( children.begin(), children.end(), leaf,
+                                            [this]( uint32_t a, uint32_t b ) { return _nodes[a].label[0] < _nodes[b].label[0]; } ),
+                          leaf );
+         ++_size;
+         return;
+      }
+      const uint32_t child = *itr;
+      const size_t child_pos = itr - _nodes[cur].children.begin();
+      const std::string& label = _nodes[child].label;
+      size_t common = 1;
+      while( common < label.size() && pos + common < name.size() && label[common] == name[pos + common] )
+         ++common;
+      if( common < label.size() )
+      {
+         // split the edge where the name leaves it
+         const uint32_t mid = new_node();
+         _nodes[mid].label = _nodes[child].label.substr( 0, common );
+         _nodes[child].label.erase( 0, common );
+         _nodes[mid].children.push_back( child );
+         _nodes[cur].children[child_pos] = mid;
+         cur = mid;
+      }
+      else
+         cur = child;
+      pos += common;
+   }
+   if( !_nodes[cur].terminal )
+      ++_size;
+   _nodes[cur].terminal = true;
+   _nodes[cur].uid = uid;
+}
+
+bool name_trie::remove( const std::string& name )
+{
+   // the nodes on the path, with the position of each in the children of its parent
+   std::vector< std::pair<uint32_t, size_t> > path;
+   uint32_t cur = 0;
+   size_t pos = 0;
+   while( pos < name.size() )
+   {
+      auto itr = find_child( _nodes[cur], name[pos] );
+      if( itr == _nodes[cur].children.end() )
+         return false;
+      const std::string& label = _nodes[*itr].label;
+      if( name.compare( pos, label.size(), label ) != 0 )
+         return false;
+      path.emplace_back( *itr, itr - _nodes[cur].children.begin() );
+      cur = *itr;
+      pos += label.size();
+   }
+   if( !_nodes[cur].terminal || cur == 0 )
+      return false;
+
+   _nodes[cur].terminal = false;
+   _nodes[cur].uid = 0;
+   --_size;
+
+   const uint32_t parent = path.size() > 1 ? path[path.size() - 2].first : 0;
+   if( _nodes[cur].children.empty() )
+   {
+      _nodes[parent].children.erase( _nodes[parent].children.begin() + path.back().second );
+      free_node( cur );
+      cur = parent;
+   }
+   // keep the trie compressed, a non-terminal node other than the root has at least two children
+   if( cur != 0 && !_nodes[cur].terminal && _nodes[cur].children.size() == 1 )
+   {
+      const uint32_t child = _nodes[cur].children.front();
+      _nodes[cur].label += _nodes[child].label;
+      _nodes[cur].children = std::move( _nodes[child].children );
+      _nodes[cur].uid = _nodes[child].uid;
+      _nodes[cur].terminal = _nodes[child].terminal;
+      free_node( child );
+   }
+   return true;
+}
+
+fc::optional<account_uid_type> name_trie::find( const std::string& name )const
+{
+   uint32_t cur = 0;
+   size_t pos = 0;
+   while( pos < name.size() )
+   {
+      auto itr = find_child( _nodes[cur], name[pos] );
+      if( itr == _nodes[cur].children.end() )
+         return fc::optional<account_uid_type>();
+      const std::string& label = _nodes[*itr].label;
+      if( name.compare( pos, label.size(), label ) != 0 )
+         return fc::optional<account_uid_type>();
+      cur = *itr;
+      pos += label.size();
+   }
+   if( cur == 0 || !_nodes[cur].terminal )
+      return fc::optional<account_uid_type>();
+   return _nodes[cur].uid;
+}
+
+void name_trie::collect( uint32_t n, std::string& path, uint32_t limit, std::vector<account_name_match>& result )const
+{
+   const node& nd = _nodes[n];
+   if( nd.terminal )
+   {
+      account_name_match m;
+      m.name = path;
+      m.uid = nd.uid;
+      result.push_back( std::move( m ) );
+   }
+   for( uint32_t child : nd.children )
+   {
+      if( result.size() >= limit )
+         return;
+      const size_t length = path.size();
+      path += _nodes[child].label;
+      collect( child, path, limit, result );
+      path.resize( length );
+   }
+}
+
+std::vector<account_name_match> name_trie::find_by_prefix( const std::string& prefix, uint32_t limit )const
+{
+   std::vector<account_name_match> result;
+   if( limit == 0 )
+      return result;
+   uint32_t cur = 0;
+   size_t pos = 0;
+   std::string path;
+   while( pos < prefix.size() )
+   {
+      auto itr = find_child( _nodes[cur], prefix[pos] );
+      if( itr == _nodes[cur].children.end() )
+         return result;
+      const std::string& label = _nodes[*itr].label;
+      const size_t compared = std::min( label.size(), prefix.size() - pos );
+      if( prefix.compare( pos, compared, label, 0, compared ) != 0 )
+         return result;
+      path += label;
+      cur = *itr;
+      pos += label.size();
+   }
+   collect( cur, path, limit, result );
+   return result;
+}
+
+std::vector<account_name_match> name_trie::find_similar( const std::string& name, uint32_t max_distance,
+                                                         uint32_t limit )const
+{
+   std::vector<account_name_match> best; // a heap of the closest matches so far, the farthest on top
+   if( limit == 0 )
+      return best;
+
+   // depth first walk computing one row of the Levenshtein matrix per byte, subtrees are skipped once every
+   // entry of the row exceeds the distance still worth finding
+   struct frame
+   {
+      uint32_t                node;
+      size_t                  path_length;
+      std::vector<uint32_t>   row;
+   };
+   const size_t m = name.size();
+   std::vector<frame> stack;
+   std::vector<uint32_t> first_row( m + 1 );
+   for( size_t i = 0; i <= m; ++i )
+      first_row[i] = i;
+   stack.push_back( frame{ 0, 0, std::move( first_row ) } );
+   std::string path;
+
+   auto bound = [&]() -> uint32_t {
+      return best.size() < limit ? max_distance : best.front().distance;
+   };
+
+   while( !stack.empty() )
+   {
+      frame f = std::move( stack.back() );
+      stack.pop_back();
+      path.resize( f.path_length );
+      const node& nd = _nodes[f.node];
+
+      std::vector<uint32_t> row = std::move( f.row );
+      std::vector<uint32_t> next( m + 1 );
+      bool pruned = false;
+      for( char c : nd.label )
+      {
+         path.push_back( c );
+         next[0] = row[0] + 1;
+         uint32_t row_min = next[0];
+         for( size_t i = 1; i <= m; ++i )
+         {
+            next[i] = std::min( { next[i - 1] + 1, row[i] + 1, row[i - 1] + ( name[i - 1] == c ? 0u : 1u ) } );
+            row_min = std::min( row_min, next[i] );
+         }
+         row.swap( next );
+         if( row_min > bound() )
+         {
+            pruned = true;
+            break;
+         }
+      }
+      if( pruned )
+         continue;
+
+      if( nd.terminal && row[m] <= bound() )
+      {
+         account_name_match match;
+         match.name = path;
+         match.uid = nd.uid;
+         match.distance = row[m];
+         if( best.size() < limit )
+         {
+            best.push_back( std::move( match ) );
+            std::push_heap( best.begin(), best.end(), closer_match );
+         }
+         else if( closer_match( match, best.front() ) )
+         {
+            std::pop_heap( best.begin(), best.end(), closer_match );
+            best.back() = std::move( match );
+            std::push_heap( best.begin(), best.end(), closer_match );
+         }
+      }
+
+      // pushed in reverse so that children are visited in lexicographic order
+      for( auto itr = nd.children.rbegin(); itr != nd.children.rend(); ++itr )
+         stack.push_back( frame{ *itr, path.size(), row } );
+   }
+
+   std::sort_heap( best.begin(), best.end(), closer_match );
+   return best;
+}
+
+void account_name_index::object_inserted( const graphene::db::object& obj )
+{
+   assert( dynamic_cast<const graphene::chain::account_object*>(&obj) ); // for debug only
+   const auto& a = static_cast<const graphene::chain::account_object&>(obj);
+   names.insert( a.name, a.uid );
+}
+
+void account_name_index::object_removed( const graphene::db::object& obj )
+{
+   assert( dynamic_cast<const graphene::chain::account_object*>(&obj) ); // for debug only
+   names.remove( static_cast<const graphene::chain::account_object&>(obj).name );
+}
+
+void account_name_index::about_to_modify( const graphene::db::object& before )
+{
+   assert( dynamic_cast<const graphene::chain::account_object*>(&before) ); // for debug only
+   before_name = static_cast<const graphene::chain::account_object&>(before).name;
+}
+
+void account_name_index::object_modified( const graphene::db::object& after  )
+{
+   assert( dynamic_cast<const graphene::chain::account_object*>(&after) ); // for debug only
+   const auto& a = static_cast<const graphene::chain::account_object&>(after);
+   if( a.name == before_name )
+      return;
+   names.remove( before_name );
+   names.insert( a.name, a.uid );
+}
+
+} } // graphene::app
@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 #include <cctype>
+#include <iterator>
 
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
@@ -29,16 +30,18 @@
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/get_config.hpp>
 #include <graphene/utilities/key_conversion.hpp>
+#include <graphene/utilities/transaction_tracer.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 #include <graphene/chain/transaction_object.hpp>
+#include <graphene/post_search/post_search_plugin.hpp>
 
 #include <fc/crypto/hex.hpp>
 #include <fc/smart_ref_impl.hpp>
 
 namespace graphene { namespace app {
 
-    login_api::login_api(application& a)
-    :_app(a)
+    login_api::login_api( application& a, const string& api_client )
+    :_app(a), _api_client(api_client)
     {
     }
 
@@ -84,7 +87,7 @@ namespace graphene { namespace app {
        }
        else if( api_name == "history_api" )
        {
-          _history_api = std::make_shared< history_api >( _app );
+          _history_api = std::make_shared< history_api >( _app, _api_client );
        }
        else if( api_name == "network_node_api" )
        {
@@ -104,6 +107,13 @@ namespace graphene { namespace app {
           if( _app.get_plugin( "debug_witness" ) )
              _debug_api = std::make_shared< graphene::debug_witness::debug_api >( std::ref(_app) );
        }
+       else if( api_name == "post_search_api" )
+       {
+          // can only enable this API if the plugin was loaded and enabled
+          auto plugin = _app.get_plugin< graphene::post_search::post_search_plugin >( "post_search" );
+          if( plugin && plugin->enabled() )
+             _post_search_api = std::make_shared< graphene::post_search::post_search_api >( std::ref(_app) );
+       }
        return;
     }
 
@@ -152,62 +162,78 @@ namespace graphene { namespace app {
 
     void network_broadcast_api::broadcast_transaction(const signed_transaction& trx)
     {
+       FC_ASSERT( _app.p2p_node() != nullptr, "This node is a read replica, it does not broadcast transactions" );
        trx.validate();
+       auto& tracer = utilities::transaction_tracer::instance();
+       if( tracer.enabled() )
+          tracer.record( trx.id(), utilities::transaction_tracer::received_stage );
        _app.chain_database()->push_transaction(trx);
-       if( _app.p2p_node() != nullptr )
-          _app.p2p_node()->broadcast_transaction(trx);
+       _app.p2p_node()->broadcast_transaction(trx);
     }
 
     void network_broadcast_api::broadcast_block( const signed_block& b )
     {
+       FC_ASSERT( _app.p2p_node() != nullptr, "This node is a read replica, it does not broadcast blocks" );
        _app.chain_database()->push_block(b);
-       if( _app.p2p_node() != nullptr )
-          _app.p2p_node()->broadcast( net::block_message( b ));
+       _app.p2p_node()->broadcast( net::block_message( b ));
     }
 
     void network_broadcast_api::broadcast_transaction_with_callback(confirmation_callback cb, const signed_transaction& trx)
     {
+       FC_ASSERT( _app.p2p_node() != nullptr, "This node is a read replica, it does not broadcast transactions" );
        trx.validate();
        _callbacks[trx.id()] = cb;
+       utilities::transaction_tracer::instance().record( trx.id(), utilities::transaction_tracer::received_stage );
        _app.chain_database()->push_transaction(trx);
-       if( _app.p2p_node() != nullptr )
-          _app.p2p_node()->broadcast_transaction(trx);
+       _app.p2p_node()->broadcast_transaction(trx);
     }
 
     network_node_api::network_node_api( application& a ) : _app( a )
     {
     }
 
+    net::node_ptr network_node_api::p2p_node() const
+    {
+       net::node_ptr node = _app.p2p_node();
+       FC_ASSERT( node != nullptr, "This node is a read replica, it is not connected to the p2p network" );
+       return node;
+    }
+
     fc::variant_object network_node_api::get_info() const
     {
-       fc::mutable_variant_object result = _app.p2p_node()->network_get_info();
-       result["connection_count"] = _app.p2p_node()->get_connection_count();
+       fc::mutable_variant_object result = p2p_node()->network_get_info();
+       result["connection_count"] = p2p_node()->get_connection_count();
        return result;
     }
 
     void network_node_api::add_node(const fc::ip::endpoint& ep)
     {
-       _app.p2p_node()->add_node(ep);
+       p2p_node()->add_node(ep);
     }
 
     std::vector<net::peer_status> network_node_api::get_connected_peers() const
     {
-       return _app.p2p_node()->get_connected_peers();
+       return p2p_node()->get_connected_peers();
     }
 
     std::vector<net::potential_peer_record> network_node_api::get_potential_peers() const
     {
-       return _app.p2p_node()->get_potential_peers();
+       return p2p_node()->get_potential_peers();
+    }
+
+    api_admission_stats network_node_api::get_api_admission_stats() const
+    {
+       return _app.get_api_admission_stats();
     }
 
     fc::variant_object network_node_api::get_advanced_node_parameters() const
     {
-       return _app.p2p_node()->get_advanced_node_parameters();
+       return p2p_node()->get_advanced_node_parameters();
     }
 
     void network_node_api::set_advanced_node_parameters(const fc::variant_object& params)
     {
-       return _app.p2p_node()->set_advanced_node_parameters(params);
+       return p2p_node()->set_advanced_node_parameters(params);
     }
 
     fc::api<network_broadcast_api> login_api::network_broadcast()const
@@ -258,6 +284,12 @@ namespace graphene { namespace app {
        return *_debug_api;
     }
 
+    fc::api<graphene::post_search::post_search_api> login_api::post_search() const
+    {
+       FC_ASSERT(_post_search_api);
+       return *_post_search_api;
+    }
+
     vector<operation_history_object> history_api::get_account_history( account_id_type account, 
                                                                        operation_history_id_type stop, 
                                                                        unsigned limit, 
@@ -372,6 +404,136 @@ namespace graphene { namespace app {
        return result;
     }
 
+    namespace {
+
+    /** reads @ref page backwards from the operation of key @ref start_key, to the first one of @ref first_key */
+    template<typename Index, typename FirstKey, typename StartKey>
+    void fill_history_page( const database& db, const Index& idx, const FirstKey& first_key, const StartKey& start_key,
+                            uint32_t limit, api_page<std::pair<uint32_t,operation_history_object>>& page )
+    {
+       const auto first = idx.lower_bound( first_key );
+       auto itr = idx.upper_bound( start_key );
+       while( itr != first && page.items.size() < limit )
+       {
+          --itr;
+          page.items.push_back( std::make_pair( itr->sequence, itr->operation_id(db) ) );
+       }
+       if( itr != first )
+          set_next_cursor( page, std::prev( itr )->sequence );
+    }
+
+    api_page<std::pair<uint32_t,operation_history_object>> relative_account_history_page( const database& db,
+                                                                                          account_uid_type account,
+                                                                                          optional<uint16_t> op_type,
+                                                                                          const optional<string>& cursor,
+                                                                                          uint32_t limit )
+    {
+       FC_ASSERT( limit <= max_page_size );
+       api_page<std::pair<uint32_t,operation_history_object>> page;
+       uint32_t start = db.get_account_statistics_by_uid( account ).total_ops;
+       begin_page( db, cursor, page, start );
+
+       const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
+       if( !op_type.valid() )
+          fill_history_page( db, hist_idx.indices().get<by_seq>(), boost::make_tuple( account ),
+                             boost::make_tuple( account, start ), limit, page );
+       else
+          fill_history_page( db, hist_idx.indices().get<by_type_seq>(), boost::make_tuple( account, *op_type ),
+                             boost::make_tuple( account, *op_type, start ), limit, page );
+       return page;
+    }
+
+    }
+
+    api_page<std::pair<uint32_t,operation_history_object>> history_api::get_relative_account_history_page(
+                                                                          account_uid_type account,
+                                                                          optional<uint16_t> op_type,
+                                                                          optional<string> cursor,
+                                                                          uint32_t limit ) const
+    {
+       FC_ASSERT( _app.chain_database() );
+       return relative_account_history_page( *_app.chain_database(), account, op_type, cursor, limit );
+    }
+
+    const uint32_t history_api::max_streams_per_connection;
+
+    namespace {
+
+    /** waits until the next page of an export may be read: the export slows down, it is not refused */
+    api_admission_controller::ticket admit_stream_page( api_admission_controller& admission, const string& client,
+                                                        const string& method )
+    {
+       api_admission_controller::ticket ticket;
+       while( true )
+       {
+          const auto result = admission.try_admit( client, method, fc::time_point::now(), ticket );
+          if( result == api_admission_controller::admitted )
+             return ticket;
+          if( result == api_admission_controller::busy )
+             admission.wait_for_slot( method, fc::time_point::now() + fc::seconds( 1 ) );
+          else
+          {
+             // the bucket of the client holds the cost of the page again after this
+             const double seconds = admission.cost_of( method ) / admission.get_config().quota_per_second;
+             fc::usleep( fc::microseconds( static_cast<int64_t>( seconds * 1000000 ) + 1 ) );
+          }
+       }
+    }
+
+    }
+
+    void history_api::stream_relative_account_history( std::function<void(const variant&)> callback,
+                                                       account_uid_type account,
+                                                       optional<uint16_t> op_type,
+                                                       uint32_t page_size ) const
+    {
+       FC_ASSERT( _app.chain_database() );
+       FC_ASSERT( page_size > 0 && page_size <= max_page_size );
+       FC_ASSERT( *_streams < max_streams_per_connection,
+                  "At most ${n} exports can run at a time on a connection", ("n",max_streams_per_connection) );
+       // check the account before answering
+       _app.chain_database()->get_account_statistics_by_uid( account );
+
+       // the application outlives the connections, the export stops when the connection is closed
+       std::shared_ptr<database> db = _app.chain_database();
+       std::shared_ptr<uint32_t> streams = _streams;
+       api_admission_controller& admission = _app.get_api_admission_controller();
+       const string client = _api_client;
+       ++*streams;
+       fc::async( [db,callback,account,op_type,page_size,streams,&admission,client]() {
+          static const string method = "stream_relative_account_history_page";
+          optional<string> cursor;
+          try
+          {
+             do
+             {
+                const auto ticket = admit_stream_page( admission, client, method );
+                const auto start = fc::time_point::now();
+                try
+                {
+                   auto page = relative_account_history_page( *db, account, op_type, cursor, page_size );
+                   cursor = page.next_cursor;
+                   callback( fc::variant( page, GRAPHENE_MAX_NESTED_OBJECTS ) );
+                }
+                catch( ... )
+                {
+                   admission.finish( ticket, fc::time_point::now() - start );
+                   throw;
+                }
+                admission.finish( ticket, fc::time_point::now() - start );
+                // let blocks and other calls in between pages
+                fc::yield();
+             }
+             while( cursor.valid() );
+          }
+          catch( const fc::exception& e )
+          {
+             wlog( "Stopped streaming the history of account ${a}: ${e}", ("a",account)("e",e.to_string()) );
+          }
+          --*streams;
+       }, "stream_relative_account_history" );
+    }
+
     crypto_api::crypto_api(){};
     
     blind_signature crypto_api::blind_sign( const extended_private_key_type& key, const blinded_hash& hash, int i )
@@ -446,51 +608,94 @@ namespace graphene { namespace app {
     asset_api::asset_api(graphene::chain::database& db) : _db(db) { }
     asset_api::~asset_api() { }
 
+    const asset_holder_index& asset_api::get_holder_index()const {
+      const auto& idx = _db.get_index_type< account_balance_index >();
+      const auto& bidx = dynamic_cast<const primary_index< account_balance_index >&>(idx);
+      return bidx.get_secondary_index< graphene::chain::asset_holder_index >();
+    }
+
     vector<account_asset_balance> asset_api::get_asset_holders( asset_aid_type asset_id ) const {
+      return get_top_asset_holders_internal( asset_id, get_holder_index().get_stats( asset_id ).holders );
+    }
+
+    vector<account_asset_balance> asset_api::get_top_asset_holders( asset_aid_type asset_id, uint32_t limit ) const {
+      FC_ASSERT( limit <= 100 );
+      return get_top_asset_holders_internal( asset_id, limit );
+    }
+
+    vector<account_asset_balance> asset_api::get_top_asset_holders_internal( asset_aid_type asset_id, uint64_t limit ) const {
 
       const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
       auto range = bal_idx.equal_range( asset_id );
 
       vector<account_asset_balance> result;
+      result.reserve( limit );
 
-      for( const account_balance_object& bal : boost::make_iterator_range( range.first, range.second ) )
+      // ordered by balance, largest first
+      for( auto itr = range.first; itr != range.second && result.size() < limit; ++itr )
       {
-        if( bal.balance.value == 0 ) break; // ordered
+        if( itr->balance.value == 0 ) break;
 
         account_asset_balance aab;
-        aab.account_uid = bal.owner;
-        aab.amount      = bal.balance.value;
+        aab.account_uid = itr->owner;
+        aab.amount      = itr->balance.value;
 
         result.push_back(aab);
       }
 
       return result;
     }
-    // get number of asset holders.
-    uint64_t asset_api::get_asset_holders_count( asset_aid_type asset_id ) const {
+    api_page<account_asset_balance> asset_api::get_asset_holders_page( asset_aid_type asset_id,
+                                                                       optional<string> cursor,
+                                                                       uint32_t limit ) const {
+      FC_ASSERT( limit <= max_page_size );
+
+      api_page<account_asset_balance> page;
+      // balance and owner of the next holder
+      std::pair<share_type, account_uid_type> next;
+      const bool resumed = begin_page( _db, cursor, page, next );
 
       const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-      auto range = bal_idx.equal_range( asset_id );
-      // TODO FIXME filter out accounts with balance == 0
-      uint64_t count = boost::distance(range) - 1;
+      auto itr = resumed ? bal_idx.lower_bound( boost::make_tuple( asset_id, next.first, next.second ) )
+                         : bal_idx.lower_bound( asset_id );
+      const auto itr_end = bal_idx.upper_bound( asset_id );
 
-      return count;
+      // ordered by balance, largest first
+      for( ; itr != itr_end && itr->balance.value != 0; ++itr )
+      {
+        if( page.items.size() == limit )
+        {
+          set_next_cursor( page, std::make_pair( itr->balance, itr->owner ) );
+          break;
+        }
+        account_asset_balance aab;
+        aab.account_uid = itr->owner;
+        aab.amount      = itr->balance.value;
+        page.items.push_back(aab);
+      }
+
+      return page;
+    }
+
+    // get number of asset holders.
+    uint64_t asset_api::get_asset_holders_count( asset_aid_type asset_id ) const {
+      return get_holder_index().get_stats( asset_id ).holders;
+    }
+
+    asset_holder_stats asset_api::get_asset_holder_stats( asset_aid_type asset_id ) const {
+      return get_holder_index().get_stats( asset_id );
     }
     // function to get vector of system assets with holders count.
     vector<asset_holders> asset_api::get_all_asset_holders() const {
-            
+
+      const asset_holder_index& holder_idx = get_holder_index();
       vector<asset_holders> result;
-            
+
       for( const asset_object& asset_obj : _db.get_index_type<asset_index>().indices() )
       {
-        const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-        auto range = bal_idx.equal_range( asset_obj.asset_id );
-        // TODO FIXME filter out accounts with balance == 0
-        uint64_t count = boost::distance(range) - 1;
-                
         asset_holders ah;
         ah.asset_id  = asset_obj.asset_id;
-        ah.count     = count;
+        ah.count     = holder_idx.get_stats( asset_obj.asset_id ).holders;
 
         result.push_back(ah);
       }
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/app/api_admission.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace app {
+
+namespace {
+
+/// weight of the latest measurement in the cost of a method
+const double calibration_weight = 0.1;
+/// no method is free, or a client could make unlimited calls to it
+const double min_cost = 0.01;
+const fc::microseconds prune_interval = fc::seconds( 60 );
+
+}
+
+api_admission_controller::api_admission_controller( const api_admission_config& config )
+: _config( config )
+{
+}
+
+void api_admission_controller::set_config( const api_admission_config& config )
+{
+   std::vector<fc::promise<void>::ptr> waiters;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _config = config;
+      waiters = take_waiters_locked();
+   }
+   wake( waiters );
+}
+
+api_admission_config api_admission_controller::get_config()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return _config;
+}
+
+double api_admission_controller::cost_of( const std::string& method )const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return cost_of_locked( method );
+}
+
+double api_admission_controller::cost_of_locked( const std::string& method )const
+{
+   auto configured = _config.method_costs.find( method );
+   if( configured != _config.method_costs.end() )
+      return configured->second;
+   auto measured = _measured_costs.find( method );
+   if( measured != _measured_costs.end() )
+      return measured->second;
+   return _config.default_cost;
+}
+
+bool api_admission_controller::is_busy_locked( double cost )const
+{
+   return ( _config.max_concurrent_calls > 0 && _stats.calls_in_flight >= _config.max_concurrent_calls )
+          || ( _config.max_cost_in_flight > 0 && _stats.calls_in_flight > 0
+               && _stats.cost_in_flight + cost > _config.max_cost_in_flight );
+}
+
+std::vector<fc::promise<void>::ptr> api_admission_controller::take_waiters_locked()
+{
+   std::vector<fc::promise<void>::ptr> waiters;
+   waiters.swap( _waiters );
+   return waiters;
+}
+
+void api_admission_controller::wake( const std::vector<fc::promise<void>::ptr>& waiters )
+{
+   // every waiter retries, a slot too small for the first one may fit another
+   for( const auto& w : waiters )
+      w->set_value();
+}
+
+void api_admission_controller::refill( bucket& b, fc::time_point now )const
+{
+   const double burst = std::max( _config.quota_burst, _config.quota_per_second );
+   if( now > b.updated )
+      b.tokens = std::min( burst, b.tokens + _config.quota_per_second * ( now - b.updated ).count() / 1000000.0 );
+   b.updated = now;
+}
+
+void api_admission_controller::prune_buckets( fc::time_point now )
+{
+   if( now - _last_prune < prune_interval )
+      return;
+   _last_prune = now;
+   // a full bucket is the same as no bucket
+   const double burst = std::max( _config.quota_burst, _config.quota_per_second );
+   for( auto itr = _buckets.begin(); itr != _buckets.end(); )
+   {
+      refill( itr->second, now );
+      if( itr->second.tokens >= burst )
+         itr = _buckets.erase( itr );
+      else
+         ++itr;
+   }
+}
+
+void api_admission_controller::count_rejection( const std::string& method )
+{
+   ++_stats.rejected_by_method[ method ];
+}
+
+api_admission_controller::result api_admission_controller::try_admit( const std::string& client,
+                                                                       const std::string& method,
+                                                                       fc::time_point now, ticket& t )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   const double cost = cost_of_locked( method );
+
+   if( is_busy_locked( cost ) )
+      return busy;
+
+   if( _config.quota_per_second > 0 )
+   {
+      prune_buckets( now );
+      auto inserted = _buckets.emplace( client, bucket() );
+      bucket& b = inserted.first->second;
+      if( inserted.second )
+      {
+         b.tokens = std::max( _config.quota_burst, _config.quota_per_second );
+         b.updated = now;
+      }
+      else
+         refill( b, now );
+      // a call costing more than the burst is allowed from a full bucket, and empties it for longer
+      if( b.tokens < cost && b.tokens < std::max( _config.quota_burst, _config.quota_per_second ) )
+      {
+         ++_stats.rejected_over_quota;
+         count_rejection( method );
+         return over_quota;
+      }
+      b.tokens -= cost;
+   }
+
+   ++_stats.calls_in_flight;
+   _stats.cost_in_flight += cost;
+   ++_stats.admitted;
+   t.method = method;
+   t.cost = cost;
+   return admitted;
+}
+
+void api_admission_controller::finish( const ticket& t, fc::microseconds latency )
+{
+   std::vector<fc::promise<void>::ptr> waiters;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( _stats.calls_in_flight > 0 )
+         --_stats.calls_in_flight;
+      _stats.cost_in_flight = _stats.calls_in_flight > 0 ? std::max( 0.0, _stats.cost_in_flight - t.cost ) : 0;
+      waiters = take_waiters_locked();
+
+      if( _config.method_costs.count( t.method ) == 0 )
+      {
+         const double measured = std::max( min_cost, latency.count() / 1000.0 );
+         auto itr = _measured_costs.find( t.method );
+         if( itr == _measured_costs.end() )
+            _measured_costs.emplace( t.method, measured );
+         else
+            itr->second += calibration_weight * ( measured - itr->second );
+      }
+   }
+   wake( waiters );
+}
+
+bool api_admission_controller::enter_queue( const std::string& method )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   if( _stats.calls_in_queue >= _config.max_queued_calls )
+   {
+      ++_stats.rejected_busy;
+      count_rejection( method );
+      return false;
+   }
+   ++_stats.calls_in_queue;
+   ++_stats.queued;
+   return true;
+}
+
+void api_admission_controller::leave_queue( const std::string& method, bool admitted )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   if( _stats.calls_in_queue > 0 )
+      --_stats.calls_in_queue;
+   if( !admitted )
+   {
+      ++_stats.rejected_busy;
+      count_rejection( method );
+   }
+}
+
+void api_admission_controller::wait_for_slot( const std::string& method, fc::time_point deadline )
+{
+   fc::promise<void>::ptr slot_freed;
+   {
+      // checked under the lock, so a call finishing before the waiter is registered is not missed
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( !is_busy_locked( cost_of_locked( method ) ) )
+         return;
+      slot_freed = fc::promise<void>::ptr( new fc::promise<void>( "graphene::app::api_admission_controller::wait_for_slot" ) );
+      _waiters.push_back( slot_freed );
+   }
+   try
+   {
+      slot_freed->wait_until( deadline );
+   }
+   catch( const fc::timeout_exception& ) // the caller gives up
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _waiters.erase( std::remove( _waiters.begin(), _waiters.end(), slot_freed ), _waiters.end() );
+   }
+}
+
+api_admission_stats api_admission_controller::get_stats()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   api_admission_stats result = _stats;
+   result.clients = _buckets.size();
+   for( const auto& e : _measured_costs )
+      result.method_costs[ e.first ] = e.second;
+   for( const auto& e : _config.method_costs )
+      result.method_costs[ e.first ] = e.second;
+   return result;
+}
+
+} } // graphene::app
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/app/api_pagination.hpp>
+
+#include <fc/crypto/hex.hpp>
+
+namespace graphene { namespace app {
+
+string encode_cursor( const page_cursor& cursor )
+{
+   return fc::to_hex( fc::raw::pack( cursor ) );
+}
+
+page_cursor decode_cursor( const string& cursor )
+{ try {
+   FC_ASSERT( cursor.size() % 2 == 0, "malformed cursor" );
+   std::vector<char> bytes( cursor.size() / 2 );
+   FC_ASSERT( fc::from_hex( cursor, bytes.data(), bytes.size() ) == bytes.size(), "malformed cursor" );
+   return fc::raw::unpack<page_cursor>( bytes );
+} FC_CAPTURE_AND_RETHROW( (cursor) ) }
+
+bool cursor_reorganized( const graphene::chain::database& db, const page_cursor& cursor )
+{
+   if( cursor.head_block_num == 0 )
+      return false;
+   if( cursor.head_block_num > db.head_block_num() )
+      return true;
+   if( cursor.head_block_num == db.head_block_num() )
+      return cursor.head_block_id != db.head_block_id();
+   try
+   {
+      return db.get_block_id_for_num( cursor.head_block_num ) != cursor.head_block_id;
+   }
+   catch( const fc::exception& )
+   {
+      // the block database no longer has it, nothing tells the cursor is still valid
+      return true;
+   }
+}
+
+} } // graphene::app
@@ -21,8 +21,10 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
+#include <graphene/app/account_name_index.hpp>
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/api_admission.hpp>
 #include <graphene/app/application.hpp>
 #include <graphene/app/plugin.hpp>
 
@@ -35,21 +37,29 @@
 #include <graphene/net/exceptions.hpp>
 
 #include <graphene/utilities/key_conversion.hpp>
+#include <graphene/utilities/metrics.hpp>
+#include <graphene/utilities/transaction_tracer.hpp>
 
 #include <fc/smart_ref_impl.hpp>
 
 #include <fc/io/fstream.hpp>
 #include <fc/rpc/api_connection.hpp>
 #include <fc/rpc/websocket_api.hpp>
+#include <fc/network/http/server.hpp>
 #include <fc/network/resolve.hpp>
 #include <fc/crypto/base64.hpp>
+#include <fc/thread/thread.hpp>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/signals2.hpp>
 #include <boost/range/algorithm/reverse.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
+#include <mutex>
+#include <set>
 
 #include <fc/log/file_appender.hpp>
 #include <fc/log/logger.hpp>
@@ -76,6 +86,141 @@ namespace bpo = boost::program_options;
 
 namespace detail {
 
+   /**
+    * A websocket API connection, also serving calls posted over HTTP, which records the time spent in each call in the
+    * metrics registry, labelled by the name of the called method, and runs calls only when the admission controller
+    * allows them.
+    */
+   class metered_websocket_api_connection : public fc::rpc::websocket_api_connection
+   {
+      public:
+         /** @param client the key of the quota of this connection */
+         metered_websocket_api_connection( fc::http::websocket_connection& c, uint32_t max_conversion_depth,
+                                           api_admission_controller& admission, const std::string& client )
+            : fc::rpc::websocket_api_connection( c, max_conversion_depth ),
+              _ws( c ), _admission( admission ), _client( client )
+         {
+            c.on_message_handler( [this]( const std::string& msg ) { metered_call( msg, true ); } );
+            c.on_http_handler( [this]( const std::string& msg ) -> std::string { return metered_call( msg, false ); } );
+         }
+
+      private:
+         /**
+          * Runs a call received as a websocket message, or as the body of an HTTP request.
+          * @param send_message true to send the reply on the websocket, false to return it
+          */
+         std::string metered_call( const std::string& msg, bool send_message )
+         {
+            const std::string method = method_label( msg );
+            api_admission_controller::ticket ticket;
+            auto admission = _admission.try_admit( _client, method, fc::time_point::now(), ticket );
+            if( admission == api_admission_controller::busy && _admission.enter_queue( method ) )
+            {
+               // other calls run while this one waits, and wake it up when they finish
+               const fc::time_point give_up = fc::time_point::now() + _admission.get_config().max_queue_wait;
+               do
+               {
+                  _admission.wait_for_slot( method, give_up );
+                  admission = _admission.try_admit( _client, method, fc::time_point::now(), ticket );
+               } while( admission == api_admission_controller::busy && fc::time_point::now() < give_up );
+               _admission.leave_queue( method, admission != api_admission_controller::busy );
+            }
+            if( admission != api_admission_controller::admitted )
+               return reject( msg, admission, send_message );
+
+            std::string reply;
+            auto start = fc::time_point::now();
+            try
+            {
+               reply = on_message( msg, send_message );
+            }
+            catch( ... )
+            {
+               _admission.finish( ticket, fc::time_point::now() - start );
+               throw;
+            }
+            const auto elapsed = fc::time_point::now() - start;
+            _admission.finish( ticket, elapsed );
+            utilities::metrics_registry::instance().get_histogram(
+                  "graphene_api_call_seconds", "Time spent in API calls", utilities::histogram::latency_buckets(),
+                  { { "method", method } } ).observe( elapsed );
+            return reply;
+         }
+
+         /** replies to a refused call with a JSON-RPC error */
+         std::string reject( const std::string& msg, api_admission_controller::result reason, bool send_message )
+         {
+            const bool over_quota = ( reason == api_admission_controller::over_quota );
+            utilities::metrics_registry::instance().get_counter(
+                  "graphene_api_calls_rejected_total", "API calls refused by admission control",
+                  { { "reason", over_quota ? "quota" : "busy" } } ).increment();
+            fc::variant id;
+            try
+            {
+               id = fc::json::from_string( msg ).get_object()["id"];
+            }
+            catch( const fc::exception& )
+            {
+            }
+            fc::mutable_variant_object error;
+            error( "code", over_quota ? -32001 : -32002 )
+                 ( "message", over_quota ? "API call rejected: quota of the client exceeded"
+                                         : "API call rejected: the server is busy" );
+            const std::string reply = fc::json::to_string( fc::mutable_variant_object( "id", id )( "jsonrpc", "2.0" )
+                                                                                  ( "error", error ) );
+            if( send_message )
+               _ws.send_message( reply );
+            return reply;
+         }
+
+         /**
+          * Finds the method name in a JSON-RPC request without parsing all of it, e.g. "get_accounts" in
+          * {"id":1,"method":"call","params":[0,"get_accounts",[...]]}. Names are chosen by clients, so only the
+          * first max_methods distinct ones get their own series.
+          */
+         static std::string method_label( const std::string& msg )
+         {
+            static const size_t max_methods = 256;
+            static std::set<std::string> known_methods;
+            static std::mutex known_methods_mutex;
+
+            std::string method;
+            auto read_string_after = [&msg]( size_t pos, char open ) -> std::string {
+               pos = msg.find( open, pos );
+               if( pos == std::string::npos )
+                  return std::string();
+               size_t start = msg.find( '"', pos + 1 );
+               size_t end = start == std::string::npos ? start : msg.find( '"', start + 1 );
+               if( end == std::string::npos || end - start > 65 )
+                  return std::string();
+               return msg.substr( start + 1, end - start - 1 );
+            };
+            size_t pos = msg.find( "\"method\"" );
+            if( pos != std::string::npos )
+               method = read_string_after( pos + 8, ':' );
+            if( method == "call" )
+            {
+               pos = msg.find( "\"params\"" );
+               method = pos == std::string::npos ? std::string() : read_string_after( msg.find( ',', pos ), ',' );
+            }
+            if( method.empty() || !std::all_of( method.begin(), method.end(),
+                                                []( char c ) { return std::isalnum( static_cast<unsigned char>( c ) ) || c == '_'; } ) )
+               return "unknown";
+            std::lock_guard<std::mutex> lock( known_methods_mutex );
+            if( known_methods.count( method ) == 0 )
+            {
+               if( known_methods.size() >= max_methods )
+                  return "other";
+               known_methods.insert( method );
+            }
+            return method;
+         }
+
+         fc::http::websocket_connection&  _ws;
+         api_admission_controller&        _admission;
+         const std::string                _client;
+   };
+
    genesis_state_type create_example_genesis() {
       auto nathan_key = fc::ecc::private_key::regenerate(fc::sha256::hash(string("nathan")));
       dlog("Allocating all stake to ${key}", ("key", utilities::key_to_wif(nathan_key)));
@@ -239,10 +384,48 @@ namespace detail {
          FC_CAPTURE_AND_RETHROW((endpoint_string))
       }
 
+      api_admission_config get_api_admission_config()const
+      {
+         api_admission_config config;
+         config.default_cost = _options->at("api-default-call-cost").as<double>();
+         config.quota_per_second = _options->at("api-quota-per-second").as<double>();
+         config.quota_burst = _options->at("api-quota-burst").as<double>();
+         config.max_concurrent_calls = _options->at("api-max-concurrent-calls").as<uint32_t>();
+         config.max_cost_in_flight = _options->at("api-max-cost-in-flight").as<double>();
+         config.max_queued_calls = _options->at("api-max-queued-calls").as<uint32_t>();
+         config.max_queue_wait = fc::milliseconds( _options->at("api-max-queue-wait-ms").as<uint32_t>() );
+         if( _options->count("api-call-cost") )
+         {
+            for( const string& pair_str : _options->at("api-call-cost").as<vector<string>>() )
+            {
+               auto cost = fc::json::from_string(pair_str).as<std::pair<string,double>>(2);
+               FC_ASSERT( cost.second >= 0, "Negative cost for API method ${m}", ("m",cost.first) );
+               config.method_costs[cost.first] = cost.second;
+            }
+         }
+         return config;
+      }
+
       void new_connection( const fc::http::websocket_connection_ptr& c )
       {
-         auto wsc = std::make_shared<fc::rpc::websocket_api_connection>(*c, GRAPHENE_NET_MAX_NESTED_OBJECTS);
-         auto login = std::make_shared<graphene::app::login_api>( std::ref(*_self) );
+         // calls are counted against the quota of the address of the client, as forwarded by a proxy if it is
+         // configured, else of the remote address without its port, so reconnecting does not reset the quota
+         string client;
+         if( !_api_quota_ip_header.empty() )
+            client = c->get_request_header( _api_quota_ip_header );
+         if( client.empty() )
+         {
+            // "address:port", or "[address]:port" for IPv6
+            client = c->get_remote_endpoint_string();
+            const auto port = client.rfind( ':' );
+            if( port != string::npos )
+               client.erase( port );
+         }
+         if( client.empty() )
+            client = "connection " + std::to_string( ++_api_connection_count );
+         auto wsc = std::make_shared<metered_websocket_api_connection>(*c, GRAPHENE_NET_MAX_NESTED_OBJECTS,
+                                                                       _api_admission, client);
+         auto login = std::make_shared<graphene::app::login_api>( std::ref(*_self), client );
          login->enable_api("database_api");
 
          wsc->register_api(login->database());
@@ -304,6 +487,39 @@ namespace detail {
          _websocket_tls_server->start_accept();
       } FC_CAPTURE_AND_RETHROW() }
 
+      void reset_metrics_server()
+      { try {
+         if( !_options->count("metrics-endpoint") )
+            return;
+
+         auto& registry = utilities::metrics_registry::instance();
+         registry.add_callback_gauge( this, "graphene_head_block_number", "Number of the head block",
+               [this]() -> double { return _chain_db->head_block_num(); } );
+         registry.add_callback_gauge( this, "graphene_last_irreversible_block_number", "Number of the last irreversible block",
+               [this]() -> double { return _chain_db->get_dynamic_global_properties().last_irreversible_block_num; } );
+         registry.add_callback_gauge( this, "graphene_undo_depth", "Number of blocks which can still be undone",
+               [this]() -> double { return _chain_db->head_block_num() - _chain_db->last_non_undoable_block_num(); } );
+         registry.add_callback_gauge( this, "graphene_pending_transactions", "Transactions waiting to be included in a block",
+               [this]() -> double { return _chain_db->get_pending_transaction_pool_stats().transactions; } );
+         registry.add_callback_gauge( this, "graphene_pending_transactions_bytes", "Size of the transactions waiting to be included in a block",
+               [this]() -> double { return _chain_db->get_pending_transaction_pool_stats().bytes; } );
+         registry.add_callback_gauge( this, "graphene_p2p_connections", "Number of connected peers",
+               [this]() -> double { return _p2p_network ? _p2p_network->get_connection_count() : 0; } );
+
+         _metrics_server = std::make_shared<fc::http::server>();
+         ilog("Configured metrics exporter to listen on ${ip}", ("ip",_options->at("metrics-endpoint").as<string>()));
+         _metrics_server->listen( fc::ip::endpoint::from_string(_options->at("metrics-endpoint").as<string>()) );
+         // on_request() must come after listen()
+         _metrics_server->on_request( []( const fc::http::request& req, const fc::http::server::response& resp )
+         {
+            const std::string body = utilities::metrics_registry::instance().render_text();
+            resp.add_header( "Content-Type", "text/plain; version=0.0.4" );
+            resp.set_status( fc::http::reply::OK );
+            resp.set_length( body.size() );
+            resp.write( body.c_str(), body.size() );
+         } );
+      } FC_CAPTURE_AND_RETHROW() }
+
       explicit application_impl(application* self)
          : _self(self),
            _chain_db(std::make_shared<chain::database>())
@@ -312,6 +528,7 @@ namespace detail {
 
       ~application_impl()
       {
+         utilities::metrics_registry::instance().remove_callbacks( this );
       }
 
       void set_dbg_init_key( genesis_state_type& genesis, const std::string& init_key )
@@ -387,9 +604,28 @@ namespace detail {
          }
          _chain_db->add_checkpoints( loaded_checkpoints );
 
+         if( _options->count("state-checkpoint-interval") )
+            _chain_db->set_state_checkpoint_interval( _options->at("state-checkpoint-interval").as<uint32_t>() );
+
+         _chain_db->set_pending_transaction_limits( _options->at("max-pending-transactions-size").as<uint64_t>() * 1024 * 1024,
+                                                    _options->at("max-pending-transactions-per-account").as<uint32_t>() );
+
+         _chain_db->set_expired_transactions_per_block( _options->at("expired-transactions-per-block").as<uint32_t>() );
+
+         _chain_db->set_undo_spill_limits( _options->at("undo-blocks-in-memory").as<uint32_t>(),
+                                           _options->at("undo-size-in-memory").as<uint64_t>() * 1024 * 1024 );
+         _chain_db->set_validated_block_cache_size( _options->at("validated-block-cache-size").as<uint32_t>() );
+
+         utilities::transaction_tracer::instance().configure( _options->at("transaction-trace-sample-rate").as<uint32_t>(),
+                                                              _options->at("transaction-trace-buffer-size").as<uint32_t>() );
+
          if( _options->count("replay-blockchain") )
             _chain_db->wipe( _data_dir / "blockchain", false );
 
+         // added before the database is opened, so the accounts loaded from disk are indexed too
+         if( _options->at("enable-account-name-index").as<bool>() )
+            _chain_db->add_secondary_index< graphene::db::primary_index_of<chain::account_object>::type, account_name_index >();
+
          try
          {
             _chain_db->open( _data_dir / "blockchain", initial_state, GRAPHENE_CURRENT_DB_VERSION );
@@ -434,14 +670,69 @@ namespace detail {
             wild_access.allowed_apis.push_back( "network_broadcast_api" );
             wild_access.allowed_apis.push_back( "history_api" );
             wild_access.allowed_apis.push_back( "crypto_api" );
+            wild_access.allowed_apis.push_back( "post_search_api" );
             _apiaccess.permission_map["*"] = wild_access;
          }
 
-         reset_p2p_node(_data_dir);
+         if( _options->count("replica-of") )
+         {
+            const fc::path primary_dir = _options->at("replica-of").as<boost::filesystem::path>();
+            _replica_source.open( primary_dir / "blockchain" / "database" / "block_num_to_block", true );
+            ilog( "Following the chain of the node in ${d}, p2p is disabled", ("d",primary_dir) );
+            _replica_task = fc::schedule( [this]{ replica_loop(); }, fc::time_point::now(), "Replica Sync" );
+         }
+         else
+            reset_p2p_node(_data_dir);
+
+         _api_admission.set_config( get_api_admission_config() );
+         if( _options->count("api-quota-ip-header") )
+            _api_quota_ip_header = _options->at("api-quota-ip-header").as<string>();
          reset_websocket_server();
          reset_websocket_tls_server();
+         reset_metrics_server();
       } FC_LOG_AND_RETHROW() }
 
+      /**
+       * Pushes the blocks which the primary node has saved since the last call. The primary has already
+       * validated them, so signatures, authorities, TaPoS and invariants are not checked again.
+       */
+      void replica_loop()
+      {
+         const uint32_t trusted_skip = database::skip_witness_signature |
+                                       database::skip_transaction_signatures |
+                                       database::skip_transaction_dupe_check |
+                                       database::skip_tapos_check |
+                                       database::skip_witness_schedule_check |
+                                       database::skip_invariants_check |
+                                       database::skip_authority_check |
+                                       database::skip_merkle_check |
+                                       database::skip_block_size_check;
+         const uint32_t max_blocks_per_pass = 1000;
+         uint32_t pushed = 0;
+         try
+         {
+            pushed = _chain_db->push_blocks_from( _replica_source, trusted_skip, max_blocks_per_pass );
+            if( pushed == 0 && !_is_finished_syncing )
+            {
+               ilog( "Replica caught up with the primary node at block ${n}", ("n",_chain_db->head_block_num()) );
+               _is_finished_syncing = true;
+               _self->syncing_finished();
+            }
+         }
+         catch( const fc::canceled_exception& )
+         {
+            throw;
+         }
+         catch( const fc::exception& e )
+         {
+            elog( "Got exception while following the primary node:\n${e}", ("e", e.to_detail_string()) );
+         }
+         // yield to the API between passes while catching up, otherwise poll a few times per block
+         const fc::time_point next_wakeup = fc::time_point::now()
+               + ( pushed == max_blocks_per_pass ? fc::microseconds( 0 ) : fc::milliseconds( 250 ) );
+         _replica_task = fc::schedule( [this]{ replica_loop(); }, next_wakeup, "Replica Sync" );
+      }
+
       optional< api_access_info > get_api_access_info(const string& username)const
       {
          optional< api_access_info > result;
@@ -503,13 +794,22 @@ namespace detail {
             dlog( "${b}", ("b",blk_msg.block) );
          }
          FC_ASSERT( (latency.count()/1000) > -2500, "Rejecting block with timestamp in the future" );
+         if( !sync_mode )
+         {
+            static auto& block_latency = utilities::metrics_registry::instance().get_histogram(
+                  "graphene_block_receive_latency_seconds", "Time from the timestamp of a block until it was received from the network" );
+            block_latency.observe( std::max( latency, fc::microseconds() ) );
+         }
 
          try {
             // TODO: in the case where this block is valid but on a fork that's too old for us to switch to,
             // you can help the network code out by throwing a block_older_than_undo_history exception.
             // when the net code sees that, it will stop trying to push blocks from that chain, but
             // leave that peer connected so that they can get sync blocks from us
-            bool result = _chain_db->push_block(blk_msg.block, (_is_block_producer | _force_validate) ? database::skip_nothing : ( database::skip_transaction_signatures | database::skip_invariants_check ) );
+            const uint32_t skip = (_is_block_producer | _force_validate) ? database::skip_nothing : ( database::skip_transaction_signatures | database::skip_invariants_check );
+            // a block from the network is stored with the bytes it was received as
+            bool result = blk_msg.packed ? _chain_db->push_block(blk_msg.block, *blk_msg.packed, skip)
+                                         : _chain_db->push_block(blk_msg.block, skip);
             // the block was accepted, so we now know all of the transactions contained in the block
             if (!sync_mode)
             {
@@ -554,6 +854,14 @@ namespace detail {
             trx_count = 0;
          }
 
+         static auto& received = utilities::metrics_registry::instance().get_counter(
+               "graphene_p2p_transactions_received_total", "Transactions received from the network" );
+         received.increment();
+
+         auto& tracer = utilities::transaction_tracer::instance();
+         if( tracer.enabled() )
+            tracer.record( transaction_message.trx.id(), utilities::transaction_tracer::received_stage );
+
          _chain_db->push_transaction( transaction_message.trx );
       } FC_CAPTURE_AND_RETHROW( (transaction_message) ) }
 
@@ -634,13 +942,14 @@ namespace detail {
         // ilog("Request for item ${id}", ("id", id));
          if( id.item_type == graphene::net::block_message_type )
          {
-            auto opt_block = _chain_db->fetch_block_by_id(id.item_hash);
+            // relay the block as it is stored, without decoding and packing it again
+            auto opt_block = _chain_db->fetch_packed_block_by_id(id.item_hash);
             if( !opt_block )
                elog("Couldn't find block ${id} -- corresponding ID in our chain is ${id2}",
                     ("id", id.item_hash)("id2", _chain_db->get_block_id_for_num(block_header::num_from_id(id.item_hash))));
             FC_ASSERT( opt_block.valid() );
             // ilog("Serving up block #${num}", ("num", opt_block->block_num()));
-            return block_message(std::move(*opt_block));
+            return block_message::to_message(*opt_block);
          }
          return trx_message( _chain_db->get_recent_transaction( id.item_hash ) );
       } FC_CAPTURE_AND_RETHROW( (id) ) }
@@ -893,11 +1202,20 @@ namespace detail {
       std::shared_ptr<graphene::net::node>                  _p2p_network;
       std::shared_ptr<fc::http::websocket_server>      _websocket_server;
       std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
+      std::shared_ptr<fc::http::server>                _metrics_server;
+
+      api_admission_controller                         _api_admission;
+      string                                           _api_quota_ip_header;
+      uint64_t                                         _api_connection_count = 0;
 
       std::map<string, std::shared_ptr<abstract_plugin>> _active_plugins;
       std::map<string, std::shared_ptr<abstract_plugin>> _available_plugins;
 
       bool _is_finished_syncing = false;
+
+      /// block database of the primary node when running as a read replica, see replica_loop()
+      block_database                                   _replica_source;
+      fc::future<void>                                 _replica_task;
    };
 
 }
@@ -908,6 +1226,11 @@ application::application()
 
 application::~application()
 {
+   // the metrics callbacks read the database and the p2p node
+   utilities::metrics_registry::instance().remove_callbacks( my.get() );
+   my->_metrics_server.reset();
+   if( my->_replica_task.valid() )
+      my->_replica_task.cancel_and_wait( __FUNCTION__ );
    if( my->_p2p_network )
    {
       my->_p2p_network->close();
@@ -935,6 +1258,56 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("dbg-init-key", bpo::value<string>(), "Block signing key to use for init witnesses, overrides genesis file")
          ("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions")
          ("plugins", bpo::value<string>(), "Space-separated list of plugins to activate")
+         ("replica-of", bpo::value<boost::filesystem::path>(),
+          "Data directory of a validating node on this host. Serve the APIs as a read replica which follows the "
+          "blocks saved by that node, instead of syncing over p2p")
+         ("metrics-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8095"),
+          "Endpoint for the metrics exporter to listen on, metrics are served in the Prometheus text format")
+         ("max-pending-transactions-size", bpo::value<uint64_t>()->default_value(64),
+          "Total size in MiB of the transactions waiting to be included in a block, when it is reached the "
+          "transactions paying the lowest fee per byte are dropped (0 for no limit)")
+         ("max-pending-transactions-per-account", bpo::value<uint32_t>()->default_value(1000),
+          "Number of transactions one account can have waiting to be included in a block (0 for no limit)")
+         ("expired-transactions-per-block", bpo::value<uint32_t>()->default_value(0),
+          "Number of expired transactions to forget per block, to spread the cleanup after a burst of transactions "
+          "over several blocks (0 for no limit)")
+         ("undo-blocks-in-memory", bpo::value<uint32_t>()->default_value(0),
+          "Number of reversible blocks whose undo history is kept in memory, the older ones are written to disk "
+          "until they become irreversible (0 for no limit)")
+         ("undo-size-in-memory", bpo::value<uint64_t>()->default_value(0),
+          "Size in MiB of the undo history kept in memory, the history of the older reversible blocks is written to "
+          "disk until they become irreversible (0 for no limit)")
+         ("validated-block-cache-size", bpo::value<uint32_t>()->default_value(256),
+          "Number of recent blocks kept in memory with their signatures checked, to pop blocks and switch forks "
+          "faster (0 to disable)")
+         ("transaction-trace-sample-rate", bpo::value<uint32_t>()->default_value(0),
+          "Trace the lifecycle of 1 in N transactions, from being received until becoming irreversible (0 to disable)")
+         ("transaction-trace-buffer-size", bpo::value<uint32_t>()->default_value(10000),
+          "Number of the most recent transaction traces to keep")
+         ("enable-account-name-index", bpo::value<bool>()->default_value(true),
+          "Keep the names of all accounts in a trie, for lookups of accounts by name prefix and by similar names")
+         ("state-checkpoint-interval", bpo::value<uint32_t>(),
+          "Save the irreversible chain state to disk every N irreversible blocks, so after a crash only the blocks since then are replayed (0 to disable)")
+         ("api-call-cost", bpo::value<vector<string>>()->composing(),
+          "Cost of an API method as a pair of [METHOD,COST], in milliseconds. Methods without a configured cost are "
+          "costed by the time their calls take (may specify multiple times)")
+         ("api-default-call-cost", bpo::value<double>()->default_value(1),
+          "Cost of an API method whose calls were not measured yet, in milliseconds")
+         ("api-quota-per-second", bpo::value<double>()->default_value(0),
+          "Cost of API calls a client can make per second, in milliseconds (0 for no limit)")
+         ("api-quota-burst", bpo::value<double>()->default_value(0),
+          "Cost of API calls a client can make at once after being idle, in milliseconds (at least api-quota-per-second)")
+         ("api-quota-ip-header", bpo::value<string>(),
+          "HTTP header holding the address of the client, e.g. X-Real-IP behind a reverse proxy, otherwise the remote "
+          "address of the connection is used. Connections from the same address share their quota")
+         ("api-max-concurrent-calls", bpo::value<uint32_t>()->default_value(0),
+          "Number of API calls which may run at once (0 for no limit)")
+         ("api-max-cost-in-flight", bpo::value<double>()->default_value(0),
+          "Total cost of the API calls which may run at once, in milliseconds (0 for no limit)")
+         ("api-max-queued-calls", bpo::value<uint32_t>()->default_value(0),
+          "Number of API calls which may wait for others to finish when the limits are reached, the others are refused")
+         ("api-max-queue-wait-ms", bpo::value<uint32_t>()->default_value(500),
+          "Milliseconds an API call waits for others to finish before being refused")
          ;
    command_line_options.add(configuration_file_options);
    command_line_options.add_options()
@@ -1030,6 +1403,16 @@ void application::set_block_production(bool producing_blocks)
    my->_is_block_producer = producing_blocks;
 }
 
+api_admission_stats application::get_api_admission_stats()const
+{
+   return my->_api_admission.get_stats();
+}
+
+api_admission_controller& application::get_api_admission_controller()
+{
+   return my->_api_admission;
+}
+
 optional< api_access_info > application::get_api_access_info( const string& username )const
 {
    return my->get_api_access_info( username );
@@ -1045,6 +1428,11 @@ bool application::is_finished_syncing() const
    return my->_is_finished_syncing;
 }
 
+bool application::is_replica() const
+{
+   return my->_options != nullptr && my->_options->count("replica-of") > 0;
+}
+
 void graphene::app::application::enable_plugin(const string& name)
 {
    FC_ASSERT(my->_available_plugins[name], "Unknown plugin '" + name + "'");
@@ -1065,6 +1453,8 @@ void application::shutdown_plugins()
 }
 void application::shutdown()
 {
+   if( my->_replica_task.valid() )
+      my->_replica_task.cancel_and_wait( __FUNCTION__ );
    if( my->_p2p_network )
       my->_p2p_network->close();
    if( my->_chain_db )
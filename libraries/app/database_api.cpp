@@ -77,6 +77,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       map<uint32_t, optional<block_header>> get_block_header_batch(const vector<uint32_t> block_nums)const;
       optional<signed_block_with_info> get_block(uint32_t block_num)const;
       processed_transaction get_transaction( uint32_t block_num, uint32_t trx_in_block )const;
+      optional<graphene::utilities::transaction_trace> get_transaction_trace( const transaction_id_type& id )const;
+      vector<graphene::utilities::transaction_trace> get_recent_transaction_traces( uint32_t limit )const;
 
       // Globals
       chain_property_object get_chain_properties()const;
@@ -84,6 +86,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       fc::variant_object get_config()const;
       chain_id_type get_chain_id()const;
       dynamic_global_property_object get_dynamic_global_properties()const;
+      vector<slab_pool_stats> get_memory_pool_stats()const;
+      pending_transaction_pool_stats get_pending_transaction_pool_stats()const;
 
       // Keys
       vector<vector<account_uid_type>> get_key_references( vector<public_key_type> key )const;
@@ -99,6 +103,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<account_uid_type> get_account_references( account_uid_type uid )const;
       vector<optional<account_object>> lookup_account_names(const vector<string>& account_names)const;
       map<string,account_uid_type> lookup_accounts_by_name(const string& lower_bound_name, uint32_t limit)const;
+      map<string,account_uid_type> lookup_accounts_by_prefix(const string& prefix, uint32_t limit)const;
+      vector<account_name_match> search_accounts_by_name(const string& name, uint32_t max_distance, uint32_t limit)const;
       uint64_t get_account_count()const;
 
       // CSAF
@@ -108,6 +114,12 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<csaf_lease_object> get_csaf_leases_by_to( const account_uid_type to,
                                                        const account_uid_type lower_bound_from,
                                                        const uint32_t limit )const;
+      api_page<csaf_lease_object> get_csaf_leases_by_from_page( const account_uid_type from,
+                                                                const optional<string>& cursor,
+                                                                const uint32_t limit )const;
+      api_page<csaf_lease_object> get_csaf_leases_by_to_page( const account_uid_type to,
+                                                              const optional<string>& cursor,
+                                                              const uint32_t limit )const;
 
 
       // Platforms and posts
@@ -140,6 +152,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<witness_object> lookup_witnesses(const account_uid_type lower_bound_uid, uint32_t limit,
                                               data_sorting_type order_by)const;
       uint64_t get_witness_count()const;
+      vector<double_production_evidence> get_double_production_evidence()const;
 
       // Committee members and proposals
       vector<optional<committee_member_object>> get_committee_members(const vector<account_uid_type>& committee_member_uids)const;
@@ -161,6 +174,9 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
       // Proposed transactions
       vector<proposal_object> get_proposed_transactions( account_uid_type uid )const;
+      api_page<proposal_object> get_proposed_transactions_page( account_uid_type uid,
+                                                                const optional<string>& cursor,
+                                                                const uint32_t limit )const;
 
    //private:
       template<typename T>
@@ -412,6 +428,27 @@ processed_transaction database_api_impl::get_transaction(uint32_t block_num, uin
    return opt_block->transactions[trx_num];
 }
 
+optional<graphene::utilities::transaction_trace> database_api::get_transaction_trace( const transaction_id_type& id )const
+{
+   return my->get_transaction_trace( id );
+}
+
+optional<graphene::utilities::transaction_trace> database_api_impl::get_transaction_trace( const transaction_id_type& id )const
+{
+   return graphene::utilities::transaction_tracer::instance().get_trace( id );
+}
+
+vector<graphene::utilities::transaction_trace> database_api::get_recent_transaction_traces( uint32_t limit )const
+{
+   return my->get_recent_transaction_traces( limit );
+}
+
+vector<graphene::utilities::transaction_trace> database_api_impl::get_recent_transaction_traces( uint32_t limit )const
+{
+   FC_ASSERT( limit <= 1000 );
+   return graphene::utilities::transaction_tracer::instance().get_recent_traces( limit );
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Globals                                                          //
@@ -468,6 +505,26 @@ dynamic_global_property_object database_api_impl::get_dynamic_global_properties(
    return _db.get(dynamic_global_property_id_type());
 }
 
+vector<slab_pool_stats> database_api::get_memory_pool_stats()const
+{
+   return my->get_memory_pool_stats();
+}
+
+vector<slab_pool_stats> database_api_impl::get_memory_pool_stats()const
+{
+   return _db.get_memory_pool_stats();
+}
+
+pending_transaction_pool_stats database_api::get_pending_transaction_pool_stats()const
+{
+   return my->get_pending_transaction_pool_stats();
+}
+
+pending_transaction_pool_stats database_api_impl::get_pending_transaction_pool_stats()const
+{
+   return _db.get_pending_transaction_pool_stats();
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Keys                                                             //
@@ -493,7 +550,7 @@ vector<vector<account_uid_type>> database_api_impl::get_key_references( vector<p
       subscribe_to_item( key );
 
       const auto& idx = _db.get_index_type<account_index>();
-      const auto& aidx = dynamic_cast<const primary_index<account_index>&>(idx);
+      const auto& aidx = dynamic_cast<const primary_index_of<account_object>::type&>(idx);
       const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
       auto itr = refs.account_to_key_memberships.find(key);
       vector<account_uid_type> result;
@@ -533,7 +590,7 @@ bool database_api_impl::is_public_key_registered(string public_key) const
         return false;
     }
     const auto& idx = _db.get_index_type<account_index>();
-    const auto& aidx = dynamic_cast<const primary_index<account_index>&>(idx);
+    const auto& aidx = dynamic_cast<const primary_index_of<account_object>::type&>(idx);
     const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
     auto itr = refs.account_to_key_memberships.find(key);
     bool is_known = itr != refs.account_to_key_memberships.end();
@@ -800,7 +857,7 @@ vector<account_uid_type> database_api::get_account_references( account_uid_type
 vector<account_uid_type> database_api_impl::get_account_references( account_uid_type uid )const
 {
    const auto& idx = _db.get_index_type<account_index>();
-   const auto& aidx = dynamic_cast<const primary_index<account_index>&>(idx);
+   const auto& aidx = dynamic_cast<const primary_index_of<account_object>::type&>(idx);
    const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
    auto itr = refs.account_to_account_memberships.find(uid);
    vector<account_uid_type> result;
@@ -854,6 +911,39 @@ map<string,account_uid_type> database_api_impl::lookup_accounts_by_name(const st
    return result;
 }
 
+map<string,account_uid_type> database_api::lookup_accounts_by_prefix(const string& prefix, uint32_t limit)const
+{
+   return my->lookup_accounts_by_prefix( prefix, limit );
+}
+
+map<string,account_uid_type> database_api_impl::lookup_accounts_by_prefix(const string& prefix, uint32_t limit)const
+{
+   FC_ASSERT( limit <= 1001 );
+   const auto& idx = _db.get_index_type<account_index>();
+   const auto& aidx = dynamic_cast<const primary_index_of<account_object>::type&>(idx);
+   const auto& names = aidx.get_secondary_index<graphene::app::account_name_index>().names;
+
+   map<string,account_uid_type> result;
+   for( auto& match : names.find_by_prefix( prefix, limit ) )
+      result.emplace_hint( result.end(), std::move( match.name ), match.uid );
+   return result;
+}
+
+vector<account_name_match> database_api::search_accounts_by_name(const string& name, uint32_t max_distance, uint32_t limit)const
+{
+   return my->search_accounts_by_name( name, max_distance, limit );
+}
+
+vector<account_name_match> database_api_impl::search_accounts_by_name(const string& name, uint32_t max_distance, uint32_t limit)const
+{
+   FC_ASSERT( max_distance <= 2 );
+   FC_ASSERT( limit <= 100 );
+   FC_ASSERT( name.size() <= GRAPHENE_MAX_ACCOUNT_NAME_LENGTH );
+   const auto& idx = _db.get_index_type<account_index>();
+   const auto& aidx = dynamic_cast<const primary_index_of<account_object>::type&>(idx);
+   return aidx.get_secondary_index<graphene::app::account_name_index>().names.find_similar( name, max_distance, limit );
+}
+
 uint64_t database_api::get_account_count()const
 {
    return my->get_account_count();
@@ -900,6 +990,37 @@ vector<csaf_lease_object> database_api_impl::get_csaf_leases_by_from( const acco
    return result;
 }
 
+api_page<csaf_lease_object> database_api::get_csaf_leases_by_from_page( const account_uid_type from,
+                                                                         const optional<string> cursor,
+                                                                         const uint32_t limit )const
+{
+   return my->get_csaf_leases_by_from_page( from, cursor, limit );
+}
+
+api_page<csaf_lease_object> database_api_impl::get_csaf_leases_by_from_page( const account_uid_type from,
+                                                                              const optional<string>& cursor,
+                                                                              const uint32_t limit )const
+{
+   FC_ASSERT( limit <= max_page_size );
+
+   api_page<csaf_lease_object> page;
+   account_uid_type lower_bound_to = 0;
+   begin_page( _db, cursor, page, lower_bound_to );
+
+   const auto& idx = _db.get_index_type<csaf_lease_index>().indices().get<by_from_to>();
+   auto itr = idx.lower_bound( std::make_tuple( from, lower_bound_to ) );
+
+   while( itr != idx.end() && itr->from == from && page.items.size() < limit )
+   {
+      page.items.push_back(*itr);
+      ++itr;
+   }
+   if( itr != idx.end() && itr->from == from )
+      set_next_cursor( page, itr->to );
+
+   return page;
+}
+
 vector<csaf_lease_object> database_api::get_csaf_leases_by_to( const account_uid_type to,
                                                                const account_uid_type lower_bound_from,
                                                                const uint32_t limit )const
@@ -930,6 +1051,37 @@ vector<csaf_lease_object> database_api_impl::get_csaf_leases_by_to( const accoun
    return result;
 }
 
+api_page<csaf_lease_object> database_api::get_csaf_leases_by_to_page( const account_uid_type to,
+                                                                       const optional<string> cursor,
+                                                                       const uint32_t limit )const
+{
+   return my->get_csaf_leases_by_to_page( to, cursor, limit );
+}
+
+api_page<csaf_lease_object> database_api_impl::get_csaf_leases_by_to_page( const account_uid_type to,
+                                                                            const optional<string>& cursor,
+                                                                            const uint32_t limit )const
+{
+   FC_ASSERT( limit <= max_page_size );
+
+   api_page<csaf_lease_object> page;
+   account_uid_type lower_bound_from = 0;
+   begin_page( _db, cursor, page, lower_bound_from );
+
+   const auto& idx = _db.get_index_type<csaf_lease_index>().indices().get<by_to_from>();
+   auto itr = idx.lower_bound( std::make_tuple( to, lower_bound_from ) );
+
+   while( itr != idx.end() && itr->to == to && page.items.size() < limit )
+   {
+      page.items.push_back(*itr);
+      ++itr;
+   }
+   if( itr != idx.end() && itr->to == to )
+      set_next_cursor( page, itr->from );
+
+   return page;
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Platforms and posts                                              //
@@ -1119,6 +1271,66 @@ vector<post_object> database_api_impl::get_posts_by_platform_poster( const accou
    return result;
 }
 
+api_page<post_object> database_api::get_posts_by_platform_poster_page( const account_uid_type platform_owner,
+                                      const optional<account_uid_type> poster,
+                                      const std::pair<time_point_sec, time_point_sec> create_time_range,
+                                      const optional<string> cursor,
+                                      const uint32_t limit )const
+{
+   return my->get_posts_by_platform_poster_page( platform_owner, poster, create_time_range, cursor, limit );
+}
+
+template<typename Iterator>
+static void fill_post_page( api_page<post_object>& page, uint32_t limit, Iterator itr, Iterator itr_end )
+{
+   while( itr != itr_end && page.items.size() < limit )
+   {
+      page.items.push_back(*itr);
+      ++itr;
+   }
+   if( itr != itr_end )
+      set_next_cursor( page, std::make_pair( itr->create_time, itr->id ) );
+}
+
+api_page<post_object> database_api_impl::get_posts_by_platform_poster_page( const account_uid_type platform_owner,
+                                      const optional<account_uid_type> poster,
+                                      const std::pair<time_point_sec, time_point_sec> create_time_range,
+                                      const optional<string>& cursor,
+                                      const uint32_t limit )const
+{
+   FC_ASSERT( limit <= max_page_size );
+
+   api_page<post_object> page;
+
+   const time_point_sec max_time = std::max( create_time_range.first, create_time_range.second );
+   const time_point_sec min_time = std::min( create_time_range.first, create_time_range.second );
+
+   // create time and ID of the next post, the index is latest first
+   std::pair<time_point_sec, object_id_type> next;
+   const bool resumed = begin_page( _db, cursor, page, next ) && next.first <= max_time;
+   if( resumed && next.first <= min_time ) // a cursor of another range
+      return page;
+
+   if( poster.valid() )
+   {
+      const auto& post_idx = _db.get_index_type<post_index>().indices().get<by_platform_poster_create_time>();
+      auto itr = resumed ? post_idx.lower_bound( std::make_tuple( platform_owner, *poster, next.first, next.second ) )
+                         : post_idx.lower_bound( std::make_tuple( platform_owner, *poster, max_time ) );
+      auto itr_end = post_idx.lower_bound( std::make_tuple( platform_owner, *poster, min_time ) );
+      fill_post_page( page, limit, itr, itr_end );
+   }
+   else
+   {
+      const auto& post_idx = _db.get_index_type<post_index>().indices().get<by_platform_create_time>();
+      auto itr = resumed ? post_idx.lower_bound( std::make_tuple( platform_owner, next.first, next.second ) )
+                         : post_idx.lower_bound( std::make_tuple( platform_owner, max_time ) );
+      auto itr_end = post_idx.lower_bound( std::make_tuple( platform_owner, min_time ) );
+      fill_post_page( page, limit, itr, itr_end );
+   }
+
+   return page;
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Balances                                                         //
@@ -1369,6 +1581,16 @@ uint64_t database_api_impl::get_witness_count()const
    return _db.get_index_type<witness_index>().indices().get<by_valid>().count( true );
 }
 
+vector<double_production_evidence> database_api::get_double_production_evidence()const
+{
+   return my->get_double_production_evidence();
+}
+
+vector<double_production_evidence> database_api_impl::get_double_production_evidence()const
+{
+   return _db.get_double_production_evidence();
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Committee members and proposals                                  //
@@ -1757,6 +1979,15 @@ vector<proposal_object> database_api::get_proposed_transactions( account_uid_typ
    return my->get_proposed_transactions( uid );
 }
 
+static bool is_proposal_relevant( const proposal_object& p, account_uid_type uid )
+{
+   return p.required_secondary_approvals.find( uid ) != p.required_secondary_approvals.end()
+       || p.required_active_approvals.find( uid ) != p.required_active_approvals.end()
+       || p.required_owner_approvals.find( uid ) != p.required_owner_approvals.end()
+       || p.available_active_approvals.find( uid ) != p.available_active_approvals.end()
+       || p.available_secondary_approvals.find( uid ) != p.available_secondary_approvals.end();
+}
+
 /** TODO: add secondary index that will accelerate this process */
 vector<proposal_object> database_api_impl::get_proposed_transactions( account_uid_type uid )const
 {
@@ -1765,20 +1996,44 @@ vector<proposal_object> database_api_impl::get_proposed_transactions( account_ui
 
    idx.inspect_all_objects( [&](const object& obj){
            const proposal_object& p = static_cast<const proposal_object&>(obj);
-           if( p.required_secondary_approvals.find( uid ) != p.required_secondary_approvals.end() )
-              result.push_back(p);
-           else if( p.required_active_approvals.find( uid ) != p.required_active_approvals.end() )
-              result.push_back(p);
-           else if ( p.required_owner_approvals.find( uid ) != p.required_owner_approvals.end() )
-              result.push_back(p);
-           else if ( p.available_active_approvals.find( uid ) != p.available_active_approvals.end() )
-              result.push_back(p);
-           else if( p.available_secondary_approvals.find( uid ) != p.available_secondary_approvals.end() )
+           if( is_proposal_relevant( p, uid ) )
               result.push_back(p);
    });
    return result;
 }
 
+api_page<proposal_object> database_api::get_proposed_transactions_page( account_uid_type uid,
+                                                                        const optional<string> cursor,
+                                                                        const uint32_t limit )const
+{
+   return my->get_proposed_transactions_page( uid, cursor, limit );
+}
+
+api_page<proposal_object> database_api_impl::get_proposed_transactions_page( account_uid_type uid,
+                                                                             const optional<string>& cursor,
+                                                                             const uint32_t limit )const
+{
+   FC_ASSERT( limit <= max_page_size );
+
+   api_page<proposal_object> page;
+   object_id_type lower_bound_id = proposal_id_type();
+   begin_page( _db, cursor, page, lower_bound_id );
+
+   const auto& idx = _db.get_index_type<proposal_index>().indices().get<by_id>();
+   for( auto itr = idx.lower_bound( lower_bound_id ); itr != idx.end(); ++itr )
+   {
+      if( !is_proposal_relevant( *itr, uid ) )
+         continue;
+      if( page.items.size() == limit )
+      {
+         set_next_cursor( page, itr->id );
+         break;
+      }
+      page.items.push_back(*itr);
+   }
+   return page;
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Private methods                                                  //
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/types.hpp>
+#include <graphene/db/index.hpp>
+
+#include <fc/optional.hpp>
+
+#include <string>
+#include <vector>
+
+namespace graphene { namespace app {
+
+   using graphene::chain::account_uid_type;
+
+   struct account_name_match
+   {
+      std::string       name;
+      account_uid_type  uid = 0;
+      uint32_t          distance = 0; ///< edit distance from the query, 0 for exact and prefix matches
+   };
+
+   /**
+    *  @class name_trie
+    *  @brief compressed trie (radix tree) mapping account names to account UIDs
+    *
+    *  Each edge is labeled with the longest run of bytes shared by all names below it, so a name of length n is
+    *  found in O(n) and the names under a prefix are enumerated in lexicographic order without touching the others.
+    *  Nodes live in a single vector and refer to each other by position, freed nodes are reused.
+    */
+   class name_trie
+   {
+      public:
+         name_trie();
+
+         /** adds a name, or changes its UID if it is already present */
+         void insert( const std::string& name, account_uid_type uid );
+         /** @return false if the name was not present */
+         bool remove( const std::string& name );
+         void clear();
+
+         fc::optional<account_uid_type> find( const std::string& name )const;
+
+         /** @return up to @ref limit names starting with @ref prefix, in lexicographic order */
+         std::vector<account_name_match> find_by_prefix( const std::string& prefix, uint32_t limit )const;
+
+         /**
+          * @return up to @ref limit names within @ref max_distance edits (insertions, deletions and substitutions of
+          * a byte) of @ref name, closest first, then in lexicographic order
+          */
+         std::vector<account_name_match> find_similar( const std::string& name, uint32_t max_distance, uint32_t limit )const;
+
+         size_t size()const { return _size; }
+         size_t node_count()const { return _nodes.size() - _free.size(); }
+
+      private:
+         struct node
+         {
+            std::string             label;    ///< bytes of the edge from the parent
+            std::vector<uint32_t>   children; ///< sorted by the first byte of their label
+            account_uid_type        uid = 0;
+            bool                    terminal = false;
+         };
+
+         /// @return the position in the children of @ref parent of the child whose label starts with @ref c
+         std::vector<uint32_t>::const_iterator find_child( const node& parent, char c )const;
+         uint32_t new_node();
+         void     free_node( uint32_t n );
+
+         void collect( uint32_t n, std::string& path, uint32_t limit, std::vector<account_name_match>& result )const;
+
+         std::vector<node>       _nodes; ///< the root is the first node
+         std::vector<uint32_t>   _free;
+         size_t                  _size = 0;
+   };
+
+   /**
+    *  @brief This secondary index keeps the names of all accounts in a @ref name_trie, for name autocompletion and
+    *  typo-tolerant lookups of the database API.
+    */
+   class account_name_index : public graphene::db::secondary_index
+   {
+      public:
+         virtual void object_inserted( const graphene::db::object& obj ) override;
+         virtual void object_removed( const graphene::db::object& obj ) override;
+         virtual void about_to_modify( const graphene::db::object& before ) override;
+         virtual void object_modified( const graphene::db::object& after  ) override;
+
+         name_trie names;
+
+      protected:
+         std::string before_name;
+   };
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::account_name_match, (name)(uid)(distance) )
@@ -28,6 +28,7 @@
 #include <graphene/chain/protocol/types.hpp>
 
 #include <graphene/debug_witness/debug_api.hpp>
+#include <graphene/post_search/post_search_api.hpp>
 
 #include <graphene/net/node.hpp>
 
@@ -86,7 +87,9 @@ namespace graphene { namespace app {
    class history_api
    {
       public:
-         history_api(application& app):_app(app){}
+         /** @param api_client the key of the quota of the connection, charged for the pages of the exports */
+         history_api( application& app, const string& api_client = string() )
+            : _app( app ), _api_client( api_client ), _streams( std::make_shared<uint32_t>( 0 ) ) {}
 
          /**
           * @brief Get operations relevant to the specificed account
@@ -136,8 +139,44 @@ namespace graphene { namespace app {
                                                                                             unsigned limit = 100,
                                                                                             uint32_t start = 0) const;
 
+         /**
+          * @brief Get operations relevant to the specified account, a page at a time, see
+          * @ref get_relative_account_history
+          * @param account The account whose history should be queried
+          * @param op_type Only query for this operation type if specified
+          * @param cursor @ref api_page::next_cursor of the previous page, omitted to start from the most recent
+          * operation
+          * @param limit Maximum number of operations to retrieve (must not exceed 1000)
+          * @return operations performed by account, with a sequence number for each operation, ordered from most
+          *         recent to oldest.
+          */
+         api_page<std::pair<uint32_t,operation_history_object>> get_relative_account_history_page(
+                                                                   account_uid_type account,
+                                                                   optional<uint16_t> op_type,
+                                                                   optional<string> cursor,
+                                                                   uint32_t limit = 100 ) const;
+
+         /**
+          * @brief Export the whole history of an account: the pages of @ref get_relative_account_history_page are
+          * pushed to @ref callback one after the other, as notices, the last one has no @ref api_page::next_cursor
+          * @param page_size Number of operations per page (must not exceed 1000)
+          *
+          * Each page is charged to the quota of the connection as a call of stream_relative_account_history_page,
+          * the export slows down to what the quota allows. A connection runs at most
+          * @ref max_streams_per_connection exports at a time.
+          */
+         void stream_relative_account_history( std::function<void(const variant&)> callback,
+                                               account_uid_type account,
+                                               optional<uint16_t> op_type,
+                                               uint32_t page_size = 1000 ) const;
+
+         static const uint32_t max_streams_per_connection = 2;
+
       private:
            application& _app;
+           const string _api_client;
+           /// exports running, shared with them so that they can end after the connection
+           std::shared_ptr<uint32_t> _streams;
    };
 
    /**
@@ -248,7 +287,15 @@ namespace graphene { namespace app {
           */
          std::vector<net::potential_peer_record> get_potential_peers() const;
 
+         /**
+          * @brief Get the API calls admitted and refused by admission control, and the estimated cost of each method
+          */
+         api_admission_stats get_api_admission_stats() const;
+
       private:
+         /// @throws if the node runs without p2p, as a read replica
+         net::node_ptr p2p_node() const;
+
          application& _app;
    };
    
@@ -299,11 +346,31 @@ namespace graphene { namespace app {
          asset_api(graphene::chain::database& db);
          ~asset_api();
 
+         /** @return all accounts with a non-zero balance of @ref asset_id, largest balance first */
          vector<account_asset_balance> get_asset_holders( asset_aid_type asset_id )const;
+         /**
+          * @return up to @ref limit accounts with the largest balances of @ref asset_id, largest first
+          * @param limit at most 100
+          */
+         vector<account_asset_balance> get_top_asset_holders( asset_aid_type asset_id, uint32_t limit )const;
+         /** @return the number of accounts with a non-zero balance of @ref asset_id */
          uint64_t get_asset_holders_count( asset_aid_type asset_id )const;
+         /** @return the number of holders and the sum of balances of @ref asset_id */
+         asset_holder_stats get_asset_holder_stats( asset_aid_type asset_id )const;
+         /** @return the number of holders of every asset */
          vector<asset_holders> get_all_asset_holders() const;
+         /**
+          * @return accounts with a non-zero balance of @ref asset_id, largest balance first, a page at a time
+          * @param cursor @ref api_page::next_cursor of the previous page, omitted for the first page
+          * @param limit at most 1000
+          */
+         api_page<account_asset_balance> get_asset_holders_page( asset_aid_type asset_id, optional<string> cursor,
+                                                                 uint32_t limit )const;
 
       private:
+         const asset_holder_index& get_holder_index()const;
+         vector<account_asset_balance> get_top_asset_holders_internal( asset_aid_type asset_id, uint64_t limit )const;
+
          graphene::chain::database& _db;
    };
 
@@ -315,7 +382,8 @@ namespace graphene { namespace app {
    class login_api
    {
       public:
-         login_api(application& a);
+         /** @param api_client the key of the quota of the connection */
+         login_api( application& a, const string& api_client = string() );
          ~login_api();
 
          /**
@@ -344,12 +412,15 @@ namespace graphene { namespace app {
          fc::api<asset_api> asset()const;
          /// @brief Retrieve the debug API (if available)
          fc::api<graphene::debug_witness::debug_api> debug()const;
+         /// @brief Retrieve the post search API (if available)
+         fc::api<graphene::post_search::post_search_api> post_search()const;
 
          /// @brief Called to enable an API, not reflected.
          void enable_api( const string& api_name );
       private:
 
          application& _app;
+         const string _api_client;
          optional< fc::api<block_api> > _block_api;
          optional< fc::api<database_api> > _database_api;
          optional< fc::api<network_broadcast_api> > _network_broadcast_api;
@@ -358,6 +429,7 @@ namespace graphene { namespace app {
          optional< fc::api<crypto_api> > _crypto_api;
          optional< fc::api<asset_api> > _asset_api;
          optional< fc::api<graphene::debug_witness::debug_api> > _debug_api;
+         optional< fc::api<graphene::post_search::post_search_api> > _post_search_api;
    };
 
 }}  // graphene::app
@@ -378,6 +450,8 @@ FC_API(graphene::app::history_api,
        //(get_account_history)
        //(get_account_history_operations)
        (get_relative_account_history)
+       (get_relative_account_history_page)
+       (stream_relative_account_history)
      )
 FC_API(graphene::app::block_api,
        (get_blocks)
@@ -394,6 +468,7 @@ FC_API(graphene::app::network_node_api,
        (get_potential_peers)
        (get_advanced_node_parameters)
        (set_advanced_node_parameters)
+       (get_api_admission_stats)
      )
 FC_API(graphene::app::crypto_api,
        (blind_sign)
@@ -408,8 +483,11 @@ FC_API(graphene::app::crypto_api,
      )
 FC_API(graphene::app::asset_api,
        (get_asset_holders)
+       (get_top_asset_holders)
        (get_asset_holders_count)
+       (get_asset_holder_stats)
        (get_all_asset_holders)
+       (get_asset_holders_page)
      )
 FC_API(graphene::app::login_api,
        (login)
@@ -421,4 +499,5 @@ FC_API(graphene::app::login_api,
        (crypto)
        (asset)
        (debug)
+       (post_search)
      )
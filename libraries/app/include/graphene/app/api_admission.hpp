@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/thread/future.hpp>
+#include <fc/time.hpp>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace graphene { namespace app {
+
+   /**
+    *  Limits of @ref api_admission_controller. Costs are in milliseconds of the thread which runs API calls, 0 disables
+    *  a limit.
+    */
+   struct api_admission_config
+   {
+      double                        default_cost = 1;          ///< of a method which was neither measured nor configured
+      std::map<std::string, double> method_costs;              ///< fixed costs, the other methods are calibrated
+      double                        quota_per_second = 0;      ///< cost refilled per second in the bucket of a client
+      double                        quota_burst = 0;           ///< capacity of the bucket of a client
+      uint32_t                      max_concurrent_calls = 0;
+      double                        max_cost_in_flight = 0;
+      uint32_t                      max_queued_calls = 0;      ///< calls waiting for a slot, the others are rejected
+      fc::microseconds              max_queue_wait = fc::milliseconds( 500 );
+   };
+
+   struct api_admission_stats
+   {
+      uint64_t    admitted = 0;
+      uint64_t    queued = 0;                 ///< calls which waited for a slot
+      uint64_t    rejected_over_quota = 0;
+      uint64_t    rejected_busy = 0;          ///< the queue was full, or the wait for a slot timed out
+      uint32_t    calls_in_flight = 0;
+      double      cost_in_flight = 0;
+      uint32_t    calls_in_queue = 0;
+      uint32_t    clients = 0;                ///< with a bucket
+      std::map<std::string, uint64_t> rejected_by_method;
+      std::map<std::string, double>   method_costs; ///< current estimates
+   };
+
+   /**
+    *  @class api_admission_controller
+    *  @brief decides which API calls may run, so that no client can monopolize the thread which applies blocks
+    *
+    *  Each call has a cost, estimated per method by a moving average of the time it took, unless it is configured.
+    *  A client (a connection, or an address) draws the cost of its calls from a token bucket, calls are refused when
+    *  the bucket is empty. All clients together are bounded by the number and the total cost of the calls in flight,
+    *  a call over these bounds waits in a bounded queue until another call finishes, or is refused.
+    *
+    *  A call which gets @ref busy is retried by its caller, between calls to @ref enter_queue and @ref leave_queue,
+    *  each time @ref wait_for_slot returns.
+    */
+   class api_admission_controller
+   {
+      public:
+         enum result
+         {
+            admitted,
+            over_quota,
+            busy
+         };
+
+         /** a call which was admitted, to pass to @ref finish */
+         struct ticket
+         {
+            std::string method;
+            double      cost = 0;
+         };
+
+         explicit api_admission_controller( const api_admission_config& config = api_admission_config() );
+
+         void set_config( const api_admission_config& config );
+         api_admission_config get_config()const;
+
+         /** @param client the key of the bucket of the caller */
+         result try_admit( const std::string& client, const std::string& method, fc::time_point now, ticket& t );
+         /** ends an admitted call, @ref latency calibrates the cost of its method */
+         void finish( const ticket& t, fc::microseconds latency );
+
+         /** @return false if the queue is full, the call is then refused */
+         bool enter_queue( const std::string& method );
+         /** @param admitted false if the call gave up waiting */
+         void leave_queue( const std::string& method, bool admitted );
+         /**
+          * Blocks the calling task until a call finishes or the limits change, or until @p deadline. Returns at once
+          * if a call of @p method would not be busy.
+          */
+         void wait_for_slot( const std::string& method, fc::time_point deadline );
+
+         double cost_of( const std::string& method )const;
+         api_admission_stats get_stats()const;
+
+      private:
+         struct bucket
+         {
+            double          tokens = 0;
+            fc::time_point  updated;
+         };
+
+         double cost_of_locked( const std::string& method )const;
+         bool   is_busy_locked( double cost )const;
+         /** @return the waiters to wake, outside of the lock */
+         std::vector<fc::promise<void>::ptr> take_waiters_locked();
+         static void wake( const std::vector<fc::promise<void>::ptr>& waiters );
+         void   refill( bucket& b, fc::time_point now )const;
+         void   prune_buckets( fc::time_point now );
+         void   count_rejection( const std::string& method );
+
+         mutable std::mutex                        _mutex;
+         api_admission_config                      _config;
+         std::unordered_map<std::string, double>   _measured_costs;
+         std::unordered_map<std::string, bucket>   _buckets;
+         fc::time_point                            _last_prune;
+         api_admission_stats                       _stats;
+         std::vector<fc::promise<void>::ptr>       _waiters;
+   };
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::api_admission_stats,
+            (admitted)(queued)(rejected_over_quota)(rejected_busy)(calls_in_flight)(cost_in_flight)(calls_in_queue)
+            (clients)(rejected_by_method)(method_costs) )
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/optional.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <string>
+#include <vector>
+
+namespace graphene { namespace app {
+   using graphene::chain::block_id_type;
+   using std::string;
+   using std::vector;
+
+   /** largest page returned by the paged APIs */
+   const uint32_t max_page_size = 1000;
+
+   /**
+    *  Where a paged query resumes: the key, in the index walked by the query, of the first object of the next page,
+    *  and the head block when the cursor was issued. Clients only see it encoded as a string, see @ref encode_cursor.
+    */
+   struct page_cursor
+   {
+      uint32_t            head_block_num = 0;
+      block_id_type       head_block_id;
+      std::vector<char>   key;
+   };
+
+   /**
+    *  A page of results. Pages are consistent with the index at @ref head_block_num: when blocks arrive between two
+    *  pages, a page starts exactly where the previous one stopped, but objects changed meanwhile may be seen twice or
+    *  missed. @ref reorganized tells that the block the cursor was issued at is no longer in the chain, the pages
+    *  read so far may then contain objects of the abandoned fork.
+    */
+   template<typename T>
+   struct api_page
+   {
+      vector<T>           items;
+      fc::optional<string> next_cursor;    ///< absent after the last page
+      uint32_t            head_block_num = 0;
+      block_id_type       head_block_id;
+      bool                reorganized = false;
+   };
+
+   string      encode_cursor( const page_cursor& cursor );
+   page_cursor decode_cursor( const string& cursor );
+
+   /** @return true if the head block @ref cursor was issued at was popped, or replaced by a block of another fork */
+   bool cursor_reorganized( const graphene::chain::database& db, const page_cursor& cursor );
+
+   /** starts @ref page, reading the key to resume at from @ref cursor if there is one, @return true if there is one */
+   template<typename T, typename Key>
+   bool begin_page( const graphene::chain::database& db, const fc::optional<string>& cursor, api_page<T>& page,
+                    Key& key )
+   {
+      page.head_block_num = db.head_block_num();
+      page.head_block_id = db.head_block_id();
+      if( !cursor.valid() || cursor->empty() )
+         return false;
+      const page_cursor c = decode_cursor( *cursor );
+      try {
+         key = fc::raw::unpack<Key>( c.key );
+      } FC_CAPTURE_AND_RETHROW( (cursor) )
+      page.reorganized = cursor_reorganized( db, c );
+      return true;
+   }
+
+   /** ends @ref page, which stopped before the object of key @ref key */
+   template<typename T, typename Key>
+   void set_next_cursor( api_page<T>& page, const Key& key )
+   {
+      page_cursor c;
+      c.head_block_num = page.head_block_num;
+      c.head_block_id = page.head_block_id;
+      c.key = fc::raw::pack( key );
+      page.next_cursor = encode_cursor( c );
+   }
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::page_cursor, (head_block_num)(head_block_id)(key) )
+FC_REFLECT_TEMPLATE( (typename T), graphene::app::api_page<T>,
+                     (items)(next_cursor)(head_block_num)(head_block_id)(reorganized) )
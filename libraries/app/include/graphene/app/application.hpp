@@ -24,6 +24,7 @@
 #pragma once
 
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/api_admission.hpp>
 #include <graphene/net/node.hpp>
 #include <graphene/chain/database.hpp>
 
@@ -82,9 +83,15 @@ namespace graphene { namespace app {
 
          void set_block_production(bool producing_blocks);
          fc::optional< api_access_info > get_api_access_info( const string& username )const;
+         /** @return the calls admitted and refused by the admission control of the websocket APIs */
+         api_admission_stats get_api_admission_stats()const;
+         /** @return the admission control of the websocket APIs, for calls which go on after they returned */
+         api_admission_controller& get_api_admission_controller();
          void set_api_access_info(const string& username, api_access_info&& permissions);
 
          bool is_finished_syncing()const;
+         /// @return true if the node follows the block database of another node instead of the p2p network
+         bool is_replica()const;
          /// Emitted when syncing finishes (is_finished_syncing will return true)
          boost::signals2::signal<void()> syncing_finished;
 
@@ -23,6 +23,8 @@
  */
 #pragma once
 
+#include <graphene/app/account_name_index.hpp>
+#include <graphene/app/api_pagination.hpp>
 #include <graphene/app/full_account.hpp>
 
 #include <graphene/chain/protocol/types.hpp>
@@ -38,6 +40,8 @@
 #include <graphene/chain/proposal_object.hpp>
 #include <graphene/chain/witness_object.hpp>
 
+#include <graphene/utilities/transaction_tracer.hpp>
+
 #include <fc/api.hpp>
 #include <fc/optional.hpp>
 #include <fc/variant_object.hpp>
@@ -186,6 +190,20 @@ class database_api
        */
       optional<signed_transaction> get_recent_transaction_by_id( const transaction_id_type& id )const;
 
+      /**
+       * @brief Retrieve when a transaction traced by this node reached each stage of its lifecycle
+       * @return the trace, or null if the transaction was not sampled or its trace was dropped from the buffer
+       *
+       * Only the transactions sampled by the transaction-trace-sample-rate option of the node are traced.
+       */
+      optional<graphene::utilities::transaction_trace> get_transaction_trace( const transaction_id_type& id )const;
+
+      /**
+       * @brief Retrieve the most recent transaction traces of this node, newest first
+       * @param limit Maximum number of traces to return, must not exceed 1000
+       */
+      vector<graphene::utilities::transaction_trace> get_recent_transaction_traces( uint32_t limit )const;
+
       /////////////
       // Globals //
       /////////////
@@ -215,6 +233,17 @@ class database_api
        */
       dynamic_global_property_object get_dynamic_global_properties()const;
 
+      /**
+       * @brief Retrieve occupancy of the slab pools which hold the nodes of high churn object indexes of this node's
+       * database
+       */
+      vector<slab_pool_stats> get_memory_pool_stats()const;
+
+      /**
+       * @brief Retrieve size, limits and eviction counters of the pool of transactions waiting to be included in a block
+       */
+      pending_transaction_pool_stats get_pending_transaction_pool_stats()const;
+
       //////////
       // Keys //
       //////////
@@ -306,6 +335,23 @@ class database_api
        */
       map<string,account_uid_type> lookup_accounts_by_name(const string& lower_bound_name, uint32_t limit)const;
 
+      /**
+       * @brief Get names and UIDs of the accounts whose name starts with a prefix, for name autocompletion
+       * @param prefix Prefix of the names to return
+       * @param limit Maximum number of results to return -- must not exceed 1001
+       * @return Map of account names to corresponding IDs, the first names in lexicographic order
+       */
+      map<string,account_uid_type> lookup_accounts_by_prefix(const string& prefix, uint32_t limit)const;
+
+      /**
+       * @brief Get the accounts whose name is close to a possibly misspelled name
+       * @param name The name to look for
+       * @param max_distance Maximum number of inserted, deleted or substituted characters -- must not exceed 2
+       * @param limit Maximum number of results to return -- must not exceed 100
+       * @return The closest names with their UIDs and edit distances, closest first
+       */
+      vector<account_name_match> search_accounts_by_name(const string& name, uint32_t max_distance, uint32_t limit)const;
+
       //////////////
       // Balances //
       //////////////
@@ -352,6 +398,28 @@ class database_api
                                                        const account_uid_type lower_bound_from,
                                                        const uint32_t limit )const;
 
+      /**
+       * @brief Get CSAF leases by lessor, a page at a time
+       * @param from UID of the lessor
+       * @param cursor @ref api_page::next_cursor of the previous page, omitted for the first page
+       * @param limit Maximum number of results to return -- must not exceed 1000
+       * @return Leases of same lessor, ordered by lessee UID
+       */
+      api_page<csaf_lease_object> get_csaf_leases_by_from_page( const account_uid_type from,
+                                                                const optional<string> cursor,
+                                                                const uint32_t limit )const;
+
+      /**
+       * @brief Get CSAF leases by lessee, a page at a time
+       * @param to UID of the lessee
+       * @param cursor @ref api_page::next_cursor of the previous page, omitted for the first page
+       * @param limit Maximum number of results to return -- must not exceed 1000
+       * @return Leases of same lessee, ordered by lessor UID
+       */
+      api_page<csaf_lease_object> get_csaf_leases_by_to_page( const account_uid_type to,
+                                                              const optional<string> cursor,
+                                                              const uint32_t limit )const;
+
 
       /////////////////////////
       // Platforms and posts //
@@ -412,6 +480,21 @@ class database_api
                                       const std::pair<time_point_sec, time_point_sec> create_time_range,
                                       const uint32_t limit )const;
 
+      /**
+       * @brief Get posts by platform plus poster, a page at a time
+       * @param platform_owner uid of a platform
+       * @param poster UID of a poster, will query for all posters if omitted
+       * @param create_time_range a time range (earliest, latest] to query
+       * @param cursor @ref api_page::next_cursor of the previous page, omitted for the first page
+       * @param limit Maximum number of posts to fetch (must not exceed 1000)
+       * @return posts corresponding to the provided parameters, ordered by create time, newest first.
+       */
+      api_page<post_object> get_posts_by_platform_poster_page( const account_uid_type platform_owner,
+                                      const optional<account_uid_type> poster,
+                                      const std::pair<time_point_sec, time_point_sec> create_time_range,
+                                      const optional<string> cursor,
+                                      const uint32_t limit )const;
+
       ////////////
       // Assets //
       ////////////
@@ -475,6 +558,12 @@ class database_api
        */
       uint64_t get_witness_count()const;
 
+      /**
+       * @brief Get the double productions seen by this node
+       * @return for each slot a witness signed two different blocks for, both signed headers, oldest first
+       */
+      vector<double_production_evidence> get_double_production_evidence()const;
+
 
       /////////////////////////////////////
       // Committee members and proposals //
@@ -571,6 +660,15 @@ class database_api
        */
       vector<proposal_object> get_proposed_transactions( account_uid_type uid )const;
 
+      /**
+       *  @param cursor @ref api_page::next_cursor of the previous page, omitted for the first page
+       *  @param limit Maximum number of proposals to return -- must not exceed 1000
+       *  @return the proposed transactions relevant to the specified account, ordered by ID
+       */
+      api_page<proposal_object> get_proposed_transactions_page( account_uid_type uid,
+                                                                const optional<string> cursor,
+                                                                const uint32_t limit )const;
+
    private:
       std::shared_ptr< database_api_impl > my;
 };
@@ -623,6 +721,8 @@ FC_API( graphene::app::database_api,
    (get_block)
    (get_transaction)
    (get_recent_transaction_by_id)
+   (get_transaction_trace)
+   (get_recent_transaction_traces)
 
    // Globals
    (get_chain_properties)
@@ -630,6 +730,8 @@ FC_API( graphene::app::database_api,
    (get_config)
    (get_chain_id)
    (get_dynamic_global_properties)
+   (get_memory_pool_stats)
+   (get_pending_transaction_pool_stats)
 
    // Keys
    (get_key_references)
@@ -644,11 +746,15 @@ FC_API( graphene::app::database_api,
    (get_account_references)
    //(lookup_account_names)
    (lookup_accounts_by_name)
+   (lookup_accounts_by_prefix)
+   (search_accounts_by_name)
    (get_account_count)
 
    // CSAF
    (get_csaf_leases_by_from)
    (get_csaf_leases_by_to)
+   (get_csaf_leases_by_from_page)
+   (get_csaf_leases_by_to_page)
 
    // Platforms and posts
    (get_platforms)
@@ -657,6 +763,7 @@ FC_API( graphene::app::database_api,
    (get_platform_count)
    (get_post)
    (get_posts_by_platform_poster)
+   (get_posts_by_platform_poster_page)
 
    // Balances
    (get_account_balances)
@@ -672,6 +779,7 @@ FC_API( graphene::app::database_api,
    (get_witness_by_account)
    (lookup_witnesses)
    (get_witness_count)
+   (get_double_production_evidence)
 
    // Committee members
    (get_committee_members)
@@ -692,5 +800,6 @@ FC_API( graphene::app::database_api,
 
    // Proposed transactions
    //(get_proposed_transactions)
+   (get_proposed_transactions_page)
 
 )
@@ -23,6 +23,7 @@
  */
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/coin_seconds.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/hardfork.hpp>
 #include <fc/uint128.hpp>
@@ -53,7 +54,6 @@ std::pair<fc::uint128_t,share_type> account_statistics_object::compute_coin_seco
    fc::time_point_sec now_rounded( ( now.sec_since_epoch() / 60 ) * 60 );
    // check average coins and max coin-seconds
    share_type new_average_coins;
-   fc::uint128_t max_coin_seconds;
 
    share_type effective_balance = core_balance + core_leased_in - core_leased_out;
 
@@ -65,34 +65,21 @@ std::pair<fc::uint128_t,share_type> account_statistics_object::compute_coin_seco
       if( delta_seconds >= window )
          new_average_coins = effective_balance;
       else
-      {
-         uint64_t old_seconds = window - delta_seconds;
-
-         fc::uint128_t old_coin_seconds = fc::uint128_t( average_coins.value ) * old_seconds;
-         fc::uint128_t new_coin_seconds = fc::uint128_t( effective_balance.value ) * delta_seconds;
-
-         max_coin_seconds = old_coin_seconds + new_coin_seconds;
-         new_average_coins = ( max_coin_seconds / window ).to_uint64();
-      }
+         new_average_coins = coin_seconds::average_after( average_coins.value, effective_balance.value, window, delta_seconds );
    }
    // kill rounding issue
-   max_coin_seconds = fc::uint128_t( new_average_coins.value ) * window;
+   const fc::uint128_t max_coin_seconds = coin_seconds::window_capacity( new_average_coins.value, window );
 
    // check earned coin-seconds
    fc::uint128_t new_coin_seconds_earned;
    if( now_rounded <= coin_seconds_earned_last_update )
-      new_coin_seconds_earned = coin_seconds_earned;
+      new_coin_seconds_earned = ( coin_seconds_earned > max_coin_seconds ? max_coin_seconds : coin_seconds_earned );
    else
    {
       int64_t delta_seconds = ( now_rounded - coin_seconds_earned_last_update ).to_seconds();
-
-      fc::uint128_t delta_coin_seconds = effective_balance.value;
-      delta_coin_seconds *= delta_seconds;
-
-      new_coin_seconds_earned = coin_seconds_earned + delta_coin_seconds;
+      new_coin_seconds_earned = coin_seconds::accrue( coin_seconds_earned, effective_balance.value, delta_seconds,
+                                                      max_coin_seconds );
    }
-   if( new_coin_seconds_earned > max_coin_seconds )
-      new_coin_seconds_earned = max_coin_seconds;
 
    return std::make_pair( new_coin_seconds_earned, new_average_coins );
 }
@@ -236,4 +223,59 @@ void account_referrer_index::object_modified( const object& after  )
 {
 }
 
+void asset_holder_index::add_balance( asset_aid_type asset_id, share_type balance )
+{
+   asset_holder_stats& stats = stats_by_asset[asset_id];
+   if( balance != 0 )
+      ++stats.holders;
+   stats.total_balance += balance;
+}
+
+void asset_holder_index::remove_balance( asset_aid_type asset_id, share_type balance )
+{
+   auto itr = stats_by_asset.find( asset_id );
+   FC_ASSERT( itr != stats_by_asset.end(), "no balance of asset ${a} is tracked", ("a",asset_id) );
+   if( balance != 0 )
+      --itr->second.holders;
+   itr->second.total_balance -= balance;
+}
+
+asset_holder_stats asset_holder_index::get_stats( asset_aid_type asset_id )const
+{
+   auto itr = stats_by_asset.find( asset_id );
+   if( itr == stats_by_asset.end() )
+      return asset_holder_stats();
+   return itr->second;
+}
+
+void asset_holder_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const account_balance_object*>(&obj) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(obj);
+   add_balance( b.asset_type, b.balance );
+}
+
+void asset_holder_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const account_balance_object*>(&obj) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(obj);
+   remove_balance( b.asset_type, b.balance );
+}
+
+void asset_holder_index::about_to_modify( const object& before )
+{
+   assert( dynamic_cast<const account_balance_object*>(&before) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(before);
+   before_asset_type = b.asset_type;
+   before_balance    = b.balance;
+}
+
+void asset_holder_index::object_modified( const object& after  )
+{
+   assert( dynamic_cast<const account_balance_object*>(&after) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(after);
+   remove_balance( before_asset_type, before_balance );
+   add_balance( b.asset_type, b.balance );
+}
+
 } } // graphene::chain
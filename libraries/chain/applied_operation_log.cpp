@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/chain/applied_operation_log.hpp>
+
+namespace graphene { namespace chain {
+
+void applied_operation::copy_to( operation_history_object& h )const
+{
+   h.op              = *op;
+   h.result          = result;
+   h.block_timestamp = block_timestamp;
+   h.block_num       = block_num;
+   h.trx_in_block    = trx_in_block;
+   h.op_in_trx       = op_in_trx;
+   h.virtual_op      = virtual_op;
+}
+
+applied_operation& applied_operation_log::push( const operation& op, bool stable )
+{
+   _entries.emplace_back();
+   applied_operation& a = _entries.back();
+   if( stable )
+      a.op = &op;
+   else
+   {
+      _arena.push_back( op );
+      a.op = &_arena.back();
+      a.owned = true;
+   }
+   return a;
+}
+
+void applied_operation_log::truncate( size_t n )
+{
+   while( _entries.size() > n )
+   {
+      if( _entries.back().owned )
+         _arena.pop_back();
+      _entries.pop_back();
+   }
+}
+
+void applied_operation_log::clear()
+{
+   _entries.clear();
+   _arena.clear();
+}
+
+} } // graphene::chain
@@ -39,13 +39,22 @@ FC_REFLECT( graphene::chain::index_entry, (block_pos)(block_size)(block_id) );
 
 namespace graphene { namespace chain {
 
-void block_database::open( const fc::path& dbdir )
+void block_database::open( const fc::path& dbdir, bool read_only )
 { try {
-   fc::create_directories(dbdir);
+   _read_only = read_only;
    _block_num_to_pos.exceptions(std::ios_base::failbit | std::ios_base::badbit);
    _blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
 
    _index_filename = dbdir / "index";
+   if( read_only )
+   {
+     FC_ASSERT( fc::exists( _index_filename ), "No block database in ${d}", ("d",dbdir) );
+     _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in );
+     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in );
+     return;
+   }
+
+   fc::create_directories(dbdir);
    if( !fc::exists( _index_filename ) )
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
@@ -83,15 +92,25 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
       id = b.id();
       elog( "id argument of block_database::store() was not initialized for block ${id}", ("id", id) );
    }
+   auto vec = fc::raw::pack( b );
+   write( id, vec.data(), vec.size() );
+}
+
+void block_database::store( const packed_block& b )
+{
+   write( b.id(), b.bytes().data(), b.bytes().size() );
+}
+
+void block_database::write( const block_id_type& id, const char* data, size_t size )
+{
    auto num = block_header::num_from_id(id);
    _block_num_to_pos.seekp( sizeof( index_entry ) * num );
    index_entry e;
    _blocks.seekp( 0, _blocks.end );
-   auto vec = fc::raw::pack( b );
    e.block_pos  = _blocks.tellp();
-   e.block_size = vec.size();
+   e.block_size = size;
    e.block_id   = id;
-   _blocks.write( vec.data(), vec.size() );
+   _blocks.write( data, size );
    _block_num_to_pos.write( (char*)&e, sizeof(e) );
 }
 
@@ -147,6 +166,24 @@ block_id_type block_database::fetch_block_id( uint32_t block_num )const
 }
 
 optional<signed_block> block_database::fetch_optional( const block_id_type& id )const
+{
+   optional<packed_block> packed = fetch_packed( id );
+   if( !packed.valid() )
+      return optional<signed_block>();
+   try
+   {
+      return packed->decode();
+   }
+   catch (const fc::exception&)
+   {
+   }
+   catch (const std::exception&)
+   {
+   }
+   return optional<signed_block>();
+}
+
+optional<packed_block> block_database::fetch_packed( const block_id_type& id )const
 {
    try
    {
@@ -159,13 +196,13 @@ optional<signed_block> block_database::fetch_optional( const block_id_type& id )
       _block_num_to_pos.seekg( index_pos );
       _block_num_to_pos.read( (char*)&e, sizeof(e) );
 
-      if( e.block_id != id ) return optional<signed_block>();
+      if( e.block_id != id ) return optional<packed_block>();
 
       vector<char> data( e.block_size );
       _blocks.seekg( e.block_pos );
       if (e.block_size)
          _blocks.read( data.data(), e.block_size );
-      auto result = fc::raw::unpack<signed_block>(data);
+      packed_block result( std::move(data) );
       FC_ASSERT( result.id() == e.block_id );
       return result;
    }
@@ -175,7 +212,7 @@ optional<signed_block> block_database::fetch_optional( const block_id_type& id )
    catch (const std::exception&)
    {
    }
-   return optional<signed_block>();
+   return optional<packed_block>();
 }
 
 optional<signed_block> block_database::fetch_by_number( uint32_t block_num )const
@@ -204,6 +241,9 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
    catch (const std::exception&)
    {
    }
+   // a block which is still being written by another process fails the read, keep the streams usable
+   _blocks.clear();
+   _block_num_to_pos.clear();
    return optional<signed_block>();
 }
 
@@ -246,6 +286,9 @@ optional<index_entry> block_database::last_index_entry()const {
             catch (const std::exception&)
             {
             }
+         // the writer of a read-only database may be in the middle of appending this entry
+         if( _read_only )
+            continue;
          fc::resize_file( _index_filename, pos );
       }
    }
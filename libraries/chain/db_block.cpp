@@ -37,10 +37,47 @@
 #include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/evaluator.hpp>
 
+#include <graphene/utilities/metrics.hpp>
+#include <graphene/utilities/transaction_tracer.hpp>
+
 #include <fc/smart_ref_impl.hpp>
+#include <fc/io/json.hpp>
+
+#include <algorithm>
+#include <fstream>
 
 namespace graphene { namespace chain {
 
+namespace {
+
+/// adds the time since the previous lap to a step of the block apply profile, when profiling is enabled
+class profile_lap_timer
+{
+   public:
+      explicit profile_lap_timer( bool enabled ) : _enabled( enabled ) { restart(); }
+
+      void restart()
+      {
+         if( _enabled )
+            _last = fc::time_point::now();
+      }
+
+      void lap( fc::microseconds& step )
+      {
+         if( !_enabled )
+            return;
+         const fc::time_point now = fc::time_point::now();
+         step += now - _last;
+         _last = now;
+      }
+
+   private:
+      bool           _enabled;
+      fc::time_point _last;
+};
+
+}
+
 bool database::is_known_block( const block_id_type& id )const
 {
    return _fork_db.is_known_block(id) || _block_id_to_block.contains(id);
@@ -78,6 +115,17 @@ optional<signed_block> database::fetch_block_by_id( const block_id_type& id )con
    return b->data;
 }
 
+optional<packed_block> database::fetch_packed_block_by_id( const block_id_type& id )const
+{
+   auto packed = _block_id_to_block.fetch_packed( id );
+   if( packed.valid() )
+      return packed;
+   auto b = _fork_db.fetch_block( id );
+   if( !b )
+      return optional<packed_block>();
+   return packed_block( b->data );
+}
+
 optional<signed_block> database::fetch_block_by_number( uint32_t num )const
 {
    auto results = _fork_db.fetch_block_by_number(num);
@@ -120,29 +168,67 @@ std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of
  * @return true if we switched forks as a result of this push.
  */
 bool database::push_block(const signed_block& new_block, uint32_t skip)
+{
+   return push_block( new_block, packed_block(), skip );
+}
+
+bool database::push_block(const signed_block& new_block, const packed_block& packed, uint32_t skip)
 {
 //   idump((new_block.block_num())(new_block.id())(new_block.timestamp)(new_block.previous));
    bool result;
    detail::with_skip_flags( *this, skip, [&]()
    {
-      detail::without_pending_transactions( *this, std::move(_pending_tx),
+      detail::without_pending_transactions( *this, _pending_tx.release( head_block_time() ),
       [&]()
       {
-         result = _push_block(new_block);
+         result = _push_block(new_block, packed);
+         // pending transactions are not applied here, so the undo states are those of the blocks
+         if( _state_checkpoint_interval != 0
+             && get_dynamic_global_properties().last_irreversible_block_num
+                >= _state_checkpoint_block + _state_checkpoint_interval )
+            save_state_checkpoint();
       });
    });
    return result;
 }
 
-bool database::_push_block(const signed_block& new_block)
+uint32_t database::push_blocks_from( const block_database& source, uint32_t skip, uint32_t max_blocks )
+{ try {
+   while( head_block_num() > 0 && !source.contains( head_block_id() ) )
+   {
+      FC_ASSERT( head_block_num() > last_non_undoable_block_num(),
+                 "Irreversible block ${n} is not in the source block database", ("n",head_block_num()) );
+      ilog( "Popping block ${n} which was replaced in the source block database", ("n",head_block_num()) );
+      block_id_type popped_block_id = head_block_id();
+      pop_block();
+      _fork_db.remove( popped_block_id );
+   }
+   // transactions of popped blocks are in the source blocks which replaced them, don't re-apply them as pending
+   _popped_tx.clear();
+
+   uint32_t pushed = 0;
+   while( pushed < max_blocks )
+   {
+      optional<signed_block> block = source.fetch_by_number( head_block_num() + 1 );
+      if( !block.valid() || block->previous != head_block_id() )
+         break;
+      push_block( *block, skip );
+      ++pushed;
+   }
+   return pushed;
+} FC_CAPTURE_AND_RETHROW( (skip)(max_blocks) ) }
+
+bool database::_push_block(const signed_block& new_block, const packed_block& packed)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
+   shared_ptr<fork_item> new_head;
    if( !(skip&skip_fork_db) )
    {
       /// TODO: if the block is greater than the head block and before the next maitenance interval
       // verify that the block signer is in the current set of active witnesses.
 
-      shared_ptr<fork_item> new_head = _fork_db.push_block(new_block);
+      new_head = _fork_db.push_block(new_block);
+      check_double_production( new_block );
       //If the head block from the longest chain does not build off of the current head, we need to switch forks.
       if( new_head->data.previous != head_block_id() )
       {
@@ -151,6 +237,9 @@ bool database::_push_block(const signed_block& new_block)
          if( new_head->data.block_num() > head_block_num() )
          {
             wlog( "Switching to fork: ${id}", ("id",new_head->data.id()) );
+            static auto& fork_switches = graphene::utilities::metrics_registry::instance().get_counter(
+                  "graphene_fork_switches_total", "Number of times the node switched to another fork" );
+            fork_switches.increment();
             auto branches = _fork_db.fetch_branch_from(new_head->data.id(), head_block_id());
 
             // pop blocks until we hit the forked block
@@ -175,7 +264,8 @@ bool database::_push_block(const signed_block& new_block)
                    // remove the rest of branches.first from the fork_db, those blocks are invalid
                    while( ritr != branches.first.rend() )
                    {
-                      _fork_db.remove( (*ritr)->data.id() );
+                      _fork_db.remove( (*ritr)->id );
+                      _validated_blocks.remove( (*ritr)->id );
                       ++ritr;
                    }
                    _fork_db.set_head( branches.second.front() );
@@ -189,7 +279,7 @@ bool database::_push_block(const signed_block& new_block)
                    {
                       auto session = _undo_db.start_undo_session();
                       apply_block( (*ritr)->data, skip );
-                      _block_id_to_block.store( new_block.id(), (*ritr)->data );
+                      _block_id_to_block.store( (*ritr)->id, (*ritr)->data );
                       session.commit();
                    }
                    throw *except;
@@ -197,24 +287,169 @@ bool database::_push_block(const signed_block& new_block)
             }
             return true;
          }
-         else return false;
+         else
+         {
+            // the block is on another branch, check it now rather than when switching to its branch
+            const item_ptr item = _fork_db.fetch_block( new_block.id() );
+            if( item )
+               prevalidate_block( item );
+            return false;
+         }
       }
    }
 
    try {
+      profile_lap_timer timer( _profile_block_apply );
       auto session = _undo_db.start_undo_session();
-      apply_block(new_block, skip);
-      _block_id_to_block.store(new_block.id(), new_block);
+      timer.lap( _block_apply_profile.undo );
+      // the copy held by the fork database is applied, so that the checks made on it can be cached
+      apply_block( new_head && new_head->id == new_block.id() ? new_head->data : new_block, skip );
+      if( packed.empty() )
+         _block_id_to_block.store(new_block.id(), new_block);
+      else
+         _block_id_to_block.store(packed);
+      timer.restart();
       session.commit();
+      timer.lap( _block_apply_profile.undo );
    } catch ( const fc::exception& e ) {
       elog("Failed to push new block:\n${e}", ("e", e.to_detail_string()));
       _fork_db.remove(new_block.id());
+      _validated_blocks.remove(new_block.id());
       throw;
    }
 
    return false;
 } FC_CAPTURE_AND_RETHROW( (new_block) ) }
 
+void database::prevalidate_block( const item_ptr& item )
+{
+   if( _validated_blocks.capacity() == 0 || _validated_blocks.find( item->id ) )
+      return;
+   const uint32_t skip = get_node_properties().skip_flags;
+   const signed_block& b = item->data;
+   try {
+      validated_block_ptr validated = std::make_shared<validated_block>( item );
+      // anyone can send blocks of other branches: the signatures of the transactions are only recovered for a block
+      // signed by its witness, with the key and in a slot the head state knows of. A block which fails this because
+      // the witness changed its key on the other branch is checked in full if that branch is applied.
+      if( !(skip & skip_witness_signature) )
+      {
+         validated->signee = public_key_type( b.signee() );
+         const witness_object* witness = find_witness_by_uid( b.witness );
+         FC_ASSERT( witness != nullptr && witness->signing_key == *validated->signee,
+                    "Block not signed by the key of its witness", ("witness",b.witness) );
+      }
+      if( !(skip & skip_witness_schedule_check) )
+      {
+         // the schedule is only known for the slots after the head block
+         const uint32_t slot_num = get_slot_at_time( b.timestamp );
+         FC_ASSERT( slot_num == 0 || get_scheduled_witness( slot_num ) == b.witness,
+                    "Witness produced block at wrong time", ("witness",b.witness)("slot_num",slot_num) );
+      }
+      if( !(skip & skip_merkle_check) )
+      {
+         FC_ASSERT( b.transaction_merkle_root == b.calculate_merkle_root() );
+         validated->merkle_checked = true;
+      }
+      const chain_id_type& chain_id = get_chain_id();
+      for( size_t t = 0; t < b.transactions.size(); ++t )
+      {
+         b.transactions[t].validate();
+         validated->transactions[t].validated = true;
+         if( !(skip & (skip_transaction_signatures | skip_authority_check) ) )
+            validated->transactions[t].signature_keys = b.transactions[t].get_signature_keys( chain_id );
+      }
+      _validated_blocks.insert( validated );
+   } catch( const fc::exception& e ) {
+      // not cached, the block fails again if its branch is ever applied
+      wlog( "Block ${n} ${id} of another branch is invalid: ${e}",
+            ("n",item->num)("id",item->id)("e",e.to_detail_string()) );
+   }
+}
+
+void database::check_double_production( const signed_block& new_block )
+{
+   const auto slot_blocks = _fork_db.fetch_blocks_by_witness_slot( new_block.witness, new_block.timestamp );
+   if( slot_blocks.size() < 2 )
+      return;
+   for( const auto& e : _double_production_evidence )
+      if( e.witness == new_block.witness && e.timestamp == new_block.timestamp )
+         return;
+   const witness_object* witness = find_witness_by_uid( new_block.witness );
+   if( witness == nullptr )
+      return;
+
+   // the fork database holds no slot this old any more
+   const uint32_t window = GRAPHENE_MAX_UNDO_HISTORY * get_global_properties().parameters.block_interval;
+   if( new_block.timestamp.sec_since_epoch() > window )
+   {
+      const fc::time_point_sec oldest = new_block.timestamp - window;
+      while( !_rejected_slot_blocks.empty() && _rejected_slot_blocks.begin()->first.first < oldest )
+         _rejected_slot_blocks.erase( _rejected_slot_blocks.begin() );
+   }
+
+   // blocks of a fork which is not applied were not checked, only keep evidence signed by the witness. The ids and
+   // the headers are compared first, the signature of each block is only recovered once.
+   const block_id_type new_id = new_block.id();
+   const digest_type new_digest = new_block.digest();
+   const auto slot = std::make_pair( new_block.timestamp, new_block.witness );
+   auto rejected = _rejected_slot_blocks.find( slot );
+   auto is_rejected = [&rejected, this]( const block_id_type& id ) -> bool {
+      return rejected != _rejected_slot_blocks.end() && rejected->second.count( id ) != 0;
+   };
+   auto reject = [&rejected, &slot, this]( const block_id_type& id ) {
+      if( rejected == _rejected_slot_blocks.end() )
+         rejected = _rejected_slot_blocks.emplace( slot, flat_set<block_id_type>() ).first;
+      rejected->second.insert( id );
+   };
+
+   if( is_rejected( new_id ) )
+      return;
+   if( new_block.signee() != witness->signing_key )
+   {
+      reject( new_id );
+      return;
+   }
+
+   item_ptr other;
+   for( const auto& item : slot_blocks )
+   {
+      // the same header signed again is not a second block
+      if( item->id == new_id || is_rejected( item->id ) || item->data.digest() == new_digest )
+         continue;
+      if( item->data.signee() != witness->signing_key )
+      {
+         reject( item->id );
+         continue;
+      }
+      other = item;
+      break;
+   }
+   if( !other )
+      return;
+
+   double_production_evidence evidence;
+   evidence.witness = new_block.witness;
+   evidence.timestamp = new_block.timestamp;
+   evidence.first = other->data;
+   evidence.second = new_block;
+   evidence.detected_at = fc::time_point::now();
+
+   elog( "Witness ${w} signed two blocks for slot ${t}: ${a} and ${b}",
+         ("w",evidence.witness)("t",evidence.timestamp)("a",evidence.first.id())("b",evidence.second.id()) );
+   static auto& double_productions = graphene::utilities::metrics_registry::instance().get_counter(
+         "graphene_double_productions_total", "Number of slots for which a witness signed two different blocks" );
+   double_productions.increment();
+
+   _double_production_evidence.push_back( evidence );
+   if( !_double_production_evidence_file.empty() )
+   {
+      std::ofstream out( _double_production_evidence_file.generic_string().c_str(), std::ios::out | std::ios::app );
+      out << fc::json::to_string( fc::variant( evidence, GRAPHENE_MAX_NESTED_OBJECTS ) ) << "\n";
+   }
+   double_production_detected( evidence );
+}
+
 /**
  * Attempts to push the transaction into the pending queue
  *
@@ -226,11 +461,15 @@ bool database::_push_block(const signed_block& new_block)
  */
 processed_transaction database::push_transaction( const signed_transaction& trx, uint32_t skip )
 { try {
+   static auto& push_time = graphene::utilities::metrics_registry::instance().get_histogram(
+         "graphene_transaction_push_seconds", "Time to validate and apply a transaction to the pending state" );
+   auto start = fc::time_point::now();
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
    {
       result = _push_transaction( trx );
    } );
+   push_time.observe( fc::time_point::now() - start );
    return result;
 } FC_CAPTURE_AND_RETHROW( (trx) ) }
 
@@ -246,9 +485,17 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
    // _apply_transaction fails.  If we make it to merge(), we
    // apply the changes.
 
+   // Refuse the transaction before applying it if the pool has no room for it.
+   auto pool_entry = _pending_tx.admit( trx );
+
    auto temp_session = _undo_db.start_undo_session();
+   const fc::time_point apply_start = fc::time_point::now();
    auto processed_trx = _apply_transaction( trx );
-   _pending_tx.push_back(processed_trx);
+   pool_entry.apply_time = fc::time_point::now() - apply_start;
+   pool_entry.trx = processed_trx;
+   graphene::utilities::transaction_tracer::instance().record( pool_entry.id,
+         graphene::utilities::transaction_tracer::validated_stage );
+   _pending_tx.insert( std::move(pool_entry) );
 
    // notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
@@ -275,6 +522,11 @@ processed_transaction database::push_proposal(const proposal_object& proposal)
    eval_state._trx = &ptrx;
    size_t old_applied_ops_size = _applied_ops.size();
 
+   // A failed proposal is undone while the block goes on, so votes must not be buffered inside it
+   apply_pending_voter_self_votes();
+   const bool old_buffer_voter_self_votes = _buffer_voter_self_votes;
+   _buffer_voter_self_votes = false;
+
    try {
       auto session = _undo_db.start_undo_session(true);
       for( auto& op : proposal.proposed_transaction.operations )
@@ -282,10 +534,12 @@ processed_transaction database::push_proposal(const proposal_object& proposal)
       remove(proposal);
       session.merge();
    } catch ( const fc::exception& e ) {
-      _applied_ops.resize( old_applied_ops_size );
+      _buffer_voter_self_votes = old_buffer_voter_self_votes;
+      _applied_ops.truncate( old_applied_ops_size );
       elog( "e", ("e",e.to_detail_string() ) );
       throw;
    }
+   _buffer_voter_self_votes = old_buffer_voter_self_votes;
 
    ptrx.operation_results = std::move(eval_state.operation_results);
    return ptrx;
@@ -295,13 +549,14 @@ signed_block database::generate_block(
    fc::time_point_sec when,
    account_uid_type witness_uid,
    const fc::ecc::private_key& block_signing_private_key,
-   uint32_t skip /* = 0 */
+   uint32_t skip /* = 0 */,
+   fc::time_point deadline /* = fc::time_point::maximum() */
    )
 { try {
    signed_block result;
    detail::with_skip_flags( *this, skip, [&]()
    {
-      result = _generate_block( when, witness_uid, block_signing_private_key );
+      result = _generate_block( when, witness_uid, block_signing_private_key, deadline );
    } );
    return result;
 } FC_CAPTURE_AND_RETHROW() }
@@ -309,7 +564,8 @@ signed_block database::generate_block(
 signed_block database::_generate_block(
    fc::time_point_sec when,
    account_uid_type witness_uid,
-   const fc::ecc::private_key& block_signing_private_key
+   const fc::ecc::private_key& block_signing_private_key,
+   fc::time_point deadline /* = fc::time_point::maximum() */
    )
 {
    try {
@@ -350,16 +606,30 @@ signed_block database::_generate_block(
 
    update_global_dynamic_data(pending_block);
 
-   uint64_t postponed_tx_count = 0;
-   // pop pending state (reset to head block state)
-   for( const processed_transaction& tx : _pending_tx )
+   block_generation_stats stats;
+   const fc::time_point start = fc::time_point::now();
+   // the transactions paying most per byte are chosen when they don't all fit, they are applied in arrival order
+   const auto chosen = _pending_tx.select( maximum_block_size - total_block_size - 1, deadline - start, deadline,
+                                           stats );
+   uint32_t visited = 0;
+   for( const auto* pool_entry : chosen )
    {
+      const fc::time_point now = fc::time_point::now();
+      if( now >= deadline )
+      {
+         // out of time, leave the rest for the next block
+         stats.skipped_for_time += chosen.size() - visited;
+         break;
+      }
+      ++visited;
+
+      const processed_transaction& tx = pool_entry->trx;
       size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
 
       // postpone transaction if it would make block too big
       if( new_total_size >= maximum_block_size )
       {
-         postponed_tx_count++;
+         stats.postponed_for_size++;
          continue;
       }
 
@@ -374,18 +644,27 @@ signed_block database::_generate_block(
          // their size)
          total_block_size += fc::raw::pack_size( ptx );
          pending_block.transactions.push_back( ptx );
+         stats.included++;
       }
       catch ( const fc::exception& e )
       {
          // Do nothing, transaction will not be re-applied
+         stats.failed++;
          wlog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
          wlog( "The transaction was ${t}", ("t", tx) );
       }
    }
-   if( postponed_tx_count > 0 )
+   stats.elapsed = fc::time_point::now() - start;
+   if( stats.postponed_for_size > 0 )
+   {
+      wlog( "Postponed ${n} transactions due to block size limit", ("n", stats.postponed_for_size) );
+   }
+   if( stats.skipped_for_time > 0 )
    {
-      wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
+      wlog( "Postponed ${n} transactions due to block generation deadline, spent ${t} us applying ${i}",
+            ("n", stats.skipped_for_time)("t", stats.elapsed.count())("i", stats.included) );
    }
+   _last_block_generation_stats = stats;
 
    _pending_tx_session.reset();
 
@@ -419,13 +698,19 @@ void database::pop_block()
 { try {
    _pending_tx_session.reset();
    auto head_id = head_block_id();
-   optional<signed_block> head_block = fetch_block_by_id( head_id );
-   GRAPHENE_ASSERT( head_block.valid(), pop_empty_chain, "there are no blocks to pop" );
+   // the blocks of the fork window are in memory, only older ones are read from the block database
+   const validated_block_ptr validated = _validated_blocks.find( head_id );
+   const item_ptr item = validated ? validated->item : _fork_db.fetch_block( head_id );
+   optional<signed_block> stored;
+   if( !item )
+      stored = _block_id_to_block.fetch_optional( head_id );
+   GRAPHENE_ASSERT( item || stored.valid(), pop_empty_chain, "there are no blocks to pop" );
+   const signed_block& head_block = item ? item->data : *stored;
 
    _fork_db.pop_block();
    pop_undo();
 
-   _popped_tx.insert( _popped_tx.begin(), head_block->transactions.begin(), head_block->transactions.end() );
+   _popped_tx.insert( _popped_tx.begin(), head_block.transactions.begin(), head_block.transactions.end() );
 
 } FC_CAPTURE_AND_RETHROW() }
 
@@ -436,10 +721,9 @@ void database::clear_pending()
    _pending_tx_session.reset();
 } FC_CAPTURE_AND_RETHROW() }
 
-uint32_t database::push_applied_operation( const operation& op )
+uint32_t database::push_applied_operation( const operation& op, bool stable )
 {
-   _applied_ops.emplace_back(op);
-   operation_history_object& oh = *(_applied_ops.back());
+   applied_operation& oh = _applied_ops.push( op, stable );
    oh.block_timestamp = _current_block_time;
    oh.block_num    = _current_block_num;
    oh.trx_in_block = _current_trx_in_block;
@@ -450,15 +734,15 @@ uint32_t database::push_applied_operation( const operation& op )
 void database::set_applied_operation_result( uint32_t op_id, const operation_result& result )
 {
    assert( op_id < _applied_ops.size() );
-   if( _applied_ops[op_id] )
-      _applied_ops[op_id]->result = result;
+   if( op_id < _applied_ops.size() )
+      _applied_ops[op_id].result = result;
    else
    {
       elog( "Could not set operation result (head_block_num=${b})", ("b", head_block_num()) );
    }
 }
 
-const vector<optional< operation_history_object > >& database::get_applied_operations() const
+const applied_operation_log& database::get_applied_operations() const
 {
    return _applied_ops;
 }
@@ -478,10 +762,14 @@ void database::apply_block( const signed_block& next_block, uint32_t skip )
          skip = ~0;// WE CAN SKIP ALMOST EVERYTHING
    }
 
+   static auto& apply_time = graphene::utilities::metrics_registry::instance().get_histogram(
+         "graphene_block_apply_seconds", "Time to apply a block, including its transactions and maintenance" );
+   auto start = fc::time_point::now();
    detail::with_skip_flags( *this, skip, [&]()
    {
       _apply_block( next_block );
    } );
+   apply_time.observe( fc::time_point::now() - start );
    return;
 }
 
@@ -490,10 +778,36 @@ void database::_apply_block( const signed_block& next_block )
    uint32_t next_block_num = next_block.block_num();
    uint32_t skip = get_node_properties().skip_flags;
    _applied_ops.clear();
+   _block_journal.reset( next_block_num );
 
-   FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(), "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()) );
+   profile_lap_timer timer( _profile_block_apply );
+   // the checks which do not depend on the state are made once per block of the fork window
+   validated_block_ptr validated;
+   if( !(skip & skip_fork_db) && _validated_blocks.capacity() > 0 )
+   {
+      const block_id_type next_block_id = next_block.id();
+      validated = _validated_blocks.find( next_block_id );
+      if( !validated )
+      {
+         const item_ptr item = _fork_db.fetch_block( next_block_id );
+         if( item )
+            validated = std::make_shared<validated_block>( item );
+      }
+      // the checks are those of the block held by the fork database, another block with the same header may have
+      // other transactions
+      if( validated && &validated->block() != &next_block )
+         validated.reset();
+   }
 
-   const witness_object& signing_witness = validate_block_header(skip, next_block);
+   if( !(skip & skip_merkle_check) && !( validated && validated->merkle_checked ) )
+   {
+      FC_ASSERT( next_block.transaction_merkle_root == next_block.calculate_merkle_root(), "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()) );
+      if( validated )
+         validated->merkle_checked = true;
+   }
+
+   const witness_object& signing_witness = validate_block_header( skip, next_block, validated.get() );
+   timer.lap( _block_apply_profile.header );
 
    _current_block_time   = next_block.timestamp;
    _current_block_num    = next_block_num;
@@ -501,17 +815,46 @@ void database::_apply_block( const signed_block& next_block )
 
    update_global_dynamic_data(next_block);
 
+   timer.lap( _block_apply_profile.maintenance );
+   const fc::microseconds authorities_before = _block_apply_profile.authorities;
+
    dlog("before apply_transaction");
-   for( const auto& trx : next_block.transactions )
+   // Votes of voters are aggregated while applying transactions of the block. Since either all transactions
+   // apply or the entire block fails, the buffer only needs to be discarded on failure.
+   _buffer_voter_self_votes = _aggregate_block_votes;
+   _applying_block_transactions = true;
+   _applying_validated_block = validated.get();
+   try {
+      for( const auto& trx : next_block.transactions )
+      {
+         /* We do not need to push the undo state for each transaction
+          * because they either all apply and are valid or the
+          * entire block fails to apply.  We only need an "undo" state
+          * for transactions when validating broadcast transactions or
+          * when building a block.
+          */
+         apply_transaction( trx, skip );
+         ++_current_trx_in_block;
+      }
+   } catch( ... ) {
+      _buffer_voter_self_votes = false;
+      _applying_block_transactions = false;
+      _applying_validated_block = nullptr;
+      _pending_voter_self_votes.clear();
+      throw;
+   }
+   _buffer_voter_self_votes = false;
+   _applying_block_transactions = false;
+   _applying_validated_block = nullptr;
+   apply_pending_voter_self_votes();
+   timer.lap( _block_apply_profile.evaluation );
+   _block_apply_profile.evaluation -= _block_apply_profile.authorities - authorities_before;
+
+   auto& tracer = graphene::utilities::transaction_tracer::instance();
+   if( tracer.enabled() )
    {
-      /* We do not need to push the undo state for each transaction
-       * because they either all apply and are valid or the
-       * entire block fails to apply.  We only need an "undo" state
-       * for transactions when validating broadcast transactions or
-       * when building a block.
-       */
-      apply_transaction( trx, skip );
-      ++_current_trx_in_block;
+      for( const auto& trx : next_block.transactions )
+         tracer.record( trx.id(), graphene::utilities::transaction_tracer::included_stage, next_block_num );
    }
 
    dlog("after apply_transaction");
@@ -551,7 +894,14 @@ void database::_apply_block( const signed_block& next_block )
       check_invariants();
    }
 
+   timer.lap( _block_apply_profile.maintenance );
+
+   if( validated )
+      _validated_blocks.insert( validated );
+
    dlog("before notify applied block");
+   if( _journal_operations )
+      _block_journal.add_operations( _applied_ops );
    // notify observers that the block has been applied
    // TODO catch exceptions thrown by plugins but not the core
    applied_block( next_block ); //emit
@@ -559,8 +909,16 @@ void database::_apply_block( const signed_block& next_block )
 
    dlog("before notify changed objects");
    notify_changed_objects();
+   timer.lap( _block_apply_profile.notifications );
 } FC_CAPTURE_AND_RETHROW( (next_block.block_num())(next_block) )  }
 
+block_apply_profile database::take_block_apply_profile()
+{
+   block_apply_profile result = _block_apply_profile;
+   _block_apply_profile = block_apply_profile();
+   return result;
+}
+
 
 
 processed_transaction database::apply_transaction(const signed_transaction& trx, uint32_t skip)
@@ -577,12 +935,25 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
 { try {
    uint32_t skip = get_node_properties().skip_flags;
 
-   if( true || !(skip&skip_validate) )   /* issue #505 explains why this skip_flag is disabled */
-      trx.validate();
+   // the checks made when the block was applied or seen before, see validated_block_cache
+   validated_transaction* validated = nullptr;
+   if( _applying_block_transactions && _applying_validated_block != nullptr )
+   {
+      FC_ASSERT( _current_trx_in_block < _applying_validated_block->transactions.size() );
+      validated = &_applying_validated_block->transactions[_current_trx_in_block];
+   }
+
+   if( validated == nullptr || !validated->validated )
+   {
+      if( true || !(skip&skip_validate) )   /* issue #505 explains why this skip_flag is disabled */
+         trx.validate();
+      if( validated != nullptr )
+         validated->validated = true;
+   }
 
    auto& trx_idx = get_mutable_index_type<transaction_index>();
    const chain_id_type& chain_id = get_chain_id();
-   auto trx_id = trx.id();
+   auto trx_id = ( validated != nullptr ? validated->id : trx.id() );
    FC_ASSERT( (skip & skip_transaction_dupe_check) ||
               trx_idx.indices().get<by_trx_id>().find(trx_id) == trx_idx.indices().get<by_trx_id>().end() );
    transaction_evaluation_state eval_state(this);
@@ -598,11 +969,26 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
       auto get_owner_by_uid      = [&]( account_uid_type uid ) { return &(this->get_account_by_uid(uid).owner);     };
       auto get_active_by_uid     = [&]( account_uid_type uid ) { return &(this->get_account_by_uid(uid).active);    };
       auto get_secondary_by_uid  = [&]( account_uid_type uid ) { return &(this->get_account_by_uid(uid).secondary); };
-      trx.verify_authority( chain_id,
-                            get_owner_by_uid,
-                            get_active_by_uid,
-                            get_secondary_by_uid,
-                            chain_parameters.max_authority_depth );
+      profile_lap_timer timer( _profile_block_apply );
+      if( validated == nullptr )
+         trx.verify_authority( chain_id,
+                               get_owner_by_uid,
+                               get_active_by_uid,
+                               get_secondary_by_uid,
+                               chain_parameters.max_authority_depth );
+      else
+      {
+         // the keys do not depend on the state, the authorities they satisfy do
+         if( !validated->signature_keys.valid() )
+            validated->signature_keys = trx.get_signature_keys( chain_id );
+         graphene::chain::verify_authority( trx.operations,
+                                            *validated->signature_keys,
+                                            get_owner_by_uid,
+                                            get_active_by_uid,
+                                            get_secondary_by_uid,
+                                            chain_parameters.max_authority_depth );
+      }
+      timer.lap( _block_apply_profile.authorities );
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
@@ -638,7 +1024,8 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    //Finally process the operations
    processed_transaction ptrx(trx);
    _current_op_in_trx = 0;
-   for( const auto& op : ptrx.operations )
+   // the operations of trx, which the applied operations of a block reference, rather than those of the copy
+   for( const auto& op : trx.operations )
    {
       eval_state.operation_results.emplace_back(apply_operation(eval_state, op));
       ++_current_op_in_trx;
@@ -656,20 +1043,35 @@ operation_result database::apply_operation(transaction_evaluation_state& eval_st
    FC_ASSERT( u_which < _operation_evaluators.size(), "No registered evaluator for operation ${op}", ("op",op) );
    unique_ptr<op_evaluator>& eval = _operation_evaluators[ u_which ];
    FC_ASSERT( eval, "No registered evaluator for operation ${op}", ("op",op) );
-   auto op_id = push_applied_operation( op );
+   // buffered votes need to be applied before an operation which may change the vote set or the proxy
+   // of a voter, or the validity of a candidate
+   if( !_pending_voter_self_votes.empty() && operation_changes_vote_set_of( op ) )
+      apply_pending_voter_self_votes();
+   auto op_id = push_applied_operation( op, _applying_block_transactions && !eval_state._is_proposed_trx );
    auto result = eval->evaluate( eval_state, op, true );
    set_applied_operation_result( op_id, result );
    return result;
 } FC_CAPTURE_AND_RETHROW( (op) ) }
 
-const witness_object& database::validate_block_header( uint32_t skip, const signed_block& next_block )const
+const witness_object& database::validate_block_header( uint32_t skip, const signed_block& next_block,
+                                                       validated_block* validated )const
 {
    FC_ASSERT( head_block_id() == next_block.previous, "", ("head_block_id",head_block_id())("next.prev",next_block.previous) );
    FC_ASSERT( head_block_time() < next_block.timestamp, "", ("head_block_time",head_block_time())("next",next_block.timestamp)("blocknum",next_block.block_num()) );
    const witness_object& witness = get_witness_by_uid( next_block.witness );
 
-   if( !(skip&skip_witness_signature) ) 
-      FC_ASSERT( next_block.validate_signee( witness.signing_key ) );
+   if( !(skip&skip_witness_signature) )
+   {
+      if( validated == nullptr )
+         FC_ASSERT( next_block.validate_signee( witness.signing_key ) );
+      else
+      {
+         // the key is recovered once, the witness may have changed it on another branch
+         if( !validated->signee.valid() )
+            validated->signee = public_key_type( next_block.signee() );
+         FC_ASSERT( *validated->signee == witness.signing_key );
+      }
+   }
 
    if( !(skip&skip_witness_schedule_check) )
    {
@@ -115,6 +115,11 @@ uint32_t database::last_non_undoable_block_num() const
    return head_block_num() - _undo_db.size();
 }
 
+pending_transaction_pool_stats database::get_pending_transaction_pool_stats()const
+{
+   return _pending_tx.get_stats();
+}
+
 const account_object& database::get_account_by_uid( account_uid_type uid )const
 {
    const auto& accounts_by_uid = get_index_type<account_index>().indices().get<by_uid>();
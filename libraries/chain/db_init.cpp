@@ -169,9 +169,9 @@ void database::initialize_indexes()
    _undo_db.set_max_size( GRAPHENE_MIN_UNDO_HISTORY );
 
    //Protocol object indexes
-   add_index< primary_index<asset_index> >();
+   add_index< primary_index<asset_index, true> >();
 
-   auto acnt_index = add_index< primary_index<account_index> >();
+   auto acnt_index = add_index< primary_index<account_index, true> >();
    acnt_index->add_secondary_index<account_member_index>();
    acnt_index->add_secondary_index<account_referrer_index>();
 
@@ -180,18 +180,27 @@ void database::initialize_indexes()
 
    add_index< primary_index<committee_member_index> >();
    add_index< primary_index<committee_proposal_index> >();
-   add_index< primary_index<witness_index> >();
+   auto wit_index = add_index< primary_index<witness_index> >();
+   _witness_avg_pledge_update_schedule = wit_index->add_secondary_index<witness_avg_pledge_update_schedule>();
 
    auto prop_index = add_index< primary_index<proposal_index > >();
    prop_index->add_secondary_index<required_approval_index>();
+   auto prop_auth_index = prop_index->add_secondary_index<proposal_authorization_index>();
+   prop_auth_index->set_database( *this );
+   acnt_index->add_secondary_index<proposal_authority_watcher>()->set_proposals( *prop_auth_index );
 
    //Implementation object indexes
    add_index< primary_index<transaction_index                             > >();
-   add_index< primary_index<account_balance_index                         > >();
+   auto bal_index = add_index< primary_index<account_balance_index        > >();
+   bal_index->add_secondary_index<asset_holder_index>();
    add_index< primary_index<simple_index<global_property_object          >> >();
    add_index< primary_index<simple_index<dynamic_global_property_object  >> >();
-   add_index< primary_index<account_statistics_index                      > >();
-   add_index< primary_index<voter_index                                   > >();
+   auto stats_index = add_index< primary_index<account_statistics_index, true> >();
+   _witness_pledge_release_schedule = stats_index->add_secondary_index<witness_pledge_release_schedule>();
+   _committee_member_pledge_release_schedule = stats_index->add_secondary_index<committee_member_pledge_release_schedule>();
+   _platform_pledge_release_schedule = stats_index->add_secondary_index<platform_pledge_release_schedule>();
+   auto voter_idx = add_index< primary_index<voter_index                  > >();
+   _voter_effective_votes_update_schedule = voter_idx->add_secondary_index<voter_effective_votes_update_schedule>();
    add_index< primary_index<registrar_takeover_index                      > >();
    add_index< primary_index<witness_vote_index                            > >();
    add_index< primary_index<platform_vote_index                           > >();
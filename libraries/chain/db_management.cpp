@@ -28,6 +28,7 @@
 #include <graphene/chain/protocol/fee_schedule.hpp>
 
 #include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
 
 #include <fstream>
 #include <functional>
@@ -43,6 +44,7 @@ database::database()
 
 database::~database()
 {
+   wait_for_state_checkpoint();
    clear_pending();
 }
 
@@ -162,23 +164,104 @@ void database::open(
 
       _block_id_to_block.open(data_dir / "database" / "block_num_to_block");
 
+      _double_production_evidence.clear();
+      _double_production_evidence_file = data_dir / "database" / "double_production_evidence.json";
+      if( fc::exists( _double_production_evidence_file ) )
+      {
+         std::ifstream in( _double_production_evidence_file.generic_string().c_str() );
+         std::string line;
+         while( std::getline( in, line ) )
+         {
+            if( line.empty() )
+               continue;
+            try {
+               _double_production_evidence.push_back( fc::json::from_string( line )
+                     .as<double_production_evidence>( GRAPHENE_MAX_NESTED_OBJECTS ) );
+            } catch( const fc::exception& e ) {
+               // the last line may be cut if the node crashed while writing it
+               wlog( "Skipping unreadable double production evidence: ${e}", ("e",e.to_string()) );
+            }
+         }
+      }
+
       if( !find(global_property_id_type()) )
          init_genesis(genesis_loader());
 
       fc::optional<block_id_type> last_block = _block_id_to_block.last_id();
       if( last_block.valid() )
       {
+         // state checkpoints are irreversible, the saved state is not on the saved chain if the blocks were replaced
+         if( head_block_num() > 0 && !_block_id_to_block.contains( head_block_id() ) )
+         {
+            wlog( "Saved state at block ${n} is not on the saved chain, wiping it",
+                  ("n",head_block_num())("id",head_block_id()) );
+            object_database::wipe( data_dir );
+            FC_THROW( "Saved state is not on the saved chain, the blockchain has to be replayed" );
+         }
          FC_ASSERT( *last_block >= head_block_id(),
                     "last block ID does not match current chain state",
                     ("last_block->id", last_block)("head_block_id",head_block_num()) );
+         _state_checkpoint_block = head_block_num();
          reindex( data_dir );
       }
    }
    FC_CAPTURE_LOG_AND_RETHROW( (data_dir) )
 }
 
+void database::save_state_checkpoint()
+{ try {
+   const uint32_t irreversible = get_dynamic_global_properties().last_irreversible_block_num;
+   if( _state_checkpoint_write.valid() && !_state_checkpoint_write.ready() )
+   {
+      wlog( "Skipping the state checkpoint at block ${n}, the previous one is still being written",
+            ("n",irreversible) );
+      return;
+   }
+   const size_t reversible = head_block_num() - irreversible;
+   if( _undo_db.size() < reversible )
+   {
+      wlog( "Skipping the state checkpoint at block ${n}, the undo history does not reach it", ("n",irreversible) );
+      return;
+   }
+
+   auto start = fc::time_point::now();
+   _block_id_to_block.flush();
+   auto state = std::make_shared<std::vector<packed_index>>( pack_state( reversible ) );
+   _state_checkpoint_block = irreversible;
+   const auto packed = fc::time_point::now() - start;
+
+   if( !_state_checkpoint_thread )
+      _state_checkpoint_thread.reset( new fc::thread( "state checkpoint" ) );
+   const fc::path data_dir = get_data_dir();
+   _state_checkpoint_write = _state_checkpoint_thread->async( [state, data_dir, irreversible, packed]()
+   {
+      auto start = fc::time_point::now();
+      object_database::write_state( data_dir, *state );
+      ilog( "Saved chain state at irreversible block ${n}, packed in ${p} ms, written in ${t} ms",
+            ("n",irreversible)("p",packed.count() / 1000)("t",(fc::time_point::now() - start).count() / 1000) );
+   }, "save state checkpoint" );
+} FC_CAPTURE_AND_RETHROW() }
+
+void database::wait_for_state_checkpoint()
+{
+   if( !_state_checkpoint_write.valid() )
+      return;
+   try
+   {
+      _state_checkpoint_write.wait();
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "Unable to save the state checkpoint: ${e}", ("e",e.to_detail_string()) );
+   }
+   _state_checkpoint_write = fc::future<void>();
+}
+
 void database::close(bool rewind)
 {
+   // the checkpoint is written in the same directories as the state saved below
+   wait_for_state_checkpoint();
+
    // TODO:  Save pending tx's on close()
    clear_pending();
 
@@ -216,6 +299,7 @@ void database::close(bool rewind)
       _block_id_to_block.close();
 
    _fork_db.reset();
+   _validated_blocks.clear();
 }
 
 } }
@@ -6,6 +6,7 @@
 #include <graphene/chain/protocol/types.hpp>
 #include <graphene/chain/committee_member_object.hpp>
 #include <graphene/chain/impacted.hpp>
+#include <graphene/chain/block_journal.hpp>
 
 using namespace fc;
 
@@ -402,57 +403,146 @@ void get_relevant_accounts( const object* obj, flat_set<account_uid_type>& accou
    }
 }
 
+void block_journal::reset( uint32_t num )
+{
+   block_num = num;
+   operations.clear();
+   created.clear();
+   modified.clear();
+   removed.clear();
+   created_accounts.clear();
+   modified_accounts.clear();
+   removed_accounts.clear();
+   _operation_by_position.clear();
+}
+
+void block_journal::add_operations( const applied_operation_log& ops )
+{
+   operations.reserve( operations.size() + ops.size() );
+   for( const auto& a : ops )
+   {
+      operations.emplace_back();
+      journaled_operation& jop = operations.back();
+      jop.trx_in_block = a.trx_in_block;
+      jop.op_in_trx = a.op_in_trx;
+      jop.virtual_op = a.virtual_op;
+      operation_get_impacted_account_uids( *a.op, jop.impacted );
+      vector<authority> other;
+      operation_get_required_uid_authorities( *a.op, jop.authorities, jop.authorities, jop.authorities, other );
+      for( const auto& a : other )
+         for( const auto& item : a.account_uid_auths )
+            jop.authorities.insert( item.first.uid );
+      _operation_by_position[ position( jop.trx_in_block, jop.op_in_trx, jop.virtual_op ) ] = operations.size() - 1;
+   }
+}
+
+const journaled_operation* block_journal::find_operation( uint16_t trx_in_block, uint16_t op_in_trx,
+                                                          uint16_t virtual_op )const
+{
+   auto itr = _operation_by_position.find( position( trx_in_block, op_in_trx, virtual_op ) );
+   if( itr == _operation_by_position.end() )
+      return nullptr;
+   return &operations[itr->second];
+}
+
+void block_journal::get_relevant_accounts( const object* obj, flat_set<account_uid_type>& accounts )const
+{
+   if( obj->id.space() == protocol_ids && obj->id.type() == operation_history_object_type )
+   {
+      const auto& hobj = static_cast<const operation_history_object&>( *obj );
+      if( hobj.block_num == block_num )
+      {
+         const journaled_operation* jop = find_operation( hobj.trx_in_block, hobj.op_in_trx, hobj.virtual_op );
+         if( jop != nullptr )
+         {
+            accounts.insert( jop->impacted.begin(), jop->impacted.end() );
+            return;
+         }
+      }
+   }
+   graphene::chain::get_relevant_accounts( obj, accounts );
+}
+
+void block_journal::add_object( const object* obj, vector<journaled_object>& objects,
+                                flat_set<account_uid_type>& accounts )
+{
+   objects.emplace_back();
+   objects.back().id = obj->id;
+   get_relevant_accounts( obj, objects.back().accounts );
+   accounts.insert( objects.back().accounts.begin(), objects.back().accounts.end() );
+}
+
+void block_journal::add_created( const object* obj )
+{
+   add_object( obj, created, created_accounts );
+}
+
+void block_journal::add_modified( const object* obj )
+{
+   add_object( obj, modified, modified_accounts );
+}
+
+void block_journal::add_removed( const object* obj )
+{
+   add_object( obj, removed, removed_accounts );
+}
+
 void database::notify_changed_objects()
 { try {
    if( _undo_db.enabled() )
    {
       const auto& head_undo = _undo_db.head();
 
+      // each part of the journal is only built when something is connected to its notification
+
       // New
       if( !new_objects.empty() )
       {
-        vector<object_id_type> new_ids;  new_ids.reserve(head_undo.new_ids.size());
-        flat_set<account_uid_type> new_accounts_impacted;
+        _block_journal.created.reserve( head_undo.new_ids.size() );
         for( const auto& item : head_undo.new_ids )
         {
-          new_ids.push_back(item);
           auto obj = find_object(item);
-          if(obj != nullptr)
-            get_relevant_accounts(obj, new_accounts_impacted);
+          if( obj != nullptr )
+            _block_journal.add_created( obj );
+          else
+            _block_journal.created.push_back( journaled_object{ item, {} } );
         }
 
-        new_objects(new_ids, new_accounts_impacted);
+        vector<object_id_type> new_ids;  new_ids.reserve( _block_journal.created.size() );
+        for( const auto& item : _block_journal.created )
+          new_ids.push_back( item.id );
+
+        new_objects( new_ids, _block_journal.created_accounts );
       }
 
       // Changed
       if( !changed_objects.empty() )
       {
-        vector<object_id_type> changed_ids;  changed_ids.reserve(head_undo.old_values.size());
-        flat_set<account_uid_type> changed_accounts_impacted;
+        _block_journal.modified.reserve( head_undo.old_values.size() );
         for( const auto& item : head_undo.old_values )
-        {
-          changed_ids.push_back(item.first);
-          get_relevant_accounts(item.second.get(), changed_accounts_impacted);
-        }
+          _block_journal.add_modified( item.second.get() );
+
+        vector<object_id_type> changed_ids;  changed_ids.reserve( _block_journal.modified.size() );
+        for( const auto& item : _block_journal.modified )
+          changed_ids.push_back( item.id );
 
-        changed_objects(changed_ids, changed_accounts_impacted);
+        changed_objects( changed_ids, _block_journal.modified_accounts );
       }
 
       // Removed
       if( !removed_objects.empty() )
       {
+        _block_journal.removed.reserve( head_undo.removed.size() );
         vector<object_id_type> removed_ids; removed_ids.reserve( head_undo.removed.size() );
         vector<const object*> removed; removed.reserve( head_undo.removed.size() );
-        flat_set<account_uid_type> removed_accounts_impacted;
         for( const auto& item : head_undo.removed )
         {
+          _block_journal.add_removed( item.second.get() );
           removed_ids.emplace_back( item.first );
-          auto obj = item.second.get();
-          removed.emplace_back( obj );
-          get_relevant_accounts(obj, removed_accounts_impacted);
+          removed.emplace_back( item.second.get() );
         }
 
-        removed_objects(removed_ids, removed, removed_accounts_impacted);
+        removed_objects( removed_ids, removed, _block_journal.removed_accounts );
       }
    }
 } FC_CAPTURE_AND_LOG( (0) ) }
@@ -26,6 +26,7 @@
 #include <graphene/chain/db_with.hpp>
 
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/coin_seconds.hpp>
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/hardfork.hpp>
 #include <graphene/chain/proposal_object.hpp>
@@ -34,6 +35,8 @@
 
 #include <graphene/chain/protocol/fee_schedule.hpp>
 
+#include <graphene/utilities/transaction_tracer.hpp>
+
 #include <fc/uint128.hpp>
 
 namespace graphene { namespace chain {
@@ -200,6 +203,7 @@ void database::update_last_irreversible_block()
       {
          _dpo.last_irreversible_block_num = new_last_irreversible_block_num;
       } );
+      graphene::utilities::transaction_tracer::instance().record_irreversible( new_last_irreversible_block_num );
    }
 }
 
@@ -207,10 +211,17 @@ void database::clear_expired_transactions()
 { try {
    //Look for expired transactions in the deduplication list, and remove them.
    //Transactions must have expired by at least two forking windows in order to be removed.
-   auto& transaction_idx = static_cast<transaction_index&>(get_mutable_index(implementation_ids, impl_transaction_object_type));
+   auto& transaction_idx = static_cast<primary_index<transaction_index>&>(get_mutable_index(implementation_ids, impl_transaction_object_type));
    const auto& dedupe_index = transaction_idx.indices().get<by_expiration>();
-   while( (!dedupe_index.empty()) && (head_block_time() > dedupe_index.begin()->trx.expiration) )
-      transaction_idx.remove(*dedupe_index.begin());
+   auto end = dedupe_index.lower_bound( head_block_time() );
+   if( _expired_transactions_per_block != 0 )
+   {
+      auto itr = dedupe_index.begin();
+      for( uint32_t i = 0; i < _expired_transactions_per_block && itr != end; ++i )
+         ++itr;
+      end = itr;
+   }
+   transaction_idx.remove_range( dedupe_index.begin(), end );
 } FC_CAPTURE_AND_RETHROW() }
 
 void database::clear_expired_proposals()
@@ -251,9 +262,10 @@ void database::clear_expired_csaf_leases()
 {
    const uint64_t csaf_window = get_global_properties().parameters.csaf_accumulate_window;
    const auto head_time = head_block_time();
-   const auto& idx = get_index_type<csaf_lease_index>().indices().get<by_expiration>();
-   auto itr = idx.begin();
-   while( itr != idx.end() && itr->expiration <= head_time )
+   auto& lease_idx = get_mutable_index_type< primary_index<csaf_lease_index> >();
+   const auto& idx = lease_idx.indices().get<by_expiration>();
+   const auto end = idx.upper_bound( boost::make_tuple( head_time ) );
+   for( auto itr = idx.begin(); itr != end; ++itr )
    {
       modify( get_account_statistics_by_uid( itr->from ), [&](account_statistics_object& s) {
          s.update_coin_seconds_earned( csaf_window, head_time );
@@ -263,52 +275,45 @@ void database::clear_expired_csaf_leases()
          s.update_coin_seconds_earned( csaf_window, head_time );
          s.core_leased_in -= itr->amount;
       });
-      remove( *itr );
-      itr = idx.begin();
    }
+   lease_idx.remove_range( idx.begin(), end );
 }
 
 void database::update_average_witness_pledges()
 {
    const auto head_num = head_block_num();
-   const auto& idx = get_index_type<witness_index>().indices().get<by_pledge_next_update>();
-   auto itr = idx.begin();
-   while( itr != idx.end() && itr->average_pledge_next_update_block <= head_num && itr->is_valid )
+   for( const auto& id : _witness_avg_pledge_update_schedule->due( head_num ) )
    {
-      update_witness_avg_pledge( *itr );
-      itr = idx.begin();
+      const witness_object& wit = get<witness_object>( id );
+      // invalid witnesses are unscheduled when they resign, so they should never be due here
+      if( wit.is_valid && wit.average_pledge_next_update_block <= head_num )
+         update_witness_avg_pledge( wit );
    }
 }
 
 void database::release_witness_pledges()
 {
    const auto head_num = head_block_num();
-   const auto& idx = get_index_type<account_statistics_index>().indices().get<by_witness_pledge_release>();
-   auto itr = idx.begin();
-   while( itr != idx.end() && itr->witness_pledge_release_block_number <= head_num )
+   for( const auto& id : _witness_pledge_release_schedule->due( head_num ) )
    {
-      modify( *itr, [&](account_statistics_object& s) {
+      modify( get<account_statistics_object>( id ), [&](account_statistics_object& s) {
          s.total_witness_pledge -= s.releasing_witness_pledge;
          s.releasing_witness_pledge = 0;
          s.witness_pledge_release_block_number = -1;
       });
-      itr = idx.begin();
    }
 }
 
 void database::release_committee_member_pledges()
 {
    const auto head_num = head_block_num();
-   const auto& idx = get_index_type<account_statistics_index>().indices().get<by_committee_member_pledge_release>();
-   auto itr = idx.begin();
-   while( itr != idx.end() && itr->committee_member_pledge_release_block_number <= head_num )
+   for( const auto& id : _committee_member_pledge_release_schedule->due( head_num ) )
    {
-      modify( *itr, [&](account_statistics_object& s) {
+      modify( get<account_statistics_object>( id ), [&](account_statistics_object& s) {
          s.total_committee_member_pledge -= s.releasing_committee_member_pledge;
          s.releasing_committee_member_pledge = 0;
          s.committee_member_pledge_release_block_number = -1;
       });
-      itr = idx.begin();
    }
 }
 
@@ -391,12 +396,26 @@ void database::clear_resigned_committee_member_votes()
 void database::update_voter_effective_votes()
 {
    const auto head_num = head_block_num();
-   const auto& idx = get_index_type<voter_index>().indices().get<by_votes_next_update>();
-   auto itr = idx.begin();
-   while( itr != idx.end() && itr->effective_votes_next_update_block <= head_num )
+   const auto due_ids = _voter_effective_votes_update_schedule->due( head_num );
+   if( due_ids.empty() )
+      return;
+
+   vector<const voter_object*> due_voters;
+   due_voters.reserve( due_ids.size() );
+   for( const auto& id : due_ids )
+      due_voters.push_back( &get<voter_object>( id ) );
+
+   // keep the processing order of the former (next_update_block, uid, sequence) index
+   std::sort( due_voters.begin(), due_voters.end(), []( const voter_object* a, const voter_object* b )
    {
-      update_voter_effective_votes( *itr );
-      itr = idx.begin();
+      return std::tie( a->effective_votes_next_update_block, a->uid, a->sequence )
+           < std::tie( b->effective_votes_next_update_block, b->uid, b->sequence );
+   } );
+
+   for( const voter_object* voter : due_voters )
+   {
+      if( voter->effective_votes_next_update_block <= head_num )
+         update_voter_effective_votes( *voter );
    }
 }
 
@@ -1073,16 +1092,13 @@ void database::check_invariants()
 void database::release_platform_pledges()
 {
    const auto head_num = head_block_num();
-   const auto& idx = get_index_type<account_statistics_index>().indices().get<by_platform_pledge_release>();
-   auto itr = idx.begin();
-   while( itr != idx.end() && itr->platform_pledge_release_block_number <= head_num )
+   for( const auto& id : _platform_pledge_release_schedule->due( head_num ) )
    {
-      modify( *itr, [&](account_statistics_object& s) {
+      modify( get<account_statistics_object>( id ), [&](account_statistics_object& s) {
          s.total_platform_pledge -= s.releasing_platform_pledge;
          s.releasing_platform_pledge = 0;
          s.platform_pledge_release_block_number = -1;
       });
-      itr = idx.begin();
    }
 }
 
@@ -1133,12 +1149,7 @@ void database::update_platform_avg_pledge( const platform_object& pla )
    {
       // need to schedule next update because average_pledge < pledge, and need to update average_pledge
       uint64_t delta_seconds = ( now - pla.average_pledge_last_update ).to_seconds();
-      uint64_t old_seconds = window - delta_seconds;
-
-      fc::uint128_t old_coin_seconds = fc::uint128_t( pla.average_pledge ) * old_seconds;
-      fc::uint128_t new_coin_seconds = fc::uint128_t( pla.pledge ) * delta_seconds;
-
-      uint64_t new_average_coins = ( ( old_coin_seconds + new_coin_seconds ) / window ).to_uint64();
+      uint64_t new_average_coins = coin_seconds::average_after( pla.average_pledge, pla.pledge, window, delta_seconds );
 
       modify( pla, [&]( platform_object& p )
       {
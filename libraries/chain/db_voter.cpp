@@ -6,11 +6,11 @@
 
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/account_object.hpp>
+#include <graphene/chain/coin_seconds.hpp>
 #include <graphene/chain/witness_object.hpp>
 #include <graphene/chain/committee_member_object.hpp>
 #include <graphene/chain/content_object.hpp>
 
-#include <fc/uint128.hpp>
 
 namespace graphene { namespace chain {
 
@@ -43,12 +43,7 @@ void database::update_voter_effective_votes( const voter_object& voter )
    {
       // need to schedule next update because effective_votes < votes, and need to update effective_votes
       uint64_t delta_seconds = ( now - voter.effective_votes_last_update ).to_seconds();
-      uint64_t old_seconds = window - delta_seconds;
-
-      fc::uint128_t old_coin_seconds = fc::uint128_t( voter.effective_votes ) * old_seconds;
-      fc::uint128_t new_coin_seconds = fc::uint128_t( voter.votes ) * delta_seconds;
-
-      uint64_t new_average_coins = ( ( old_coin_seconds + new_coin_seconds ) / window ).to_uint64();
+      uint64_t new_average_coins = coin_seconds::average_after( voter.effective_votes, voter.votes, window, delta_seconds );
 
       modify( voter, [&]( voter_object& v )
       {
@@ -93,19 +88,34 @@ void database::adjust_voter_votes( const voter_object& voter, share_type delta )
 
    if( current_voter->proxy_uid == GRAPHENE_PROXY_TO_SELF_ACCOUNT_UID )
    {
-      adjust_voter_self_votes( *current_voter, delta );
+      if( _buffer_voter_self_votes )
+         _pending_voter_self_votes[ current_voter->id ] += delta;
+      else
+         adjust_voter_self_votes( *current_voter, delta );
    }
 
 }
 
-void database::adjust_voter_self_votes( const voter_object& voter, share_type delta )
+void database::apply_pending_voter_self_votes()
+{
+   if( _pending_voter_self_votes.empty() )
+      return;
+
+   // clear the buffer first, so nothing would be applied twice if this is called again in the middle
+   flat_map<object_id_type, share_type> pending;
+   std::swap( pending, _pending_voter_self_votes );
+   for( const auto& item : pending )
+      adjust_voter_self_votes( get<voter_object>( item.first ), item.second, true );
+}
+
+void database::adjust_voter_self_votes( const voter_object& voter, share_type delta, bool force_update )
 {
-   adjust_voter_self_witness_votes( voter, delta );
+   adjust_voter_self_witness_votes( voter, delta, force_update );
    adjust_voter_self_committee_member_votes( voter, delta );
    adjust_voter_self_platform_votes( voter, delta );
 }
 
-void database::adjust_voter_self_witness_votes( const voter_object& voter, share_type delta )
+void database::adjust_voter_self_witness_votes( const voter_object& voter, share_type delta, bool force_update )
 {
    // adjust witness votes
    uint16_t invalid_witness_votes_removed = 0;
@@ -116,7 +126,7 @@ void database::adjust_voter_self_witness_votes( const voter_object& voter, share
       const witness_object* witness = find_witness_by_uid( itr->witness_uid );
       bool to_remove = false;
       if( witness != nullptr && witness->sequence == itr->witness_sequence )
-         adjust_witness_votes( *witness, delta );
+         adjust_witness_votes( *witness, delta, force_update );
       else
       {
          to_remove = true;
@@ -201,6 +211,8 @@ void database::adjust_voter_self_committee_member_votes( const voter_object& vot
 
 void database::adjust_voter_proxy_votes( const voter_object& voter, vector<share_type> delta, bool update_last_vote )
 {
+   apply_pending_voter_self_votes();
+
    const auto max_level = get_global_properties().parameters.max_governance_voting_proxy_level;
 
    const voter_object* current_voter = &voter;
@@ -330,6 +342,8 @@ void database::clear_voter_proxy_votes( const voter_object& voter )
 
 void database::clear_voter_votes( const voter_object& voter )
 {
+   apply_pending_voter_self_votes();
+
    if( voter.proxy_uid == GRAPHENE_PROXY_TO_SELF_ACCOUNT_UID ) // voting by self
    {
       // remove its all witness votes
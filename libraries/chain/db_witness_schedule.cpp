@@ -23,6 +23,7 @@
  */
 
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/coin_seconds.hpp>
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/witness_object.hpp>
 #include <graphene/chain/witness_schedule_object.hpp>
@@ -293,12 +294,7 @@ void database::update_witness_avg_pledge( const witness_object& wit )
    {
       // need to schedule next update because average_pledge < pledge, and need to update average_pledge
       uint64_t delta_seconds = ( now - wit.average_pledge_last_update ).to_seconds();
-      uint64_t old_seconds = window - delta_seconds;
-
-      fc::uint128_t old_coin_seconds = fc::uint128_t( wit.average_pledge ) * old_seconds;
-      fc::uint128_t new_coin_seconds = fc::uint128_t( wit.pledge ) * delta_seconds;
-
-      uint64_t new_average_coins = ( ( old_coin_seconds + new_coin_seconds ) / window ).to_uint64();
+      uint64_t new_average_coins = coin_seconds::average_after( wit.average_pledge, wit.pledge, window, delta_seconds );
 
       modify( wit, [&]( witness_object& w )
       {
@@ -370,9 +366,11 @@ void database::reset_witness_by_vote_schedule()
    }
 }
 
-void database::adjust_witness_votes( const witness_object& witness, share_type delta )
+void database::adjust_witness_votes( const witness_object& witness, share_type delta, bool force_update )
 {
-   if( delta == 0 || !witness.is_valid )
+   // when applying aggregated votes, the witness need to be updated even if the changes summed up to zero,
+   // since its position would have been updated by each change
+   if( ( delta == 0 && !force_update ) || !witness.is_valid )
       return;
 
    const witness_schedule_object& wso = witness_schedule_id_type()(*this);
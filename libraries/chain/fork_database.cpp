@@ -196,6 +196,13 @@ vector<item_ptr> fork_database::fetch_block_by_number(uint32_t num)const
    return result;
 }
 
+vector<item_ptr> fork_database::fetch_blocks_by_witness_slot( account_uid_type witness,
+                                                              fc::time_point_sec timestamp )const
+{
+   auto range = _index.get<by_witness_slot>().equal_range( boost::make_tuple( witness, timestamp ) );
+   return vector<item_ptr>( range.first, range.second );
+}
+
 pair<fork_database::branch_type,fork_database::branch_type>
   fork_database::fetch_branch_from(block_id_type first, block_id_type second)const
 { try {
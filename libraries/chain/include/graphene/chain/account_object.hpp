@@ -24,6 +24,7 @@
 #pragma once
 #include <graphene/chain/protocol/operations.hpp>
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/timing_wheel.hpp>
 #include <boost/multi_index/composite_key.hpp>
 #include <numeric>
 
@@ -542,7 +543,8 @@ namespace graphene { namespace chain {
                std::less< account_uid_type >
             >
          >
-      >
+      >,
+      graphene::db::slab_allocator< account_balance_object >
    > account_balance_object_multi_index_type;
 
    /**
@@ -550,6 +552,42 @@ namespace graphene { namespace chain {
     */
    typedef generic_index<account_balance_object, account_balance_object_multi_index_type> account_balance_index;
 
+   /** aggregates of the balances of an asset */
+   struct asset_holder_stats
+   {
+      uint64_t    holders = 0;   ///< number of accounts with a non-zero balance
+      share_type  total_balance; ///< sum of the balances of all accounts
+   };
+
+   /**
+    *  @brief This secondary index maintains the number of holders and the sum of balances of each asset, so that
+    *  the holder APIs do not have to walk all the balances of an asset.
+    *
+    *  It is updated from the callbacks of the balance index, which are also invoked when blocks are undone and when
+    *  the database is loaded, so the aggregates always match the balances.
+    */
+   class asset_holder_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /** @return the aggregates of @ref asset_id, all zero if nobody ever held it */
+         asset_holder_stats get_stats( asset_aid_type asset_id )const;
+         const map< asset_aid_type, asset_holder_stats >& get_all_stats()const { return stats_by_asset; }
+
+      protected:
+         void add_balance( asset_aid_type asset_id, share_type balance );
+         void remove_balance( asset_aid_type asset_id, share_type balance );
+
+         map< asset_aid_type, asset_holder_stats > stats_by_asset;
+
+         asset_aid_type  before_asset_type = 0;
+         share_type      before_balance;
+   };
+
    struct by_name;
    struct by_uid;
 
@@ -572,7 +610,6 @@ namespace graphene { namespace chain {
 
 
    struct by_uid_seq;
-   struct by_votes_next_update;
    struct by_last_vote;
    struct by_valid;
    struct by_proxy;
@@ -591,14 +628,6 @@ namespace graphene { namespace chain {
                member< voter_object, uint32_t, &voter_object::sequence>
             >
          >,
-         ordered_unique< tag<by_votes_next_update>,
-            composite_key<
-               voter_object,
-               member< voter_object, uint32_t, &voter_object::effective_votes_next_update_block>,
-               member< voter_object, account_uid_type, &voter_object::uid>,
-               member< voter_object, uint32_t, &voter_object::sequence>
-            >
-         >,
          ordered_unique< tag<by_last_vote>,
             composite_key<
                voter_object,
@@ -635,6 +664,13 @@ namespace graphene { namespace chain {
     */
    typedef generic_index<voter_object, voter_multi_index_type> voter_index;
 
+   /**
+    * @ingroup object_index
+    * Schedule of effective votes updates, used by the per-block sweep.
+    */
+   typedef graphene::db::scheduled_event_index< voter_object, &voter_object::effective_votes_next_update_block >
+           voter_effective_votes_update_schedule;
+
 
    struct by_original;
    struct by_takeover;
@@ -665,10 +701,6 @@ namespace graphene { namespace chain {
    typedef generic_index<registrar_takeover_object, registrar_takeover_multi_index_type> registrar_takeover_index;
 
 
-   struct by_witness_pledge_release;
-   struct by_committee_member_pledge_release;
-   struct by_platform_pledge_release;
-
    /**
     * @ingroup object_index
     */
@@ -676,28 +708,7 @@ namespace graphene { namespace chain {
       account_statistics_object,
       indexed_by<
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
-         ordered_unique< tag<by_uid>, member<account_statistics_object, account_uid_type, &account_statistics_object::owner> >,
-         ordered_unique< tag<by_witness_pledge_release>,
-            composite_key<
-               account_statistics_object,
-               member<account_statistics_object, uint32_t, &account_statistics_object::witness_pledge_release_block_number>,
-               member<account_statistics_object, account_uid_type, &account_statistics_object::owner>
-            >
-         >,
-         ordered_unique< tag<by_committee_member_pledge_release>,
-            composite_key<
-               account_statistics_object,
-               member<account_statistics_object, uint32_t, &account_statistics_object::committee_member_pledge_release_block_number>,
-               member<account_statistics_object, account_uid_type, &account_statistics_object::owner>
-            >
-         >,
-         ordered_unique< tag<by_platform_pledge_release>,
-            composite_key<
-               account_statistics_object,
-               member<account_statistics_object, uint32_t, &account_statistics_object::platform_pledge_release_block_number>,
-               member<account_statistics_object, account_uid_type, &account_statistics_object::owner>
-            >
-         >
+         ordered_unique< tag<by_uid>, member<account_statistics_object, account_uid_type, &account_statistics_object::owner> >
       >
    > account_statistics_object_multi_index_type;
 
@@ -706,6 +717,20 @@ namespace graphene { namespace chain {
     */
    typedef generic_index<account_statistics_object, account_statistics_object_multi_index_type> account_statistics_index;
 
+   /**
+    * @ingroup object_index
+    * Pledge release schedules, used by the per-block release sweeps instead of ordered keys on the statistics object.
+    */
+   typedef graphene::db::scheduled_event_index< account_statistics_object,
+                                                &account_statistics_object::witness_pledge_release_block_number >
+           witness_pledge_release_schedule;
+   typedef graphene::db::scheduled_event_index< account_statistics_object,
+                                                &account_statistics_object::committee_member_pledge_release_block_number >
+           committee_member_pledge_release_schedule;
+   typedef graphene::db::scheduled_event_index< account_statistics_object,
+                                                &account_statistics_object::platform_pledge_release_block_number >
+           platform_pledge_release_schedule;
+
 }}
 
 FC_REFLECT_DERIVED( graphene::chain::account_object,
@@ -745,6 +770,8 @@ FC_REFLECT_DERIVED( graphene::chain::account_balance_object,
                     (graphene::db::object),
                     (owner)(asset_type)(balance) )
 
+FC_REFLECT( graphene::chain::asset_holder_stats, (holders)(total_balance) )
+
 FC_REFLECT_DERIVED( graphene::chain::account_statistics_object,
                     (graphene::chain::object),
                     (owner)
@@ -773,3 +800,9 @@ FC_REFLECT_DERIVED( graphene::chain::account_statistics_object,
                     (last_post_sequence)
                   )
 
+GRAPHENE_DB_REGISTER_PRIMARY_INDEX( graphene::chain::account_object,
+                                    graphene::db::primary_index<graphene::chain::account_index, true> )
+GRAPHENE_DB_REGISTER_PRIMARY_INDEX( graphene::chain::account_statistics_object,
+                                    graphene::db::primary_index<graphene::chain::account_statistics_index, true> )
+GRAPHENE_DB_REGISTER_PRIMARY_INDEX( graphene::chain::voter_object,
+                                    graphene::db::primary_index<graphene::chain::voter_index> )
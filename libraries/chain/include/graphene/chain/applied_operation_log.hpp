@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <deque>
+#include <vector>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  An operation applied since the block being applied started, with its result and its position in the block.
+    *  @ref op points into a transaction of the block, or into the @ref applied_operation_log for the operations which
+    *  do not outlive their application, such as those of proposals. Valid until the log is cleared, once the
+    *  observers of database::applied_block were called.
+    */
+   struct applied_operation
+   {
+      const operation*  op = nullptr;
+      operation_result  result;
+      time_point_sec    block_timestamp;
+      uint32_t          block_num = 0;
+      uint16_t          trx_in_block = 0;
+      uint16_t          op_in_trx = 0;
+      uint16_t          virtual_op = 0;
+      bool              owned = false;   ///< @ref op is a copy kept by the log
+
+      /** copies the operation to an object of the database, which outlives the block */
+      void copy_to( operation_history_object& h )const;
+   };
+
+   /**
+    *  @class applied_operation_log
+    *  @brief the operations applied by a block, see database::get_applied_operations()
+    *
+    *  The operations of the transactions of the block are referenced, the other ones are copied to an arena whose
+    *  addresses do not change as operations are added, and which is released when the log is cleared. The entries
+    *  keep their capacity from block to block.
+    */
+   class applied_operation_log
+   {
+      public:
+         typedef std::vector<applied_operation>::const_iterator const_iterator;
+
+         /** @param stable true if @ref op outlives the block, it is then referenced instead of copied */
+         applied_operation& push( const operation& op, bool stable );
+
+         /** drops the operations added after the first @ref n, when what applied them failed */
+         void truncate( size_t n );
+         void clear();
+
+         size_t size()const  { return _entries.size(); }
+         bool   empty()const { return _entries.empty(); }
+         const applied_operation& operator[]( size_t i )const { return _entries[i]; }
+         applied_operation&       operator[]( size_t i )      { return _entries[i]; }
+         const_iterator begin()const { return _entries.begin(); }
+         const_iterator end()const   { return _entries.end(); }
+
+         /** @return the number of operations the log holds a copy of */
+         size_t copied()const { return _arena.size(); }
+
+      private:
+         std::vector<applied_operation> _entries;
+         std::deque<operation>          _arena;
+   };
+
+} } // graphene::chain
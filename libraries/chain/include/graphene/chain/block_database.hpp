@@ -23,7 +23,7 @@
  */
 #pragma once
 #include <fstream>
-#include <graphene/chain/protocol/block.hpp>
+#include <graphene/chain/protocol/packed_block.hpp>
 
 namespace graphene { namespace chain {
    struct index_entry;
@@ -31,23 +31,33 @@ namespace graphene { namespace chain {
    class block_database 
    {
       public:
-         void open( const fc::path& dbdir );
+         /**
+          * @param read_only open the files of another process for reading, e.g. to follow its chain,
+          *        nothing is created or truncated and @ref store / @ref remove must not be called
+          */
+         void open( const fc::path& dbdir, bool read_only = false );
          bool is_open()const;
          void flush();
          void close();
 
          void store( const block_id_type& id, const signed_block& b );
+         /** stores the bytes of @ref b as they are */
+         void store( const packed_block& b );
          void remove( const block_id_type& id );
 
          bool                   contains( const block_id_type& id )const;
          block_id_type          fetch_block_id( uint32_t block_num )const;
          optional<signed_block> fetch_optional( const block_id_type& id )const;
+         /** @return the block as it is stored, without decoding its transactions */
+         optional<packed_block> fetch_packed( const block_id_type& id )const;
          optional<signed_block> fetch_by_number( uint32_t block_num )const;
          optional<signed_block> last()const;
          optional<block_id_type> last_id()const;
       private:
          optional<index_entry> last_index_entry()const;
+         void write( const block_id_type& id, const char* data, size_t size );
          fc::path _index_filename;
+         bool     _read_only = false;
          mutable std::fstream _blocks;
          mutable std::fstream _block_num_to_pos;
    };
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <graphene/chain/applied_operation_log.hpp>
+#include <graphene/chain/protocol/types.hpp>
+
+#include <fc/container/flat.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace graphene { namespace chain {
+
+   /** the accounts an applied operation concerns, see @ref block_journal */
+   struct journaled_operation
+   {
+      uint16_t                   trx_in_block = 0;
+      uint16_t                   op_in_trx = 0;
+      uint16_t                   virtual_op = 0;
+      flat_set<account_uid_type> impacted;           ///< see operation_get_impacted_account_uids()
+      flat_set<account_uid_type> authorities;        ///< the accounts of the authorities the operation requires
+   };
+
+   /** an object created, modified or removed by a block, with the accounts it belongs to */
+   struct journaled_object
+   {
+      object_id_type             id;
+      flat_set<account_uid_type> accounts;           ///< see get_relevant_accounts()
+   };
+
+   /**
+    *  @class block_journal
+    *  @brief what the last applied block did, and to which accounts
+    *
+    *  Built once by the database while applying a block, so that the account history, the subscriptions of the API
+    *  and the change notifications do not visit each operation again. The operations are recorded before
+    *  database::applied_block is emitted, if database::set_journal_operations() was enabled. The created, modified
+    *  and removed objects are each recorded before database::new_objects, changed_objects and removed_objects are
+    *  emitted, if something is connected to that signal.
+    */
+   class block_journal
+   {
+      public:
+         void reset( uint32_t block_num );
+
+         /** records one entry per applied operation, in the same order */
+         void add_operations( const applied_operation_log& ops );
+
+         /** @return the operation applied at this position in the block, or nullptr */
+         const journaled_operation* find_operation( uint16_t trx_in_block, uint16_t op_in_trx,
+                                                    uint16_t virtual_op )const;
+
+         /** get_relevant_accounts(), without visiting again the operation of a history object of this block */
+         void get_relevant_accounts( const object* obj, flat_set<account_uid_type>& accounts )const;
+
+         void add_created( const object* obj );
+         void add_modified( const object* obj );
+         void add_removed( const object* obj );
+
+         uint32_t                          block_num = 0;
+         std::vector<journaled_operation>  operations;
+         std::vector<journaled_object>     created;
+         std::vector<journaled_object>     modified;
+         std::vector<journaled_object>     removed;
+         /// unions of the accounts of the objects
+         ///@{
+         flat_set<account_uid_type>        created_accounts;
+         flat_set<account_uid_type>        modified_accounts;
+         flat_set<account_uid_type>        removed_accounts;
+         ///@}
+
+      private:
+         static uint64_t position( uint16_t trx_in_block, uint16_t op_in_trx, uint16_t virtual_op )
+         {
+            return ( uint64_t( trx_in_block ) << 32 ) | ( uint64_t( op_in_trx ) << 16 ) | virtual_op;
+         }
+         void add_object( const object* obj, std::vector<journaled_object>& objects,
+                          flat_set<account_uid_type>& accounts );
+
+         std::unordered_map<uint64_t, uint32_t> _operation_by_position;
+   };
+
+} } // graphene::chain
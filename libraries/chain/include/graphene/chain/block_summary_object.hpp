@@ -23,6 +23,7 @@
  */
 #pragma once
 #include <graphene/db/object.hpp>
+#include <graphene/db/flat_index.hpp>
 
 namespace graphene { namespace chain {
    using namespace graphene::db;
@@ -48,3 +49,6 @@ namespace graphene { namespace chain {
 } }
 
 FC_REFLECT_DERIVED( graphene::chain::block_summary_object, (graphene::db::object), (block_id) )
+
+GRAPHENE_DB_REGISTER_PRIMARY_INDEX( graphene::chain::block_summary_object,
+                                    graphene::db::primary_index<graphene::db::flat_index<graphene::chain::block_summary_object>> )
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <graphene/chain/immutable_chain_parameters.hpp>
+#include <graphene/db/simple_index.hpp>
 
 namespace graphene { namespace chain {
 
@@ -48,3 +49,6 @@ FC_REFLECT_DERIVED( graphene::chain::chain_property_object, (graphene::db::objec
                     (chain_id)
                     (immutable_parameters)
                   )
+
+GRAPHENE_DB_REGISTER_PRIMARY_INDEX( graphene::chain::chain_property_object,
+                                    graphene::db::primary_index<graphene::db::simple_index<graphene::chain::chain_property_object>> )
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <fc/uint128.hpp>
+
+#include <limits>
+#include <type_traits>
+
+namespace graphene { namespace chain { namespace coin_seconds {
+
+   /**
+    *  Arithmetic of coin-seconds, shared by the CSAF of accounts, the effective votes of voters and the average pledges
+    *  of platforms.
+    *
+    *  The results are bit-identical to computing with fc::uint128_t, including its wrap-around and its truncation
+    *  to 64 bits, but 64-bit integers are used when the products can't overflow, and native 128-bit integers when the
+    *  compiler has them. The software division of fc::uint128_t dominates the cost of these computations otherwise.
+    */
+
+   namespace detail {
+#ifdef __SIZEOF_INT128__
+      typedef unsigned __int128 native_uint128;
+
+      /// widens like the constructors of fc::uint128_t, signed values are sign-extended
+      inline native_uint128 widen( int64_t v )  { return native_uint128( __int128( v ) ); }
+      inline native_uint128 widen( uint64_t v ) { return native_uint128( v ); }
+
+      inline fc::uint128_t to_fc( native_uint128 v ) { return fc::uint128_t( uint64_t( v >> 64 ), uint64_t( v ) ); }
+      inline native_uint128 from_fc( const fc::uint128_t& v ) { return ( native_uint128( v.hi ) << 64 ) | v.lo; }
+#endif
+
+      inline bool fits_in_window( int64_t v, uint64_t limit )  { return v >= 0 && uint64_t( v ) <= limit; }
+      inline bool fits_in_window( uint64_t v, uint64_t limit ) { return v <= limit; }
+   }
+
+   /**
+    * @return the average balance over a sliding window of @ref window seconds, @ref delta_seconds after the average was
+    * @ref average, if the balance has been @ref balance since:
+    * ( average * ( window - delta_seconds ) + balance * delta_seconds ) / window, truncated to 64 bits
+    * @pre delta_seconds < window
+    */
+   template<typename T>
+   uint64_t average_after( T average, T balance, uint64_t window, uint64_t delta_seconds )
+   {
+      static_assert( std::is_same<T, int64_t>::value || std::is_same<T, uint64_t>::value, "64-bit integers only" );
+      const uint64_t old_seconds = window - delta_seconds;
+      // the sum is at most max( average, balance ) * window
+      const uint64_t limit = std::numeric_limits<uint64_t>::max() / window;
+      if( detail::fits_in_window( average, limit ) && detail::fits_in_window( balance, limit ) )
+         return ( uint64_t( average ) * old_seconds + uint64_t( balance ) * delta_seconds ) / window;
+#ifdef __SIZEOF_INT128__
+      return uint64_t( ( detail::widen( average ) * old_seconds + detail::widen( balance ) * delta_seconds ) / window );
+#else
+      return ( ( fc::uint128_t( average ) * old_seconds + fc::uint128_t( balance ) * delta_seconds ) / window ).to_uint64();
+#endif
+   }
+
+   /** @return average * window, the most coin-seconds an account with this average can have earned */
+   inline fc::uint128_t window_capacity( int64_t average, uint64_t window )
+   {
+#ifdef __SIZEOF_INT128__
+      return detail::to_fc( detail::widen( average ) * window );
+#else
+      return fc::uint128_t( average ) * window;
+#endif
+   }
+
+   /** @return earned + balance * delta_seconds, at most @ref cap */
+   inline fc::uint128_t accrue( const fc::uint128_t& earned, int64_t balance, int64_t delta_seconds, const fc::uint128_t& cap )
+   {
+#ifdef __SIZEOF_INT128__
+      const detail::native_uint128 result = detail::from_fc( earned )
+                                          + detail::widen( balance ) * detail::widen( delta_seconds );
+      const detail::native_uint128 native_cap = detail::from_fc( cap );
+      return detail::to_fc( result > native_cap ? native_cap : result );
+#else
+      fc::uint128_t delta_coin_seconds = balance;
+      delta_coin_seconds *= delta_seconds;
+      const fc::uint128_t result = earned + delta_coin_seconds;
+      return result > cap ? cap : result;
+#endif
+   }
+
+} } } // graphene::chain::coin_seconds
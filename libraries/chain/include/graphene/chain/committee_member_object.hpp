@@ -169,7 +169,8 @@ namespace graphene { namespace chain {
                member< committee_member_vote_object, uint32_t, &committee_member_vote_object::voter_sequence>
             >
          >
-      >
+      >,
+      graphene::db::slab_allocator< committee_member_vote_object >
    > committee_member_vote_multi_index_type;
 
    /**
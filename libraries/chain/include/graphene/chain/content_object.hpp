@@ -163,7 +163,8 @@ namespace graphene { namespace chain {
                member< platform_vote_object, uint32_t, &platform_vote_object::voter_sequence>
             >
          >
-      >
+      >,
+      graphene::db::slab_allocator< platform_vote_object >
    > platform_vote_multi_index_type;
 
     /**
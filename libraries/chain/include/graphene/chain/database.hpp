@@ -30,7 +30,11 @@
 #include <graphene/chain/content_object.hpp>
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/fork_database.hpp>
+#include <graphene/chain/applied_operation_log.hpp>
 #include <graphene/chain/block_database.hpp>
+#include <graphene/chain/block_journal.hpp>
+#include <graphene/chain/pending_transaction_pool.hpp>
+#include <graphene/chain/validated_block_cache.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
 
@@ -38,6 +42,7 @@
 #include <graphene/db/object.hpp>
 #include <graphene/db/simple_index.hpp>
 #include <fc/signals.hpp>
+#include <fc/thread/thread.hpp>
 
 #include <graphene/chain/protocol/protocol.hpp>
 
@@ -53,6 +58,19 @@ namespace graphene { namespace chain {
 
    struct budget_record;
 
+   /**
+    * Time spent in each step of applying blocks, see database::set_block_apply_profiling()
+    */
+   struct block_apply_profile
+   {
+      fc::microseconds header;         ///< merkle root and block header checks, including the witness signature
+      fc::microseconds authorities;    ///< signature and authority checks of transactions
+      fc::microseconds evaluation;     ///< the rest of applying transactions: validation, TaPoS checks and operations
+      fc::microseconds maintenance;    ///< per-block updates and chain maintenance around the transactions
+      fc::microseconds undo;           ///< starting and committing the undo sessions of blocks
+      fc::microseconds notifications;  ///< applied_block signal and changed object notifications
+   };
+
    /**
     *   @class database
     *   @brief tracks the blockchain state in an extensible manner
@@ -117,6 +135,74 @@ namespace graphene { namespace chain {
          void wipe(const fc::path& data_dir, bool include_blocks);
          void close(bool rewind = true);
 
+         /**
+          * @brief Save the irreversible object graph to disk each time @ref blocks more blocks became irreversible
+          *
+          * After an unclean shutdown, @ref open loads the last saved state and only replays the blocks pushed
+          * after it, instead of the whole chain. The saved state is the one of the last irreversible block, so the
+          * blocks replayed after it can still be popped. 0 (the default) only saves the state on @ref close.
+          *
+          * The objects are packed when the block is pushed, they are written to disk on another thread.
+          */
+         void set_state_checkpoint_interval( uint32_t blocks ) { _state_checkpoint_interval = blocks; }
+         /** @brief Wait until the last state checkpoint is on disk */
+         void wait_for_state_checkpoint();
+
+         /**
+          * @brief Aggregate the vote changes of the voters voting by self while applying the transactions of a block
+          *
+          * Enabled by default. The result is the same as fanning out every change to the candidates immediately,
+          * disabling it is meant for tests comparing both.
+          */
+         void set_block_vote_aggregation( bool enabled ) { _aggregate_block_votes = enabled; }
+
+         /**
+          * @brief Bound the pool of pending transactions
+          * @param max_bytes total size of the pending transactions, 0 for no limit
+          * @param max_per_account number of pending transactions whose fee is paid by one account, 0 for no limit
+          */
+         void set_pending_transaction_limits( uint64_t max_bytes, uint32_t max_per_account )
+         { _pending_tx.set_limits( max_bytes, max_per_account ); }
+
+         /**
+          * @brief Bound the number of expired transactions removed from the deduplication index per block
+          *
+          * An expired transaction is rejected whether or not it is still in the index, so removing them later does
+          * not change consensus. After a burst of transactions with the same expiration, a limit spreads their
+          * removal over several blocks. 0 (the default) removes all expired transactions at once.
+          */
+         void set_expired_transactions_per_block( uint32_t limit ) { _expired_transactions_per_block = limit; }
+
+         /**
+          * @brief Bound the memory used by the undo history of the reversible blocks
+          *
+          * While the last irreversible block lags, the undo states of the oldest reversible blocks beyond the limits
+          * are written to the undo_spill file of the data directory, and read back when blocks are popped down to
+          * them. 0 means no limit, both are 0 by default.
+          */
+         void set_undo_spill_limits( size_t max_states_in_memory, uint64_t max_bytes_in_memory )
+         { _undo_db.set_spill_limits( max_states_in_memory, max_bytes_in_memory ); }
+
+         /**
+          * @brief Bound the number of blocks of the fork window kept with their checks
+          *
+          * A block popped, or switched back to, is read from memory, and its signatures are not recovered again. Side
+          * branch blocks are checked as they arrive, so that switching to their branch is faster. 0 disables the
+          * cache, 256 blocks by default.
+          */
+         void set_validated_block_cache_size( size_t blocks ) { _validated_blocks.set_capacity( blocks ); }
+         const validated_block_cache& get_validated_block_cache()const { return _validated_blocks; }
+
+         /**
+          * @brief Measure the time spent in each step of applying blocks
+          *
+          * Meant for benchmarks, it reads the clock several times per transaction. The times accumulate until
+          * they are read by @ref take_block_apply_profile.
+          */
+         void set_block_apply_profiling( bool enabled ) { _profile_block_apply = enabled; }
+         /** @return the times accumulated since the last call, and resets them */
+         block_apply_profile take_block_apply_profile();
+
          //////////////////// db_block.cpp ////////////////////
 
          /**
@@ -128,10 +214,20 @@ namespace graphene { namespace chain {
          block_id_type              get_block_id_for_num( uint32_t block_num )const; // get from disk directly
          block_id_type              fetch_block_id_for_num( uint32_t block_num )const; // check fork db first
          optional<signed_block>     fetch_block_by_id( const block_id_type& id )const;
+         /** @return the block as it is stored in the block database, without decoding it, or packed if it is not there */
+         optional<packed_block>     fetch_packed_block_by_id( const block_id_type& id )const;
          optional<signed_block>     fetch_block_by_number( uint32_t num )const;
          const signed_transaction&  get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
 
+         /**
+          *  @return the double productions detected since the node was first started, oldest first, at most one per
+          *  witness and slot. They are detected when a block enters the fork database, whether or not it is applied,
+          *  and saved in the data directory.
+          */
+         const vector<double_production_evidence>& get_double_production_evidence()const
+         { return _double_production_evidence; }
+
          /**
           *  Calculate the percent of block production slots that were missed in the
           *  past 128 blocks, not including the current block.
@@ -143,23 +239,48 @@ namespace graphene { namespace chain {
          bool before_last_checkpoint()const;
 
          bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
+         /**
+          * Like push_block( const signed_block&, uint32_t ) for a block received serialized, @ref packed are the bytes
+          * @ref b was decoded from. They must be exactly @ref b packed, as block_message::from_message checks. They
+          * are stored as they are, and the ID of the block is taken from them. An empty @ref packed is ignored.
+          */
+         bool push_block( const signed_block& b, const packed_block& packed, uint32_t skip = skip_nothing );
+         bool push_block( const packed_block& b, uint32_t skip = skip_nothing ) { return push_block( b.block(), b, skip ); }
          processed_transaction push_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
-         bool _push_block( const signed_block& b );
+         /** @param packed the bytes of @ref b if it was received serialized, empty otherwise */
+         bool _push_block( const signed_block& b, const packed_block& packed = packed_block() );
          processed_transaction _push_transaction( const signed_transaction& trx );
 
          ///@throws fc::exception if the proposed transaction fails to apply.
          processed_transaction push_proposal( const proposal_object& proposal );
 
+         /**
+          * @brief Follow the chain saved in the block database of another node
+          *
+          * Pops the blocks which are no longer in @ref source (the other node switched forks), then pushes the
+          * blocks after our head block which @ref source has, at most @ref max_blocks of them.
+          *
+          * @return the number of blocks pushed
+          */
+         uint32_t push_blocks_from( const block_database& source, uint32_t skip, uint32_t max_blocks );
+
+         /**
+          * @param deadline pending transactions are only applied until this time. Those whose apply time, as measured
+          * when they were pushed, would take the block past it are left pending, so that an expensive pool can't
+          * make the witness miss its slot. See get_last_block_generation_stats().
+          */
          signed_block generate_block(
             const fc::time_point_sec when,
             account_uid_type witness_uid,
             const fc::ecc::private_key& block_signing_private_key,
-            uint32_t skip
+            uint32_t skip,
+            fc::time_point deadline = fc::time_point::maximum()
             );
          signed_block _generate_block(
             const fc::time_point_sec when,
             account_uid_type witness_uid,
-            const fc::ecc::private_key& block_signing_private_key
+            const fc::ecc::private_key& block_signing_private_key,
+            fc::time_point deadline = fc::time_point::maximum()
             );
 
          void pop_block();
@@ -172,11 +293,18 @@ namespace graphene { namespace chain {
           *  applied operations is cleared after applying each block and calling the block
           *  observers which may want to index these operations.
           *
+          *  @param stable true if @ref op is in a transaction of the block being applied, it is then referenced
+          *  rather than copied
           *  @return the op_id which can be used to set the result after it has finished being applied.
           */
-         uint32_t  push_applied_operation( const operation& op );
+         uint32_t  push_applied_operation( const operation& op, bool stable = false );
          void      set_applied_operation_result( uint32_t op_id, const operation_result& r );
-         const vector<optional< operation_history_object > >& get_applied_operations()const;
+         /** @return the operations applied so far, the operations are valid until applied_block was emitted */
+         const applied_operation_log& get_applied_operations()const;
+         /** @return what the last applied block did, complete when applied_block and the object notifications are emitted */
+         const block_journal& get_block_journal()const { return _block_journal; }
+         /** the operations of the journal are only recorded when a plugin which reads them asked for it */
+         void set_journal_operations( bool journal ) { _journal_operations = journal; }
 
          string to_pretty_string( const asset& a )const;
          string to_pretty_core_string( const share_type amount )const;
@@ -197,6 +325,12 @@ namespace graphene { namespace chain {
           */
          fc::signal<void(const signed_transaction&)>     on_pending_transaction;
 
+         /**
+          * This signal is emitted when a block enters the fork database while another block signed by the same
+          * witness for the same slot is there, see get_double_production_evidence().
+          */
+         fc::signal<void(const double_production_evidence&)> double_production_detected;
+
          /**
           *  Emitted After a block has been applied and committed.  The callback
           *  should not yield and should execute quickly.
@@ -254,7 +388,7 @@ namespace graphene { namespace chain {
 
          void update_witness_avg_pledge( const account_uid_type uid );
          void update_witness_avg_pledge( const witness_object& wit );
-         void adjust_witness_votes( const witness_object& witness, share_type delta );
+         void adjust_witness_votes( const witness_object& witness, share_type delta, bool force_update = false );
 
       private:
          void update_witness_schedule();
@@ -274,14 +408,15 @@ namespace graphene { namespace chain {
       private:
          void update_voter_effective_votes( const voter_object& voter );
          void adjust_voter_votes( const voter_object& voter, share_type delta );
-         void adjust_voter_self_votes( const voter_object& voter, share_type delta );
-         void adjust_voter_self_witness_votes( const voter_object& voter, share_type delta );
+         void adjust_voter_self_votes( const voter_object& voter, share_type delta, bool force_update = false );
+         void adjust_voter_self_witness_votes( const voter_object& voter, share_type delta, bool force_update = false );
          void adjust_voter_self_committee_member_votes( const voter_object& voter, share_type delta );
          void adjust_voter_self_platform_votes( const voter_object& voter, share_type delta );
          void clear_voter_witness_votes( const voter_object& voter );
          void clear_voter_committee_member_votes( const voter_object& voter );
          void clear_voter_platform_votes( const voter_object& voter );
          uint32_t process_invalid_proxied_voters( const voter_object& proxy, uint32_t max_voters_to_process );
+         void apply_pending_voter_self_votes();
 
          //////////////////// db_getter.cpp ////////////////////
       public:
@@ -308,6 +443,10 @@ namespace graphene { namespace chain {
 
          uint32_t last_non_undoable_block_num() const;
 
+         pending_transaction_pool_stats get_pending_transaction_pool_stats()const;
+         /** @return how the pending transactions were packed by the last call to generate_block() */
+         const block_generation_stats& get_last_block_generation_stats()const { return _last_block_generation_stats; }
+
          const account_object& get_account_by_uid( account_uid_type uid )const;
          const account_object* find_account_by_uid( account_uid_type uid )const;
          const optional<account_id_type> find_account_id_by_uid( account_uid_type uid )const;
@@ -434,7 +573,13 @@ namespace graphene { namespace chain {
          ///Steps involved in applying a new block
          ///@{
 
-         const witness_object& validate_block_header( uint32_t skip, const signed_block& next_block )const;
+         /** @param validated the checks already made on @ref next_block, which are completed, if it is cached */
+         const witness_object& validate_block_header( uint32_t skip, const signed_block& next_block,
+                                                      validated_block* validated = nullptr )const;
+         /** makes the checks of a block of another branch than the head which do not depend on the state */
+         void prevalidate_block( const item_ptr& item );
+         /** records the evidence if @ref new_block, just pushed to the fork database, conflicts with another block */
+         void check_double_production( const signed_block& new_block );
          const witness_object& _validate_block_header( const signed_block& next_block )const;
          void create_block_summary(const signed_block& next_block);
 
@@ -481,7 +626,7 @@ namespace graphene { namespace chain {
 
       private:
 
-         vector< processed_transaction >        _pending_tx;
+         pending_transaction_pool               _pending_tx;
          fork_database                          _fork_db;
 
          /**
@@ -501,7 +646,17 @@ namespace graphene { namespace chain {
           * order they occur and is cleared after the applied_block signal is
           * emited.
           */
-         vector<optional<operation_history_object> >  _applied_ops;
+         applied_operation_log                        _applied_ops;
+         /// the transactions being applied belong to a block, their operations outlive _applied_ops
+         bool                                         _applying_block_transactions = false;
+         /// reset at the start of each block, see get_block_journal()
+         block_journal                                _block_journal;
+         /// see set_journal_operations()
+         bool                                         _journal_operations = false;
+         /// see set_validated_block_cache_size()
+         validated_block_cache                        _validated_blocks;
+         /// the checks of the block whose transactions are being applied, if it is cached
+         validated_block*                             _applying_validated_block = nullptr;
 
          time_point_sec                    _current_block_time;
          uint32_t                          _current_block_num    = 0;
@@ -511,7 +666,54 @@ namespace graphene { namespace chain {
 
          flat_map<uint32_t,block_id_type>  _checkpoints;
 
+         /// save the irreversible object graph every N blocks, see set_state_checkpoint_interval()
+         uint32_t                          _state_checkpoint_interval = 0;
+         /// the irreversible block of the last state checkpoint, or of the state loaded
+         uint32_t                          _state_checkpoint_block = 0;
+         std::unique_ptr<fc::thread>       _state_checkpoint_thread;
+         fc::future<void>                  _state_checkpoint_write;
+         void                              save_state_checkpoint();
+
          node_property_object              _node_property_object;
+
+         block_generation_stats            _last_block_generation_stats;
+
+         vector<double_production_evidence> _double_production_evidence;
+         /// one JSON evidence per line, appended to
+         fc::path                          _double_production_evidence_file;
+         /// by slot and witness, the blocks of the slot which are not signed by the witness, see check_double_production()
+         std::map< std::pair<fc::time_point_sec, account_uid_type>, flat_set<block_id_type> > _rejected_slot_blocks;
+
+         /// see set_expired_transactions_per_block()
+         uint32_t                          _expired_transactions_per_block = 0;
+
+         bool                              _profile_block_apply = false;
+         block_apply_profile               _block_apply_profile;
+
+         /**
+          * Timing wheels for "due at block N" maintenance events, they are secondary indexes
+          * owned by the object indexes and are set up in initialize_indexes().
+          */
+         ///@{
+         witness_pledge_release_schedule*          _witness_pledge_release_schedule = nullptr;
+         committee_member_pledge_release_schedule* _committee_member_pledge_release_schedule = nullptr;
+         platform_pledge_release_schedule*         _platform_pledge_release_schedule = nullptr;
+         witness_avg_pledge_update_schedule*       _witness_avg_pledge_update_schedule = nullptr;
+         voter_effective_votes_update_schedule*    _voter_effective_votes_update_schedule = nullptr;
+         ///@}
+
+         /**
+          * While applying the transactions of a block, changes of voters' votes are not fanned out to
+          * the witnesses, committee members and platforms they voted for immediately, instead they are
+          * accumulated here, keyed by the voter who votes by self at the end of the proxy chain, and
+          * applied once by apply_pending_voter_self_votes(). Pending votes are applied before anything
+          * changes the vote set, the proxy or the validity of a voter or of a candidate.
+          */
+         ///@{
+         bool                                   _aggregate_block_votes = true;
+         bool                                   _buffer_voter_self_votes = false;
+         flat_map<object_id_type, share_type>   _pending_voter_self_votes;
+         ///@}
    };
 
    namespace detail
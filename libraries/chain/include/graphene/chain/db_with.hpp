@@ -25,6 +25,8 @@
 
 #include <graphene/chain/database.hpp>
 
+#include <graphene/utilities/transaction_tracer.hpp>
+
 /*
  * This file provides with() functions which modify the database
  * temporarily, then restore it.  These functions are mostly internal
@@ -83,6 +85,8 @@ struct pending_transactions_restorer
                // since push_transaction() takes a signed_transaction,
                // the operation_results field will be ignored.
                _db._push_transaction( tx );
+               graphene::utilities::transaction_tracer::instance().record( tx.id(),
+                     graphene::utilities::transaction_tracer::reapplied_stage );
             }
          } catch ( const fc::exception&  ) {
          }
@@ -96,6 +100,8 @@ struct pending_transactions_restorer
                // since push_transaction() takes a signed_transaction,
                // the operation_results field will be ignored.
                _db._push_transaction( tx );
+               graphene::utilities::transaction_tracer::instance().record( tx.id(),
+                     graphene::utilities::transaction_tracer::reapplied_stage );
             }
          }
          catch( const fc::exception& e )
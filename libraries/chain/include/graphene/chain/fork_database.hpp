@@ -29,6 +29,7 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/composite_key.hpp>
 
 
 namespace graphene { namespace chain {
@@ -40,7 +41,9 @@ namespace graphene { namespace chain {
       fork_item( signed_block d )
       :num(d.block_num()),id(d.id()),data( std::move(d) ){}
 
-      block_id_type previous_id()const { return data.previous; }
+      block_id_type      previous_id()const { return data.previous; }
+      account_uid_type   witness()const { return data.witness; }
+      fc::time_point_sec timestamp()const { return data.timestamp; }
 
       weak_ptr< fork_item > prev;
       uint32_t              num;    // initialized in ctor
@@ -54,6 +57,19 @@ namespace graphene { namespace chain {
    };
    typedef shared_ptr<fork_item> item_ptr;
 
+   /**
+    *  Two different blocks signed by the same witness for the same slot. Both headers carry the signature of the
+    *  witness, so anybody can check that it produced twice.
+    */
+   struct double_production_evidence
+   {
+      account_uid_type     witness = 0;
+      fc::time_point_sec   timestamp;
+      signed_block_header  first;          ///< the block received first
+      signed_block_header  second;
+      fc::time_point_sec   detected_at;    ///< local time of the detection
+   };
+
 
    /**
     *  As long as blocks are pushed in order the fork
@@ -81,6 +97,9 @@ namespace graphene { namespace chain {
          bool                             is_known_block(const block_id_type& id)const;
          shared_ptr<fork_item>            fetch_block(const block_id_type& id)const;
          vector<item_ptr>                 fetch_block_by_number(uint32_t n)const;
+         /** @return the blocks signed by @ref witness for the slot at @ref timestamp, more than one is a double production */
+         vector<item_ptr>                 fetch_blocks_by_witness_slot( account_uid_type witness,
+                                                                        fc::time_point_sec timestamp )const;
 
          /**
           *  @return the new head block ( the longest fork )
@@ -99,12 +118,19 @@ namespace graphene { namespace chain {
          struct block_id;
          struct block_num;
          struct by_previous;
+         struct by_witness_slot;
          typedef multi_index_container<
             item_ptr,
             indexed_by<
                hashed_unique<tag<block_id>, member<fork_item, block_id_type, &fork_item::id>, std::hash<fc::ripemd160>>,
                hashed_non_unique<tag<by_previous>, const_mem_fun<fork_item, block_id_type, &fork_item::previous_id>, std::hash<fc::ripemd160>>,
-               ordered_non_unique<tag<block_num>, member<fork_item,uint32_t,&fork_item::num>>
+               ordered_non_unique<tag<block_num>, member<fork_item,uint32_t,&fork_item::num>>,
+               ordered_non_unique<tag<by_witness_slot>,
+                  composite_key<fork_item,
+                     const_mem_fun<fork_item, account_uid_type, &fork_item::witness>,
+                     const_mem_fun<fork_item, fc::time_point_sec, &fork_item::timestamp>
+                  >
+               >
             >
          > fork_multi_index_type;
 
@@ -122,3 +148,5 @@ namespace graphene { namespace chain {
          shared_ptr<fork_item>    _head;
    };
 } } // graphene::chain
+
+FC_REFLECT( graphene::chain::double_production_evidence, (witness)(timestamp)(first)(second)(detected_at) )
@@ -109,7 +109,8 @@ typedef multi_index_container<
             operation_history_object,
             indexed_by<
             ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >
-            >
+            >,
+            graphene::db::slab_allocator< operation_history_object >
       > operation_history_multi_index_type;
 
 typedef generic_index<operation_history_object, operation_history_multi_index_type> operation_history_index;
@@ -145,7 +146,8 @@ typedef multi_index_container<
       ordered_non_unique< tag<by_opid>,
          member< account_transaction_history_object, operation_history_id_type, &account_transaction_history_object::operation_id>
       >
-   >
+   >,
+   graphene::db::slab_allocator< account_transaction_history_object >
 > account_transaction_history_multi_index_type;
 
 typedef generic_index<account_transaction_history_object, account_transaction_history_multi_index_type> account_transaction_history_index;
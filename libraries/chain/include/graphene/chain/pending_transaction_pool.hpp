@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+#include <graphene/chain/protocol/transaction.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/composite_key.hpp>
+
+namespace graphene { namespace chain {
+   using boost::multi_index_container;
+   using namespace boost::multi_index;
+
+   /** occupancy and limits of the pending transaction pool, see database::get_pending_transaction_pool_stats() */
+   struct pending_transaction_pool_stats
+   {
+      uint32_t transactions = 0;
+      uint64_t bytes = 0;
+      uint32_t accounts = 0;                       ///< number of distinct fee payers
+      uint64_t max_bytes = 0;                      ///< 0 means unlimited
+      uint32_t max_transactions_per_account = 0;   ///< 0 means unlimited
+      uint64_t lowest_fee_per_kbyte = 0;           ///< of the transaction which would be evicted first
+      uint64_t highest_fee_per_kbyte = 0;
+      uint64_t rejected = 0;                       ///< refused because of the account quota or a full pool
+      uint64_t evicted = 0;                        ///< dropped to make room for transactions paying more
+      uint64_t expired = 0;                        ///< dropped because they expired before being included
+   };
+
+   /** what became of the pending transactions when a block was generated, see database::generate_block() */
+   struct block_generation_stats
+   {
+      uint32_t          included = 0;
+      uint32_t          failed = 0;
+      uint32_t          postponed_for_size = 0;
+      uint32_t          skipped_for_time = 0;  ///< not applied because the deadline was reached or would have been
+      fc::microseconds  elapsed;               ///< spent applying the pending transactions
+   };
+
+   /**
+    *  @class pending_transaction_pool
+    *  @brief the transactions which have been pushed but are not yet included in a block
+    *
+    *  Transactions are applied in the order they arrived, so a transaction which depends on an earlier one still
+    *  applies when the pending state is rebuilt. The fee (including CSAF) they pay per kilobyte only decides which
+    *  ones are dropped or left out: the pool can be bounded by its total size and by the number of transactions per
+    *  fee payer; when it is full, a new transaction evicts the transactions which pay less, or is rejected if there
+    *  are none. When a block can not hold all of them, @ref select keeps those paying most.
+    *
+    *  The pool only holds the transactions, the state they produce is kept in the pending undo session of the
+    *  database. An evicted transaction stays in that state until it is rebuilt, i.e. until the next block.
+    */
+   class pending_transaction_pool
+   {
+      public:
+         struct entry
+         {
+            processed_transaction trx;
+            transaction_id_type   id;
+            account_uid_type      payer = 0;
+            uint64_t              fee_per_kbyte = 0;
+            uint32_t              size = 0;
+            uint64_t              sequence = 0;
+            time_point_sec        expiration;
+            fc::microseconds      apply_time; ///< measured when the transaction was pushed, predicts its cost in a block
+         };
+
+         struct by_priority;
+         struct by_sequence;
+         struct by_trx_id;
+         struct by_payer;
+         typedef multi_index_container<
+            entry,
+            indexed_by<
+               ordered_unique< tag<by_priority>,
+                  composite_key< entry,
+                     member< entry, uint64_t, &entry::fee_per_kbyte >,
+                     member< entry, uint64_t, &entry::sequence >
+                  >,
+                  composite_key_compare< std::greater<uint64_t>, std::less<uint64_t> >
+               >,
+               ordered_unique< tag<by_sequence>, member< entry, uint64_t, &entry::sequence > >,
+               hashed_unique< tag<by_trx_id>, member< entry, transaction_id_type, &entry::id >, std::hash<transaction_id_type> >,
+               ordered_unique< tag<by_payer>,
+                  composite_key< entry,
+                     member< entry, account_uid_type, &entry::payer >,
+                     member< entry, uint64_t, &entry::sequence >
+                  >
+               >
+            >
+         > entry_index_type;
+
+         /** @param max_bytes 0 for no limit  @param max_per_account 0 for no limit */
+         void set_limits( uint64_t max_bytes, uint32_t max_per_account );
+
+         /**
+          * Checks that the pool has room for @ref trx, without adding it.
+          * @return the entry to pass to @ref insert once the transaction has been applied
+          * @throws fc::exception if the payer reached its quota or the pool is full of transactions paying more
+          */
+         entry admit( const signed_transaction& trx );
+
+         /**
+          * Adds an entry returned by @ref admit, with trx set to the applied transaction, evicting the
+          * transactions with the lowest priority if needed.
+          */
+         void insert( entry&& e );
+
+         /**
+          * Empties the pool and drops the transactions which expired at or before @ref now.
+          * @return the remaining transactions, in arrival order
+          */
+         vector<processed_transaction> release( time_point_sec now );
+
+         /**
+          * Chooses the transactions to put in a block: those paying most per kilobyte whose sizes fit in
+          * @ref max_bytes and whose apply times fit in @ref max_time, each one with the earlier transactions of its
+          * payer. Stops when @ref max_bytes is used up or at @ref deadline. Counts the others as postponed for size
+          * or skipped for time in @ref stats.
+          * @return the chosen entries, in arrival order
+          */
+         vector<const entry*> select( uint64_t max_bytes, fc::microseconds max_time, fc::time_point deadline,
+                                      block_generation_stats& stats )const;
+
+         void clear();
+
+         size_t size()const  { return _entries.size(); }
+         bool   empty()const { return _entries.empty(); }
+
+         pending_transaction_pool_stats get_stats()const;
+
+      private:
+         entry_index_type  _entries;
+         uint64_t          _bytes = 0;
+         uint64_t          _next_sequence = 0;
+         pending_transaction_pool_stats _counters; ///< only limits and the cumulative counters are maintained here
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::pending_transaction_pool_stats,
+            (transactions)(bytes)(accounts)(max_bytes)(max_transactions_per_account)
+            (lowest_fee_per_kbyte)(highest_fee_per_kbyte)(rejected)(evicted)(expired) )
+FC_REFLECT( graphene::chain::block_generation_stats,
+            (included)(failed)(postponed_for_size)(skipped_for_time)(elapsed) )
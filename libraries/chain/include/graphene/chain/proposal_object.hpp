@@ -53,7 +53,14 @@ class proposal_object : public abstract_object<proposal_object>
       flat_set<account_uid_type>     available_owner_approvals;
       flat_set<public_key_type>     available_key_approvals;
 
+      /**
+       *  @return true if the approvals satisfy the authorities the proposed transaction requires.
+       *  Uses the state kept by @ref proposal_authorization_index to answer false without walking the authorities
+       *  when it can, the answer is always the one of @ref verify_authorization.
+       */
       bool is_authorized_to_execute(database& db)const;
+      /** checks the approvals with verify_authority */
+      bool verify_authorization(database& db)const;
 };
 
 /**
@@ -80,6 +87,105 @@ class required_approval_index : public secondary_index
       map<account_uid_type, set<proposal_id_type> > _account_to_proposals;
 };
 
+/**
+ *  @brief what the approvals of a proposal do for one of the authorities its transaction requires
+ *
+ *  An authority can only be satisfied if it is approved itself, if the weights of its entries which are approved reach
+ *  its threshold, or if something approved is nested in one of its account entries. The state follows all three, so
+ *  that most approvals are known to be insufficient without walking the authority trees. It ignores the recursion
+ *  depth, and flags the authorities which may be satisfied whatever the approvals, so it never rules out an authority
+ *  verify_authority would accept.
+ */
+struct required_authority_state
+{
+   bool                                                    has_top = false;   ///< false for an "other" authority
+   authority::account_uid_auth_type                        top;
+   uint32_t                                                threshold = 0;
+   flat_map<authority::account_uid_auth_type, weight_type> account_weights;
+   flat_map<public_key_type, weight_type>                  key_weights;
+   flat_set<authority::account_uid_auth_type>             nested_accounts;
+   flat_set<public_key_type>                               nested_keys;
+   /// a threshold of 0, an unknown account or the temporary account is in the tree
+   bool                                                    always_possible = false;
+
+   int32_t                                                 top_approvals = 0;
+   int64_t                                                 approved_weight = 0;
+   int32_t                                                 nested_approvals = 0;
+
+   void approve( const authority::account_uid_auth_type& a, int32_t delta );
+   void approve( const public_key_type& k, int32_t delta );
+   bool may_be_satisfied()const;
+};
+
+struct proposal_authorization_state
+{
+   vector<required_authority_state>  authorities;
+   flat_set<account_uid_type>        accounts;   ///< whose authorities the state was built from
+
+   bool could_be_authorized()const;
+};
+
+/**
+ *  @brief keeps a @ref proposal_authorization_state per proposal, adjusted by each approval added or removed
+ *
+ *  This is a secondary index on the proposal_index. The states of the proposals involving an account are built again
+ *  when its authorities change, see @ref proposal_authority_watcher.
+ */
+class proposal_authorization_index : public secondary_index
+{
+   public:
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after  ) override;
+
+      void set_database( const database& db ) { _db = &db; }
+
+      /** @return false if the approvals of @ref p cannot satisfy the authorities it requires */
+      bool could_be_authorized( const proposal_object& p )const;
+
+      void account_authorities_changed( account_uid_type uid );
+
+   private:
+      struct approvals
+      {
+         flat_set<account_uid_type>  secondary;
+         flat_set<account_uid_type>  active;
+         flat_set<account_uid_type>  owner;
+         flat_set<public_key_type>   keys;
+      };
+
+      void build( const proposal_object& p );
+      void forget( proposal_id_type id );
+
+      const database*                                  _db = nullptr;
+      map<proposal_id_type, proposal_authorization_state> _states;
+      map<account_uid_type, set<proposal_id_type> >    _proposals_by_account;
+      approvals                                        _before;
+};
+
+/**
+ *  @brief tells @ref proposal_authorization_index about the accounts whose authorities change
+ *
+ *  This is a secondary index on the account_index.
+ */
+class proposal_authority_watcher : public secondary_index
+{
+   public:
+      virtual void object_inserted( const object& obj ) override;
+      virtual void object_removed( const object& obj ) override;
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after  ) override;
+
+      void set_proposals( proposal_authorization_index& proposals ) { _proposals = &proposals; }
+
+   private:
+      proposal_authorization_index* _proposals = nullptr;
+      authority                     _owner;
+      authority                     _active;
+      authority                     _secondary;
+};
+
 struct by_expiration{};
 typedef boost::multi_index_container<
    proposal_object,
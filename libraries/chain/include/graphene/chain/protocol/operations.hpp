@@ -32,6 +32,8 @@
 #include <graphene/chain/protocol/transfer.hpp>
 #include <graphene/chain/protocol/witness.hpp>
 
+#include <type_traits>
+
 namespace graphene { namespace chain {
 
    /**
@@ -82,6 +84,55 @@ namespace graphene { namespace chain {
 
    /// @} // operations group
 
+   /**
+    *  Whether applying an operation of type Op may change the candidates a voter votes for, the proxy of a voter, the
+    *  validity of a candidate, or execute other operations which may. The votes aggregated while applying the
+    *  transactions of a block are fanned out before such an operation, see database::apply_pending_voter_self_votes().
+    *
+    *  There is no default, every operation of the variant must be listed here or operation_changes_vote_set_of() does
+    *  not compile. Answering true is always correct, only slower.
+    */
+   template<typename Op> struct operation_changes_vote_set;
+   template<> struct operation_changes_vote_set<transfer_operation>                      : std::false_type {};
+   template<> struct operation_changes_vote_set<account_create_operation>                : std::false_type {};
+   template<> struct operation_changes_vote_set<account_manage_operation>                : std::false_type {};
+   template<> struct operation_changes_vote_set<account_update_auth_operation>           : std::false_type {};
+   template<> struct operation_changes_vote_set<account_update_key_operation>            : std::false_type {};
+   template<> struct operation_changes_vote_set<account_update_proxy_operation>          : std::true_type  {};
+   template<> struct operation_changes_vote_set<csaf_collect_operation>                  : std::false_type {};
+   template<> struct operation_changes_vote_set<csaf_lease_operation>                    : std::false_type {};
+   template<> struct operation_changes_vote_set<committee_member_create_operation>       : std::false_type {};
+   template<> struct operation_changes_vote_set<committee_member_update_operation>       : std::true_type  {};
+   template<> struct operation_changes_vote_set<committee_member_vote_update_operation>  : std::true_type  {};
+   template<> struct operation_changes_vote_set<committee_proposal_create_operation>     : std::true_type  {};
+   template<> struct operation_changes_vote_set<committee_proposal_update_operation>     : std::true_type  {};
+   template<> struct operation_changes_vote_set<witness_create_operation>                : std::false_type {};
+   template<> struct operation_changes_vote_set<witness_update_operation>                : std::true_type  {};
+   template<> struct operation_changes_vote_set<witness_vote_update_operation>           : std::true_type  {};
+   template<> struct operation_changes_vote_set<witness_collect_pay_operation>           : std::false_type {};
+   template<> struct operation_changes_vote_set<witness_report_operation>                : std::true_type  {};
+   template<> struct operation_changes_vote_set<post_operation>                          : std::false_type {};
+   template<> struct operation_changes_vote_set<post_update_operation>                   : std::false_type {};
+   template<> struct operation_changes_vote_set<platform_create_operation>               : std::false_type {};
+   template<> struct operation_changes_vote_set<platform_update_operation>               : std::true_type  {};
+   template<> struct operation_changes_vote_set<platform_vote_update_operation>          : std::true_type  {};
+   template<> struct operation_changes_vote_set<account_auth_platform_operation>         : std::false_type {};
+   template<> struct operation_changes_vote_set<account_cancel_auth_platform_operation>  : std::false_type {};
+   template<> struct operation_changes_vote_set<asset_create_operation>                  : std::false_type {};
+   template<> struct operation_changes_vote_set<asset_update_operation>                  : std::false_type {};
+   template<> struct operation_changes_vote_set<asset_issue_operation>                   : std::false_type {};
+   template<> struct operation_changes_vote_set<asset_reserve_operation>                 : std::false_type {};
+   template<> struct operation_changes_vote_set<asset_claim_fees_operation>              : std::false_type {};
+   template<> struct operation_changes_vote_set<override_transfer_operation>             : std::false_type {};
+   template<> struct operation_changes_vote_set<proposal_create_operation>               : std::true_type  {};
+   template<> struct operation_changes_vote_set<proposal_update_operation>               : std::true_type  {};
+   template<> struct operation_changes_vote_set<proposal_delete_operation>               : std::false_type {};
+   template<> struct operation_changes_vote_set<account_enable_allowed_assets_operation> : std::false_type {};
+   template<> struct operation_changes_vote_set<account_update_allowed_assets_operation> : std::false_type {};
+   template<> struct operation_changes_vote_set<account_whitelist_operation>             : std::false_type {};
+
+   bool operation_changes_vote_set_of( const operation& op );
+
    // TODO possible performance improvement by using another data structure other than flat_set, when the size is big
    void operation_get_required_uid_authorities( const operation& op,
                                             flat_set<account_uid_type>& owner_uids,
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+#include <graphene/chain/protocol/block.hpp>
+
+#include <memory>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  @class packed_block
+    *  @brief a serialized signed_block, decoded on demand
+    *
+    *  The serialized bytes are kept as they are, so a block which was received or read from the block database
+    *  can be stored and relayed without packing it again. The header is decoded eagerly and the ID is computed
+    *  once from its bytes, the transactions are only decoded when @ref block is called.
+    */
+   class packed_block
+   {
+      public:
+         packed_block() = default;
+         /** packs @ref b */
+         explicit packed_block( const signed_block& b );
+         /** @throws fc::exception if @ref bytes do not start with a block header */
+         explicit packed_block( std::vector<char> bytes );
+
+         const std::vector<char>&   bytes()const  { return _bytes; }
+         const signed_block_header& header()const { return _header; }
+         const block_id_type&       id()const     { return _id; }
+         uint32_t                   block_num()const { return _header.block_num(); }
+         bool                       empty()const  { return _bytes.empty(); }
+
+         /** @return the number of transactions, read without decoding them */
+         uint32_t transaction_count()const;
+
+         /** @return the whole block, decoded on the first call */
+         const signed_block& block()const;
+         /** @return a newly decoded copy of the whole block, for callers who need to own it */
+         signed_block decode()const;
+
+      private:
+         std::vector<char>                               _bytes;
+         size_t                                          _header_size = 0;
+         signed_block_header                             _header;
+         block_id_type                                   _id;
+         mutable std::shared_ptr<const signed_block>     _block;
+   };
+
+} } // graphene::chain
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <graphene/chain/fork_database.hpp>
+
+#include <fc/optional.hpp>
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace graphene { namespace chain {
+
+   /** what checking a transaction of a block found, whatever the state it is applied to */
+   struct validated_transaction
+   {
+      transaction_id_type                                    id;
+      bool                                                   validated = false;   ///< signed_transaction::validate() passed
+      /// the keys recovered from the signatures, absent until they are checked once
+      fc::optional<flat_map<public_key_type,signature_type>> signature_keys;
+   };
+
+   /**
+    *  The results of the checks of a block which do not depend on the chain it is applied to: its id, the key which
+    *  signed it, its merkle root and, per transaction, its id, its stateless validation and the keys of its
+    *  signatures. The checks which depend on the state, the witness schedule, the signing key of the witness and the
+    *  authorities of the accounts, run each time the block is applied, against these results.
+    */
+   struct validated_block
+   {
+      /** computes the ids of the transactions, the other checks are made by the database */
+      explicit validated_block( const item_ptr& i );
+
+      item_ptr                                item;          ///< keeps the block, shared with the fork database
+      fc::optional<public_key_type>           signee;
+      bool                                    merkle_checked = false;
+      std::vector<validated_transaction>      transactions;
+
+      const signed_block& block()const { return item->data; }
+   };
+   typedef std::shared_ptr<validated_block> validated_block_ptr;
+
+   /**
+    *  @class validated_block_cache
+    *  @brief the most recently used blocks of the fork window, with the checks already made on them
+    *
+    *  Blocks are added when they are applied, and when they enter the fork database on another branch than the head.
+    *  Popping a block reads it from here, and switching back to a branch that was applied or seen before does not
+    *  recover the signatures again. The cache holds at most @ref capacity blocks, the least recently used are
+    *  dropped first.
+    */
+   class validated_block_cache
+   {
+      public:
+         explicit validated_block_cache( size_t capacity = 256 );
+
+         /** 0 disables the cache */
+         void   set_capacity( size_t capacity );
+         size_t capacity()const { return _capacity; }
+         size_t size()const { return _entries.size(); }
+
+         /** @return the block and its checks, marked as the most recently used, or null */
+         validated_block_ptr find( const block_id_type& id );
+         /** adds the block once it passed the checks recorded, or marks it as the most recently used */
+         void insert( const validated_block_ptr& entry );
+         void remove( const block_id_type& id );
+         void clear();
+
+         uint64_t hits = 0;
+         uint64_t misses = 0;
+
+      private:
+         void prune();
+
+         typedef std::list<validated_block_ptr> lru_type;
+         size_t                                 _capacity;
+         lru_type                               _lru;      ///< most recently used first
+         std::unordered_map<block_id_type, lru_type::iterator, std::hash<fc::ripemd160>> _entries;
+   };
+
+} } // graphene::chain
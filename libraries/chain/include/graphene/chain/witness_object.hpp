@@ -25,6 +25,7 @@
 #include <graphene/chain/protocol/asset.hpp>
 #include <graphene/db/object.hpp>
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/timing_wheel.hpp>
 #include <boost/multi_index/composite_key.hpp>
 
 namespace graphene { namespace chain {
@@ -76,7 +77,6 @@ namespace graphene { namespace chain {
    };
 
    struct by_account;
-   struct by_pledge_next_update;
    struct by_pledge_schedule;
    struct by_vote_schedule;
    struct by_valid;
@@ -99,14 +99,6 @@ namespace graphene { namespace chain {
                member<witness_object, uint32_t, &witness_object::sequence>
             >
          >,
-         ordered_unique< tag<by_pledge_next_update>,
-            composite_key<
-               witness_object,
-               member<witness_object, uint32_t, &witness_object::average_pledge_next_update_block>,
-               member<witness_object, account_uid_type, &witness_object::account>,
-               member<witness_object, uint32_t, &witness_object::sequence>
-            >
-         >,
          ordered_unique< tag<by_pledge_schedule>,
             composite_key<
                witness_object,
@@ -171,6 +163,13 @@ namespace graphene { namespace chain {
     */
    typedef generic_index<witness_object, witness_multi_index_type> witness_index;
 
+   /**
+    * @ingroup object_index
+    * Schedule of average pledge updates, used by the per-block sweep.
+    */
+   typedef graphene::db::scheduled_event_index< witness_object, &witness_object::average_pledge_next_update_block >
+           witness_avg_pledge_update_schedule;
+
 
    /**
     * @brief This class represents a witness voting on the object graph
@@ -217,7 +216,8 @@ namespace graphene { namespace chain {
                member< witness_vote_object, uint32_t, &witness_vote_object::voter_sequence>
             >
          >
-      >
+      >,
+      graphene::db::slab_allocator< witness_vote_object >
    > witness_vote_multi_index_type;
 
    /**
@@ -258,3 +258,6 @@ FC_REFLECT_DERIVED( graphene::chain::witness_vote_object, (graphene::db::object)
                     (witness_uid)
                     (witness_sequence)
                   )
+
+GRAPHENE_DB_REGISTER_PRIMARY_INDEX( graphene::chain::witness_object,
+                                    graphene::db::primary_index<graphene::chain::witness_index> )
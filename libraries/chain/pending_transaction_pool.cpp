@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/chain/pending_transaction_pool.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+/// the total fee of an operation, including the part paid with prepaid balance or CSAF
+struct operation_fee_visitor
+{
+   typedef share_type result_type;
+
+   template<typename T>
+   share_type operator()( const T& op )const { return amount( op.fee ); }
+
+   static share_type amount( const asset& fee )    { return fee.amount; }
+   static share_type amount( const fee_type& fee ) { return fee.total.amount; }
+};
+
+struct operation_fee_payer_visitor
+{
+   typedef account_uid_type result_type;
+
+   template<typename T>
+   account_uid_type operator()( const T& op )const { return op.fee_payer_uid(); }
+};
+
+}
+
+void pending_transaction_pool::set_limits( uint64_t max_bytes, uint32_t max_per_account )
+{
+   _counters.max_bytes = max_bytes;
+   _counters.max_transactions_per_account = max_per_account;
+}
+
+pending_transaction_pool::entry pending_transaction_pool::admit( const signed_transaction& trx )
+{
+   entry e;
+   e.id = trx.id();
+   e.size = fc::raw::pack_size( trx );
+   e.expiration = trx.expiration;
+   share_type total_fee = 0;
+   for( const auto& op : trx.operations )
+      total_fee += op.visit( operation_fee_visitor() );
+   if( !trx.operations.empty() )
+      e.payer = trx.operations.front().visit( operation_fee_payer_visitor() );
+   e.fee_per_kbyte = total_fee > 0 ? ( fc::uint128( total_fee.value ) * 1024 / std::max<uint32_t>( e.size, 1 ) ).to_uint64() : 0;
+
+   const auto& by_payer_idx = _entries.get<by_payer>();
+   if( _counters.max_transactions_per_account != 0
+         && by_payer_idx.count( boost::make_tuple( e.payer ) ) >= _counters.max_transactions_per_account )
+   {
+      ++_counters.rejected;
+      FC_THROW( "Account ${a} already has ${n} pending transactions",
+                ("a",e.payer)("n",_counters.max_transactions_per_account) );
+   }
+
+   if( _counters.max_bytes != 0 && _bytes + e.size > _counters.max_bytes )
+   {
+      // room can only be made by evicting transactions which pay less than this one
+      uint64_t freed = 0;
+      for( auto itr = _entries.rbegin(); itr != _entries.rend() && _bytes - freed + e.size > _counters.max_bytes; ++itr )
+      {
+         if( itr->fee_per_kbyte >= e.fee_per_kbyte )
+            break;
+         freed += itr->size;
+      }
+      if( _bytes - freed + e.size > _counters.max_bytes )
+      {
+         ++_counters.rejected;
+         FC_THROW( "Pending transaction pool is full, the fee of this transaction is too low to replace others",
+                   ("fee_per_kbyte",e.fee_per_kbyte)("size",e.size)("max_bytes",_counters.max_bytes) );
+      }
+   }
+   return e;
+}
+
+void pending_transaction_pool::insert( entry&& e )
+{
+   e.sequence = _next_sequence++;
+   while( _counters.max_bytes != 0 && !_entries.empty() && _bytes + e.size > _counters.max_bytes )
+   {
+      auto lowest = std::prev( _entries.end() );
+      if( lowest->fee_per_kbyte >= e.fee_per_kbyte )
+         break;
+      _bytes -= lowest->size;
+      _entries.erase( lowest );
+      ++_counters.evicted;
+   }
+   const uint32_t size = e.size;
+   if( _entries.insert( std::move( e ) ).second )
+      _bytes += size;
+}
+
+vector<processed_transaction> pending_transaction_pool::release( time_point_sec now )
+{
+   vector<processed_transaction> result;
+   result.reserve( _entries.size() );
+   for( const entry& e : _entries.get<by_sequence>() )
+   {
+      if( e.expiration <= now )
+         ++_counters.expired;
+      else
+         result.push_back( e.trx );
+   }
+   clear();
+   return result;
+}
+
+vector<const pending_transaction_pool::entry*> pending_transaction_pool::select( uint64_t max_bytes,
+                                                                                 fc::microseconds max_time,
+                                                                                 fc::time_point deadline,
+                                                                                 block_generation_stats& stats )const
+{
+   // a transaction only applies after the earlier ones of its payer: the cost of choosing it is the sum of those of
+   // its payer from the last one chosen to it, given by the running totals of the payer in arrival order
+   struct running_total
+   {
+      uint32_t          count = 0;
+      uint64_t          bytes = 0;
+      fc::microseconds  time;
+   };
+   std::unordered_map<uint64_t, running_total> totals;   // by sequence
+   totals.reserve( _entries.size() );
+   uint32_t smallest = std::numeric_limits<uint32_t>::max();
+   {
+      running_total sum;
+      account_uid_type payer = 0;
+      bool first = true;
+      for( const entry& e : _entries.get<by_payer>() )
+      {
+         if( first || e.payer != payer )
+         {
+            sum = running_total();
+            payer = e.payer;
+            first = false;
+         }
+         ++sum.count;
+         sum.bytes += e.size;
+         sum.time += e.apply_time;
+         totals[e.sequence] = sum;
+         smallest = std::min( smallest, e.size );
+      }
+   }
+
+   /// of each payer, the last transaction chosen and the running total up to it
+   struct chosen_through
+   {
+      uint64_t       sequence = 0;
+      running_total  total;
+   };
+   std::unordered_map<account_uid_type, chosen_through> payers;
+   size_t chosen = 0;
+   uint32_t postponed = 0;
+   uint32_t skipped = 0;
+   uint64_t bytes = 0;
+   fc::microseconds time;
+   uint32_t visited = 0;
+   for( const entry& e : _entries )
+   {
+      // the rest of the entries are left out at once when nothing more fits or time is up
+      if( max_bytes - bytes < smallest )
+      {
+         postponed = _entries.size() - chosen - skipped;
+         break;
+      }
+      if( ( ++visited & 63 ) == 0 && fc::time_point::now() >= deadline )
+      {
+         skipped = _entries.size() - chosen - postponed;
+         break;
+      }
+
+      auto payer = payers.find( e.payer );
+      if( payer != payers.end() && payer->second.sequence >= e.sequence )
+         continue;
+      const running_total& through = totals[e.sequence];
+      const running_total before = ( payer == payers.end() ? running_total() : payer->second.total );
+      const uint64_t group_bytes = through.bytes - before.bytes;
+      const fc::microseconds group_time = through.time - before.time;
+      if( bytes + group_bytes > max_bytes )
+      {
+         ++postponed;
+         continue;
+      }
+      if( time + group_time > max_time )
+      {
+         ++skipped;
+         continue;
+      }
+      chosen += through.count - before.count;
+      bytes += group_bytes;
+      time += group_time;
+      if( payer == payers.end() )
+         payer = payers.emplace( e.payer, chosen_through() ).first;
+      payer->second.sequence = e.sequence;
+      payer->second.total = through;
+   }
+
+   stats.postponed_for_size += postponed;
+   stats.skipped_for_time += skipped;
+
+   vector<const entry*> result;
+   result.reserve( chosen );
+   for( const entry& e : _entries.get<by_sequence>() )
+   {
+      auto payer = payers.find( e.payer );
+      if( payer != payers.end() && e.sequence <= payer->second.sequence )
+         result.push_back( &e );
+   }
+   return result;
+}
+
+void pending_transaction_pool::clear()
+{
+   _entries.clear();
+   _bytes = 0;
+}
+
+pending_transaction_pool_stats pending_transaction_pool::get_stats()const
+{
+   pending_transaction_pool_stats result = _counters;
+   result.transactions = _entries.size();
+   result.bytes = _bytes;
+   const auto& by_payer_idx = _entries.get<by_payer>();
+   for( auto itr = by_payer_idx.begin(); itr != by_payer_idx.end();
+        itr = by_payer_idx.upper_bound( boost::make_tuple( itr->payer ) ) )
+      ++result.accounts;
+   if( !_entries.empty() )
+   {
+      result.highest_fee_per_kbyte = _entries.begin()->fee_per_kbyte;
+      result.lowest_fee_per_kbyte = _entries.rbegin()->fee_per_kbyte;
+   }
+   return result;
+}
+
+} } // graphene::chain
@@ -28,6 +28,14 @@
 namespace graphene { namespace chain {
 
 bool proposal_object::is_authorized_to_execute(database& db) const
+{
+   const auto& pidx = dynamic_cast<const primary_index<proposal_index>&>( db.get_index_type<proposal_index>() );
+   if( !pidx.get_secondary_index<proposal_authorization_index>().could_be_authorized( *this ) )
+      return false;
+   return verify_authorization( db );
+}
+
+bool proposal_object::verify_authorization(database& db) const
 {
    transaction_evaluation_state dry_run_eval(&db);
 
@@ -108,4 +116,296 @@ void required_approval_index::object_removed( const object& obj )
        remove( a, p.id );
 }
 
+void required_authority_state::approve( const authority::account_uid_auth_type& a, int32_t delta )
+{
+   if( has_top && top == a )
+      top_approvals += delta;
+   auto itr = account_weights.find( a );
+   if( itr != account_weights.end() )
+      approved_weight += int64_t( delta ) * itr->second;
+   if( nested_accounts.find( a ) != nested_accounts.end() )
+      nested_approvals += delta;
+}
+
+void required_authority_state::approve( const public_key_type& k, int32_t delta )
+{
+   auto itr = key_weights.find( k );
+   if( itr != key_weights.end() )
+      approved_weight += int64_t( delta ) * itr->second;
+   if( nested_keys.find( k ) != nested_keys.end() )
+      nested_approvals += delta;
+}
+
+bool required_authority_state::may_be_satisfied()const
+{
+   return always_possible || top_approvals > 0 || nested_approvals > 0 || approved_weight >= threshold;
+}
+
+bool proposal_authorization_state::could_be_authorized()const
+{
+   for( const auto& a : authorities )
+      if( !a.may_be_satisfied() )
+         return false;
+   return true;
+}
+
+namespace {
+
+const authority* find_authority( const database& db, const authority::account_uid_auth_type& a )
+{
+   const account_object* acc = db.find_account_by_uid( a.uid );
+   if( acc == nullptr )
+      return nullptr;
+   if( a.auth_type == authority::secondary_auth )
+      return &acc->secondary;
+   if( a.auth_type == authority::active_auth )
+      return &acc->active;
+   return &acc->owner;
+}
+
+/// adds what is nested in the account entries of @ref auth to @ref r, each account authority is visited once
+void collect_nested( const database& db, const authority& auth, required_authority_state& r,
+                     flat_set<authority::account_uid_auth_type>& visited, flat_set<account_uid_type>& accounts )
+{
+   for( const auto& entry : auth.account_uid_auths )
+   {
+      if( entry.first.uid == GRAPHENE_TEMP_ACCOUNT_UID )
+      {
+         r.always_possible = true;
+         continue;
+      }
+      if( !visited.insert( entry.first ).second )
+         continue;
+      accounts.insert( entry.first.uid );
+      const authority* nested = find_authority( db, entry.first );
+      if( nested == nullptr )
+      {
+         r.always_possible = true;
+         continue;
+      }
+      if( nested->weight_threshold == 0 )
+         r.always_possible = true;
+      for( const auto& k : nested->key_auths )
+         r.nested_keys.insert( k.first );
+      for( const auto& a : nested->account_uid_auths )
+         r.nested_accounts.insert( a.first );
+      collect_nested( db, *nested, r, visited, accounts );
+   }
+}
+
+void init_authority_state( const database& db, const authority& auth, required_authority_state& r,
+                           flat_set<account_uid_type>& accounts )
+{
+   r.threshold = auth.weight_threshold;
+   if( r.threshold == 0 )
+      r.always_possible = true;
+   for( const auto& k : auth.key_auths )
+      r.key_weights[k.first] = k.second;
+   for( const auto& a : auth.account_uid_auths )
+      r.account_weights[a.first] = a.second;
+   flat_set<authority::account_uid_auth_type> visited;
+   collect_nested( db, auth, r, visited, accounts );
+}
+
+}
+
+void proposal_authorization_index::build( const proposal_object& p )
+{
+   FC_ASSERT( _db != nullptr );
+   const database& db = *_db;
+
+   flat_set<account_uid_type> required_owner_uids;
+   flat_set<account_uid_type> required_active_uids;
+   flat_set<account_uid_type> required_secondary_uids;
+   vector<authority> other;
+   for( const auto& op : p.proposed_transaction.operations )
+      operation_get_required_uid_authorities( op, required_owner_uids, required_active_uids, required_secondary_uids,
+                                              other );
+
+   proposal_authorization_state state;
+   auto add_required = [&]( account_uid_type uid, authority::account_auth_type type )
+   {
+      required_authority_state r;
+      r.has_top = true;
+      r.top = authority::account_uid_auth_type( uid, type );
+      state.accounts.insert( uid );
+      const authority* auth = find_authority( db, r.top );
+      if( uid == GRAPHENE_TEMP_ACCOUNT_UID || auth == nullptr )
+         r.always_possible = true;
+      else
+         init_authority_state( db, *auth, r, state.accounts );
+      state.authorities.push_back( std::move( r ) );
+   };
+   for( auto uid : required_owner_uids )
+      add_required( uid, authority::owner_auth );
+   for( auto uid : required_active_uids )
+      add_required( uid, authority::active_auth );
+   for( auto uid : required_secondary_uids )
+      add_required( uid, authority::secondary_auth );
+   for( const auto& auth : other )
+   {
+      required_authority_state r;
+      init_authority_state( db, auth, r, state.accounts );
+      state.authorities.push_back( std::move( r ) );
+   }
+
+   for( auto& r : state.authorities )
+   {
+      for( auto uid : p.available_secondary_approvals )
+         r.approve( authority::account_uid_auth_type( uid, authority::secondary_auth ), 1 );
+      for( auto uid : p.available_active_approvals )
+         r.approve( authority::account_uid_auth_type( uid, authority::active_auth ), 1 );
+      for( auto uid : p.available_owner_approvals )
+         r.approve( authority::account_uid_auth_type( uid, authority::owner_auth ), 1 );
+      for( const auto& k : p.available_key_approvals )
+         r.approve( k, 1 );
+   }
+
+   for( auto uid : state.accounts )
+      _proposals_by_account[uid].insert( p.id );
+   _states[p.id] = std::move( state );
+}
+
+void proposal_authorization_index::forget( proposal_id_type id )
+{
+   auto itr = _states.find( id );
+   if( itr == _states.end() )
+      return;
+   for( auto uid : itr->second.accounts )
+   {
+      auto pitr = _proposals_by_account.find( uid );
+      if( pitr != _proposals_by_account.end() )
+      {
+         pitr->second.erase( id );
+         if( pitr->second.empty() )
+            _proposals_by_account.erase( pitr );
+      }
+   }
+   _states.erase( itr );
+}
+
+void proposal_authorization_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const proposal_object*>(&obj) );
+   const proposal_object& p = static_cast<const proposal_object&>(obj);
+   forget( p.id );
+   build( p );
+}
+
+void proposal_authorization_index::object_removed( const object& obj )
+{
+   forget( obj.id );
+}
+
+void proposal_authorization_index::about_to_modify( const object& before )
+{
+   assert( dynamic_cast<const proposal_object*>(&before) );
+   const proposal_object& p = static_cast<const proposal_object&>(before);
+   _before.secondary = p.available_secondary_approvals;
+   _before.active = p.available_active_approvals;
+   _before.owner = p.available_owner_approvals;
+   _before.keys = p.available_key_approvals;
+}
+
+namespace {
+
+/// calls @ref f with each element of @ref after which is not in @ref before and 1, then the opposite with -1
+template<typename T, typename F>
+void for_each_change( const flat_set<T>& before, const flat_set<T>& after, F&& f )
+{
+   for( const auto& x : after )
+      if( before.find( x ) == before.end() )
+         f( x, 1 );
+   for( const auto& x : before )
+      if( after.find( x ) == after.end() )
+         f( x, -1 );
+}
+
+}
+
+void proposal_authorization_index::object_modified( const object& after )
+{
+   assert( dynamic_cast<const proposal_object*>(&after) );
+   const proposal_object& p = static_cast<const proposal_object&>(after);
+   auto itr = _states.find( p.id );
+   if( itr == _states.end() )
+   {
+      build( p );
+      return;
+   }
+   for( auto& r : itr->second.authorities )
+   {
+      for_each_change( _before.secondary, p.available_secondary_approvals, [&r]( account_uid_type uid, int32_t d ) {
+         r.approve( authority::account_uid_auth_type( uid, authority::secondary_auth ), d );
+      });
+      for_each_change( _before.active, p.available_active_approvals, [&r]( account_uid_type uid, int32_t d ) {
+         r.approve( authority::account_uid_auth_type( uid, authority::active_auth ), d );
+      });
+      for_each_change( _before.owner, p.available_owner_approvals, [&r]( account_uid_type uid, int32_t d ) {
+         r.approve( authority::account_uid_auth_type( uid, authority::owner_auth ), d );
+      });
+      for_each_change( _before.keys, p.available_key_approvals, [&r]( const public_key_type& k, int32_t d ) {
+         r.approve( k, d );
+      });
+   }
+}
+
+bool proposal_authorization_index::could_be_authorized( const proposal_object& p )const
+{
+   auto itr = _states.find( p.id );
+   if( itr == _states.end() )
+      return true;
+   return itr->second.could_be_authorized();
+}
+
+void proposal_authorization_index::account_authorities_changed( account_uid_type uid )
+{
+   auto itr = _proposals_by_account.find( uid );
+   if( itr == _proposals_by_account.end() )
+      return;
+   // copied, rebuilding the states changes the map
+   const set<proposal_id_type> ids = itr->second;
+   for( const auto& id : ids )
+   {
+      forget( id );
+      const proposal_object* p = _db->find( id );
+      if( p != nullptr )
+         build( *p );
+   }
+}
+
+void proposal_authority_watcher::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const account_object*>(&obj) );
+   if( _proposals != nullptr )
+      _proposals->account_authorities_changed( static_cast<const account_object&>(obj).uid );
+}
+
+void proposal_authority_watcher::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const account_object*>(&obj) );
+   if( _proposals != nullptr )
+      _proposals->account_authorities_changed( static_cast<const account_object&>(obj).uid );
+}
+
+void proposal_authority_watcher::about_to_modify( const object& before )
+{
+   assert( dynamic_cast<const account_object*>(&before) );
+   const account_object& a = static_cast<const account_object&>(before);
+   _owner = a.owner;
+   _active = a.active;
+   _secondary = a.secondary;
+}
+
+void proposal_authority_watcher::object_modified( const object& after )
+{
+   assert( dynamic_cast<const account_object*>(&after) );
+   const account_object& a = static_cast<const account_object&>(after);
+   if( _proposals == nullptr )
+      return;
+   if( a.owner == _owner && a.active == _active && a.secondary == _secondary )
+      return;
+   _proposals->account_authorities_changed( a.uid );
+}
+
 } } // graphene::chain
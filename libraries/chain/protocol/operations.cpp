@@ -144,6 +144,18 @@ void operation_validate( const operation& op )
    op.visit( operation_validator() );
 }
 
+struct operation_changes_vote_set_visitor
+{
+   typedef bool result_type;
+   template<typename T>
+   bool operator()( const T& )const { return operation_changes_vote_set<T>::value; }
+};
+
+bool operation_changes_vote_set_of( const operation& op )
+{
+   return op.visit( operation_changes_vote_set_visitor() );
+}
+
 void operation_get_required_uid_authorities( const operation& op,
                                          flat_set<account_uid_type>& owner_uids,
                                          flat_set<account_uid_type>& active_uids,
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/chain/protocol/packed_block.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/bitutil.hpp>
+
+namespace graphene { namespace chain {
+
+   packed_block::packed_block( const signed_block& b )
+   : packed_block( fc::raw::pack( b ) )
+   {
+   }
+
+   packed_block::packed_block( std::vector<char> bytes )
+   : _bytes( std::move( bytes ) )
+   {
+      fc::datastream<const char*> ds( _bytes.data(), _bytes.size() );
+      fc::raw::unpack( ds, _header );
+      _header_size = _bytes.size() - ds.remaining();
+
+      // the same as signed_block_header::id(), hashing the bytes which it would pack
+      auto tmp = fc::sha224::hash( _bytes.data(), _header_size );
+      tmp._hash[0] = fc::endian_reverse_u32( _header.block_num() );
+      memcpy( _id._hash, tmp._hash, std::min( sizeof(_id), sizeof(tmp) ) );
+   }
+
+   uint32_t packed_block::transaction_count()const
+   {
+      fc::datastream<const char*> ds( _bytes.data() + _header_size, _bytes.size() - _header_size );
+      fc::unsigned_int count;
+      fc::raw::unpack( ds, count );
+      return count.value;
+   }
+
+   const signed_block& packed_block::block()const
+   {
+      if( !_block )
+         _block = std::make_shared<const signed_block>( decode() );
+      return *_block;
+   }
+
+   signed_block packed_block::decode()const
+   {
+      return fc::raw::unpack<signed_block>( _bytes );
+   }
+
+} } // graphene::chain
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/chain/validated_block_cache.hpp>
+
+namespace graphene { namespace chain {
+
+validated_block::validated_block( const item_ptr& i )
+: item( i )
+{
+   transactions.resize( i->data.transactions.size() );
+   for( size_t t = 0; t < transactions.size(); ++t )
+      transactions[t].id = i->data.transactions[t].id();
+}
+
+validated_block_cache::validated_block_cache( size_t capacity )
+: _capacity( capacity )
+{
+}
+
+void validated_block_cache::set_capacity( size_t capacity )
+{
+   _capacity = capacity;
+   prune();
+}
+
+validated_block_ptr validated_block_cache::find( const block_id_type& id )
+{
+   auto itr = _entries.find( id );
+   if( itr == _entries.end() )
+   {
+      ++misses;
+      return validated_block_ptr();
+   }
+   ++hits;
+   _lru.splice( _lru.begin(), _lru, itr->second );
+   return *itr->second;
+}
+
+void validated_block_cache::insert( const validated_block_ptr& entry )
+{
+   auto itr = _entries.find( entry->item->id );
+   if( itr != _entries.end() )
+   {
+      *itr->second = entry;
+      _lru.splice( _lru.begin(), _lru, itr->second );
+      return;
+   }
+   if( _capacity == 0 )
+      return;
+   _lru.push_front( entry );
+   _entries[entry->item->id] = _lru.begin();
+   prune();
+}
+
+void validated_block_cache::remove( const block_id_type& id )
+{
+   auto itr = _entries.find( id );
+   if( itr == _entries.end() )
+      return;
+   _lru.erase( itr->second );
+   _entries.erase( itr );
+}
+
+void validated_block_cache::clear()
+{
+   _entries.clear();
+   _lru.clear();
+}
+
+void validated_block_cache::prune()
+{
+   while( _lru.size() > _capacity )
+   {
+      _entries.erase( _lru.back()->item->id );
+      _lru.pop_back();
+   }
+}
+
+} } // graphene::chain
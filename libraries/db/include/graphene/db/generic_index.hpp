@@ -23,10 +23,14 @@
  */
 #pragma once
 #include <graphene/db/index.hpp>
+#include <graphene/db/slab_allocator.hpp>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
+#include <boost/core/demangle.hpp>
+
+#include <typeinfo>
 
 namespace graphene { namespace chain {
 
@@ -46,6 +50,11 @@ namespace graphene { namespace chain {
          typedef MultiIndexType index_type;
          typedef ObjectType     object_type;
 
+         generic_index()
+         :_slab_pool( boost::core::demangle( typeid(ObjectType).name() ) ),
+          _indices( typename index_type::ctor_args_list(),
+                    graphene::db::pool_allocator<typename index_type::allocator_type>::make( &_slab_pool ) ){}
+
          virtual const object& insert( object&& obj )override
          {
             assert( nullptr != dynamic_cast<ObjectType*>(&obj) );
@@ -78,6 +87,16 @@ namespace graphene { namespace chain {
             _indices.erase( _indices.iterator_to( static_cast<const ObjectType&>(obj) ) );
          }
 
+         /** takes obj out of the container without copying it, see primary_index::remove_range */
+         std::unique_ptr<object> extract( const object& obj )
+         {
+            auto itr = _indices.iterator_to( static_cast<const ObjectType&>(obj) );
+            // erasing by iterator only unlinks the node from each index, the keys of the moved-from object aren't read
+            std::unique_ptr<object> result( new ObjectType( std::move( const_cast<ObjectType&>( *itr ) ) ) );
+            _indices.erase( itr );
+            return result;
+         }
+
          virtual const object* find( object_id_type id )const override
          {
             static_assert(std::is_same<typename MultiIndexType::key_type, object_id_type>::value,
@@ -97,6 +116,11 @@ namespace graphene { namespace chain {
 
          const index_type& indices()const { return _indices; }
 
+         virtual const graphene::db::slab_pool* get_slab_pool()const override
+         {
+            return graphene::db::pool_allocator<typename index_type::allocator_type>::uses_pool ? &_slab_pool : nullptr;
+         }
+
          virtual fc::uint128 hash()const override {
             fc::uint128 result;
             for( const auto& ptr : _indices )
@@ -108,8 +132,9 @@ namespace graphene { namespace chain {
          }
 
       private:
-         fc::uint128 _current_hash;
-         index_type  _indices;
+         fc::uint128              _current_hash;
+         graphene::db::slab_pool  _slab_pool;   ///< declared before _indices, which give their nodes back when destroyed
+         index_type               _indices;
    };
 
    /**
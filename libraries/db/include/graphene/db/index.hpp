@@ -23,6 +23,7 @@
  */
 #pragma once
 #include <graphene/db/object.hpp>
+#include <graphene/db/slab_allocator.hpp>
 #include <fc/interprocess/file_mapping.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/io/json.hpp>
@@ -94,6 +95,8 @@ namespace graphene { namespace db {
           *  Opens the index loading objects from a file
           */
          virtual void open( const fc::path& db ) = 0;
+         /** @return the version written in the file of the index, see save() */
+         virtual fc::sha256 get_object_version()const = 0;
          virtual void save( const fc::path& db ) = 0;
 
 
@@ -132,6 +135,11 @@ namespace graphene { namespace db {
 
          virtual void               object_from_variant( const fc::variant& var, object& obj, uint32_t max_depth )const = 0;
          virtual void               object_default( object& obj )const = 0;
+         /** @return an object of the type of the index, which is not inserted, from the result of object::pack() */
+         virtual unique_ptr<object> unpack_object( const std::vector<char>& data )const = 0;
+
+         /** @return the pool which holds the nodes of this index, or null if they come from the heap */
+         virtual const slab_pool*   get_slab_pool()const { return nullptr; }
    };
 
    class secondary_index
@@ -164,6 +172,12 @@ namespace graphene { namespace db {
          /** called just after obj is modified */
          void on_modify( const object& obj );
 
+         /** called just after obj was taken out of its container by remove_range, the undo state takes ownership */
+         void on_extract( unique_ptr<object> obj );
+
+         /** called before count objects are removed at once */
+         void reserve_undo_removals( size_t count );
+
          template<typename T>
          T* add_secondary_index()
          {
@@ -196,9 +210,13 @@ namespace graphene { namespace db {
     * @brief  Wraps a derived index to intercept calls to create, modify, and remove so that
     *  callbacks may be fired and undo state saved.
     *
+    *  When DenseInstances is true, the index also keeps a table from instance number to object, so
+    *  objects of types whose IDs are dense (i.e. objects are rarely or never removed) can be found
+    *  in O(1) by typed_find().
+    *
     *  @see http://en.wikipedia.org/wiki/Curiously_recurring_template_pattern
     */
-   template<typename DerivedIndex>
+   template<typename DerivedIndex, bool DenseInstances = false>
    class primary_index  : public DerivedIndex, public base_primary_index
    {
       public:
@@ -217,7 +235,7 @@ namespace graphene { namespace db {
          virtual void           use_next_id()override                    { ++_next_id.number;  }
          virtual void           set_next_id( object_id_type id )override { _next_id = id;      }
 
-         fc::sha256 get_object_version()const
+         virtual fc::sha256 get_object_version()const override
          {
             std::string desc = "1.0";//get_type_description<object_type>();
             return fc::sha256::hash(desc);
@@ -262,6 +280,7 @@ namespace graphene { namespace db {
          virtual const object&  load( const std::vector<char>& data )override
          {
             const auto& result = DerivedIndex::insert( fc::raw::unpack<object_type>( data ) );
+            track_instance( result );
             for( const auto& item : _sindex )
                item->object_inserted( result );
             return result;
@@ -271,6 +290,7 @@ namespace graphene { namespace db {
          virtual const object&  create(const std::function<void(object&)>& constructor )override
          {
             const auto& result = DerivedIndex::create( constructor );
+            track_instance( result );
             for( const auto& item : _sindex )
                item->object_inserted( result );
             on_add( result );
@@ -280,6 +300,7 @@ namespace graphene { namespace db {
          virtual const object& insert( object&& obj ) override
          {
             const auto& result = DerivedIndex::insert( std::move( obj ) );
+            track_instance( result );
             for( const auto& item : _sindex )
                item->object_inserted( result );
             on_add( result );
@@ -291,20 +312,71 @@ namespace graphene { namespace db {
             for( const auto& item : _sindex )
                item->object_removed( obj );
             on_remove(obj);
+            untrack_instance( obj.id );
             DerivedIndex::remove(obj);
          }
 
+         /**
+          * Removes the objects in [first, last) of one of the indices of this index, e.g. the expired objects of an
+          * index ordered by expiration. This is equivalent to removing them one by one, but the objects are moved
+          * into the undo state instead of being copied, and the undo state is sized for the whole range at once.
+          * @return the number of removed objects
+          */
+         template<typename Iterator>
+         size_t remove_range( Iterator first, Iterator last )
+         {
+            const size_t count = std::distance( first, last );
+            if( count == 0 )
+               return 0;
+            reserve_undo_removals( count );
+            while( first != last )
+            {
+               // erasing the object only invalidates iterators to it
+               const object_type& obj = *first++;
+               for( const auto& item : _sindex )
+                  item->object_removed( obj );
+               for( const auto& ob : _observers )
+                  ob->on_remove( obj );
+               untrack_instance( obj.id );
+               on_extract( DerivedIndex::extract( obj ) );
+            }
+            return count;
+         }
+
          virtual void modify( const object& obj, const std::function<void(object&)>& m )override
          {
             save_undo( obj );
             for( const auto& item : _sindex )
                item->about_to_modify( obj );
-            DerivedIndex::modify( obj, m );
+            const object_id_type id = obj.id;
+            try {
+               DerivedIndex::modify( obj, m );
+            } catch( ... ) {
+               // a multi_index container drops the object if the modification violates a constraint
+               if( DerivedIndex::find( id ) == nullptr )
+                  untrack_instance( id );
+               throw;
+            }
             for( const auto& item : _sindex )
                item->object_modified( obj );
             on_modify( obj );
          }
 
+         /**
+          * Non-virtual lookup used by object_database for the object types registered with
+          * GRAPHENE_DB_REGISTER_PRIMARY_INDEX. The ID must belong to this index.
+          */
+         const object_type* typed_find( object_id_type id )const
+         {
+            assert( id.space() == object_type::space_id && id.type() == object_type::type_id );
+            if( DenseInstances )
+            {
+               const auto instance = id.instance();
+               return instance < _instances.size() ? _instances[instance] : nullptr;
+            }
+            return static_cast<const object_type*>( DerivedIndex::find( id ) );
+         }
+
          virtual void add_observer( const shared_ptr<index_observer>& o ) override
          {
             _observers.emplace_back( o );
@@ -328,8 +400,63 @@ namespace graphene { namespace db {
             obj.id = id;
          }
 
+         virtual unique_ptr<object> unpack_object( const std::vector<char>& data )const override
+         {
+            return unique_ptr<object>( new object_type( fc::raw::unpack<object_type>( data ) ) );
+         }
+
       private:
-         object_id_type _next_id;
+         void track_instance( const object& obj )
+         {
+            if( !DenseInstances )
+               return;
+            const auto instance = obj.id.instance();
+            if( instance >= _instances.size() )
+               _instances.resize( instance + 1, nullptr );
+            _instances[instance] = static_cast<const object_type*>( &obj );
+         }
+
+         void untrack_instance( object_id_type id )
+         {
+            if( !DenseInstances )
+               return;
+            const auto instance = id.instance();
+            if( instance < _instances.size() )
+               _instances[instance] = nullptr;
+         }
+
+         object_id_type               _next_id;
+         vector<const object_type*>   _instances; ///< only used when DenseInstances is true
    };
 
+   /**
+    *  Compile-time registry from an object type to the concrete type of its primary index, specialized
+    *  by GRAPHENE_DB_REGISTER_PRIMARY_INDEX. Typed lookups of registered object types are resolved
+    *  statically, without virtual calls and without the checks of object_database::get_index().
+    *  Unregistered object types keep using the polymorphic path.
+    */
+   template<typename ObjectType>
+   struct primary_index_of {};
+
+   namespace detail {
+      template<typename ObjectType>
+      struct is_registered_object
+      {
+         template<typename T> static std::true_type  test( typename primary_index_of<T>::type* );
+         template<typename T> static std::false_type test( ... );
+         static const bool value = decltype( test<ObjectType>( nullptr ) )::value;
+      };
+   }
+
 } } // graphene::db
+
+/**
+ * Registers PRIMARY_INDEX as the primary index type of OBJECT, see graphene::db::primary_index_of.
+ * Must be used at global scope, after the index type is defined.
+ */
+#define GRAPHENE_DB_REGISTER_PRIMARY_INDEX( OBJECT, PRIMARY_INDEX ) \
+   namespace graphene { namespace db { \
+      template<> struct primary_index_of< OBJECT > { typedef PRIMARY_INDEX type; }; \
+   } }
+
+
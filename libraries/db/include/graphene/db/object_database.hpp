@@ -50,6 +50,24 @@ namespace graphene { namespace db {
           * Saves the complete state of the object_database to disk, this could take a while
           */
          void flush();
+
+         /// the objects of one index, packed as they are saved by flush()
+         struct packed_index
+         {
+            uint8_t                          space = 0;
+            uint8_t                          type = 0;
+            object_id_type                   next_id;
+            fc::sha256                       version;
+            std::vector<std::vector<char>>   objects;
+         };
+         /**
+          * Packs the objects as they were before the newest @p undone_states undo states, without undoing them, so
+          * the result can be written by write_state() on another thread while the database changes
+          */
+         std::vector<packed_index> pack_state( size_t undone_states );
+         /** saves a state returned by pack_state() in @p data_dir, in place of the saved state, like flush() */
+         static void write_state( const fc::path& data_dir, const std::vector<packed_index>& state );
+
          void wipe(const fc::path& data_dir); // remove from disk
          void close();
 
@@ -69,11 +87,17 @@ namespace graphene { namespace db {
          template<typename IndexType>
          const IndexType& get_index_type()const {
             static_assert( std::is_base_of<index,IndexType>::value, "Type must be an index type" );
-            return static_cast<const IndexType&>( get_index( IndexType::object_type::space_id, IndexType::object_type::type_id ) );
+            typedef typename IndexType::object_type ObjectType;
+            if( detail::is_registered_object<ObjectType>::value )
+               return static_cast<const IndexType&>( *_index[ObjectType::space_id][ObjectType::type_id] );
+            return static_cast<const IndexType&>( get_index( ObjectType::space_id, ObjectType::type_id ) );
          }
          template<typename T>
          const index&  get_index()const { return get_index(T::space_id,T::type_id); }
          const index&  get_index(uint8_t space_id, uint8_t type_id)const;
+
+         /** @return occupancy of the slab pools of the indexes of this database */
+         vector<slab_pool_stats> get_memory_pool_stats()const;
          const index&  get_index(object_id_type id)const { return get_index(id.space(),id.type()); }
          /// @}
 
@@ -109,16 +133,12 @@ namespace graphene { namespace db {
          template<typename T>
          const T& get( object_id_type id )const
          {
-            const object& obj = get_object( id );
-            assert( nullptr != dynamic_cast<const T*>(&obj) );
-            return static_cast<const T&>(obj);
+            return get<T>( id, std::integral_constant<bool, detail::is_registered_object<T>::value>() );
          }
          template<typename T>
          const T* find( object_id_type id )const
          {
-            const object* obj = find_object( id );
-            assert(  !obj || nullptr != dynamic_cast<const T*>(obj) );
-            return static_cast<const T*>(obj);
+            return find<T>( id, std::integral_constant<bool, detail::is_registered_object<T>::value>() );
          }
 
          template<uint8_t SpaceID, uint8_t TypeID, typename T>
@@ -131,6 +151,9 @@ namespace graphene { namespace db {
          IndexType* add_index()
          {
             typedef typename IndexType::object_type ObjectType;
+            static_assert( !detail::is_registered_object<ObjectType>::value
+                           || std::is_same<IndexType, typename primary_index_of<ObjectType>::type>::value,
+                           "The index type does not match the one registered for the object type" );
             if( _index[ObjectType::space_id].size() <= ObjectType::type_id  )
                 _index[ObjectType::space_id].resize( 255 );
             assert(!_index[ObjectType::space_id][ObjectType::type_id]);
@@ -163,12 +186,52 @@ namespace graphene { namespace db {
          index& get_mutable_index(uint8_t space_id, uint8_t type_id);
 
      private:
+         /** moves the state written in object_database.tmp in place of the saved state */
+         static void replace_saved_state( const fc::path& data_dir );
+
+         template<typename T>
+         const typename primary_index_of<T>::type& get_registered_index()const
+         {
+            assert( _index.size() > T::space_id && _index[T::space_id].size() > T::type_id
+                    && _index[T::space_id][T::type_id] );
+            return static_cast<const typename primary_index_of<T>::type&>( *_index[T::space_id][T::type_id] );
+         }
+
+         template<typename T>
+         const T* find( object_id_type id, std::true_type )const
+         {
+            return get_registered_index<T>().typed_find( id );
+         }
+         template<typename T>
+         const T* find( object_id_type id, std::false_type )const
+         {
+            const object* obj = find_object( id );
+            assert(  !obj || nullptr != dynamic_cast<const T*>(obj) );
+            return static_cast<const T*>(obj);
+         }
+
+         template<typename T>
+         const T& get( object_id_type id, std::true_type )const
+         {
+            const T* obj = get_registered_index<T>().typed_find( id );
+            FC_ASSERT( obj != nullptr, "Unable to find Object ${id}", ("id",id) );
+            return *obj;
+         }
+         template<typename T>
+         const T& get( object_id_type id, std::false_type )const
+         {
+            const object& obj = get_object( id );
+            assert( nullptr != dynamic_cast<const T*>(&obj) );
+            return static_cast<const T&>(obj);
+         }
 
          friend class base_primary_index;
          friend class undo_database;
          void save_undo( const object& obj );
          void save_undo_add( const object& obj );
          void save_undo_remove( const object& obj );
+         void save_undo_remove( unique_ptr<object> obj );
+         void reserve_undo_removals( size_t count );
 
          fc::path                                                  _data_dir;
          vector< vector< unique_ptr<index> > >                     _index;
@@ -176,4 +239,3 @@ namespace graphene { namespace db {
 
 } } // graphene::db
 
-
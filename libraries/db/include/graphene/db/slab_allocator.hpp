@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+#include <fc/reflect/reflect.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graphene { namespace db {
+
+   /** occupancy of the slab pool which serves the nodes of one object index */
+   struct slab_pool_stats
+   {
+      std::string object_type;
+      uint32_t    slot_size = 0;       ///< bytes per node, including the multi_index node headers
+      uint32_t    slots_per_slab = 0;
+      uint64_t    slabs = 0;
+      uint64_t    in_use = 0;          ///< nodes currently allocated
+      uint64_t    peak_in_use = 0;
+      uint64_t    total_allocations = 0;
+   };
+
+   /**
+    *  @class slab_pool
+    *  @brief a free list of fixed size slots carved out of large slabs
+    *
+    *  Each object index owns its pool, so two databases in the same process never share one. Freed slots are
+    *  reused by the next allocation, so the memory used by object types with high churn stays flat instead of
+    *  fragmenting the general purpose heap; the slabs go back to the heap when the index is destroyed.
+    *
+    *  The slot size is fixed by the first node served, nodes of another size are left to the heap.
+    *
+    *  @note not thread safe, like the index which owns it: objects are only created and removed by the thread
+    *  which owns the database
+    */
+   class slab_pool
+   {
+      public:
+         explicit slab_pool( std::string object_type = std::string() )
+         {
+            _stats.object_type = std::move( object_type );
+         }
+         slab_pool( const slab_pool& ) = delete;
+         slab_pool& operator=( const slab_pool& ) = delete;
+
+         ~slab_pool()
+         {
+            for( char* slab : _slabs )
+               ::operator delete( slab );
+         }
+
+         /** @return true if nodes of this size and alignment are served by the pool, the first call fixes the size */
+         bool serves( size_t size, size_t align )
+         {
+            if( align > alignof(std::max_align_t) )
+               return false;
+            const size_t slot_align = align > alignof(free_slot) ? align : alignof(free_slot);
+            const size_t slot_size  = ( ( size > sizeof(free_slot) ? size : sizeof(free_slot) ) + slot_align - 1 )
+                                      / slot_align * slot_align;
+            if( _stats.slot_size == 0 )
+            {
+               _stats.slot_size      = slot_size;
+               _stats.slots_per_slab = slab_bytes / slot_size > 0 ? slab_bytes / slot_size : 1;
+            }
+            return _stats.slot_size == slot_size;
+         }
+
+         void* allocate()
+         {
+            if( _free == nullptr )
+               grow();
+            free_slot* slot = _free;
+            _free = slot->next;
+            ++_stats.total_allocations;
+            if( ++_stats.in_use > _stats.peak_in_use )
+               _stats.peak_in_use = _stats.in_use;
+            return slot;
+         }
+
+         void deallocate( void* p )
+         {
+            free_slot* slot = static_cast<free_slot*>( p );
+            slot->next = _free;
+            _free = slot;
+            --_stats.in_use;
+         }
+
+         const slab_pool_stats& get_stats()const { return _stats; }
+
+      private:
+         struct free_slot { free_slot* next; };
+
+         static const size_t slab_bytes = 64 * 1024;
+
+         void grow()
+         {
+            char* slab = static_cast<char*>( ::operator new( size_t( _stats.slot_size ) * _stats.slots_per_slab ) );
+            _slabs.push_back( slab );
+            for( size_t i = _stats.slots_per_slab; i > 0; --i )
+            {
+               free_slot* slot = reinterpret_cast<free_slot*>( slab + ( i - 1 ) * _stats.slot_size );
+               slot->next = _free;
+               _free = slot;
+            }
+            ++_stats.slabs;
+         }
+
+         free_slot*          _free = nullptr;
+         std::vector<char*>  _slabs;
+         slab_pool_stats     _stats;
+   };
+
+   /**
+    *  @class slab_allocator
+    *  @brief allocator for boost::multi_index_container, which serves single nodes from the slab_pool it is bound to
+    *
+    *  generic_index binds the allocator of its container to its own pool. A default constructed allocator has no
+    *  pool and uses the heap, as do requests of more than one element (e.g. the bucket array of a hashed index).
+    */
+   template<typename T>
+   class slab_allocator
+   {
+      public:
+         typedef T                  value_type;
+         typedef T*                 pointer;
+         typedef const T*           const_pointer;
+         typedef T&                 reference;
+         typedef const T&           const_reference;
+         typedef std::size_t        size_type;
+         typedef std::ptrdiff_t     difference_type;
+
+         template<typename U>
+         struct rebind { typedef slab_allocator<U> other; };
+
+         slab_allocator(){}
+         explicit slab_allocator( slab_pool* pool ) : _pool( pool ){}
+         template<typename U>
+         slab_allocator( const slab_allocator<U>& other ) : _pool( other.pool() ){}
+
+         slab_pool* pool()const { return _pool; }
+
+         pointer       address( reference r )const       { return &r; }
+         const_pointer address( const_reference r )const { return &r; }
+
+         pointer allocate( size_type n, const void* = nullptr )
+         {
+            if( n == 1 && _pool != nullptr && _pool->serves( sizeof(T), alignof(T) ) )
+               return static_cast<pointer>( _pool->allocate() );
+            return static_cast<pointer>( ::operator new( n * sizeof(T) ) );
+         }
+
+         void deallocate( pointer p, size_type n )
+         {
+            if( n == 1 && _pool != nullptr && _pool->serves( sizeof(T), alignof(T) ) )
+               _pool->deallocate( p );
+            else
+               ::operator delete( p );
+         }
+
+         size_type max_size()const { return std::numeric_limits<size_type>::max() / sizeof(T); }
+
+         template<typename U, typename... Args>
+         void construct( U* p, Args&&... args ) { ::new( (void*)p ) U( std::forward<Args>(args)... ); }
+
+         template<typename U>
+         void destroy( U* p ) { p->~U(); }
+
+      private:
+         slab_pool* _pool = nullptr;
+   };
+
+   template<typename T, typename U>
+   bool operator==( const slab_allocator<T>& a, const slab_allocator<U>& b ) { return a.pool() == b.pool(); }
+   template<typename T, typename U>
+   bool operator!=( const slab_allocator<T>& a, const slab_allocator<U>& b ) { return a.pool() != b.pool(); }
+
+   /** makes the allocator of a container, bound to the pool if it is a slab_allocator */
+   template<typename Allocator>
+   struct pool_allocator
+   {
+      static const bool uses_pool = false;
+      static Allocator make( slab_pool* ) { return Allocator(); }
+   };
+   template<typename T>
+   struct pool_allocator< slab_allocator<T> >
+   {
+      static const bool uses_pool = true;
+      static slab_allocator<T> make( slab_pool* pool ) { return slab_allocator<T>( pool ); }
+   };
+
+} } // graphene::db
+
+FC_REFLECT( graphene::db::slab_pool_stats,
+            (object_type)(slot_size)(slots_per_slab)(slabs)(in_use)(peak_in_use)(total_allocations) )
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+#include <graphene/db/index.hpp>
+#include <fc/container/flat.hpp>
+
+#include <map>
+
+namespace graphene { namespace db {
+
+   using fc::flat_set;
+
+   /**
+    *  @class timing_wheel
+    *  @brief tracks payloads that become due at a given point (e.g. a block number or a time in seconds)
+    *
+    *  The wheel has two levels: a ring of slot_count buckets covering the near window
+    *  [base, base + slot_count), where scheduling and cancelling are O(1) plus the cost of a small
+    *  flat_set insert, and an ordered overflow map for everything outside that window (events in
+    *  the far future, or events that fell behind the window, e.g. after popping blocks).
+    *  When the window moves, buckets that leave it are spilled to the overflow level and overflow
+    *  buckets that enter it are cascaded into the ring, so each entry is moved at most a few times.
+    *
+    *  The wheel does not remove entries when they become due; owners cancel them explicitly,
+    *  which keeps it consistent with state that may be undone.
+    */
+   template<typename Payload, uint32_t SlotBits = 10>
+   class timing_wheel
+   {
+      public:
+         static const uint64_t slot_count = uint64_t(1) << SlotBits;
+
+         timing_wheel():_slots( slot_count ){}
+
+         void schedule( uint64_t when, const Payload& p )
+         {
+            if( in_window( when ) )
+               _slots[ when & slot_mask ].insert( p );
+            else
+               _overflow[ when ].insert( p );
+            ++_size;
+         }
+
+         void cancel( uint64_t when, const Payload& p )
+         {
+            size_t erased = 0;
+            if( in_window( when ) )
+               erased = _slots[ when & slot_mask ].erase( p );
+            else
+            {
+               auto itr = _overflow.find( when );
+               if( itr != _overflow.end() )
+               {
+                  erased = itr->second.erase( p );
+                  if( itr->second.empty() )
+                     _overflow.erase( itr );
+               }
+            }
+            assert( erased == 1 );
+            _size -= erased;
+         }
+
+         /**
+          * Moves the near window so that it starts at @ref now, then returns all entries due at or before
+          * @ref now, ordered by (when, payload).
+          */
+         vector<Payload> due( uint64_t now )
+         {
+            rebase( now );
+            vector<Payload> result;
+            for( auto itr = _overflow.begin(); itr != _overflow.end() && itr->first <= now; ++itr )
+               result.insert( result.end(), itr->second.begin(), itr->second.end() );
+            const auto& current = _slots[ now & slot_mask ];
+            result.insert( result.end(), current.begin(), current.end() );
+            return result;
+         }
+
+         size_t   size()const { return _size; }
+         uint64_t base()const { return _base; }
+
+      private:
+         static const uint64_t slot_mask = slot_count - 1;
+
+         bool in_window( uint64_t when )const { return when >= _base && when - _base < slot_count; }
+
+         void spill( uint64_t when )
+         {
+            auto& slot = _slots[ when & slot_mask ];
+            if( slot.empty() )
+               return;
+            auto& target = _overflow[ when ];
+            target.insert( slot.begin(), slot.end() );
+            slot.clear();
+         }
+
+         void rebase( uint64_t new_base )
+         {
+            if( new_base == _base )
+               return;
+            const uint64_t old_end = _base + slot_count;
+            const uint64_t new_end = new_base + slot_count;
+            if( new_base > _base )
+            {
+               for( uint64_t t = _base; t < std::min( new_base, old_end ); ++t )
+                  spill( t );
+            }
+            else
+            {
+               for( uint64_t t = std::max( new_end, _base ); t < old_end; ++t )
+                  spill( t );
+            }
+            _base = new_base;
+            // cascade overflow entries that are now inside the window
+            auto itr = _overflow.lower_bound( new_base );
+            while( itr != _overflow.end() && itr->first < new_end )
+            {
+               auto& slot = _slots[ itr->first & slot_mask ];
+               slot.insert( itr->second.begin(), itr->second.end() );
+               itr = _overflow.erase( itr );
+            }
+         }
+
+         vector< flat_set<Payload> >                 _slots;
+         std::map< uint64_t, flat_set<Payload> >      _overflow;
+         uint64_t                                     _base = 0;
+         size_t                                       _size = 0;
+   };
+
+   /**
+    *  @class scheduled_event_index
+    *  @brief a secondary index which schedules objects on a timing wheel by one of their uint32_t fields
+    *
+    *  This replaces an ordered multi_index key on a "due at block N" field. Objects whose field is
+    *  uint32_t(-1) are treated as not scheduled. Because undo is applied through the primary index,
+    *  the wheel follows undo and fork switches automatically.
+    */
+   template<typename ObjectType, uint32_t ObjectType::*Field>
+   class scheduled_event_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override
+         {
+            const ObjectType& o = static_cast<const ObjectType&>( obj );
+            if( o.*Field != unscheduled )
+               _wheel.schedule( o.*Field, o.id );
+         }
+         virtual void object_removed( const object& obj ) override
+         {
+            const ObjectType& o = static_cast<const ObjectType&>( obj );
+            if( o.*Field != unscheduled )
+               _wheel.cancel( o.*Field, o.id );
+         }
+         virtual void about_to_modify( const object& before ) override
+         {
+            _before = static_cast<const ObjectType&>( before ).*Field;
+         }
+         virtual void object_modified( const object& after ) override
+         {
+            const ObjectType& o = static_cast<const ObjectType&>( after );
+            if( o.*Field == _before )
+               return;
+            if( _before != unscheduled )
+               _wheel.cancel( _before, o.id );
+            if( o.*Field != unscheduled )
+               _wheel.schedule( o.*Field, o.id );
+         }
+
+         /** @return IDs of the objects due at or before @ref now, ordered by (due, id) */
+         vector<object_id_type> due( uint32_t now ) { return _wheel.due( now ); }
+
+         size_t size()const { return _wheel.size(); }
+
+      private:
+         static const uint32_t unscheduled = uint32_t(-1);
+
+         timing_wheel<object_id_type> _wheel;
+         uint32_t                     _before = unscheduled;
+   };
+
+} } // graphene::db
@@ -24,7 +24,9 @@
 #pragma once
 #include <graphene/db/object.hpp>
 #include <deque>
+#include <fstream>
 #include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
 
 namespace graphene { namespace db {
 
@@ -38,6 +40,19 @@ namespace graphene { namespace db {
       unordered_map<object_id_type, object_id_type>      old_index_next_ids;
       std::unordered_set<object_id_type>                 new_ids;
       unordered_map<object_id_type, unique_ptr<object> > removed;
+
+      /// packed size of each object kept and their sum, tracked while undo_database::set_spill_limits() sets a
+      /// budget in bytes
+      unordered_map<object_id_type, uint32_t>            packed_sizes;
+      uint64_t                                           packed_bytes = 0;
+   };
+
+   /// the values replaced by the newest undo states, see undo_database::values_before()
+   struct undone_values
+   {
+      /// the objects changed by the states, null for those which did not exist before them
+      unordered_map<object_id_type, unique_ptr<object> > objects;
+      unordered_map<object_id_type, object_id_type>      old_index_next_ids;
    };
 
 
@@ -45,6 +60,10 @@ namespace graphene { namespace db {
     * @class undo_database
     * @brief tracks changes to the state and allows changes to be undone
     *
+    * When a spill file and limits are set, the oldest states beyond the limits are written to the spill file and
+    * dropped from memory, they are read back when the states above them were undone or popped. The states of the open
+    * sessions always stay in memory. The space of the spilled states which are dropped is reused, the file stays
+    * within about twice the size of the states in it.
     */
    class undo_database
    {
@@ -117,6 +136,13 @@ namespace graphene { namespace db {
           * want to re-delete it if this state is undone.
           */
          void on_remove( const object& obj );
+         /**
+          * This should be called just after an object was taken out of its index, instead of on_remove( const object& ).
+          * The object itself is kept as its pre-removal value rather than a copy of it.
+          */
+         void on_remove( unique_ptr<object> obj );
+         /** prepares the current undo state for count more removals */
+         void reserve_removals( size_t count );
 
          /**
           *  Removes the last committed session,
@@ -126,22 +152,69 @@ namespace graphene { namespace db {
           */
          void pop_commit();
 
-         std::size_t size()const { return _stack.size(); }
+         std::size_t size()const { return _stack.size() + _spilled.size(); }
          void set_max_size(size_t new_max_size) { _max_size = new_max_size; }
          size_t max_size()const { return _max_size; }
 
+         /** where the states are spilled, its content is only meaningful while the database is open */
+         void set_spill_file( const fc::path& file );
+         /**
+          * @param max_states_in_memory number of states kept in memory, 0 for no limit
+          * @param max_bytes_in_memory packed size of the objects of the states kept in memory, 0 for no limit
+          */
+         void set_spill_limits( size_t max_states_in_memory, uint64_t max_bytes_in_memory );
+         /** @return the number of states in the spill file */
+         size_t spilled_size()const { return _spilled.size(); }
+         /** @return the number of states in memory */
+         size_t memory_size()const { return _stack.size(); }
+         /** @return the packed size of the objects of the states in memory, while a budget in bytes is set */
+         uint64_t bytes_in_memory()const { return _bytes_in_memory; }
+
          const undo_state& head()const;
 
+         /** @return the values from before the newest @p count states, which are not undone */
+         undone_values values_before( size_t count );
+
       private:
          void undo();
          void merge();
          void commit();
 
+         /// where a state is in the spill file
+         struct spill_record
+         {
+            uint64_t offset = 0;
+            uint64_t size = 0;
+         };
+
+         undo_state& back_state();
+         /// counts the packed size of @p obj, which @p state now keeps
+         void track_packed( undo_state& state, const object& obj );
+         void move_packed( undo_state& from, undo_state& to, object_id_type id );
+         /// to call before @p state is taken out of memory
+         void forget_packed( const undo_state& state );
+         void drop_oldest();
+         void spill_if_needed();
+         void spill_oldest();
+         void compact_spill_file();
+         void load_newest_spilled();
+         undo_state read_spilled( const spill_record& record );
+
          uint32_t                _active_sessions = 0;
          bool                    _disabled = true;
          std::deque<undo_state>  _stack;
          object_database&        _db;
          size_t                  _max_size = 256;
+
+         fc::path                 _spill_file;
+         std::fstream             _spill_stream;
+         /// the spilled states, oldest first, they are older than those of _stack
+         std::deque<spill_record> _spilled;
+         uint64_t                 _spill_end = 0;
+         size_t                   _max_states_in_memory = 0;
+         uint64_t                 _max_bytes_in_memory = 0;
+         /// the sum of the packed_bytes of the states of _stack
+         uint64_t                 _bytes_in_memory = 0;
    };
 
 } } // graphene::db
@@ -40,4 +40,10 @@ namespace graphene { namespace db {
 
    void base_primary_index::on_modify( const object& obj )
    {for( auto ob : _observers ) ob->on_modify(  obj ); }
+
+   void base_primary_index::on_extract( unique_ptr<object> obj )
+   { _db.save_undo_remove( std::move( obj ) ); }
+
+   void base_primary_index::reserve_undo_removals( size_t count )
+   { _db.reserve_undo_removals( count ); }
 } } // graphene::chain
@@ -27,6 +27,8 @@
 #include <fc/container/flat.hpp>
 #include <fc/uint128.hpp>
 
+#include <fstream>
+
 namespace graphene { namespace db {
 
 object_database::object_database()
@@ -68,6 +70,16 @@ index& object_database::get_mutable_index(uint8_t space_id, uint8_t type_id)
    return *idx;
 }
 
+vector<slab_pool_stats> object_database::get_memory_pool_stats()const
+{
+   vector<slab_pool_stats> result;
+   for( const auto& space : _index )
+      for( const auto& idx : space )
+         if( idx && idx->get_slab_pool() != nullptr )
+            result.push_back( idx->get_slab_pool()->get_stats() );
+   return result;
+}
+
 void object_database::flush()
 {
 //   ilog("Save object_database in ${d}", ("d", _data_dir));
@@ -80,11 +92,65 @@ void object_database::flush()
          if( _index[space][type] )
             _index[space][type]->save( _data_dir / "object_database.tmp" / fc::to_string(space)/fc::to_string(type) );
    }
-   fc::remove_all( _data_dir / "object_database.tmp" / "lock" );
-   if( fc::exists( _data_dir / "object_database" ) )
-      fc::rename( _data_dir / "object_database", _data_dir / "object_database.old" );
-   fc::rename( _data_dir / "object_database.tmp", _data_dir / "object_database" );
-   fc::remove_all( _data_dir / "object_database.old" );
+   replace_saved_state( _data_dir );
+}
+
+std::vector<object_database::packed_index> object_database::pack_state( size_t undone_states )
+{ try {
+   const undone_values before = _undo_db.values_before( undone_states );
+   std::vector<packed_index> result;
+   std::map<std::pair<uint8_t,uint8_t>, size_t> positions;
+   for( uint32_t space = 0; space < _index.size(); ++space )
+      for( uint32_t type = 0; type < _index[space].size(); ++type )
+      {
+         const auto& idx = _index[space][type];
+         if( !idx )
+            continue;
+         packed_index packed;
+         packed.space = space;
+         packed.type = type;
+         auto next_itr = before.old_index_next_ids.find( object_id_type( space, type, 0 ) );
+         packed.next_id = next_itr != before.old_index_next_ids.end() ? next_itr->second : idx->get_next_id();
+         packed.version = idx->get_object_version();
+         idx->inspect_all_objects( [&]( const object& o ) {
+            if( before.objects.find( o.id ) == before.objects.end() )
+               packed.objects.push_back( o.pack() );
+         });
+         positions[ std::make_pair( uint8_t(space), uint8_t(type) ) ] = result.size();
+         result.push_back( std::move( packed ) );
+      }
+   for( const auto& item : before.objects )
+      if( item.second )
+         result[ positions.at( std::make_pair( item.first.space(), item.first.type() ) ) ].objects.push_back( item.second->pack() );
+   return result;
+} FC_CAPTURE_AND_RETHROW( (undone_states) ) }
+
+void object_database::write_state( const fc::path& data_dir, const std::vector<packed_index>& state )
+{ try {
+   fc::create_directories( data_dir / "object_database.tmp" / "lock" );
+   for( const auto& packed : state )
+   {
+      fc::create_directories( data_dir / "object_database.tmp" / fc::to_string(packed.space) );
+      const fc::path file = data_dir / "object_database.tmp" / fc::to_string(packed.space) / fc::to_string(packed.type);
+      std::ofstream out( file.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+      FC_ASSERT( out );
+      // the layout written by index::save()
+      fc::raw::pack( out, packed.next_id );
+      fc::raw::pack( out, packed.version );
+      for( const auto& data : packed.objects )
+         fc::raw::pack( out, data );
+      FC_ASSERT( out.good(), "unable to write the saved state", ("file",file) );
+   }
+   replace_saved_state( data_dir );
+} FC_CAPTURE_AND_RETHROW( (data_dir) ) }
+
+void object_database::replace_saved_state( const fc::path& data_dir )
+{
+   fc::remove_all( data_dir / "object_database.tmp" / "lock" );
+   if( fc::exists( data_dir / "object_database" ) )
+      fc::rename( data_dir / "object_database", data_dir / "object_database.old" );
+   fc::rename( data_dir / "object_database.tmp", data_dir / "object_database" );
+   fc::remove_all( data_dir / "object_database.old" );
 }
 
 void object_database::wipe(const fc::path& data_dir)
@@ -103,6 +169,7 @@ void object_database::open(const fc::path& data_dir)
        wlog("Ignoring locked object_database");
        return;
    }
+   _undo_db.set_spill_file( _data_dir / "undo_spill" );
    ilog("Opening object database from ${d} ...", ("d", data_dir));
    for( uint32_t space = 0; space < _index.size(); ++space )
       for( uint32_t type = 0; type  < _index[space].size(); ++type )
@@ -133,4 +200,14 @@ void object_database::save_undo_remove(const object& obj)
    _undo_db.on_remove( obj );
 }
 
+void object_database::save_undo_remove( unique_ptr<object> obj )
+{
+   _undo_db.on_remove( std::move( obj ) );
+}
+
+void object_database::reserve_undo_removals( size_t count )
+{
+   _undo_db.reserve_removals( count );
+}
+
 } } // namespace graphene::db
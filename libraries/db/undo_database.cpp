@@ -23,7 +23,32 @@
  */
 #include <graphene/db/object_database.hpp>
 #include <graphene/db/undo_database.hpp>
+#include <fc/io/raw.hpp>
 #include <fc/reflect/variant.hpp>
+#include <algorithm>
+
+namespace graphene { namespace db { namespace detail {
+
+   /// an object of a spilled undo state, as packed by object::pack()
+   struct spilled_object
+   {
+      object_id_type    id;
+      std::vector<char> data;
+   };
+
+   /// an undo_state as it is written to the spill file
+   struct spilled_undo_state
+   {
+      std::vector<spilled_object>                              old_values;
+      std::vector<std::pair<object_id_type, object_id_type>>   old_index_next_ids;
+      std::vector<object_id_type>                              new_ids;
+      std::vector<spilled_object>                              removed;
+   };
+
+} } }
+
+FC_REFLECT( graphene::db::detail::spilled_object, (id)(data) )
+FC_REFLECT( graphene::db::detail::spilled_undo_state, (old_values)(old_index_next_ids)(new_ids)(removed) )
 
 namespace graphene { namespace db {
 
@@ -38,19 +63,47 @@ undo_database::session undo_database::start_undo_session( bool force_enable )
       _disabled = false;
 
    while( size() > max_size() )
-      _stack.pop_front();
+      drop_oldest();
 
    _stack.emplace_back();
    ++_active_sessions;
+   spill_if_needed();
    return session(*this, disable_on_exit );
 }
+undo_state& undo_database::back_state()
+{
+   if( _stack.empty() )
+      _stack.emplace_back();
+   return _stack.back();
+}
+void undo_database::track_packed( undo_state& state, const object& obj )
+{
+   if( _max_bytes_in_memory == 0 )
+      return;
+   const uint32_t size = obj.pack().size();
+   state.packed_sizes[obj.id] = size;
+   state.packed_bytes += size;
+   _bytes_in_memory += size;
+}
+void undo_database::move_packed( undo_state& from, undo_state& to, object_id_type id )
+{
+   auto itr = from.packed_sizes.find( id );
+   if( itr == from.packed_sizes.end() )
+      return;
+   to.packed_sizes[id] = itr->second;
+   to.packed_bytes += itr->second;
+   from.packed_bytes -= itr->second;
+   from.packed_sizes.erase( itr );
+}
+void undo_database::forget_packed( const undo_state& state )
+{
+   _bytes_in_memory -= state.packed_bytes;
+}
 void undo_database::on_create( const object& obj )
 {
    if( _disabled ) return;
 
-   if( _stack.empty() )
-      _stack.emplace_back();
-   auto& state = _stack.back();
+   auto& state = back_state();
    auto index_id = object_id_type( obj.id.space(), obj.id.type(), 0 );
    auto itr = state.old_index_next_ids.find( index_id );
    if( itr == state.old_index_next_ids.end() )
@@ -61,22 +114,19 @@ void undo_database::on_modify( const object& obj )
 {
    if( _disabled ) return;
 
-   if( _stack.empty() )
-      _stack.emplace_back();
-   auto& state = _stack.back();
+   auto& state = back_state();
    if( state.new_ids.find(obj.id) != state.new_ids.end() )
       return;
    auto itr =  state.old_values.find(obj.id);
    if( itr != state.old_values.end() ) return;
    state.old_values[obj.id] = obj.clone();
+   track_packed( state, obj );
 }
 void undo_database::on_remove( const object& obj )
 {
    if( _disabled ) return;
 
-   if( _stack.empty() )
-      _stack.emplace_back();
-   undo_state& state = _stack.back();
+   undo_state& state = back_state();
    if( state.new_ids.count(obj.id) )
    {
       state.new_ids.erase(obj.id);
@@ -90,6 +140,37 @@ void undo_database::on_remove( const object& obj )
    }
    if( state.removed.count(obj.id) ) return;
    state.removed[obj.id] = obj.clone();
+   track_packed( state, obj );
+}
+
+void undo_database::on_remove( unique_ptr<object> obj )
+{
+   if( _disabled ) return;
+
+   undo_state& state = back_state();
+   const object_id_type id = obj->id;
+   if( state.new_ids.count(id) )
+   {
+      state.new_ids.erase(id);
+      return;
+   }
+   auto itr = state.old_values.find(id);
+   if( itr != state.old_values.end() )
+   {
+      // the value to restore is the one from before the modification
+      state.removed[id] = std::move(itr->second);
+      state.old_values.erase(itr);
+      return;
+   }
+   track_packed( state, *obj );
+   state.removed.emplace( id, std::move(obj) );
+}
+void undo_database::reserve_removals( size_t count )
+{
+   if( _disabled ) return;
+
+   undo_state& state = back_state();
+   state.removed.reserve( state.removed.size() + count );
 }
 
 void undo_database::undo()
@@ -117,7 +198,10 @@ void undo_database::undo()
    for( auto& item : state.removed )
       _db.insert( std::move(*item.second) );
 
+   forget_packed( state );
    _stack.pop_back();
+   if( _stack.empty() && !_spilled.empty() )
+      load_newest_spilled();
    enable();
    --_active_sessions;
 } FC_CAPTURE_AND_RETHROW() }
@@ -125,12 +209,15 @@ void undo_database::undo()
 void undo_database::merge()
 {
    FC_ASSERT( _active_sessions > 0 );
-   if( _active_sessions == 1 && _stack.size() == 1 )
+   if( _active_sessions == 1 && size() == 1 )
    {
+      forget_packed( _stack.back() );
       _stack.pop_back();
       --_active_sessions;
       return;
    }
+   if( _stack.size() < 2 && !_spilled.empty() )
+      load_newest_spilled();
    FC_ASSERT( _stack.size() >=2 );
    auto& state = _stack.back();
    auto& prev_state = _stack[_stack.size()-2];
@@ -193,6 +280,7 @@ void undo_database::merge()
       // del+upd -> N/A
       assert( prev_state.removed.find(obj.second->id) == prev_state.removed.end() );
       // nop+upd(was=Y) -> upd(was=Y), type B
+      move_packed( state, prev_state, obj.first );
       prev_state.old_values[obj.second->id] = std::move(obj.second);
    }
 
@@ -237,8 +325,11 @@ void undo_database::merge()
       // del + del -> N/A
       assert( prev_state.removed.find( obj.second->id ) == prev_state.removed.end() );
       // nop + del(was=Y) -> del(was=Y)
+      move_packed( state, prev_state, obj.first );
       prev_state.removed[obj.second->id] = std::move(obj.second);
    }
+   // what is left of the sizes of the state are those of the values it replaced by older ones
+   forget_packed( state );
    _stack.pop_back();
    --_active_sessions;
 }
@@ -275,7 +366,10 @@ void undo_database::pop_commit()
       for( auto& item : state.removed )
          _db.insert( std::move(*item.second) );
 
+      forget_packed( state );
       _stack.pop_back();
+      if( _stack.empty() && !_spilled.empty() )
+         load_newest_spilled();
    }
    catch ( const fc::exception& e )
    {
@@ -291,4 +385,207 @@ const undo_state& undo_database::head()const
    return _stack.back();
 }
 
+void undo_database::set_spill_file( const fc::path& file )
+{ try {
+   FC_ASSERT( _spilled.empty(), "cannot change the spill file while states are spilled" );
+   if( _spill_stream.is_open() )
+      _spill_stream.close();
+   // opened when the first state is spilled, the spilled states of a previous run are not needed
+   _spill_file = file;
+   _spill_end = 0;
+} FC_CAPTURE_AND_RETHROW( (file) ) }
+
+void undo_database::set_spill_limits( size_t max_states_in_memory, uint64_t max_bytes_in_memory )
+{
+   const bool was_tracking = _max_bytes_in_memory != 0;
+   _max_states_in_memory = max_states_in_memory;
+   _max_bytes_in_memory = max_bytes_in_memory;
+   if( _max_bytes_in_memory == 0 || was_tracking )
+      return;
+   // the sizes were not tracked until now, from here on they are as objects are kept and states merged or dropped
+   _bytes_in_memory = 0;
+   for( auto& state : _stack )
+   {
+      state.packed_sizes.clear();
+      state.packed_bytes = 0;
+      for( const auto& item : state.old_values )
+         track_packed( state, *item.second );
+      for( const auto& item : state.removed )
+         track_packed( state, *item.second );
+   }
+}
+
+void undo_database::drop_oldest()
+{
+   if( _spilled.empty() )
+   {
+      forget_packed( _stack.front() );
+      _stack.pop_front();
+      return;
+   }
+   _spilled.pop_front();
+   // the file is rewritten from its start once nothing in it is needed anymore
+   if( _spilled.empty() )
+      _spill_end = 0;
+   else
+      compact_spill_file();
+}
+
+void undo_database::spill_if_needed()
+{
+   if( _spill_file.generic_string().empty() || ( _max_states_in_memory == 0 && _max_bytes_in_memory == 0 ) )
+      return;
+   // the states of the open sessions, and the last state, which is modified outside of sessions, are not spilled
+   while( _stack.size() > _active_sessions + 1
+          && ( ( _max_states_in_memory != 0 && _stack.size() > _max_states_in_memory )
+               || ( _max_bytes_in_memory != 0 && _bytes_in_memory > _max_bytes_in_memory ) ) )
+      spill_oldest();
+}
+
+void undo_database::spill_oldest()
+{ try {
+   const undo_state& state = _stack.front();
+   detail::spilled_undo_state spilled;
+   spilled.old_values.reserve( state.old_values.size() );
+   for( const auto& item : state.old_values )
+      spilled.old_values.push_back( detail::spilled_object{ item.first, item.second->pack() } );
+   spilled.old_index_next_ids.assign( state.old_index_next_ids.begin(), state.old_index_next_ids.end() );
+   spilled.new_ids.assign( state.new_ids.begin(), state.new_ids.end() );
+   spilled.removed.reserve( state.removed.size() );
+   for( const auto& item : state.removed )
+      spilled.removed.push_back( detail::spilled_object{ item.first, item.second->pack() } );
+
+   if( !_spill_stream.is_open() )
+   {
+      if( !fc::exists( _spill_file.parent_path() ) )
+         fc::create_directories( _spill_file.parent_path() );
+      _spill_stream.open( _spill_file.generic_string().c_str(),
+                          std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc );
+      FC_ASSERT( _spill_stream.is_open(), "unable to open the undo spill file" );
+   }
+   const std::vector<char> data = fc::raw::pack( spilled );
+   _spill_stream.seekp( _spill_end );
+   _spill_stream.write( data.data(), data.size() );
+   FC_ASSERT( _spill_stream.good(), "unable to write to the undo spill file" );
+
+   spill_record record;
+   record.offset = _spill_end;
+   record.size = data.size();
+   _spilled.push_back( record );
+   _spill_end += data.size();
+   forget_packed( state );
+   _stack.pop_front();
+} FC_CAPTURE_AND_RETHROW( (_spill_file) ) }
+
+void undo_database::compact_spill_file()
+{ try {
+   // the states dropped leave space at the start of the file, the states kept are moved there once it is as large as
+   // them: the two ranges do not overlap, and each byte spilled is moved about once
+   const uint64_t start = _spilled.front().offset;
+   const uint64_t kept = _spill_end - start;
+   if( start < kept )
+      return;
+   std::vector<char> buffer( std::min<uint64_t>( kept, 1 << 20 ) );
+   _spill_stream.flush();
+   for( uint64_t moved = 0; moved < kept; )
+   {
+      const size_t count = std::min<uint64_t>( buffer.size(), kept - moved );
+      _spill_stream.seekg( start + moved );
+      _spill_stream.read( buffer.data(), count );
+      _spill_stream.seekp( moved );
+      _spill_stream.write( buffer.data(), count );
+      FC_ASSERT( _spill_stream.good(), "unable to compact the undo spill file" );
+      moved += count;
+   }
+   for( auto& record : _spilled )
+      record.offset -= start;
+   _spill_end = kept;
+} FC_CAPTURE_AND_RETHROW( (_spill_file)(_spill_end) ) }
+
+void undo_database::load_newest_spilled()
+{ try {
+   FC_ASSERT( !_spilled.empty() );
+   const spill_record record = _spilled.back();
+   _stack.push_front( read_spilled( record ) );
+   _bytes_in_memory += _stack.front().packed_bytes;
+
+   _spilled.pop_back();
+   // the record is overwritten by the next state spilled
+   _spill_end = record.offset;
+} FC_CAPTURE_AND_RETHROW( (_spill_file) ) }
+
+undo_state undo_database::read_spilled( const spill_record& record )
+{ try {
+   std::vector<char> data( record.size );
+   _spill_stream.flush();
+   _spill_stream.seekg( record.offset );
+   _spill_stream.read( data.data(), data.size() );
+   FC_ASSERT( _spill_stream.good(), "unable to read the undo spill file" );
+   const auto spilled = fc::raw::unpack<detail::spilled_undo_state>( data );
+
+   undo_state state;
+   // the objects are kept as they were packed, their sizes are known
+   const bool track = _max_bytes_in_memory != 0;
+   auto track_spilled = [&state,track]( const detail::spilled_object& item ) {
+      if( !track )
+         return;
+      state.packed_sizes[item.id] = item.data.size();
+      state.packed_bytes += item.data.size();
+   };
+   for( const auto& item : spilled.old_values )
+   {
+      state.old_values[item.id] = _db.get_index( item.id.space(), item.id.type() ).unpack_object( item.data );
+      track_spilled( item );
+   }
+   for( const auto& item : spilled.old_index_next_ids )
+      state.old_index_next_ids[item.first] = item.second;
+   state.new_ids.insert( spilled.new_ids.begin(), spilled.new_ids.end() );
+   for( const auto& item : spilled.removed )
+   {
+      state.removed[item.id] = _db.get_index( item.id.space(), item.id.type() ).unpack_object( item.data );
+      track_spilled( item );
+   }
+   return state;
+} FC_CAPTURE_AND_RETHROW( (_spill_file)(record.offset)(record.size) ) }
+
+undone_values undo_database::values_before( size_t count )
+{ try {
+   FC_ASSERT( count <= size(), "not enough undo history", ("count",count)("size",size()) );
+   undone_values result;
+   // from the oldest of the states to the newest, the first value found for an object is the one from before them
+   auto add = [&result]( const undo_state& state )
+   {
+      for( const auto& item : state.old_values )
+         if( result.objects.find( item.first ) == result.objects.end() )
+            result.objects.emplace( item.first, item.second->clone() );
+      for( const auto& item : state.removed )
+         if( result.objects.find( item.first ) == result.objects.end() )
+            result.objects.emplace( item.first, item.second->clone() );
+      for( const auto& id : state.new_ids )
+         result.objects.emplace( id, unique_ptr<object>() );
+      for( const auto& item : state.old_index_next_ids )
+         result.old_index_next_ids.emplace( item.first, item.second );
+   };
+   size_t skipped = size() - count;
+   for( const auto& record : _spilled )
+   {
+      if( skipped > 0 )
+      {
+         --skipped;
+         continue;
+      }
+      add( read_spilled( record ) );
+   }
+   for( const auto& state : _stack )
+   {
+      if( skipped > 0 )
+      {
+         --skipped;
+         continue;
+      }
+      add( state );
+   }
+   return result;
+} FC_CAPTURE_AND_RETHROW( (count) ) }
+
 } } // graphene::db
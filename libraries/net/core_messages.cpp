@@ -23,6 +23,7 @@
  */
 #include <graphene/net/core_messages.hpp>
 
+#include <algorithm>
 
 namespace graphene { namespace net {
 
@@ -46,5 +47,32 @@ namespace graphene { namespace net {
   const core_message_type_enum get_current_connections_request_message::type = core_message_type_enum::get_current_connections_request_message_type;
   const core_message_type_enum get_current_connections_reply_message::type   = core_message_type_enum::get_current_connections_reply_message_type;
 
+  block_message block_message::from_message( const message& m )
+  {
+    block_message result = m.as<block_message>();
+    // the message is the block followed by its ID. The bytes are only kept if they are exactly the block as we pack
+    // it, without trailing data or non-canonical encodings, and if the ID the peer sent matches them.
+    std::vector<char> bytes = fc::raw::pack( result.block );
+    if( bytes.size() + sizeof(block_id_type) != m.data.size()
+        || !std::equal( bytes.begin(), bytes.end(), m.data.begin() ) )
+      return result;
+    result.packed = std::make_shared<const graphene::chain::packed_block>( std::move( bytes ) );
+    if( result.packed->id() != result.block_id )
+      result.packed.reset();
+    return result;
+  }
+
+  message block_message::to_message( const graphene::chain::packed_block& b )
+  {
+    message result;
+    result.msg_type = block_message::type;
+    result.data.reserve( b.bytes().size() + sizeof(block_id_type) );
+    result.data.assign( b.bytes().begin(), b.bytes().end() );
+    const auto id = fc::raw::pack( b.id() );
+    result.data.insert( result.data.end(), id.begin(), id.end() );
+    result.size = (uint32_t)result.data.size();
+    return result;
+  }
+
 } } // graphene::net
 
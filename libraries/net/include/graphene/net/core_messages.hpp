@@ -24,7 +24,9 @@
 #pragma once
 
 #include <graphene/net/config.hpp>
+#include <graphene/net/message.hpp>
 #include <graphene/chain/protocol/block.hpp>
+#include <graphene/chain/protocol/packed_block.hpp>
 
 #include <fc/crypto/ripemd160.hpp>
 #include <fc/crypto/elliptic.hpp>
@@ -110,9 +112,16 @@ namespace graphene { namespace net {
       block_message(const signed_block& blk )
       :block(blk),block_id(blk.id()){}
 
+      /** decodes a received message, keeping the bytes of the block in @ref packed if they are the block packed */
+      static block_message from_message( const message& m );
+      /** @return the message of a block_message for @ref b, made of the bytes of @ref b without packing it again */
+      static message to_message( const graphene::chain::packed_block& b );
+
       signed_block    block;
       block_id_type   block_id;
 
+      /// the bytes @ref block was decoded from, when it came from the network, not serialized
+      std::shared_ptr<const graphene::chain::packed_block> packed;
    };
 
   struct item_ids_inventory_message
@@ -81,6 +81,9 @@
 #include <graphene/chain/config.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 
+#include <graphene/utilities/metrics.hpp>
+#include <graphene/utilities/transaction_tracer.hpp>
+
 #include <fc/git_revision.hpp>
 
 //#define ENABLE_DEBUG_ULOGS
@@ -481,6 +484,7 @@ namespace graphene { namespace net { namespace detail {
       fc::promise<void>::ptr        _retrigger_advertise_inventory_loop_promise;
       fc::future<void>              _advertise_inventory_loop_done;
       std::unordered_set<item_id>   _new_inventory; /// list of items we have received but not yet advertised to our peers
+      std::unordered_map<message_hash_type, transaction_id_type> _traced_transactions; /// sampled transactions in _new_inventory, by message hash
       // @}
 
       fc::future<void>     _terminate_inactive_connections_loop_done;
@@ -1275,7 +1279,16 @@ namespace graphene { namespace net { namespace detail {
                 peer->inventory_advertised_to_peer.insert(peer_connection::timestamped_item_id(item_to_advertise, fc::time_point::now()));
                 ++total_items_to_send_to_this_peer;
                 if (item_to_advertise.item_type == trx_message_type)
+                {
                   testnetlog("advertising transaction ${id} to peer ${endpoint}", ("id", item_to_advertise.item_hash)("endpoint", peer->get_remote_endpoint()));
+                  auto traced_itr = _traced_transactions.find(item_to_advertise.item_hash);
+                  if (traced_itr != _traced_transactions.end())
+                  {
+                    graphene::utilities::transaction_tracer::instance().record(traced_itr->second,
+                                                                               graphene::utilities::transaction_tracer::advertised_stage);
+                    _traced_transactions.erase(traced_itr);
+                  }
+                }
                 dlog("advertising item ${id} to peer ${endpoint}", ("id", item_to_advertise.item_hash)("endpoint", peer->get_remote_endpoint()));
               }
             }
@@ -1289,6 +1302,11 @@ namespace graphene { namespace net { namespace detail {
           peer->clear_old_inventory();
         }
 
+        // the sampled transactions which no peer needed are not advertised
+        if (!_traced_transactions.empty())
+          for (const item_id& item_to_advertise : inventory_to_advertise)
+            _traced_transactions.erase(item_to_advertise.item_hash);
+
         for (auto iter = inventory_messages_to_send.begin(); iter != inventory_messages_to_send.end(); ++iter)
           iter->first->send_message(iter->second);
         inventory_messages_to_send.clear();
@@ -1585,6 +1603,13 @@ namespace graphene { namespace net { namespace detail {
       update_bandwidth_data(bytes_read_this_second, bytes_written_this_second);
       _bandwidth_monitor_last_update_time = current_time;
 
+      static auto& download_rate = graphene::utilities::metrics_registry::instance().get_gauge(
+            "graphene_p2p_download_bytes_per_second", "Bytes per second received from peers" );
+      static auto& upload_rate = graphene::utilities::metrics_registry::instance().get_gauge(
+            "graphene_p2p_upload_bytes_per_second", "Bytes per second sent to peers" );
+      download_rate.set( bytes_read_this_second );
+      upload_rate.set( bytes_written_this_second );
+
       if (!_node_is_shutting_down && !_bandwidth_monitor_loop_done.canceled())
         _bandwidth_monitor_loop_done = fc::schedule( [=](){ bandwidth_monitor_loop(); },
                                                      fc::time_point::now() + fc::seconds(1),
@@ -3532,7 +3557,7 @@ namespace graphene { namespace net { namespace detail {
       // (it's possible that we request an item during normal operation and then get kicked into sync
       // mode before we receive and process the item.  In that case, we should process the item as a normal
       // item to avoid confusing the sync code)
-      graphene::net::block_message block_message_to_process(message_to_process.as<graphene::net::block_message>());
+      graphene::net::block_message block_message_to_process(graphene::net::block_message::from_message(message_to_process));
       auto item_iter = originating_peer->items_requested_from_peer.find(item_id(graphene::net::block_message_type, message_hash));
       if (item_iter != originating_peer->items_requested_from_peer.end())
       {
@@ -4958,6 +4983,9 @@ namespace graphene { namespace net { namespace detail {
         dlog( "broadcasting trx: ${trx}", ("trx", transaction_message_to_broadcast) );
       }
       message_hash_type hash_of_item_to_broadcast = item_to_broadcast.id();
+      if( item_to_broadcast.msg_type == graphene::net::trx_message_type
+            && graphene::utilities::transaction_tracer::instance().is_sampled( hash_of_message_contents ) )
+         _traced_transactions[hash_of_item_to_broadcast] = hash_of_message_contents;
 
       _message_cache.cache_message( item_to_broadcast, hash_of_item_to_broadcast, propagation_data, hash_of_message_contents );
       _new_inventory.insert( item_id(item_to_broadcast.msg_type, hash_of_item_to_broadcast ) );
@@ -79,7 +79,7 @@ account_history_plugin_impl::~account_history_plugin_impl()
 void account_history_plugin_impl::update_account_histories( const signed_block& b )
 {
    graphene::chain::database& db = database();
-   const vector<optional< operation_history_object > >& hist = db.get_applied_operations();
+   const graphene::chain::applied_operation_log& hist = db.get_applied_operations();
    bool is_first = true;
    auto skip_oho_id = [&is_first,&db,this]() {
       if( is_first && db._undo_db.enabled() ) // this ensures that the current id is rolled back on undo
@@ -90,49 +90,51 @@ void account_history_plugin_impl::update_account_histories( const signed_block&
       else
          _oho_index->use_next_id();
    };
-   for( const optional< operation_history_object >& o_op : hist )
+   // the accounts of the operations were collected once for the block, the history is only updated by blocks
+   const graphene::chain::block_journal& journal = db.get_block_journal();
+   const bool journaled = ( journal.block_num == b.block_num() && journal.operations.size() == hist.size() );
+   for( uint32_t i = 0; i < hist.size(); ++i )
    {
-      optional<operation_history_object> oho;
+      const graphene::chain::applied_operation& op = hist[i];
+      // the operation is copied once, from the block to the object database
+      const operation_history_object* oho = nullptr;
 
       auto create_oho = [&]() {
          is_first = false;
-         return optional<operation_history_object>( db.create<operation_history_object>( [&]( operation_history_object& h )
+         return &db.create<operation_history_object>( [&]( operation_history_object& h )
          {
-            if( o_op.valid() )
-            {
-               h.op           = o_op->op;
-               h.result       = o_op->result;
-               h.block_num    = o_op->block_num;
-               h.trx_in_block = o_op->trx_in_block;
-               h.op_in_trx    = o_op->op_in_trx;
-               h.virtual_op   = o_op->virtual_op;
-               h.block_timestamp = o_op->block_timestamp;
-            }
-         } ) );
+            op.copy_to( h );
+         } );
       };
 
-      if( !o_op.valid() || ( _max_ops_per_account == 0 && _partial_operations ) )
+      if( _max_ops_per_account == 0 && _partial_operations )
       {
-         // Note: the 2nd and 3rd checks above are for better performance, when the db is not clean,
-         //       they will break consistency of account_stats.total_ops and removed_ops and most_recent_op
+         // Note: the check above is for better performance, when the db is not clean,
+         //       it breaks consistency of account_stats.total_ops and removed_ops and most_recent_op
          skip_oho_id();
          continue;
       }
       else if( !_partial_operations )  // add to the operation history index
          oho = create_oho();
 
-      const operation_history_object& op = *o_op;
-
       // get the set of accounts this operation applies to
       flat_set<account_uid_type> impacted_uids;
-      vector<authority> other;
-      operation_get_required_uid_authorities( op.op, impacted_uids, impacted_uids, impacted_uids, other );
+      if( journaled )
+      {
+         impacted_uids = journal.operations[i].authorities;
+         impacted_uids.insert( journal.operations[i].impacted.begin(), journal.operations[i].impacted.end() );
+      }
+      else
+      {
+         vector<authority> other;
+         operation_get_required_uid_authorities( *op.op, impacted_uids, impacted_uids, impacted_uids, other );
 
-      graphene::chain::operation_get_impacted_account_uids( op.op, impacted_uids );
+         graphene::chain::operation_get_impacted_account_uids( *op.op, impacted_uids );
 
-      for( auto& a : other )
-         for( auto& item : a.account_uid_auths )
-            impacted_uids.insert( item.first.uid );
+         for( auto& a : other )
+            for( auto& item : a.account_uid_auths )
+               impacted_uids.insert( item.first.uid );
+      }
 
       // for each operation this account applies to that is in the config link it into the history
       if( _tracked_accounts.size() == 0 )
@@ -140,7 +142,7 @@ void account_history_plugin_impl::update_account_histories( const signed_block&
             // if tracking all accounts, when impacted_uids is not empty (although it will always be),
             //    still need to create oho if _max_ops_per_account > 0 and _partial_operations == true
             //    so always need to create oho if not done
-            if (!impacted_uids.empty() && !oho.valid()) { oho = create_oho(); }
+            if (!impacted_uids.empty() && oho == nullptr) { oho = create_oho(); }
 
             // Note: the check above is for better performance, when the db is not clean,
             //       it breaks consistency of account_stats.total_ops and removed_ops and most_recent_op,
@@ -168,14 +170,14 @@ void account_history_plugin_impl::update_account_histories( const signed_block&
             {
                if( impacted_uids.find( account_uid ) != impacted_uids.end() )
                {
-                  if (!oho.valid()) { oho = create_oho(); }
+                  if (oho == nullptr) { oho = create_oho(); }
                   // add history
                   add_account_history( account_uid, oho->id, oho->op.which() );
                }
             }
          }
       }
-      if ( _partial_operations && !oho.valid() )
+      if ( _partial_operations && oho == nullptr )
          skip_oho_id();
    }
 }
@@ -278,6 +280,7 @@ void account_history_plugin::plugin_set_program_options(
 void account_history_plugin::plugin_initialize(const boost::program_options::variables_map& options)
 {
    database().applied_block.connect( [&]( const signed_block& b){ my->update_account_histories(b); } );
+   database().set_journal_operations( true );
    my->_oho_index = database().add_index< primary_index< operation_history_index > >();
    database().add_index< primary_index< account_transaction_history_index > >();
 
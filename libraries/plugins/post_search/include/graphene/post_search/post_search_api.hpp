@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <graphene/chain/content_object.hpp>
+#include <graphene/post_search/search_index.hpp>
+
+#include <fc/api.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace app {
+class application;
+} }
+
+namespace graphene { namespace post_search {
+
+class post_search_plugin;
+
+struct ranked_post
+{
+   uint32_t                      score = 0;
+   graphene::chain::post_object  post;
+};
+
+struct post_search_results
+{
+   std::vector<ranked_post>      posts;
+   /// pass it to search_posts to get the next page, empty if there are no more results
+   std::string                   next_cursor;
+};
+
+class post_search_api
+{
+   public:
+      post_search_api( graphene::app::application& app );
+
+      /**
+       * @brief Search the posts of a platform
+       * @param platform uid of the platform
+       * @param query words which must all occur in the title, body or tags of the posts, words starting with '#'
+       *        must be tags of the posts
+       * @param limit maximum number of posts to return, must not exceed 100
+       * @param cursor empty for the first page, or the next_cursor of the previous page
+       * @return posts ranked by score, then newest first
+       */
+      post_search_results search_posts( graphene::chain::account_uid_type platform, const std::string& query,
+                                        uint32_t limit, const std::string& cursor )const;
+
+      /**
+       * @brief Retrieve the size of the post search index
+       */
+      search_index_stats get_post_search_stats()const;
+
+   private:
+      graphene::app::application&          _app;
+      std::shared_ptr<post_search_plugin>  _plugin;
+};
+
+} } // graphene::post_search
+
+FC_REFLECT( graphene::post_search::ranked_post, (score)(post) )
+FC_REFLECT( graphene::post_search::post_search_results, (posts)(next_cursor) )
+
+FC_API( graphene::post_search::post_search_api,
+        (search_posts)
+        (get_post_search_stats)
+      )
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <graphene/app/plugin.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/post_search/search_index.hpp>
+
+namespace graphene { namespace post_search {
+
+   /**
+    * Keeps the search index in step with the post objects. It is a secondary index of the post index, so it sees
+    * posts created, modified and removed when blocks and transactions are applied and when they are undone, and
+    * when the object database is loaded from disk.
+    */
+   class post_search_secondary_index : public graphene::db::secondary_index
+   {
+      public:
+         virtual void object_inserted( const graphene::db::object& obj ) override;
+         virtual void object_removed( const graphene::db::object& obj ) override;
+         virtual void about_to_modify( const graphene::db::object& before ) override;
+         virtual void object_modified( const graphene::db::object& after ) override;
+
+         post_search_index index;
+
+      private:
+         /// the indexed text of the post being modified, see about_to_modify()
+         ///@{
+         std::string _title_before_modify;
+         std::string _body_before_modify;
+         std::string _extra_data_before_modify;
+         ///@}
+   };
+
+   /**
+    *  @class post_search_plugin
+    *  @brief full text and tag search over the posts of each platform, served by post_search_api
+    *
+    *  The index is kept in memory, the plugin is disabled unless the enable-post-search option is set.
+    */
+   class post_search_plugin : public graphene::app::plugin
+   {
+      public:
+         std::string plugin_name()const override;
+         virtual void plugin_set_program_options(
+            boost::program_options::options_description& cli,
+            boost::program_options::options_description& cfg ) override;
+         virtual void plugin_initialize( const boost::program_options::variables_map& options ) override;
+         virtual void plugin_startup() override;
+
+         /** @return false unless enabled by the enable-post-search option */
+         bool enabled()const { return _index != nullptr; }
+         const post_search_index& get_index()const;
+
+      private:
+         post_search_secondary_index* _index = nullptr;
+   };
+
+} } // graphene::post_search
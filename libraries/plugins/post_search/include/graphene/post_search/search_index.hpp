@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/types.hpp>
+
+#include <fc/optional.hpp>
+
+#include <boost/container/flat_map.hpp>
+
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace graphene { namespace post_search {
+
+   using graphene::chain::account_uid_type;
+
+   /** the searchable fields of a post */
+   struct search_document
+   {
+      uint64_t             post_instance = 0; ///< instance of the post_object ID
+      account_uid_type     platform = 0;
+      fc::time_point_sec   create_time;
+      std::string          title;
+      std::string          body;
+      std::string          extra_data;
+   };
+
+   /** a post matching a query, hits are ordered by score, then by creation time and post, newest first */
+   struct search_hit
+   {
+      uint32_t             score = 0;
+      fc::time_point_sec   create_time;
+      uint64_t             post_instance = 0;
+
+      bool operator<( const search_hit& o )const ///< true if this hit ranks before o
+      {
+         return std::tie( o.score, o.create_time, o.post_instance ) < std::tie( score, create_time, post_instance );
+      }
+   };
+
+   struct search_index_stats
+   {
+      uint64_t documents = 0;
+      uint64_t posting_lists = 0;
+      uint64_t postings = 0;
+      uint64_t memory_bytes = 0;     ///< estimated
+      uint64_t max_memory_bytes = 0; ///< 0 for no limit
+      uint64_t evicted_documents = 0;
+   };
+
+   /**
+    *  @class post_search_index
+    *  @brief inverted index over the title, body and tags of posts, per platform
+    *
+    *  A query matches the posts which contain all of its terms. Words of the query match words of the title, the body
+    *  and the tags, a word starting with '#' only matches a tag. Tags are the "tags" array and the "category" of the
+    *  JSON extra_data of a post. Matches are scored by where the terms occur: 4 per occurrence in the title,
+    *  2 per tag and 1 per occurrence in the body.
+    *
+    *  When the estimated memory used by the index exceeds the limit, the oldest posts are dropped from it, so search
+    *  covers the most recent posts.
+    */
+   class post_search_index
+   {
+      public:
+         explicit post_search_index( uint64_t max_memory_bytes = 0 );
+
+         void set_max_memory( uint64_t bytes );
+
+         /** adds a post, replacing it if it is already indexed */
+         void add( const search_document& doc );
+         void remove( uint64_t post_instance );
+         void clear();
+         bool contains( uint64_t post_instance )const { return _documents.find( post_instance ) != _documents.end(); }
+
+         /**
+          * @param after the last hit of the previous page, to return the page after it
+          * @return at most @ref limit hits of @ref platform matching @ref query
+          */
+         std::vector<search_hit> search( account_uid_type platform, const std::string& query, uint32_t limit,
+                                         const fc::optional<search_hit>& after = fc::optional<search_hit>() )const;
+
+         search_index_stats get_stats()const;
+
+         /** @return the lower case words of a text, words are runs of ASCII letters and digits or of non-ASCII bytes */
+         static std::vector<std::string> tokenize( const std::string& text );
+         /** @return the normalized tags of the extra_data of a post, an empty list if it is not a JSON object */
+         static std::vector<std::string> extract_tags( const std::string& extra_data );
+
+      private:
+         struct posting_key
+         {
+            account_uid_type platform;
+            std::string      term;
+            bool operator==( const posting_key& o )const { return platform == o.platform && term == o.term; }
+         };
+         struct posting_key_hash
+         {
+            size_t operator()( const posting_key& k )const
+            {
+               return std::hash<std::string>()( k.term ) ^ ( std::hash<uint64_t>()( k.platform ) * 31 );
+            }
+         };
+         /// post instance -> weight of the term in the post, posts are mostly added in increasing order
+         typedef boost::container::flat_map<uint64_t, uint16_t> posting_list;
+         typedef std::unordered_map<posting_key, posting_list, posting_key_hash> posting_map;
+
+         struct document_info
+         {
+            fc::time_point_sec                        create_time;
+            std::vector<posting_map::value_type*>     postings; ///< element pointers are stable in unordered_map
+            uint64_t                                  memory_bytes = 0;
+         };
+
+         void evict_oldest();
+
+         posting_map                                      _postings;
+         std::unordered_map<uint64_t, document_info>      _documents;
+         std::set< std::pair<fc::time_point_sec, uint64_t> > _by_age;
+         uint64_t                                         _postings_count = 0;
+         uint64_t                                         _memory_bytes = 0;
+         uint64_t                                         _max_memory_bytes = 0;
+         uint64_t                                         _evicted = 0;
+   };
+
+} } // graphene::post_search
+
+FC_REFLECT( graphene::post_search::search_hit, (score)(create_time)(post_instance) )
+FC_REFLECT( graphene::post_search::search_index_stats,
+            (documents)(posting_lists)(postings)(memory_bytes)(max_memory_bytes)(evicted_documents) )
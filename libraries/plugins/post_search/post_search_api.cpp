@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/post_search/post_search_api.hpp>
+#include <graphene/post_search/post_search_plugin.hpp>
+
+#include <graphene/app/application.hpp>
+
+#include <sstream>
+
+namespace graphene { namespace post_search {
+
+namespace {
+
+/// the cursor is the position of the last hit of a page: "<score>-<create time>-<post instance>"
+std::string encode_cursor( const search_hit& hit )
+{
+   std::ostringstream out;
+   out << hit.score << '-' << hit.create_time.sec_since_epoch() << '-' << hit.post_instance;
+   return out.str();
+}
+
+search_hit decode_cursor( const std::string& cursor )
+{
+   search_hit hit;
+   uint32_t create_time = 0;
+   char sep1 = 0, sep2 = 0;
+   std::istringstream in( cursor );
+   in >> hit.score >> sep1 >> create_time >> sep2 >> hit.post_instance;
+   FC_ASSERT( in && sep1 == '-' && sep2 == '-' && in.peek() == std::char_traits<char>::eof(),
+              "Invalid cursor ${c}", ("c",cursor) );
+   hit.create_time = fc::time_point_sec( create_time );
+   return hit;
+}
+
+}
+
+post_search_api::post_search_api( graphene::app::application& app )
+   : _app( app ),
+     _plugin( app.get_plugin<post_search_plugin>( "post_search" ) )
+{
+   FC_ASSERT( _plugin && _plugin->enabled(), "Post search is not enabled" );
+}
+
+post_search_results post_search_api::search_posts( graphene::chain::account_uid_type platform, const std::string& query,
+                                                   uint32_t limit, const std::string& cursor )const
+{
+   FC_ASSERT( limit <= 100 );
+   fc::optional<search_hit> after;
+   if( !cursor.empty() )
+      after = decode_cursor( cursor );
+
+   // ask for one more hit to know whether there is a next page
+   auto hits = _plugin->get_index().search( platform, query, limit + 1, after );
+   const bool more = hits.size() > limit;
+   if( more )
+      hits.resize( limit );
+
+   const auto& db = *_app.chain_database();
+   post_search_results result;
+   result.posts.reserve( hits.size() );
+   for( const auto& hit : hits )
+   {
+      const auto* post = db.find( graphene::chain::post_id_type( hit.post_instance ) );
+      if( post != nullptr )
+         result.posts.push_back( ranked_post{ hit.score, *post } );
+   }
+   if( more && !hits.empty() )
+      result.next_cursor = encode_cursor( hits.back() );
+   return result;
+}
+
+search_index_stats post_search_api::get_post_search_stats()const
+{
+   return _plugin->get_index().get_stats();
+}
+
+} } // graphene::post_search
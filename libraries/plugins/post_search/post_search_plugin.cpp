@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/post_search/post_search_plugin.hpp>
+
+#include <graphene/chain/content_object.hpp>
+
+namespace graphene { namespace post_search {
+
+namespace {
+
+search_document to_search_document( const graphene::chain::post_object& post )
+{
+   search_document doc;
+   doc.post_instance = post.id.instance();
+   doc.platform = post.platform;
+   doc.create_time = post.create_time;
+   doc.title = post.title;
+   doc.body = post.body;
+   doc.extra_data = post.extra_data;
+   return doc;
+}
+
+}
+
+void post_search_secondary_index::object_inserted( const graphene::db::object& obj )
+{
+   index.add( to_search_document( static_cast<const graphene::chain::post_object&>( obj ) ) );
+}
+
+void post_search_secondary_index::object_removed( const graphene::db::object& obj )
+{
+   index.remove( obj.id.instance() );
+}
+
+void post_search_secondary_index::about_to_modify( const graphene::db::object& before )
+{
+   // assigned rather than constructed, so the buffers are reused from one modification to the next
+   const auto& post = static_cast<const graphene::chain::post_object&>( before );
+   _title_before_modify = post.title;
+   _body_before_modify = post.body;
+   _extra_data_before_modify = post.extra_data;
+}
+
+void post_search_secondary_index::object_modified( const graphene::db::object& after )
+{
+   const auto& post = static_cast<const graphene::chain::post_object&>( after );
+   // most modifications of a post don't change its text, don't tokenize it again then
+   if( post.title == _title_before_modify && post.body == _body_before_modify
+         && post.extra_data == _extra_data_before_modify && index.contains( post.id.instance() ) )
+      return;
+   index.add( to_search_document( post ) );
+}
+
+std::string post_search_plugin::plugin_name()const
+{
+   return "post_search";
+}
+
+void post_search_plugin::plugin_set_program_options(
+   boost::program_options::options_description& cli,
+   boost::program_options::options_description& cfg
+   )
+{
+   cli.add_options()
+         ("enable-post-search", boost::program_options::value<bool>()->default_value(false),
+          "Index the title, body and tags of posts for post_search_api")
+         ("post-search-max-memory", boost::program_options::value<uint64_t>()->default_value(512),
+          "Memory in MiB the post search index may use, when it is reached the oldest posts are dropped from the index (0 for no limit)")
+         ;
+   cfg.add(cli);
+}
+
+void post_search_plugin::plugin_initialize( const boost::program_options::variables_map& options )
+{
+   if( !options.at("enable-post-search").as<bool>() )
+      return;
+   // added before the object database is opened, so the posts loaded from disk are indexed too
+   _index = database().add_secondary_index< graphene::db::primary_index< graphene::chain::post_index >,
+                                            post_search_secondary_index >();
+   _index->index.set_max_memory( options.at("post-search-max-memory").as<uint64_t>() * 1024 * 1024 );
+}
+
+void post_search_plugin::plugin_startup()
+{
+   if( enabled() )
+      ilog( "post_search: indexed ${n} posts", ("n",_index->index.get_stats().documents) );
+}
+
+const post_search_index& post_search_plugin::get_index()const
+{
+   FC_ASSERT( enabled(), "Post search is not enabled" );
+   return _index->index;
+}
+
+} } // graphene::post_search
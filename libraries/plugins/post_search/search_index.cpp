@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/post_search/search_index.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <map>
+
+namespace graphene { namespace post_search {
+
+namespace {
+
+const uint16_t title_weight = 4;
+const uint16_t tag_weight   = 2;
+const uint16_t body_weight  = 1;
+
+const size_t   max_term_size = 64;
+const size_t   max_extra_data_size = 64 * 1024;
+
+/// rough per-node overheads, used to estimate the memory used by the index
+const uint64_t posting_list_overhead = 96;
+const uint64_t document_overhead     = 128;
+const uint64_t posting_size          = sizeof( std::pair<uint64_t, uint16_t> ) + sizeof( void* );
+
+bool is_word_byte( unsigned char c )
+{
+   return std::isalnum( c ) || c >= 0x80;
+}
+
+std::string normalize_tag( const std::string& tag )
+{
+   std::string result;
+   for( unsigned char c : tag )
+   {
+      if( is_word_byte( c ) )
+         result.push_back( std::tolower( c ) );
+      else if( !result.empty() && result.back() != '-' )
+         result.push_back( '-' );
+   }
+   while( !result.empty() && result.back() == '-' )
+      result.pop_back();
+   if( result.size() > max_term_size )
+      result.resize( max_term_size );
+   return result;
+}
+
+}
+
+post_search_index::post_search_index( uint64_t max_memory_bytes )
+   : _max_memory_bytes( max_memory_bytes )
+{
+}
+
+void post_search_index::set_max_memory( uint64_t bytes )
+{
+   _max_memory_bytes = bytes;
+   while( _max_memory_bytes != 0 && _memory_bytes > _max_memory_bytes && !_by_age.empty() )
+      evict_oldest();
+}
+
+std::vector<std::string> post_search_index::tokenize( const std::string& text )
+{
+   std::vector<std::string> result;
+   std::string word;
+   auto flush = [&]() {
+      // single ASCII characters are too common to be worth indexing
+      if( word.size() > 1 || ( word.size() == 1 && static_cast<unsigned char>( word[0] ) >= 0x80 ) )
+         result.push_back( word.size() > max_term_size ? word.substr( 0, max_term_size ) : word );
+      word.clear();
+   };
+   for( unsigned char c : text )
+   {
+      if( is_word_byte( c ) )
+         word.push_back( std::tolower( c ) );
+      else
+         flush();
+   }
+   flush();
+   return result;
+}
+
+std::vector<std::string> post_search_index::extract_tags( const std::string& extra_data )
+{
+   std::vector<std::string> result;
+   if( extra_data.empty() || extra_data.size() > max_extra_data_size || extra_data.front() != '{' )
+      return result;
+   try
+   {
+      const fc::variant v = fc::json::from_string( extra_data );
+      if( !v.is_object() )
+         return result;
+      const fc::variant_object& obj = v.get_object();
+      auto add = [&result]( const fc::variant& tag ) {
+         if( !tag.is_string() )
+            return;
+         std::string t = normalize_tag( tag.get_string() );
+         if( !t.empty() )
+            result.push_back( std::move( t ) );
+      };
+      auto tags = obj.find( "tags" );
+      if( tags != obj.end() )
+      {
+         if( tags->value().is_array() )
+            for( const auto& tag : tags->value().get_array() )
+               add( tag );
+         else
+            add( tags->value() );
+      }
+      auto category = obj.find( "category" );
+      if( category != obj.end() )
+         add( category->value() );
+   }
+   catch( const fc::exception& )
+   {
+      // extra_data is free form, it does not have to be JSON
+   }
+   std::sort( result.begin(), result.end() );
+   result.erase( std::unique( result.begin(), result.end() ), result.end() );
+   return result;
+}
+
+void post_search_index::add( const search_document& doc )
+{
+   remove( doc.post_instance );
+
+   std::map<std::string, uint32_t> weights;
+   for( auto& term : tokenize( doc.title ) )
+      weights[std::move( term )] += title_weight;
+   for( auto& term : tokenize( doc.body ) )
+      weights[std::move( term )] += body_weight;
+   for( const auto& tag : extract_tags( doc.extra_data ) )
+   {
+      weights["#" + tag] += tag_weight;
+      for( auto& term : tokenize( tag ) )
+         weights[std::move( term )] += tag_weight;
+   }
+
+   document_info& info = _documents[doc.post_instance];
+   info.create_time = doc.create_time;
+   info.postings.reserve( weights.size() );
+   info.memory_bytes = document_overhead + weights.size() * posting_size;
+   for( const auto& w : weights )
+   {
+      auto itr = _postings.find( posting_key{ doc.platform, w.first } );
+      if( itr == _postings.end() )
+      {
+         itr = _postings.emplace( posting_key{ doc.platform, w.first }, posting_list() ).first;
+         _memory_bytes += posting_list_overhead + itr->first.term.capacity();
+      }
+      posting_list& list = itr->second;
+      // new posts have the highest instance, appending is amortized constant time
+      const uint16_t weight = std::min<uint32_t>( w.second, std::numeric_limits<uint16_t>::max() );
+      if( list.empty() || list.rbegin()->first < doc.post_instance )
+         list.emplace_hint( list.end(), doc.post_instance, weight );
+      else
+         list[doc.post_instance] = weight;
+      info.postings.push_back( &*itr );
+   }
+   _postings_count += weights.size();
+   _memory_bytes += info.memory_bytes;
+   _by_age.emplace( doc.create_time, doc.post_instance );
+
+   while( _max_memory_bytes != 0 && _memory_bytes > _max_memory_bytes && !_by_age.empty() )
+      evict_oldest();
+}
+
+void post_search_index::remove( uint64_t post_instance )
+{
+   auto doc_itr = _documents.find( post_instance );
+   if( doc_itr == _documents.end() )
+      return;
+   const document_info& info = doc_itr->second;
+   for( posting_map::value_type* posting : info.postings )
+   {
+      posting->second.erase( post_instance );
+      if( posting->second.empty() )
+      {
+         _memory_bytes -= posting_list_overhead + posting->first.term.capacity();
+         _postings.erase( _postings.find( posting->first ) );
+      }
+   }
+   _postings_count -= info.postings.size();
+   _memory_bytes -= info.memory_bytes;
+   _by_age.erase( std::make_pair( info.create_time, post_instance ) );
+   _documents.erase( doc_itr );
+}
+
+void post_search_index::evict_oldest()
+{
+   remove( _by_age.begin()->second );
+   ++_evicted;
+}
+
+void post_search_index::clear()
+{
+   _postings.clear();
+   _documents.clear();
+   _by_age.clear();
+   _postings_count = 0;
+   _memory_bytes = 0;
+}
+
+std::vector<search_hit> post_search_index::search( account_uid_type platform, const std::string& query, uint32_t limit,
+                                                   const fc::optional<search_hit>& after )const
+{
+   std::vector<std::string> terms;
+   std::string word;
+   auto flush_word = [&]() {
+      if( word.empty() )
+         return;
+      if( word[0] == '#' )
+      {
+         std::string tag = normalize_tag( word.substr( 1 ) );
+         if( !tag.empty() )
+            terms.push_back( "#" + tag );
+      }
+      else
+         for( auto& term : tokenize( word ) )
+            terms.push_back( std::move( term ) );
+      word.clear();
+   };
+   for( char c : query )
+   {
+      if( std::isspace( static_cast<unsigned char>( c ) ) )
+         flush_word();
+      else
+         word.push_back( c );
+   }
+   flush_word();
+
+   std::vector<search_hit> result;
+   if( terms.empty() || limit == 0 )
+      return result;
+   std::sort( terms.begin(), terms.end() );
+   terms.erase( std::unique( terms.begin(), terms.end() ), terms.end() );
+
+   std::vector<const posting_list*> lists;
+   lists.reserve( terms.size() );
+   for( const auto& term : terms )
+   {
+      auto itr = _postings.find( posting_key{ platform, term } );
+      if( itr == _postings.end() )
+         return result;
+      lists.push_back( &itr->second );
+   }
+   // walk the shortest list and probe the others
+   std::sort( lists.begin(), lists.end(), []( const posting_list* a, const posting_list* b ) { return a->size() < b->size(); } );
+
+   std::vector<search_hit> matches;
+   for( const auto& posting : *lists.front() )
+   {
+      uint32_t score = posting.second;
+      bool all = true;
+      for( size_t i = 1; i < lists.size() && all; ++i )
+      {
+         auto itr = lists[i]->find( posting.first );
+         if( itr == lists[i]->end() )
+            all = false;
+         else
+            score += itr->second;
+      }
+      if( !all )
+         continue;
+      search_hit hit;
+      hit.score = score;
+      hit.create_time = _documents.at( posting.first ).create_time;
+      hit.post_instance = posting.first;
+      if( after.valid() && !( *after < hit ) )
+         continue;
+      matches.push_back( hit );
+   }
+
+   const size_t n = std::min<size_t>( limit, matches.size() );
+   std::partial_sort( matches.begin(), matches.begin() + n, matches.end() );
+   matches.resize( n );
+   return matches;
+}
+
+search_index_stats post_search_index::get_stats()const
+{
+   search_index_stats result;
+   result.documents = _documents.size();
+   result.posting_lists = _postings.size();
+   result.postings = _postings_count;
+   result.memory_bytes = _memory_bytes;
+   result.max_memory_bytes = _max_memory_bytes;
+   result.evicted_documents = _evicted;
+   return result;
+}
+
+} } // graphene::post_search
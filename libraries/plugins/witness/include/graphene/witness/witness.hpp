@@ -42,7 +42,8 @@ namespace block_production_condition
       low_participation = 5,
       lag = 6,
       consecutive = 7,
-      exception_producing_block = 8
+      exception_producing_block = 8,
+      paused = 9
    };
 }
 
@@ -68,6 +69,10 @@ public:
 
    void set_block_production(bool allow) { _production_enabled = allow; }
 
+   /** @return true if production stopped because another node produced with our keys, see --pause-on-double-production */
+   bool is_production_paused()const { return _production_paused; }
+   void resume_production() { _production_paused = false; }
+
    virtual void plugin_initialize( const boost::program_options::variables_map& options ) override;
    virtual void plugin_startup() override;
    virtual void plugin_shutdown() override;
@@ -76,12 +81,24 @@ private:
    void schedule_production_loop();
    block_production_condition::block_production_condition_enum block_production_loop();
    block_production_condition::block_production_condition_enum maybe_produce_block( fc::limited_mutable_variant_object& capture );
+   /** warns, and pauses production if configured to, if @ref b was signed with one of our keys by another node */
+   void check_foreign_block( const chain::signed_block_header& b, const chain::block_id_type& id );
 
    boost::program_options::variables_map _options;
    bool _production_enabled = false;
    bool _consecutive_production_enabled = false;
    uint32_t _required_witness_participation = 33 * GRAPHENE_1_PERCENT;
    uint32_t _production_skip_flags = graphene::chain::database::skip_nothing;
+   fc::microseconds _broadcast_margin = fc::milliseconds( 1500 );
+   bool _pause_on_double_production = false;
+   bool _production_paused = false;
+
+   /// blocks produced by this node, by timestamp, the blocks of our witnesses which are not there were produced elsewhere
+   std::map<fc::time_point_sec, chain::block_id_type> _produced_blocks;
+   /// true while generating a block, the block is applied before its ID is known
+   bool _generating = false;
+   /// blocks produced before this node started can't be told apart
+   fc::time_point_sec _startup_time;
 
    std::map<chain::public_key_type, fc::ecc::private_key> _private_keys;
    std::set<chain::account_uid_type> _witnesses;
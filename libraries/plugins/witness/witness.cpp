@@ -27,6 +27,7 @@
 #include <graphene/chain/witness_object.hpp>
 
 #include <graphene/utilities/key_conversion.hpp>
+#include <graphene/utilities/metrics.hpp>
 
 #include <fc/smart_ref_impl.hpp>
 #include <fc/thread/thread.hpp>
@@ -72,6 +73,12 @@ void witness_plugin::plugin_set_program_options(
          ("private-key", bpo::value<vector<string>>()->composing()->multitoken()->
           DEFAULT_VALUE_VECTOR(std::make_pair(chain::public_key_type(default_priv_key.get_public_key()), graphene::utilities::key_to_wif(default_priv_key))),
           "Tuple of [PublicKey, WIF private key] (may specify multiple times)")
+         ("block-broadcast-margin-ms", bpo::value<uint32_t>()->default_value(1500),
+          "Milliseconds left at the end of a production slot for signing and broadcasting the block, pending "
+          "transactions are only packed into the block until then")
+         ("pause-on-double-production", bpo::bool_switch()->notifier([this](bool e){_pause_on_double_production = e;}),
+          "Stop producing blocks when a block signed with the key of one of our witnesses is seen which this node did "
+          "not produce, as another node is probably producing with the same key")
          ;
    config_file_options.add(command_line_options);
 }
@@ -86,6 +93,8 @@ void witness_plugin::plugin_initialize(const boost::program_options::variables_m
    ilog("witness plugin:  plugin_initialize() begin");
    _options = &options;
    LOAD_VALUE_SET(options, "witness", _witnesses, chain::account_uid_type )
+   if( options.count("block-broadcast-margin-ms") )
+      _broadcast_margin = fc::milliseconds( options["block-broadcast-margin-ms"].as<uint32_t>() );
 
    if( options.count("private-key") )
    {
@@ -121,6 +130,13 @@ void witness_plugin::plugin_startup()
 
    if( !_witnesses.empty() )
    {
+      FC_ASSERT( !app().is_replica(), "A read replica has no p2p network to broadcast blocks, it can not produce them" );
+      _startup_time = fc::time_point::now();
+      d.applied_block.connect( [this]( const chain::signed_block& b ) { check_foreign_block( b, b.id() ); } );
+      d.double_production_detected.connect( [this]( const chain::double_production_evidence& e ) {
+         check_foreign_block( e.first, e.first.id() );
+         check_foreign_block( e.second, e.second.id() );
+      });
       ilog("Launching block production for ${n} witnesses.", ("n", _witnesses.size()));
       app().set_block_production(true);
       if( _production_enabled )
@@ -140,6 +156,30 @@ void witness_plugin::plugin_shutdown()
    // nothing to do
 }
 
+void witness_plugin::check_foreign_block( const chain::signed_block_header& b, const chain::block_id_type& id )
+{
+   if( _generating || b.timestamp < _startup_time || _witnesses.find( b.witness ) == _witnesses.end() )
+      return;
+   auto itr = _produced_blocks.find( b.timestamp );
+   if( itr != _produced_blocks.end() && itr->second == id )
+      return;
+   // a witness whose signing key was moved to another node does not sign with a key of ours
+   if( _private_keys.find( chain::public_key_type( b.signee() ) ) == _private_keys.end() )
+      return;
+
+   elog( "Block ${id} with timestamp ${t} was signed with the key of our witness ${w}, but not produced by this node. "
+         "Is another node producing with the same key?", ("id",id)("t",b.timestamp)("w",b.witness) );
+   static auto& foreign_blocks = graphene::utilities::metrics_registry::instance().get_counter(
+         "graphene_witness_foreign_blocks_total",
+         "Number of blocks signed with the key of a witness of this node which this node did not produce" );
+   foreign_blocks.increment();
+   if( _pause_on_double_production && !_production_paused )
+   {
+      _production_paused = true;
+      elog( "Block production paused, restart the node once only one node produces with each key" );
+   }
+}
+
 void witness_plugin::schedule_production_loop()
 {
    //Schedule for the next second's tick regardless of chain state
@@ -201,6 +241,8 @@ block_production_condition::block_production_condition_enum witness_plugin::bloc
       case block_production_condition::exception_producing_block:
          elog( "exception producing block" );
          break;
+      case block_production_condition::paused:
+         break;
    }
 
    schedule_production_loop();
@@ -209,6 +251,9 @@ block_production_condition::block_production_condition_enum witness_plugin::bloc
 
 block_production_condition::block_production_condition_enum witness_plugin::maybe_produce_block( fc::limited_mutable_variant_object& capture )
 {
+   if( _production_paused )
+      return block_production_condition::paused;
+
    chain::database& db = database();
    fc::time_point now_fine = fc::time_point::now();
    fc::time_point_sec now = now_fine + fc::microseconds( 500000 );
@@ -272,24 +317,43 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
    }
    const auto& witness_name = db.get_account_by_uid( scheduled_witness ).name;
 
+   const fc::time_point deadline = fc::time_point( scheduled_time )
+                                 + fc::seconds( db.get_global_properties().parameters.block_interval )
+                                 - _broadcast_margin;
+
    int retry = 0;
    do
    {
       try
       {
+         _generating = true;
          auto block = db.generate_block(
             scheduled_time,
             scheduled_witness,
             private_key_itr->second,
-            _production_skip_flags
+            _production_skip_flags,
+            deadline
             );
+         _generating = false;
+         _produced_blocks[block.timestamp] = block.id();
+         while( _produced_blocks.size() > 1024 )
+            _produced_blocks.erase( _produced_blocks.begin() );
          capture("n", block.block_num())("t", block.timestamp)("c", now)("w",scheduled_witness)("wname",witness_name)("bid",block.id());
-         fc::async( [this,block](){ p2p_node().broadcast(net::block_message(block)); } );
+         fc::async( [this,block,scheduled_time](){
+            if( app().p2p_node() == nullptr )
+               return;
+            p2p_node().broadcast(net::block_message(block));
+            static auto& slot_to_broadcast = graphene::utilities::metrics_registry::instance().get_histogram(
+                  "graphene_witness_slot_to_broadcast_seconds",
+                  "Time from the start of a production slot until the produced block is handed to the p2p layer" );
+            slot_to_broadcast.observe( std::max( fc::time_point::now() - fc::time_point( scheduled_time ), fc::microseconds() ) );
+         } );
 
          return block_production_condition::produced;
       }
       catch( fc::exception& e )
       {
+         _generating = false;
          elog( "${e}", ("e",e.to_detail_string()) );
          elog( "Clearing pending transactions and attempting again" );
          db.clear_pending();
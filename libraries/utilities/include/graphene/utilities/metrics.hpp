@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <fc/time.hpp>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graphene { namespace utilities {
+
+   /** label name/value pairs of one time series, e.g. {{"method","get_accounts"}} */
+   typedef std::vector< std::pair<std::string, std::string> > metric_labels;
+
+   /** a monotonically increasing count */
+   class counter
+   {
+      public:
+         void     increment( uint64_t n = 1 ) { _value.fetch_add( n, std::memory_order_relaxed ); }
+         uint64_t value()const { return _value.load( std::memory_order_relaxed ); }
+      private:
+         std::atomic<uint64_t> _value{0};
+   };
+
+   /** a value which can go up and down */
+   class gauge
+   {
+      public:
+         void    set( int64_t v ) { _value.store( v, std::memory_order_relaxed ); }
+         int64_t value()const { return _value.load( std::memory_order_relaxed ); }
+      private:
+         std::atomic<int64_t> _value{0};
+   };
+
+   /** counts observations in cumulative buckets, with their sum */
+   class histogram
+   {
+      public:
+         /** bucket upper bounds from 0.5 ms to 10 s, for latencies in seconds */
+         static const std::vector<double>& latency_buckets();
+
+         explicit histogram( std::vector<double> upper_bounds );
+
+         void observe( double v );
+         void observe( const fc::microseconds& d ) { observe( double( d.count() ) / 1000000 ); }
+
+         const std::vector<double>& upper_bounds()const { return _upper_bounds; }
+         /** @return the number of observations in each bucket (not cumulative), the last one is +Inf */
+         std::vector<uint64_t> bucket_counts()const;
+         uint64_t count()const { return _count.load( std::memory_order_relaxed ); }
+         double   sum()const   { return _sum.load( std::memory_order_relaxed ); }
+
+      private:
+         std::vector<double>                       _upper_bounds;
+         std::unique_ptr< std::atomic<uint64_t>[] > _buckets;
+         std::atomic<uint64_t>                     _count{0};
+         std::atomic<double>                       _sum{0};
+   };
+
+   /**
+    *  @class metrics_registry
+    *  @brief process wide registry of the node's metrics, rendered in the Prometheus text exposition format
+    *
+    *  Metrics are created on first use and are never destroyed, so callers can keep references to them, e.g. in
+    *  a function local static. Updating a metric is lock free and can be done from any thread.
+    *
+    *  Values which are cheaper to read when scraped than to keep up to date (sizes of containers, the head block
+    *  number) are registered as callbacks, which are called from the thread that renders the metrics.
+    */
+   class metrics_registry
+   {
+      public:
+         static metrics_registry& instance();
+
+         counter&   get_counter( const std::string& name, const std::string& help,
+                                 const metric_labels& labels = metric_labels() );
+         gauge&     get_gauge( const std::string& name, const std::string& help,
+                               const metric_labels& labels = metric_labels() );
+         histogram& get_histogram( const std::string& name, const std::string& help,
+                                   const std::vector<double>& upper_bounds = histogram::latency_buckets(),
+                                   const metric_labels& labels = metric_labels() );
+
+         /** registers a gauge whose value is read by calling @ref fn, until @ref remove_callbacks( owner ) */
+         void add_callback_gauge( const void* owner, const std::string& name, const std::string& help,
+                                  std::function<double()> fn, const metric_labels& labels = metric_labels() );
+         /** once this returns, the callbacks of @ref owner are not running and will not be called again */
+         void remove_callbacks( const void* owner );
+
+         /** @return all metrics in the Prometheus text exposition format (version 0.0.4) */
+         std::string render_text()const;
+
+      private:
+         enum metric_type { counter_type, gauge_type, histogram_type };
+
+         struct callback_gauge
+         {
+            const void*             owner;
+            std::string             name;
+            std::string             help;
+            metric_labels           labels;
+            std::function<double()> fn;
+         };
+
+         struct family
+         {
+            metric_type                                         type;
+            std::string                                         help;
+            std::map< metric_labels, std::unique_ptr<counter> >   counters;
+            std::map< metric_labels, std::unique_ptr<gauge> >     gauges;
+            std::map< metric_labels, std::unique_ptr<histogram> > histograms;
+         };
+
+         family& get_family( const std::string& name, const std::string& help, metric_type type );
+
+         mutable std::mutex              _mutex;
+         /// held while the callbacks are called, taken before _mutex
+         mutable std::mutex              _callback_mutex;
+         std::map< std::string, family > _families;
+         std::vector< callback_gauge >   _callbacks;
+   };
+
+} } // graphene::utilities
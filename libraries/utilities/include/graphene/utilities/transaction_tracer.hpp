@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#pragma once
+
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/optional.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace graphene { namespace utilities {
+
+   /** when a traced transaction reached each stage of its lifecycle, a default time_point means not (yet) reached */
+   struct transaction_trace
+   {
+      fc::ripemd160   trx_id;
+      fc::time_point  received;        ///< first seen from the network or the API
+      fc::time_point  validated;       ///< first applied to the pending state
+      fc::time_point  last_reapplied;  ///< last re-applied to the pending state after a block
+      uint32_t        reapply_count = 0;
+      fc::time_point  advertised;      ///< first offered to peers
+      fc::time_point  included;        ///< first included in a produced or received block
+      uint32_t        block_num = 0;   ///< the block which includes it now
+      fc::time_point  irreversible;
+   };
+
+   /**
+    *  @class transaction_tracer
+    *  @brief records the lifecycle of a sample of the transactions seen by the node
+    *
+    *  A transaction is sampled when its ID, taken modulo the sample rate, is 0, so every component
+    *  agrees on which transactions are traced without looking them up. The traces are kept in a ring buffer
+    *  of fixed capacity, and the time from first seen to each stage goes to the graphene_trx_stage_seconds
+    *  histograms of the metrics registry.
+    *
+    *  Tracing is disabled by default, and costs a single atomic load at each hook then.
+    */
+   class transaction_tracer
+   {
+      public:
+         enum stage
+         {
+            received_stage,
+            validated_stage,
+            reapplied_stage,
+            advertised_stage,
+            included_stage
+         };
+
+         static transaction_tracer& instance();
+
+         /** @param sample_rate trace 1 in sample_rate transactions, 0 disables tracing */
+         void configure( uint32_t sample_rate, uint32_t capacity );
+
+         bool enabled()const { return _sample_rate.load( std::memory_order_relaxed ) != 0; }
+         bool is_sampled( const fc::ripemd160& trx_id )const;
+
+         /** records that a transaction reached a stage, @ref block_num is only used by included_stage */
+         void record( const fc::ripemd160& trx_id, stage s, uint32_t block_num = 0 );
+         /** records that the traced transactions included at or before @ref block_num became irreversible */
+         void record_irreversible( uint32_t block_num );
+
+         fc::optional<transaction_trace> get_trace( const fc::ripemd160& trx_id )const;
+         /** @return up to @ref limit traces, most recently started first */
+         std::vector<transaction_trace>  get_recent_traces( uint32_t limit )const;
+
+      private:
+         void observe( const char* stage_name, const transaction_trace& t, const fc::time_point& now )const;
+
+         std::atomic<uint32_t>                          _sample_rate{0};
+         mutable std::mutex                             _mutex;
+         std::vector<transaction_trace>                 _ring;
+         size_t                                         _capacity = 0;
+         size_t                                         _next = 0;
+         std::unordered_map<fc::ripemd160, size_t>      _by_id;
+         std::multimap<uint32_t, fc::ripemd160>         _awaiting_irreversible;
+   };
+
+} } // graphene::utilities
+
+FC_REFLECT( graphene::utilities::transaction_trace,
+            (trx_id)(received)(validated)(last_reapplied)(reapply_count)(advertised)(included)(block_num)(irreversible) )
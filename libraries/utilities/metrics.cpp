@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/utilities/metrics.hpp>
+
+#include <fc/exception/exception.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace graphene { namespace utilities {
+
+namespace {
+
+void write_escaped( std::ostream& out, const std::string& s, bool quotes )
+{
+   for( char c : s )
+   {
+      if( c == '\\' )
+         out << "\\\\";
+      else if( c == '\n' )
+         out << "\\n";
+      else if( quotes && c == '"' )
+         out << "\\\"";
+      else
+         out << c;
+   }
+}
+
+void write_labels( std::ostream& out, const metric_labels& labels,
+                   const char* extra_name = nullptr, const std::string& extra_value = std::string() )
+{
+   if( labels.empty() && extra_name == nullptr )
+      return;
+   out << '{';
+   bool first = true;
+   for( const auto& l : labels )
+   {
+      if( !first )
+         out << ',';
+      first = false;
+      out << l.first << "=\"";
+      write_escaped( out, l.second, true );
+      out << '"';
+   }
+   if( extra_name != nullptr )
+   {
+      if( !first )
+         out << ',';
+      out << extra_name << "=\"" << extra_value << '"';
+   }
+   out << '}';
+}
+
+void write_header( std::ostream& out, const std::string& name, const std::string& help, const char* type )
+{
+   out << "# HELP " << name << ' ';
+   write_escaped( out, help, false );
+   out << "\n# TYPE " << name << ' ' << type << '\n';
+}
+
+std::string format_bound( double v )
+{
+   std::ostringstream s;
+   s << v;
+   return s.str();
+}
+
+}
+
+const std::vector<double>& histogram::latency_buckets()
+{
+   static const std::vector<double> buckets{ 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                                             0.1, 0.25, 0.5, 1, 2.5, 5, 10 };
+   return buckets;
+}
+
+histogram::histogram( std::vector<double> upper_bounds )
+   : _upper_bounds( std::move( upper_bounds ) ),
+     _buckets( new std::atomic<uint64_t>[ _upper_bounds.size() + 1 ] )
+{
+   FC_ASSERT( std::is_sorted( _upper_bounds.begin(), _upper_bounds.end() ) );
+   for( size_t i = 0; i <= _upper_bounds.size(); ++i )
+      _buckets[i].store( 0 );
+}
+
+void histogram::observe( double v )
+{
+   const size_t bucket = std::lower_bound( _upper_bounds.begin(), _upper_bounds.end(), v ) - _upper_bounds.begin();
+   _buckets[bucket].fetch_add( 1, std::memory_order_relaxed );
+   _count.fetch_add( 1, std::memory_order_relaxed );
+   double sum = _sum.load( std::memory_order_relaxed );
+   while( !_sum.compare_exchange_weak( sum, sum + v, std::memory_order_relaxed ) );
+}
+
+std::vector<uint64_t> histogram::bucket_counts()const
+{
+   std::vector<uint64_t> result( _upper_bounds.size() + 1 );
+   for( size_t i = 0; i < result.size(); ++i )
+      result[i] = _buckets[i].load( std::memory_order_relaxed );
+   return result;
+}
+
+metrics_registry& metrics_registry::instance()
+{
+   // never destroyed, metrics may be updated by threads which outlive static destruction
+   static metrics_registry* registry = new metrics_registry();
+   return *registry;
+}
+
+metrics_registry::family& metrics_registry::get_family( const std::string& name, const std::string& help,
+                                                        metric_type type )
+{
+   auto itr = _families.find( name );
+   if( itr == _families.end() )
+   {
+      family& f = _families[name];
+      f.type = type;
+      f.help = help;
+      return f;
+   }
+   FC_ASSERT( itr->second.type == type, "Metric ${n} is already registered with another type", ("n",name) );
+   return itr->second;
+}
+
+counter& metrics_registry::get_counter( const std::string& name, const std::string& help,
+                                        const metric_labels& labels )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto& series = get_family( name, help, counter_type ).counters[labels];
+   if( !series )
+      series.reset( new counter() );
+   return *series;
+}
+
+gauge& metrics_registry::get_gauge( const std::string& name, const std::string& help,
+                                    const metric_labels& labels )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto& series = get_family( name, help, gauge_type ).gauges[labels];
+   if( !series )
+      series.reset( new gauge() );
+   return *series;
+}
+
+histogram& metrics_registry::get_histogram( const std::string& name, const std::string& help,
+                                            const std::vector<double>& upper_bounds, const metric_labels& labels )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto& series = get_family( name, help, histogram_type ).histograms[labels];
+   if( !series )
+      series.reset( new histogram( upper_bounds ) );
+   return *series;
+}
+
+void metrics_registry::add_callback_gauge( const void* owner, const std::string& name, const std::string& help,
+                                           std::function<double()> fn, const metric_labels& labels )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _callbacks.push_back( callback_gauge{ owner, name, help, labels, std::move( fn ) } );
+}
+
+void metrics_registry::remove_callbacks( const void* owner )
+{
+   // waits for render_text() to finish calling the callbacks it copied
+   std::lock_guard<std::mutex> calling( _callback_mutex );
+   std::lock_guard<std::mutex> lock( _mutex );
+   _callbacks.erase( std::remove_if( _callbacks.begin(), _callbacks.end(),
+                                     [owner]( const callback_gauge& c ) { return c.owner == owner; } ),
+                     _callbacks.end() );
+}
+
+std::string metrics_registry::render_text()const
+{
+   std::ostringstream out;
+   out.precision( 15 );
+   std::lock_guard<std::mutex> calling( _callback_mutex );
+   std::vector<callback_gauge> callbacks;
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      for( const auto& entry : _families )
+      {
+         const std::string& name = entry.first;
+         const family& f = entry.second;
+         switch( f.type )
+         {
+         case counter_type:
+            write_header( out, name, f.help, "counter" );
+            for( const auto& s : f.counters )
+            {
+               out << name;
+               write_labels( out, s.first );
+               out << ' ' << s.second->value() << '\n';
+            }
+            break;
+         case gauge_type:
+            write_header( out, name, f.help, "gauge" );
+            for( const auto& s : f.gauges )
+            {
+               out << name;
+               write_labels( out, s.first );
+               out << ' ' << s.second->value() << '\n';
+            }
+            break;
+         case histogram_type:
+            write_header( out, name, f.help, "histogram" );
+            for( const auto& s : f.histograms )
+            {
+               const histogram& h = *s.second;
+               const auto counts = h.bucket_counts();
+               uint64_t cumulative = 0;
+               for( size_t i = 0; i < counts.size(); ++i )
+               {
+                  cumulative += counts[i];
+                  out << name << "_bucket";
+                  write_labels( out, s.first, "le", i < h.upper_bounds().size() ? format_bound( h.upper_bounds()[i] ) : "+Inf" );
+                  out << ' ' << cumulative << '\n';
+               }
+               out << name << "_sum";
+               write_labels( out, s.first );
+               out << ' ' << h.sum() << '\n';
+               out << name << "_count";
+               write_labels( out, s.first );
+               out << ' ' << h.count() << '\n';
+            }
+            break;
+         }
+      }
+      callbacks = _callbacks;
+   }
+
+   // callbacks may need other threads which update metrics, don't hold _mutex while calling them;
+   // _callback_mutex keeps their owners from removing them meanwhile
+   std::stable_sort( callbacks.begin(), callbacks.end(),
+                     []( const callback_gauge& a, const callback_gauge& b ) { return a.name < b.name; } );
+   for( size_t i = 0; i < callbacks.size(); ++i )
+   {
+      const callback_gauge& c = callbacks[i];
+      if( i == 0 || callbacks[i-1].name != c.name )
+         write_header( out, c.name, c.help, "gauge" );
+      double value = 0;
+      try
+      {
+         value = c.fn();
+      }
+      catch( const fc::exception& )
+      {
+         continue;
+      }
+      out << c.name;
+      write_labels( out, c.labels );
+      out << ' ' << value << '\n';
+   }
+   return out.str();
+}
+
+} } // graphene::utilities
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <graphene/utilities/transaction_tracer.hpp>
+#include <graphene/utilities/metrics.hpp>
+
+namespace graphene { namespace utilities {
+
+transaction_tracer& transaction_tracer::instance()
+{
+   // never destroyed, the p2p thread may record into it during static destruction
+   static transaction_tracer* tracer = new transaction_tracer();
+   return *tracer;
+}
+
+void transaction_tracer::configure( uint32_t sample_rate, uint32_t capacity )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _ring.clear();
+   _ring.reserve( capacity );
+   _capacity = capacity;
+   _next = 0;
+   _by_id.clear();
+   _awaiting_irreversible.clear();
+   _sample_rate.store( capacity == 0 ? 0 : sample_rate );
+}
+
+bool transaction_tracer::is_sampled( const fc::ripemd160& trx_id )const
+{
+   const uint32_t rate = _sample_rate.load( std::memory_order_relaxed );
+   return rate != 0 && trx_id._hash[0] % rate == 0;
+}
+
+void transaction_tracer::observe( const char* stage_name, const transaction_trace& t, const fc::time_point& now )const
+{
+   const fc::time_point& start = t.received != fc::time_point() ? t.received : t.validated;
+   metrics_registry::instance().get_histogram( "graphene_trx_stage_seconds",
+         "Time from first seeing a traced transaction until it reached a stage",
+         histogram::latency_buckets(), { { "stage", stage_name } } ).observe( now - start );
+}
+
+void transaction_tracer::record( const fc::ripemd160& trx_id, stage s, uint32_t block_num )
+{
+   if( !is_sampled( trx_id ) )
+      return;
+   const fc::time_point now = fc::time_point::now();
+
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto itr = _by_id.find( trx_id );
+   if( itr == _by_id.end() )
+   {
+      // a trace starts when the node first sees the transaction, not when it sees it in a block
+      if( s != received_stage && s != validated_stage )
+         return;
+      if( _ring.size() < _capacity )
+         _ring.emplace_back();
+      else
+         _by_id.erase( _ring[_next].trx_id );
+      _ring[_next] = transaction_trace();
+      _ring[_next].trx_id = trx_id;
+      itr = _by_id.emplace( trx_id, _next ).first;
+      _next = ( _next + 1 ) % _capacity;
+   }
+
+   transaction_trace& t = _ring[itr->second];
+   switch( s )
+   {
+   case received_stage:
+      if( t.received == fc::time_point() )
+         t.received = now;
+      break;
+   case validated_stage:
+      if( t.validated == fc::time_point() )
+      {
+         t.validated = now;
+         observe( "validated", t, now );
+      }
+      break;
+   case reapplied_stage:
+      t.last_reapplied = now;
+      ++t.reapply_count;
+      observe( "reapplied", t, now );
+      break;
+   case advertised_stage:
+      if( t.advertised == fc::time_point() )
+      {
+         t.advertised = now;
+         observe( "advertised", t, now );
+      }
+      break;
+   case included_stage:
+      if( t.included == fc::time_point() )
+      {
+         t.included = now;
+         observe( "included", t, now );
+      }
+      // after a fork switch the transaction may be included in another block
+      if( t.block_num != block_num )
+      {
+         t.block_num = block_num;
+         _awaiting_irreversible.emplace( block_num, trx_id );
+      }
+      break;
+   }
+}
+
+void transaction_tracer::record_irreversible( uint32_t block_num )
+{
+   if( !enabled() )
+      return;
+   const fc::time_point now = fc::time_point::now();
+
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto end = _awaiting_irreversible.upper_bound( block_num );
+   for( auto itr = _awaiting_irreversible.begin(); itr != end; ++itr )
+   {
+      auto trace_itr = _by_id.find( itr->second );
+      if( trace_itr == _by_id.end() )
+         continue; // dropped from the ring buffer
+      transaction_trace& t = _ring[trace_itr->second];
+      if( t.block_num != itr->first || t.irreversible != fc::time_point() )
+         continue; // included in another block after a fork switch
+      t.irreversible = now;
+      observe( "irreversible", t, now );
+   }
+   _awaiting_irreversible.erase( _awaiting_irreversible.begin(), end );
+}
+
+fc::optional<transaction_trace> transaction_tracer::get_trace( const fc::ripemd160& trx_id )const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto itr = _by_id.find( trx_id );
+   if( itr == _by_id.end() )
+      return fc::optional<transaction_trace>();
+   return _ring[itr->second];
+}
+
+std::vector<transaction_trace> transaction_tracer::get_recent_traces( uint32_t limit )const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   std::vector<transaction_trace> result;
+   const size_t n = std::min<size_t>( limit, _ring.size() );
+   result.reserve( n );
+   for( size_t i = 1; i <= n; ++i )
+      result.push_back( _ring[ ( _next + _ring.size() - i ) % _ring.size() ] );
+   return result;
+}
+
+} } // graphene::utilities
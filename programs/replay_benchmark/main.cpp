@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+/**
+ * Replays a range of the block log of a node into a fresh database and reports how long each block took to apply,
+ * split into the steps of block application, as JSON. Blocks before --start-block are applied without being
+ * measured, to bring the state up to the range.
+ */
+
+#include <graphene/chain/database.hpp>
+#include <graphene/egenesis/egenesis.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+#include <fc/smart_ref_impl.hpp>
+#include <fc/variant_object.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace graphene::chain;
+namespace bpo = boost::program_options;
+
+namespace {
+
+struct block_sample
+{
+   uint32_t            block_num = 0;
+   uint32_t            transactions = 0;
+   uint32_t            operations = 0;
+   fc::microseconds    total;
+   block_apply_profile steps;
+};
+
+const std::map<std::string, uint32_t>& skip_flag_names()
+{
+   static const std::map<std::string, uint32_t> names = {
+      { "witness_signature",      database::skip_witness_signature },
+      { "transaction_signatures", database::skip_transaction_signatures },
+      { "transaction_dupe_check", database::skip_transaction_dupe_check },
+      { "fork_db",                database::skip_fork_db },
+      { "block_size_check",       database::skip_block_size_check },
+      { "tapos_check",            database::skip_tapos_check },
+      { "authority_check",        database::skip_authority_check },
+      { "merkle_check",           database::skip_merkle_check },
+      { "assert_evaluation",      database::skip_assert_evaluation },
+      { "undo_history_check",     database::skip_undo_history_check },
+      { "witness_schedule_check", database::skip_witness_schedule_check },
+      { "invariants_check",       database::skip_invariants_check },
+      { "validate",               database::skip_validate }
+   };
+   return names;
+}
+
+uint32_t parse_skip_flags( const std::vector<std::string>& names )
+{
+   uint32_t skip = database::skip_nothing;
+   for( const auto& name : names )
+   {
+      if( name == "none" )
+         continue;
+      auto itr = skip_flag_names().find( name );
+      FC_ASSERT( itr != skip_flag_names().end(), "Unknown skip flag ${n}", ("n",name) );
+      skip |= itr->second;
+   }
+   return skip;
+}
+
+genesis_state_type load_genesis( const bpo::variables_map& options )
+{
+   if( options.count("genesis-json") )
+   {
+      std::string genesis_str;
+      fc::read_file_contents( options.at("genesis-json").as<boost::filesystem::path>(), genesis_str );
+      genesis_state_type genesis = fc::json::from_string( genesis_str ).as<genesis_state_type>( 20 );
+      genesis.initial_chain_id = fc::sha256::hash( genesis_str );
+      return genesis;
+   }
+   std::string egenesis_json;
+   graphene::egenesis::compute_egenesis_json( egenesis_json );
+   FC_ASSERT( egenesis_json != "", "No genesis state is compiled in, use --genesis-json" );
+   genesis_state_type genesis = fc::json::from_string( egenesis_json ).as<genesis_state_type>( 20 );
+   genesis.initial_chain_id = fc::sha256::hash( egenesis_json );
+   return genesis;
+}
+
+/// percentiles in microseconds of one step over all measured blocks
+fc::mutable_variant_object summarize( std::vector<int64_t> values )
+{
+   fc::mutable_variant_object result;
+   if( values.empty() )
+      return result;
+   std::sort( values.begin(), values.end() );
+   auto percentile = [&values]( double p ) {
+      return values[ std::min<size_t>( values.size() - 1, size_t( p * values.size() ) ) ];
+   };
+   int64_t sum = 0;
+   for( int64_t v : values )
+      sum += v;
+   result( "total_us", sum )
+         ( "mean_us", sum / int64_t( values.size() ) )
+         ( "p50_us", percentile( 0.5 ) )
+         ( "p90_us", percentile( 0.9 ) )
+         ( "p99_us", percentile( 0.99 ) )
+         ( "p999_us", percentile( 0.999 ) )
+         ( "max_us", values.back() );
+   return result;
+}
+
+fc::mutable_variant_object to_variant_object( const block_sample& s )
+{
+   fc::mutable_variant_object result;
+   result( "block_num", s.block_num )
+         ( "transactions", s.transactions )
+         ( "operations", s.operations )
+         ( "total_us", s.total.count() )
+         ( "header_us", s.steps.header.count() )
+         ( "authorities_us", s.steps.authorities.count() )
+         ( "evaluation_us", s.steps.evaluation.count() )
+         ( "maintenance_us", s.steps.maintenance.count() )
+         ( "undo_us", s.steps.undo.count() )
+         ( "notifications_us", s.steps.notifications.count() );
+   return result;
+}
+
+}
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description options_desc( "Replays blocks of a node's block log and reports per-block timings" );
+      options_desc.add_options()
+         ("help,h", "Print this help message and exit.")
+         ("data-dir,d", bpo::value<boost::filesystem::path>()->default_value("yoyow_node_data_dir"),
+          "Data directory of the node whose block log is replayed, it is only read")
+         ("genesis-json", bpo::value<boost::filesystem::path>(), "File to read the genesis state from, instead of the built-in one")
+         ("start-block", bpo::value<uint32_t>()->default_value(1),
+          "First block to measure, the blocks before it are applied without being measured")
+         ("end-block", bpo::value<uint32_t>(), "Last block to measure, the last block of the block log by default")
+         ("skip", bpo::value< std::vector<std::string> >()->multitoken()->default_value( std::vector<std::string>{
+               "witness_signature", "transaction_signatures", "transaction_dupe_check", "tapos_check",
+               "witness_schedule_check", "invariants_check", "authority_check" }, "the skip flags of a reindex" ),
+          "Validation steps to skip, e.g. --skip none to validate everything")
+         ("undo", "Push the measured blocks in undo sessions, as a synced node does, instead of applying them as a reindex does")
+         ("slowest", bpo::value<uint32_t>()->default_value(20), "Number of the slowest blocks to list")
+         ("output,o", bpo::value<boost::filesystem::path>(), "File to write the JSON report to, instead of stdout")
+         ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line( argc, argv, options_desc ), options );
+      }
+      catch( const boost::program_options::error& e )
+      {
+         std::cerr << "Error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") )
+      {
+         std::cout << options_desc << "\n";
+         return 0;
+      }
+
+      const uint32_t skip = parse_skip_flags( options.at("skip").as< std::vector<std::string> >() );
+      const bool use_undo = options.count("undo") != 0;
+
+      block_database source;
+      source.open( fc::path( options.at("data-dir").as<boost::filesystem::path>() ) / "blockchain" / "database" / "block_num_to_block",
+                   true );
+      optional<signed_block> last_block = source.last();
+      FC_ASSERT( last_block.valid(), "The block log is empty" );
+
+      const uint32_t start_block = std::max<uint32_t>( options.at("start-block").as<uint32_t>(), 1 );
+      const uint32_t end_block = options.count("end-block") ? std::min( options.at("end-block").as<uint32_t>(), last_block->block_num() )
+                                                            : last_block->block_num();
+      FC_ASSERT( start_block <= end_block, "Nothing to measure, the block log ends at block ${n}", ("n",last_block->block_num()) );
+
+      fc::temp_directory state_dir( graphene::utilities::temp_directory_path() );
+      database db;
+      db.open( state_dir.path(), [&options]() { return load_genesis( options ); }, "replay_benchmark" );
+
+      auto fetch = [&source]( uint32_t block_num ) {
+         optional<signed_block> block = source.fetch_by_number( block_num );
+         FC_ASSERT( block.valid(), "Block ${n} is missing from the block log", ("n",block_num) );
+         return *block;
+      };
+
+      std::cerr << "Applying blocks 1 to " << start_block - 1 << " without measuring\n";
+      for( uint32_t i = db.head_block_num() + 1; i < start_block; ++i )
+      {
+         if( i % 10000 == 0 )
+            std::cerr << "   " << i << " of " << start_block - 1 << "\n";
+         db.apply_block( fetch( i ), skip );
+      }
+
+      std::cerr << "Measuring blocks " << start_block << " to " << end_block << "\n";
+      std::vector<block_sample> samples;
+      samples.reserve( end_block - start_block + 1 );
+      db.set_block_apply_profiling( true );
+      db.take_block_apply_profile();
+      fc::microseconds measured_time;
+      uint64_t total_transactions = 0;
+      uint64_t total_operations = 0;
+      for( uint32_t i = start_block; i <= end_block; ++i )
+      {
+         if( i % 10000 == 0 )
+            std::cerr << "   " << i << " of " << end_block << "\n";
+         const signed_block block = fetch( i );
+
+         const fc::time_point start = fc::time_point::now();
+         if( use_undo )
+            db.push_block( block, skip );
+         else
+            db.apply_block( block, skip );
+         block_sample s;
+         s.total = fc::time_point::now() - start;
+         s.steps = db.take_block_apply_profile();
+         s.block_num = i;
+         s.transactions = block.transactions.size();
+         for( const auto& trx : block.transactions )
+            s.operations += trx.operations.size();
+
+         measured_time += s.total;
+         total_transactions += s.transactions;
+         total_operations += s.operations;
+         samples.push_back( s );
+      }
+
+      auto step_values = [&samples]( const std::function<int64_t(const block_sample&)>& get ) {
+         std::vector<int64_t> values;
+         values.reserve( samples.size() );
+         for( const auto& s : samples )
+            values.push_back( get( s ) );
+         return values;
+      };
+      fc::mutable_variant_object steps;
+      steps( "total",         summarize( step_values( []( const block_sample& s ) { return s.total.count(); } ) ) )
+           ( "header",        summarize( step_values( []( const block_sample& s ) { return s.steps.header.count(); } ) ) )
+           ( "authorities",   summarize( step_values( []( const block_sample& s ) { return s.steps.authorities.count(); } ) ) )
+           ( "evaluation",    summarize( step_values( []( const block_sample& s ) { return s.steps.evaluation.count(); } ) ) )
+           ( "maintenance",   summarize( step_values( []( const block_sample& s ) { return s.steps.maintenance.count(); } ) ) )
+           ( "undo",          summarize( step_values( []( const block_sample& s ) { return s.steps.undo.count(); } ) ) )
+           ( "notifications", summarize( step_values( []( const block_sample& s ) { return s.steps.notifications.count(); } ) ) );
+
+      std::vector<block_sample> slowest = samples;
+      const size_t slowest_count = std::min<size_t>( options.at("slowest").as<uint32_t>(), slowest.size() );
+      std::partial_sort( slowest.begin(), slowest.begin() + slowest_count, slowest.end(),
+                         []( const block_sample& a, const block_sample& b ) { return a.total > b.total; } );
+      fc::variants slowest_blocks;
+      for( size_t i = 0; i < slowest_count; ++i )
+         slowest_blocks.emplace_back( to_variant_object( slowest[i] ) );
+
+      const double seconds = std::max<double>( double( measured_time.count() ) / 1000000, 1e-6 );
+      fc::mutable_variant_object report;
+      report( "start_block", start_block )
+            ( "end_block", end_block )
+            ( "skip_flags", skip )
+            ( "undo", use_undo )
+            ( "blocks", samples.size() )
+            ( "transactions", total_transactions )
+            ( "operations", total_operations )
+            ( "seconds", seconds )
+            ( "blocks_per_second", samples.size() / seconds )
+            ( "transactions_per_second", total_transactions / seconds )
+            ( "operations_per_second", total_operations / seconds )
+            ( "steps", steps )
+            ( "slowest_blocks", slowest_blocks );
+
+      const std::string json = fc::json::to_pretty_string( fc::variant( report ) );
+      if( options.count("output") )
+      {
+         std::ofstream out( options.at("output").as<boost::filesystem::path>().string() );
+         out << json << "\n";
+      }
+      else
+         std::cout << json << "\n";
+
+      db.close( false );
+      return 0;
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+   }
+   return 1;
+}
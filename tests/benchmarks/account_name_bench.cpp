@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/account_name_index.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <random>
+
+using graphene::app::name_trie;
+using graphene::chain::account_uid_type;
+
+namespace {
+
+/// @return resident set size in KiB, or 0 if it is not available on this platform
+uint64_t resident_kib()
+{
+   std::ifstream statm( "/proc/self/statm" );
+   uint64_t size = 0, resident = 0;
+   if( !( statm >> size >> resident ) )
+      return 0;
+   return resident * 4;
+}
+
+/// names made of syllables and digits, which share prefixes the way user chosen names do
+std::string random_name( std::mt19937& rng )
+{
+   static const char* syllables[] = { "an", "bo", "chi", "da", "el", "fu", "go", "han", "li", "ma", "no", "pe",
+                                      "qi", "ro", "shi", "ta", "wu", "xi", "yo", "zh" };
+   std::string name;
+   const uint32_t parts = 2 + rng() % 3;
+   for( uint32_t i = 0; i < parts; ++i )
+      name += syllables[ rng() % 20 ];
+   if( rng() % 2 )
+      name += std::to_string( rng() % 10000 );
+   return name;
+}
+
+uint32_t edit_distance( const std::string& a, const std::string& b, std::vector<uint32_t>& row, std::vector<uint32_t>& next )
+{
+   row.resize( b.size() + 1 );
+   next.resize( b.size() + 1 );
+   for( size_t j = 0; j <= b.size(); ++j )
+      row[j] = j;
+   for( size_t i = 1; i <= a.size(); ++i )
+   {
+      next[0] = i;
+      for( size_t j = 1; j <= b.size(); ++j )
+         next[j] = std::min( { next[j - 1] + 1, row[j] + 1, row[j - 1] + ( a[i - 1] == b[j - 1] ? 0u : 1u ) } );
+      row.swap( next );
+   }
+   return row[b.size()];
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( account_name_bench )
+{
+#ifdef NDEBUG
+   const uint32_t names   = 10000000;
+   const uint32_t queries = 100000;
+   const uint32_t scans   = 3;
+#else
+   const uint32_t names   = 200000;
+   const uint32_t queries = 10000;
+   const uint32_t scans   = 3;
+#endif
+   std::mt19937 rng( 11 );
+
+   uint64_t rss_before = resident_kib();
+   std::map<std::string, account_uid_type> ordered;
+   auto start = fc::time_point::now();
+   for( uint32_t i = 0; ordered.size() < names; ++i )
+      ordered.emplace( random_name( rng ), i );
+   auto elapsed = fc::time_point::now() - start;
+   ilog( "ordered index: inserted ${n} names in ${t} ms, RSS ${a} KiB -> ${b} KiB",
+         ("n",names)("t",elapsed.count() / 1000)("a",rss_before)("b",resident_kib()) );
+
+   rss_before = resident_kib();
+   name_trie trie;
+   start = fc::time_point::now();
+   for( const auto& e : ordered )
+      trie.insert( e.first, e.second );
+   elapsed = fc::time_point::now() - start;
+   ilog( "trie: inserted ${n} names in ${t} ms, ${k} nodes, RSS ${a} KiB -> ${b} KiB",
+         ("n",trie.size())("t",elapsed.count() / 1000)("k",trie.node_count())("a",rss_before)("b",resident_kib()) );
+
+   std::vector<std::string> prefixes;
+   prefixes.reserve( queries );
+   for( uint32_t i = 0; i < queries; ++i )
+   {
+      const std::string name = random_name( rng );
+      prefixes.push_back( name.substr( 0, 2 + rng() % 4 ) );
+   }
+
+   // prefix queries of 20 names, as an autocompletion box does
+   uint64_t hits = 0;
+   start = fc::time_point::now();
+   for( const auto& prefix : prefixes )
+   {
+      uint32_t n = 0;
+      for( auto itr = ordered.lower_bound( prefix );
+           n < 20 && itr != ordered.end() && itr->first.compare( 0, prefix.size(), prefix ) == 0; ++itr, ++n )
+         ++hits;
+   }
+   elapsed = fc::time_point::now() - start;
+   ilog( "ordered index: ${q} prefix queries in ${t} ms (${u} ns/query), ${h} hits",
+         ("q",queries)("t",elapsed.count() / 1000)("u",elapsed.count() * 1000 / queries)("h",hits) );
+
+   hits = 0;
+   start = fc::time_point::now();
+   for( const auto& prefix : prefixes )
+      hits += trie.find_by_prefix( prefix, 20 ).size();
+   elapsed = fc::time_point::now() - start;
+   ilog( "trie: ${q} prefix queries in ${t} ms (${u} ns/query), ${h} hits",
+         ("q",queries)("t",elapsed.count() / 1000)("u",elapsed.count() * 1000 / queries)("h",hits) );
+
+   // typo tolerant queries, the ordered index can only answer them with a full scan
+   std::vector<std::string> typos;
+   for( uint32_t i = 0; i < std::min<uint32_t>( queries, 1000 ); ++i )
+   {
+      std::string name = random_name( rng );
+      name[ rng() % name.size() ] = 'a' + rng() % 26;
+      typos.push_back( name );
+   }
+
+   std::vector<uint32_t> row, next;
+   hits = 0;
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < scans; ++i )
+      for( const auto& e : ordered )
+         if( edit_distance( typos[i], e.first, row, next ) <= 1 )
+            ++hits;
+   elapsed = fc::time_point::now() - start;
+   ilog( "ordered index: ${q} distance 1 queries by full scan in ${t} ms (${u} us/query), ${h} hits",
+         ("q",scans)("t",elapsed.count() / 1000)("u",elapsed.count() / scans)("h",hits) );
+
+   for( uint32_t max_distance = 1; max_distance <= 2; ++max_distance )
+   {
+      hits = 0;
+      fc::microseconds slowest;
+      start = fc::time_point::now();
+      for( const auto& typo : typos )
+      {
+         auto query_start = fc::time_point::now();
+         hits += trie.find_similar( typo, max_distance, 10 ).size();
+         slowest = std::max( slowest, fc::time_point::now() - query_start );
+      }
+      elapsed = fc::time_point::now() - start;
+      ilog( "trie: ${q} distance ${d} queries in ${t} ms (${u} us/query, slowest ${s} us), ${h} hits",
+            ("q",typos.size())("d",max_distance)("t",elapsed.count() / 1000)("u",elapsed.count() / typos.size())
+            ("s",slowest.count())("h",hits) );
+   }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/api_admission.hpp>
+#include <graphene/app/database_api.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+#include "../common/database_fixture.hpp"
+
+#include <algorithm>
+
+using namespace graphene::chain;
+using graphene::app::api_admission_config;
+using graphene::app::api_admission_controller;
+
+/**
+ * Many clients flood the node with expensive account lookups, which run on the thread which applies blocks, queued
+ * before each block. Measures the delay from the arrival of each block until it is applied, without admission control
+ * and with quotas which leave at most a quarter of the block interval to API calls.
+ */
+BOOST_FIXTURE_TEST_CASE( api_admission_bench, database_fixture )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t accounts = 2000;
+      const uint32_t clients = 100;
+      const uint32_t blocks = 20;
+#else
+      const uint32_t accounts = 200;
+      const uint32_t clients = 20;
+      const uint32_t blocks = 5;
+#endif
+      const uint32_t calls_per_client_per_block = 5;
+      // a block interval, shortened so that the benchmark runs quickly
+      const fc::microseconds interval = fc::milliseconds( 200 );
+
+      for( uint32_t i = 0; i < accounts; ++i )
+         create_account( 1000 + i, "bench" + fc::to_string( i ) );
+      generate_block();
+      graphene::app::database_api api( db );
+
+      for( bool controlled : { false, true } )
+      {
+         api_admission_config config;
+         if( controlled )
+         {
+            // all clients together get a quarter of the thread
+            config.quota_per_second = 250.0 / clients;
+            config.quota_burst = config.quota_per_second;
+         }
+         api_admission_controller admission( config );
+
+         fc::microseconds total_delay, max_delay;
+         uint64_t calls = 0, rejected = 0;
+         fc::time_point clock = fc::time_point::now();
+         for( uint32_t b = 0; b < blocks; ++b )
+         {
+            // the requests of the clients were received before the block, and are handled first
+            const fc::time_point block_received = fc::time_point::now();
+            for( uint32_t k = 0; k < calls_per_client_per_block; ++k )
+               for( uint32_t c = 0; c < clients; ++c )
+               {
+                  api_admission_controller::ticket ticket;
+                  // quotas refill with the simulated time, one interval per block
+                  if( admission.try_admit( fc::to_string( c ), "lookup_accounts_by_name", clock, ticket )
+                        != api_admission_controller::admitted )
+                  {
+                     ++rejected;
+                     continue;
+                  }
+                  const auto start = fc::time_point::now();
+                  api.lookup_accounts_by_name( "", 1000 );
+                  admission.finish( ticket, fc::time_point::now() - start );
+                  ++calls;
+               }
+            generate_block();
+            const auto delay = fc::time_point::now() - block_received;
+            total_delay += delay;
+            max_delay = std::max( max_delay, delay );
+            clock += interval;
+         }
+         ilog( "${m}: ${n} blocks, delay from arrival to applied ${a} us on average, ${x} us at most, "
+               "${c} calls run, ${r} refused, cost estimate ${e} ms",
+               ("m",controlled ? "admission control" : "no admission control")("n",blocks)
+               ("a",total_delay.count() / blocks)("x",max_delay.count())("c",calls)("r",rejected)
+               ("e",admission.cost_of( "lookup_accounts_by_name" )) );
+      }
+   } FC_LOG_AND_RETHROW()
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/applied_operation_log.hpp>
+#include <graphene/chain/protocol/block.hpp>
+#include <graphene/chain/protocol/content.hpp>
+#include <graphene/chain/protocol/transfer.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+using namespace graphene::chain;
+
+/**
+ * Measures logging the operations of a block of posts as they are applied, then copying them to the history objects,
+ * with each operation copied to the log as it used to be, and with the log referencing the operations of the block.
+ */
+BOOST_AUTO_TEST_CASE( applied_operation_log_bench )
+{
+#ifdef NDEBUG
+   const uint32_t operations = 10000;
+   const uint32_t blocks = 50;
+#else
+   const uint32_t operations = 1000;
+   const uint32_t blocks = 10;
+#endif
+   signed_block block;
+   for( uint32_t i = 0; i < operations; ++i )
+   {
+      post_operation op;
+      op.platform = 25600;
+      op.poster = 25638 + i;
+      op.post_pid = i;
+      op.title = "title " + fc::to_string( i );
+      op.body = std::string( 500, 'x' );
+      processed_transaction tx;
+      tx.operations.push_back( op );
+      block.transactions.push_back( std::move( tx ) );
+   }
+
+   uint64_t bytes = 0;
+   auto start = fc::time_point::now();
+   for( uint32_t b = 0; b < blocks; ++b )
+   {
+      vector<optional<operation_history_object>> log;
+      for( const auto& tx : block.transactions )
+         for( const auto& op : tx.operations )
+         {
+            log.emplace_back( operation_history_object( op ) );
+            log.back()->result = void_result();
+         }
+      for( const auto& o_op : log )
+      {
+         // the account history copied each entry into an optional, then into the object database
+         const optional<operation_history_object> oho( *o_op );
+         operation_history_object h;
+         h.op = oho->op;
+         bytes += h.op.get<post_operation>().body.size();
+      }
+   }
+   auto elapsed = fc::time_point::now() - start;
+   ilog( "copied operations: ${n} blocks of ${k} operations in ${t} ms (${u} us/block)",
+         ("n",blocks)("k",operations)("t",elapsed.count() / 1000)("u",elapsed.count() / blocks) );
+
+   applied_operation_log log;
+   start = fc::time_point::now();
+   for( uint32_t b = 0; b < blocks; ++b )
+   {
+      log.clear();
+      for( const auto& tx : block.transactions )
+         for( const auto& op : tx.operations )
+            log.push( op, true ).result = void_result();
+      for( const auto& a : log )
+      {
+         operation_history_object h;
+         a.copy_to( h );
+         bytes += h.op.get<post_operation>().body.size();
+      }
+   }
+   elapsed = fc::time_point::now() - start;
+   ilog( "referenced operations: ${n} blocks of ${k} operations in ${t} ms (${u} us/block), ${c} copies in the log",
+         ("n",blocks)("k",operations)("t",elapsed.count() / 1000)("u",elapsed.count() / blocks)("c",log.copied()) );
+   BOOST_CHECK_GT( bytes, 0u );
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/block_journal.hpp>
+#include <graphene/chain/impacted.hpp>
+#include <graphene/chain/protocol/content.hpp>
+#include <graphene/chain/protocol/transfer.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+using namespace graphene::chain;
+
+namespace {
+
+/// the applied operations of a block of transfers and posts
+void make_applied_ops( uint32_t transactions, applied_operation_log& ops )
+{
+   for( uint32_t i = 0; i < transactions; ++i )
+   {
+      operation o;
+      if( i % 2 == 0 )
+      {
+         transfer_operation op;
+         op.from = 25638 + i;
+         op.to = 25639 + i;
+         op.amount = asset( i + 1 );
+         o = op;
+      }
+      else
+      {
+         post_operation op;
+         op.platform = 25600;
+         op.poster = 25638 + i;
+         op.post_pid = i;
+         op.origin_poster = 25637 + i;
+         op.origin_platform = 25600;
+         op.origin_post_pid = i - 1;
+         o = op;
+      }
+      applied_operation& a = ops.push( o, false );
+      a.block_num = 100;
+      a.trx_in_block = i;
+      a.virtual_op = i;
+   }
+}
+
+}
+
+/**
+ * The account history, which creates an operation history object per operation, and the change notifications,
+ * which find the accounts of the new objects, both visited each operation of a block to find the accounts it
+ * concerns. Measures that work for blocks of transfers and posts, with each consumer visiting the operations, and with
+ * the block journal visiting them once.
+ */
+BOOST_AUTO_TEST_CASE( block_journal_bench )
+{
+#ifdef NDEBUG
+   const uint32_t transactions = 10000;
+   const uint32_t blocks = 50;
+#else
+   const uint32_t transactions = 1000;
+   const uint32_t blocks = 10;
+#endif
+   applied_operation_log applied;
+   make_applied_ops( transactions, applied );
+   // the history objects the account history creates for the block
+   vector<operation_history_object> history( applied.size() );
+   for( uint32_t i = 0; i < applied.size(); ++i )
+   {
+      applied[i].copy_to( history[i] );
+      history[i].id = operation_history_id_type( i );
+   }
+
+   uint64_t visits = 0, accounts = 0;
+   auto start = fc::time_point::now();
+   for( uint32_t b = 0; b < blocks; ++b )
+   {
+      for( const auto& a : applied )
+      {
+         flat_set<account_uid_type> impacted;
+         vector<authority> other;
+         operation_get_required_uid_authorities( *a.op, impacted, impacted, impacted, other );
+         operation_get_impacted_account_uids( *a.op, impacted );
+         accounts += impacted.size();
+         ++visits;
+      }
+      flat_set<account_uid_type> new_accounts;
+      for( const auto& h : history )
+      {
+         get_relevant_accounts( &h, new_accounts );
+         ++visits;
+      }
+      accounts += new_accounts.size();
+   }
+   auto elapsed = fc::time_point::now() - start;
+   ilog( "per consumer: ${n} blocks of ${k} operations in ${t} ms (${u} us/block), ${v} operation visits per block, ${a} accounts",
+         ("n",blocks)("k",applied.size())("t",elapsed.count() / 1000)("u",elapsed.count() / blocks)
+         ("v",visits / blocks)("a",accounts) );
+
+   visits = 0;
+   accounts = 0;
+   block_journal journal;
+   start = fc::time_point::now();
+   for( uint32_t b = 0; b < blocks; ++b )
+   {
+      journal.reset( 100 );
+      journal.add_operations( applied );
+      visits += applied.size();
+      for( const auto& jop : journal.operations )
+      {
+         flat_set<account_uid_type> impacted = jop.authorities;
+         impacted.insert( jop.impacted.begin(), jop.impacted.end() );
+         accounts += impacted.size();
+      }
+      for( const auto& h : history )
+         journal.add_created( &h );
+      accounts += journal.created_accounts.size();
+   }
+   elapsed = fc::time_point::now() - start;
+   ilog( "block journal: ${n} blocks of ${k} operations in ${t} ms (${u} us/block), ${v} operation visits per block, ${a} accounts",
+         ("n",blocks)("k",applied.size())("t",elapsed.count() / 1000)("u",elapsed.count() / blocks)
+         ("v",visits / blocks)("a",accounts) );
+}
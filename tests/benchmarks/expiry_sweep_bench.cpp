@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/transaction_object.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+#include "../common/database_fixture.hpp"
+
+#include <fstream>
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+namespace {
+
+/// @return resident set size in KiB, or 0 if it is not available on this platform
+uint64_t resident_kib()
+{
+   std::ifstream statm( "/proc/self/statm" );
+   uint64_t size = 0, resident = 0;
+   if( !( statm >> size >> resident ) )
+      return 0;
+   return resident * 4;
+}
+
+}
+
+/**
+ * Fills the transaction index with transactions expiring at the same second, as after a burst of traffic, then
+ * measures removing them in the undo session of a block, one by one as the expiry sweep used to, and as a range.
+ */
+BOOST_FIXTURE_TEST_CASE( expiry_sweep_bench, database_fixture )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t transactions = 200000;
+#else
+      const uint32_t transactions = 20000;
+#endif
+      auto& trx_idx = const_cast< primary_index<transaction_index>& >(
+                         db.get_index_type< primary_index<transaction_index> >() );
+      const auto& by_exp = trx_idx.indices().get<by_expiration>();
+      const fc::time_point_sec expiration = db.head_block_time() + 3600;
+
+      auto fill = [&]() {
+         auto session = db._undo_db.start_undo_session();
+         for( uint32_t i = 0; i < transactions; ++i )
+            db.create<transaction_object>( [&]( transaction_object& o ) {
+               o.trx.expiration = expiration;
+               o.trx.ref_block_prefix = i;
+               o.trx_id = o.trx.id();
+            });
+         session.commit();
+      };
+
+      for( uint32_t pass = 0; pass < 2; ++pass )
+      {
+         fill();
+         const uint64_t rss_before = resident_kib();
+         auto session = db._undo_db.start_undo_session();
+         auto start = fc::time_point::now();
+         size_t removed = 0;
+         if( pass == 0 )
+         {
+            while( !by_exp.empty() && by_exp.begin()->get_expiration() <= expiration )
+            {
+               db.remove( *by_exp.begin() );
+               ++removed;
+            }
+         }
+         else
+            removed = trx_idx.remove_range( by_exp.begin(), by_exp.upper_bound( expiration ) );
+         auto elapsed = fc::time_point::now() - start;
+         ilog( "${m}: removed ${n} expired transactions in ${t} ms (${u} ns/transaction), RSS ${a} KiB -> ${b} KiB",
+               ("m",pass == 0 ? "one by one" : "remove_range")("n",removed)("t",elapsed.count() / 1000)
+               ("u",elapsed.count() * 1000 / std::max<size_t>( removed, 1 ))("a",rss_before)("b",resident_kib()) );
+
+         start = fc::time_point::now();
+         session.undo();
+         elapsed = fc::time_point::now() - start;
+         ilog( "${m}: undone in ${t} ms", ("m",pass == 0 ? "one by one" : "remove_range")("t",elapsed.count() / 1000) );
+
+         // clear the transactions for the next pass
+         trx_idx.remove_range( by_exp.begin(), by_exp.upper_bound( expiration ) );
+      }
+   } FC_LOG_AND_RETHROW()
+}
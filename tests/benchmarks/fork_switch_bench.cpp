@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/protocol/transfer.hpp>
+#include <graphene/chain/validated_block_cache.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/smart_ref_impl.hpp>
+#include <fc/time.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+/**
+ * Two other nodes build competing branches of blocks full of signed transfers. The node receives its branch, then
+ * the blocks of the other branch one by one, the last one making it switch, then the first branch grows again and it
+ * switches back. Measures, for several depths of fork, the time to receive the other branch and the time of each
+ * switch, without and with the cache of the checked blocks.
+ */
+BOOST_FIXTURE_TEST_CASE( fork_switch_bench, database_fixture )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t accounts = 200;
+      const uint32_t transfers_per_block = 200;
+      const std::vector<uint32_t> depths = { 1, 4, 16, 32 };
+#else
+      const uint32_t accounts = 20;
+      const uint32_t transfers_per_block = 20;
+      const std::vector<uint32_t> depths = { 1, 4 };
+#endif
+      const uint32_t skip = database::skip_undo_history_check;
+
+      std::vector<fc::ecc::private_key> keys;
+      std::vector<account_uid_type> uids;
+      for( uint32_t i = 0; i < accounts; ++i )
+      {
+         keys.push_back( generate_private_key( "fork" + fc::to_string( i ) ) );
+         const account_object& acc = create_account( 2000 + i, "fork" + fc::to_string( i ),
+                                                     keys.back().get_public_key() );
+         fund( acc, asset( GRAPHENE_BLOCKCHAIN_PRECISION * 1000 ) );
+         uids.push_back( acc.uid );
+      }
+      generate_block();
+
+      // the nodes building the branches start from the same chain
+      fc::temp_directory first_dir( graphene::utilities::temp_directory_path() );
+      fc::temp_directory second_dir( graphene::utilities::temp_directory_path() );
+      database first_node, second_node;
+      first_node.open( first_dir.path(), [this]{ return genesis_state; }, "test" );
+      second_node.open( second_dir.path(), [this]{ return genesis_state; }, "test" );
+      for( uint32_t n = 1; n <= db.head_block_num(); ++n )
+      {
+         const signed_block b = *db.fetch_block_by_number( n );
+         first_node.push_block( b, ~0 );
+         second_node.push_block( b, ~0 );
+      }
+
+      uint32_t round = 0;
+      auto build = [&]( database& node, uint32_t blocks, uint32_t first_slot ) -> std::vector<signed_block>
+      {
+         std::vector<signed_block> result;
+         for( uint32_t k = 0; k < blocks; ++k )
+         {
+            ++round;
+            for( uint32_t t = 0; t < transfers_per_block; ++t )
+            {
+               const uint32_t from = ( t + round ) % accounts;
+               transfer_operation op;
+               op.from = uids[from];
+               op.to = uids[( from + 1 ) % accounts];
+               op.amount = asset( round );
+               signed_transaction tx;
+               tx.operations.push_back( op );
+               for( auto& o : tx.operations )
+                  node.current_fee_schedule().set_fee( o );
+               test::set_expiration( node, tx );
+               tx.sign( keys[from], node.get_chain_id() );
+               node.push_transaction( tx, database::skip_transaction_signatures );
+            }
+            const uint32_t slot = ( k == 0 ? first_slot : 1 );
+            result.push_back( node.generate_block( node.get_slot_time( slot ), node.get_scheduled_witness( slot ),
+                                                   init_account_priv_key, skip ) );
+            node.clear_pending();
+         }
+         return result;
+      };
+
+      for( uint32_t depth : depths )
+         for( bool cached : { false, true } )
+         {
+            db.set_validated_block_cache_size( cached ? 256 : 0 );
+            const std::vector<signed_block> mine = build( first_node, depth, 1 );
+            const std::vector<signed_block> theirs = build( second_node, depth + 1, 2 );
+            for( const auto& b : mine )
+               db.push_block( b, skip );
+
+            auto start = fc::time_point::now();
+            for( size_t i = 0; i + 1 < theirs.size(); ++i )
+               BOOST_CHECK( !db.push_block( theirs[i], skip ) );
+            const fc::microseconds received = fc::time_point::now() - start;
+
+            start = fc::time_point::now();
+            BOOST_CHECK( db.push_block( theirs.back(), skip ) );
+            const fc::microseconds switched = fc::time_point::now() - start;
+
+            const std::vector<signed_block> more = build( first_node, 2, 1 );
+            start = fc::time_point::now();
+            BOOST_CHECK( !db.push_block( more[0], skip ) );
+            BOOST_CHECK( db.push_block( more[1], skip ) );
+            const fc::microseconds switched_back = fc::time_point::now() - start;
+            BOOST_CHECK( db.head_block_id() == more[1].id() );
+
+            ilog( "${c}: fork of ${d} blocks of ${t} transfers, other branch received in ${r} us, "
+                  "switched to it in ${s} us, switched back in ${b} us",
+                  ("c",cached ? "cache" : "no cache")("d",depth)("t",transfers_per_block)
+                  ("r",received.count())("s",switched.count())("b",switched_back.count()) );
+
+            // the second node follows the chain again
+            for( size_t i = 0; i < theirs.size(); ++i )
+               second_node.pop_block();
+            second_node._popped_tx.clear();
+            second_node.clear_pending();
+            for( const auto& b : mine )
+               second_node.push_block( b, skip );
+            for( const auto& b : more )
+               second_node.push_block( b, skip );
+         }
+
+      first_node.close();
+      second_node.close();
+   } FC_LOG_AND_RETHROW()
+}
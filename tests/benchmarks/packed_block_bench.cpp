@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/protocol/packed_block.hpp>
+#include <graphene/chain/protocol/transfer.hpp>
+#include <graphene/net/core_messages.hpp>
+
+#include <fc/crypto/digest.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+using namespace graphene::chain;
+using graphene::net::block_message;
+using graphene::net::message;
+
+namespace {
+
+signed_block make_block( uint32_t transactions )
+{
+   const auto key = fc::ecc::private_key::regenerate( fc::sha256::hash( std::string( "bench" ) ) );
+   signed_block b;
+   b.timestamp = fc::time_point_sec( 1500000000 );
+   b.witness = 25638;
+   for( uint32_t i = 0; i < transactions; ++i )
+   {
+      transfer_operation op;
+      op.from = 25638 + i;
+      op.to = 25639 + i;
+      op.amount = asset( i + 1 );
+      op.fee = fee_type( asset( 2000 ) );
+      processed_transaction tx;
+      tx.operations.push_back( op );
+      tx.ref_block_num = i;
+      tx.expiration = b.timestamp + 60;
+      tx.operation_results.push_back( void_result() );
+      tx.signatures.push_back( key.sign_compact( fc::sha256::hash( std::to_string( i ) ) ) );
+      b.transactions.push_back( std::move( tx ) );
+   }
+   b.transaction_merkle_root = b.calculate_merkle_root();
+   b.sign( key );
+   return b;
+}
+
+}
+
+/**
+ * Measures what a node does with a block received from a peer besides applying it: decoding the message, computing
+ * the ID of the block, storing it in the block database and serving it to the next peer. Blocks used to be packed
+ * again to be stored and relayed, packed_block reuses the received bytes.
+ */
+BOOST_AUTO_TEST_CASE( packed_block_bench )
+{
+#ifdef NDEBUG
+   const uint32_t transactions = 2000;
+   const uint32_t rounds = 200;
+#else
+   const uint32_t transactions = 200;
+   const uint32_t rounds = 20;
+#endif
+   const message received = block_message( make_block( transactions ) );
+   const uint64_t header_size = fc::raw::pack_size( signed_block_header() );
+
+   uint64_t serialized = 0;
+   auto start = fc::time_point::now();
+   for( uint32_t i = 0; i < rounds; ++i )
+   {
+      const block_message m = received.as<block_message>();
+      // the fork database, the dynamic global properties and the block summary each compute the ID
+      for( uint32_t j = 0; j < 3; ++j )
+         BOOST_CHECK( m.block.id() == m.block_id );
+      serialized += 3 * header_size;
+      const std::vector<char> stored = fc::raw::pack( m.block );
+      serialized += stored.size();
+      const message relayed = block_message( fc::raw::unpack<signed_block>( stored ) );
+      serialized += relayed.data.size();
+   }
+   auto elapsed = fc::time_point::now() - start;
+   ilog( "signed_block: ${n} blocks of ${k} bytes in ${t} ms (${u} us/block), ${s} bytes serialized per block",
+         ("n",rounds)("k",received.data.size())("t",elapsed.count() / 1000)("u",elapsed.count() / rounds)
+         ("s",serialized / rounds) );
+
+   uint64_t copied = 0;
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < rounds; ++i )
+   {
+      const block_message m = block_message::from_message( received );
+      BOOST_REQUIRE( m.packed );
+      BOOST_CHECK( m.packed->id() == m.block_id );
+      copied += m.packed->bytes().size();
+      // stored as they are, and read back without decoding the transactions
+      const packed_block stored( m.packed->bytes() );
+      copied += stored.bytes().size();
+      const message relayed = block_message::to_message( stored );
+      copied += relayed.data.size();
+      BOOST_CHECK( relayed.data == received.data );
+   }
+   elapsed = fc::time_point::now() - start;
+   ilog( "packed_block: ${n} blocks of ${k} bytes in ${t} ms (${u} us/block), 0 bytes serialized and ${c} bytes copied per block",
+         ("n",rounds)("k",received.data.size())("t",elapsed.count() / 1000)("u",elapsed.count() / rounds)
+         ("c",copied / rounds) );
+}
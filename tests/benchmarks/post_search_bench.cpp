@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/post_search/search_index.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <random>
+
+using namespace graphene::post_search;
+
+namespace {
+
+/// @return resident set size in KiB, or 0 if it is not available on this platform
+uint64_t resident_kib()
+{
+   std::ifstream statm( "/proc/self/statm" );
+   uint64_t size = 0, resident = 0;
+   if( !( statm >> size >> resident ) )
+      return 0;
+   return resident * 4;
+}
+
+/// draws words from a vocabulary with a Zipf-like distribution, like words of natural text
+class word_source
+{
+   public:
+      word_source( uint32_t vocabulary, uint32_t seed ) : _rng( seed )
+      {
+         std::vector<double> weights( vocabulary );
+         for( uint32_t i = 0; i < vocabulary; ++i )
+            weights[i] = 1.0 / ( i + 1 );
+         _dist = std::discrete_distribution<uint32_t>( weights.begin(), weights.end() );
+      }
+
+      static std::string word( uint32_t rank ) { return "w" + std::to_string( rank ); }
+
+      std::string next_text( uint32_t words )
+      {
+         std::string text;
+         for( uint32_t i = 0; i < words; ++i )
+         {
+            text += word( _dist( _rng ) );
+            text += ' ';
+         }
+         return text;
+      }
+
+      std::mt19937& rng() { return _rng; }
+
+   private:
+      std::mt19937                             _rng;
+      std::discrete_distribution<uint32_t>     _dist;
+};
+
+}
+
+BOOST_AUTO_TEST_CASE( post_search_bench )
+{
+#ifdef NDEBUG
+   const uint32_t posts   = 3000000;
+   const uint32_t queries = 2000;
+#else
+   const uint32_t posts   = 50000;
+   const uint32_t queries = 200;
+#endif
+   const uint32_t platforms = 10;
+   word_source words( 50000, 42 );
+
+   post_search_index index;
+   const uint64_t rss_before = resident_kib();
+   auto start = fc::time_point::now();
+   search_document doc;
+   for( uint32_t i = 0; i < posts; ++i )
+   {
+      doc.post_instance = i;
+      doc.platform = 1000 + i % platforms;
+      doc.create_time = fc::time_point_sec( 1500000000 + i * 3 );
+      doc.title = words.next_text( 8 );
+      doc.body = words.next_text( 60 + words.rng()() % 200 );
+      doc.extra_data = "{\"category\":\"c" + std::to_string( words.rng()() % 20 ) + "\",\"tags\":[\"t"
+                       + std::to_string( words.rng()() % 500 ) + "\",\"t" + std::to_string( words.rng()() % 500 ) + "\"]}";
+      index.add( doc );
+   }
+   auto elapsed = fc::time_point::now() - start;
+   const auto stats = index.get_stats();
+   ilog( "indexed ${n} posts in ${t} ms (${r} posts/s): ${l} posting lists, ${p} postings, estimated ${m} MiB, RSS ${a} KiB -> ${b} KiB",
+         ("n",posts)("t",elapsed.count() / 1000)("r",elapsed.count() > 0 ? uint64_t( posts ) * 1000000 / elapsed.count() : 0)
+         ("l",stats.posting_lists)("p",stats.postings)("m",stats.memory_bytes >> 20)
+         ("a",rss_before)("b",resident_kib()) );
+
+   auto run_queries = [&]( const char* label, const std::function<std::string()>& make_query ) {
+      uint64_t hits = 0;
+      fc::microseconds slowest;
+      auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < queries; ++i )
+      {
+         const std::string query = make_query();
+         auto query_start = fc::time_point::now();
+         auto page = index.search( 1000 + i % platforms, query, 20 );
+         if( !page.empty() )
+            page = index.search( 1000 + i % platforms, query, 20, page.back() );
+         slowest = std::max( slowest, fc::time_point::now() - query_start );
+         hits += page.size();
+      }
+      auto elapsed = fc::time_point::now() - start;
+      ilog( "${l}: ${n} queries of 2 pages in ${t} ms (${q} us/query, slowest ${s} us), ${h} hits on second pages",
+            ("l",label)("n",queries)("t",elapsed.count() / 1000)("q",elapsed.count() / queries)
+            ("s",slowest.count())("h",hits) );
+   };
+
+   std::mt19937 rng( 7 );
+   run_queries( "common word", [&]() { return word_source::word( rng() % 10 ); } );
+   run_queries( "rare word", [&]() { return word_source::word( 10000 + rng() % 40000 ); } );
+   run_queries( "two words", [&]() { return word_source::word( rng() % 100 ) + " " + word_source::word( rng() % 1000 ); } );
+   run_queries( "tag and word", [&]() { return "#t" + std::to_string( rng() % 500 ) + " " + word_source::word( rng() % 100 ); } );
+
+   // undoing the most recent posts, as popping blocks does
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < 10000 && i < posts; ++i )
+      index.remove( posts - 1 - i );
+   elapsed = fc::time_point::now() - start;
+   ilog( "removed the 10000 newest posts in ${t} ms", ("t",elapsed.count() / 1000) );
+}
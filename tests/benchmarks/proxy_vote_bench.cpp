@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/witness_object.hpp>
+
+#include <fc/smart_ref_impl.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+
+/**
+ * Builds a two-level proxy tree whose root votes for all active witnesses, then measures applying
+ * blocks full of transfers between the leaves. Every transfer changes the votes of two leaf voters,
+ * which used to be fanned out to every witness voted by the root each time.
+ */
+BOOST_FIXTURE_TEST_CASE( proxy_vote_bench, database_fixture )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t proxies = 100;
+      const uint32_t voters_per_proxy = 200;
+      const uint32_t blocks_to_produce = 20;
+#else
+      const uint32_t proxies = 10;
+      const uint32_t voters_per_proxy = 20;
+      const uint32_t blocks_to_produce = 5;
+#endif
+      const uint32_t transfers_per_block = proxies * voters_per_proxy / 2;
+
+      const auto& params = db.get_global_properties().parameters;
+      const asset voting_balance( params.min_governance_voting_balance * 2 );
+
+      auto make_voter = [&]( uint32_t seed, account_uid_type proxy ) -> account_uid_type
+      {
+         const account_object& acc = create_account( seed, "voter" + fc::to_string( seed ) );
+         fund( acc, voting_balance );
+         if( proxy == GRAPHENE_PROXY_TO_SELF_ACCOUNT_UID )
+         {
+            witness_vote_update_operation op;
+            op.voter = acc.uid;
+            for( const auto& w : db.get_global_properties().active_witnesses )
+               op.witnesses_to_add.insert( w.first );
+            trx.operations.push_back( op );
+         }
+         else
+         {
+            account_update_proxy_operation op;
+            op.voter = acc.uid;
+            op.proxy = proxy;
+            trx.operations.push_back( op );
+         }
+         test::set_expiration( db, trx );
+         db.push_transaction( trx, ~0 );
+         trx.clear();
+         return acc.uid;
+      };
+
+      uint32_t seed = 1000;
+      const account_uid_type root = make_voter( seed++, GRAPHENE_PROXY_TO_SELF_ACCOUNT_UID );
+      vector<account_uid_type> leaves;
+      for( uint32_t i = 0; i < proxies; ++i )
+      {
+         const account_uid_type proxy = make_voter( seed++, root );
+         for( uint32_t j = 0; j < voters_per_proxy; ++j )
+            leaves.push_back( make_voter( seed++, proxy ) );
+      }
+      generate_block();
+      ilog( "Built a proxy tree with ${p} proxies and ${v} leaf voters", ("p",proxies)("v",leaves.size()) );
+
+      fc::microseconds push_time;
+      fc::microseconds apply_time;
+      for( uint32_t b = 0; b < blocks_to_produce; ++b )
+      {
+         auto start = fc::time_point::now();
+         for( uint32_t i = 0; i < transfers_per_block; ++i )
+         {
+            const auto from = leaves[ ( i * 2 + b ) % leaves.size() ];
+            const auto to   = leaves[ ( i * 2 + b + 1 ) % leaves.size() ];
+            transfer( from, to, asset( GRAPHENE_BLOCKCHAIN_PRECISION ) );
+         }
+         auto pushed = fc::time_point::now();
+         generate_block();
+         auto applied = fc::time_point::now();
+         push_time += pushed - start;
+         apply_time += applied - pushed;
+      }
+
+      ilog( "Pushed ${n} transfers in ${t} ms, produced and applied ${b} blocks in ${a} ms",
+            ("n",transfers_per_block * blocks_to_produce)("t",push_time.count() / 1000)
+            ("b",blocks_to_produce)("a",apply_time.count() / 1000) );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
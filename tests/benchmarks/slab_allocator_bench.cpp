@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/db/slab_allocator.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/time.hpp>
+
+#include <fstream>
+#include <random>
+
+using namespace graphene::db;
+using namespace boost::multi_index;
+
+namespace {
+
+struct churn_object
+{
+   uint64_t            id = 0;
+   uint64_t            expiration = 0;
+   uint64_t            owner = 0;
+   std::vector<char>   payload; // variable sized heap allocations interleaved with the nodes, like a packed transaction
+};
+
+struct by_id;
+struct by_expiration;
+struct by_owner;
+
+template<typename Allocator>
+using churn_container = multi_index_container<
+   churn_object,
+   indexed_by<
+      ordered_unique< tag<by_id>, member< churn_object, uint64_t, &churn_object::id > >,
+      ordered_non_unique< tag<by_expiration>, member< churn_object, uint64_t, &churn_object::expiration > >,
+      ordered_non_unique< tag<by_owner>, member< churn_object, uint64_t, &churn_object::owner > >
+   >,
+   Allocator
+>;
+
+/// @return resident set size in KiB, or 0 if it is not available on this platform
+uint64_t resident_kib()
+{
+   std::ifstream statm( "/proc/self/statm" );
+   uint64_t size = 0, resident = 0;
+   if( !( statm >> size >> resident ) )
+      return 0;
+   return resident * 4;
+}
+
+/**
+ * Keeps live_objects objects in the container and replaces the oldest ones in every round,
+ * the same pattern as transactions expiring while new ones are pushed.
+ */
+template<typename Container>
+void run_churn( const char* label, slab_pool& pool, uint32_t live_objects, uint32_t rounds, uint32_t per_round )
+{
+   std::mt19937 rng( 42 );
+   std::uniform_int_distribution<uint32_t> payload_size( 100, 2000 );
+   Container c( typename Container::ctor_args_list(),
+                pool_allocator<typename Container::allocator_type>::make( &pool ) );
+   uint64_t next_id = 0;
+   auto make = [&]() {
+      churn_object o;
+      o.id = next_id++;
+      o.expiration = o.id;
+      o.owner = rng() % 10000;
+      o.payload.resize( payload_size( rng ) );
+      return o;
+   };
+
+   for( uint32_t i = 0; i < live_objects; ++i )
+      c.insert( make() );
+
+   const uint64_t rss_before = resident_kib();
+   auto start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+   {
+      auto& by_exp = c.template get<by_expiration>();
+      for( uint32_t i = 0; i < per_round; ++i )
+         by_exp.erase( by_exp.begin() );
+      for( uint32_t i = 0; i < per_round; ++i )
+         c.insert( make() );
+   }
+   auto elapsed = fc::time_point::now() - start;
+   const uint64_t ops = uint64_t( rounds ) * per_round * 2;
+
+   ilog( "${l}: ${n} creates+removes in ${t} ms (${r} ops/s), RSS ${a} KiB -> ${b} KiB",
+         ("l",label)("n",ops)("t",elapsed.count() / 1000)
+         ("r",elapsed.count() > 0 ? ops * 1000000 / elapsed.count() : 0)
+         ("a",rss_before)("b",resident_kib()) );
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( slab_allocator_churn_bench )
+{
+#ifdef NDEBUG
+   const uint32_t live_objects = 500000;
+   const uint32_t rounds       = 2000;
+   const uint32_t per_round    = 5000;
+#else
+   const uint32_t live_objects = 20000;
+   const uint32_t rounds       = 100;
+   const uint32_t per_round    = 1000;
+#endif
+
+   slab_pool pool( "churn_object" );
+   run_churn< churn_container< std::allocator<churn_object> > >( "std::allocator", pool, live_objects, rounds, per_round );
+   run_churn< churn_container< slab_allocator<churn_object> > >( "slab_allocator", pool, live_objects, rounds, per_round );
+
+   const slab_pool_stats& s = pool.get_stats();
+   ilog( "pool ${t}: slot ${s} bytes, ${n} slabs, ${u} in use, peak ${p}",
+         ("t",s.object_type)("s",s.slot_size)("n",s.slabs)("u",s.in_use)("p",s.peak_in_use) );
+}
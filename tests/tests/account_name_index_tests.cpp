@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+
+#include <graphene/app/account_name_index.hpp>
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( account_name_index_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( name_trie_test )
+{
+   using graphene::app::name_trie;
+   using graphene::app::account_name_match;
+
+   auto edit_distance = []( const std::string& a, const std::string& b ) {
+      std::vector<uint32_t> row( b.size() + 1 ), next( b.size() + 1 );
+      for( size_t j = 0; j <= b.size(); ++j )
+         row[j] = j;
+      for( size_t i = 1; i <= a.size(); ++i )
+      {
+         next[0] = i;
+         for( size_t j = 1; j <= b.size(); ++j )
+            next[j] = std::min( { next[j - 1] + 1, row[j] + 1, row[j - 1] + ( a[i - 1] == b[j - 1] ? 0u : 1u ) } );
+         row.swap( next );
+      }
+      return row[b.size()];
+   };
+
+   // names over a small alphabet share many prefixes, so edges are split and merged a lot
+   std::mt19937 rng( 5 );
+   auto random_name = [&rng]() {
+      static const char alphabet[] = "abc-";
+      std::string name( 1 + rng() % 6, 'a' );
+      for( char& c : name )
+         c = alphabet[ rng() % 4 ];
+      return name;
+   };
+
+   name_trie trie;
+   std::map<std::string, account_uid_type> expected;
+   for( uint32_t round = 0; round < 3000; ++round )
+   {
+      const std::string name = random_name();
+      if( rng() % 3 == 0 )
+      {
+         BOOST_CHECK_EQUAL( trie.remove( name ), expected.erase( name ) == 1 );
+      }
+      else
+      {
+         trie.insert( name, round );
+         expected[name] = round;
+      }
+   }
+   BOOST_REQUIRE_EQUAL( trie.size(), expected.size() );
+   BOOST_CHECK( trie.node_count() <= 2 * expected.size() + 1 );
+
+   for( uint32_t i = 0; i < 200; ++i )
+   {
+      const std::string name = random_name();
+      auto itr = expected.find( name );
+      auto found = trie.find( name );
+      BOOST_CHECK_EQUAL( found.valid(), itr != expected.end() );
+      if( found.valid() && itr != expected.end() )
+         BOOST_CHECK_EQUAL( *found, itr->second );
+
+      // prefix queries return the same names as a lower bound walk of an ordered index
+      const std::string prefix = name.substr( 0, rng() % 4 );
+      const uint32_t limit = 1 + rng() % 20;
+      std::vector<account_name_match> by_prefix = trie.find_by_prefix( prefix, limit );
+      auto eitr = expected.lower_bound( prefix );
+      for( const auto& m : by_prefix )
+      {
+         BOOST_REQUIRE( eitr != expected.end() );
+         BOOST_CHECK_EQUAL( m.name, eitr->first );
+         BOOST_CHECK_EQUAL( m.uid, eitr->second );
+         ++eitr;
+      }
+      if( by_prefix.size() < limit )
+         BOOST_CHECK( eitr == expected.end() || eitr->first.compare( 0, prefix.size(), prefix ) != 0 );
+
+      // similar names are the closest ones of a full scan
+      const uint32_t max_distance = rng() % 3;
+      std::vector<account_name_match> scanned;
+      for( const auto& e : expected )
+      {
+         const uint32_t d = edit_distance( name, e.first );
+         if( d <= max_distance )
+         {
+            account_name_match m;
+            m.name = e.first;
+            m.uid = e.second;
+            m.distance = d;
+            scanned.push_back( m );
+         }
+      }
+      std::stable_sort( scanned.begin(), scanned.end(),
+                        []( const account_name_match& a, const account_name_match& b ) { return a.distance < b.distance; } );
+      if( scanned.size() > limit )
+         scanned.resize( limit );
+      std::vector<account_name_match> similar = trie.find_similar( name, max_distance, limit );
+      BOOST_REQUIRE_EQUAL( similar.size(), scanned.size() );
+      for( size_t j = 0; j < similar.size(); ++j )
+      {
+         BOOST_CHECK_EQUAL( similar[j].name, scanned[j].name );
+         BOOST_CHECK_EQUAL( similar[j].distance, scanned[j].distance );
+      }
+   }
+
+   for( const auto& e : expected )
+      BOOST_CHECK( trie.remove( e.first ) );
+   BOOST_CHECK_EQUAL( trie.size(), 0u );
+   BOOST_CHECK_EQUAL( trie.node_count(), 1u );
+   BOOST_CHECK( trie.find_by_prefix( "", 10 ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE( account_name_index_test )
+{ try {
+   const auto* index = db.add_secondary_index< primary_index_of<account_object>::type, graphene::app::account_name_index >();
+   {
+      auto session = db._undo_db.start_undo_session();
+      create_account( 1001, "trie-one" );
+      create_account( 1002, "trie-two" );
+      BOOST_CHECK( index->names.find( "trie-one" ).valid() );
+      BOOST_CHECK_EQUAL( index->names.find_by_prefix( "trie-", 10 ).size(), 2u );
+      auto similar = index->names.find_similar( "trie-tow", 2, 10 );
+      BOOST_REQUIRE_EQUAL( similar.size(), 1u );
+      BOOST_CHECK_EQUAL( similar[0].name, "trie-two" );
+      BOOST_CHECK_EQUAL( similar[0].distance, 2u );
+   }
+   // undone with the accounts
+   BOOST_CHECK( index->names.find_by_prefix( "trie-", 10 ).empty() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+
+#include <graphene/app/api_admission.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( api_admission_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( api_admission_controller_test )
+{
+   using graphene::app::api_admission_config;
+   using graphene::app::api_admission_controller;
+
+   const fc::time_point now( fc::seconds( 1000000 ) );
+   api_admission_config config;
+   config.method_costs["get"] = 1;
+   config.quota_per_second = 10;
+   config.quota_burst = 10;
+   api_admission_controller admission( config );
+   api_admission_controller::ticket t;
+
+   // a client spends its burst, then gets what is refilled
+   for( int i = 0; i < 10; ++i )
+   {
+      BOOST_REQUIRE( admission.try_admit( "a", "get", now, t ) == api_admission_controller::admitted );
+      admission.finish( t, fc::milliseconds( 50 ) );
+   }
+   BOOST_CHECK( admission.try_admit( "a", "get", now, t ) == api_admission_controller::over_quota );
+   BOOST_CHECK( admission.try_admit( "b", "get", now, t ) == api_admission_controller::admitted );
+   admission.finish( t, fc::microseconds() );
+   int refilled = 0;
+   while( admission.try_admit( "a", "get", now + fc::milliseconds( 500 ), t ) == api_admission_controller::admitted )
+   {
+      admission.finish( t, fc::microseconds() );
+      ++refilled;
+   }
+   BOOST_CHECK_EQUAL( refilled, 5 );
+   // configured costs are not calibrated
+   BOOST_CHECK_EQUAL( admission.cost_of( "get" ), 1 );
+
+   // the cost of other methods follows their latency
+   BOOST_CHECK_EQUAL( admission.cost_of( "slow" ), config.default_cost );
+   BOOST_REQUIRE( admission.try_admit( "c", "slow", now, t ) == api_admission_controller::admitted );
+   admission.finish( t, fc::milliseconds( 8 ) );
+   BOOST_CHECK_EQUAL( admission.cost_of( "slow" ), 8 );
+   BOOST_REQUIRE( admission.try_admit( "c", "slow", now + fc::seconds( 1 ), t ) == api_admission_controller::admitted );
+   admission.finish( t, fc::milliseconds( 18 ) );
+   BOOST_CHECK_CLOSE( admission.cost_of( "slow" ), 9, 1e-9 );
+
+   // a call costing more than the burst gets through a full bucket only
+   BOOST_REQUIRE( admission.try_admit( "d", "slow", now, t ) == api_admission_controller::admitted );
+   admission.finish( t, fc::milliseconds( 109 ) );
+   BOOST_CHECK_CLOSE( admission.cost_of( "slow" ), 19, 1e-9 );
+   BOOST_CHECK( admission.try_admit( "d", "slow", now + fc::seconds( 10 ), t ) == api_admission_controller::admitted );
+   admission.finish( t, fc::milliseconds( 19 ) );
+   BOOST_CHECK( admission.try_admit( "d", "slow", now + fc::seconds( 10 ), t ) == api_admission_controller::over_quota );
+
+   auto stats = admission.get_stats();
+   BOOST_CHECK_EQUAL( stats.rejected_over_quota, 3u );
+   BOOST_CHECK_EQUAL( stats.rejected_by_method["get"], 2u );
+   BOOST_CHECK_EQUAL( stats.rejected_by_method["slow"], 1u );
+   BOOST_CHECK_EQUAL( stats.calls_in_flight, 0u );
+   BOOST_CHECK_EQUAL( stats.clients, 4u );
+
+   // global limits, without quotas
+   config = api_admission_config();
+   config.method_costs["get"] = 5;
+   config.max_concurrent_calls = 2;
+   config.max_cost_in_flight = 9;
+   config.max_queued_calls = 1;
+   admission.set_config( config );
+   api_admission_controller::ticket t1, t2, t3;
+   BOOST_REQUIRE( admission.try_admit( "a", "get", now, t1 ) == api_admission_controller::admitted );
+   BOOST_REQUIRE( admission.try_admit( "b", "other", now, t2 ) == api_admission_controller::admitted );
+   BOOST_CHECK( admission.try_admit( "c", "other", now, t3 ) == api_admission_controller::busy );
+   BOOST_CHECK( admission.enter_queue( "other" ) );
+   BOOST_CHECK( !admission.enter_queue( "other" ) );
+   admission.finish( t2, fc::milliseconds( 1 ) );
+   // a second call is allowed, but 5 + 5 would exceed the cost in flight
+   BOOST_CHECK( admission.try_admit( "c", "get", now, t3 ) == api_admission_controller::busy );
+   BOOST_CHECK( admission.try_admit( "c", "other", now, t3 ) == api_admission_controller::admitted );
+   admission.leave_queue( "other", true );
+   stats = admission.get_stats();
+   BOOST_CHECK_EQUAL( stats.calls_in_flight, 2u );
+   BOOST_CHECK_CLOSE( stats.cost_in_flight, 6, 1e-9 );
+   BOOST_CHECK_EQUAL( stats.calls_in_queue, 0u );
+   BOOST_CHECK_EQUAL( stats.queued, 1u );
+   BOOST_CHECK_EQUAL( stats.rejected_busy, 1u );
+   admission.finish( t1, fc::milliseconds( 5 ) );
+   admission.finish( t3, fc::milliseconds( 1 ) );
+
+   // a call costing more than the ceiling runs alone
+   config.max_cost_in_flight = 4;
+   admission.set_config( config );
+   BOOST_CHECK( admission.try_admit( "a", "get", now, t1 ) == api_admission_controller::admitted );
+   BOOST_CHECK( admission.try_admit( "b", "get", now, t2 ) == api_admission_controller::busy );
+
+   // a waiting call wakes up when the call in flight finishes, or gives up at its deadline
+   fc::time_point start = fc::time_point::now();
+   admission.wait_for_slot( "get", start + fc::milliseconds( 20 ) );
+   BOOST_CHECK( fc::time_point::now() - start >= fc::milliseconds( 20 ) );
+   fc::future<void> finished = fc::schedule( [&admission, &t1]() { admission.finish( t1, fc::milliseconds( 5 ) ); },
+                                             fc::time_point::now() + fc::milliseconds( 10 ) );
+   start = fc::time_point::now();
+   admission.wait_for_slot( "get", start + fc::seconds( 10 ) );
+   BOOST_CHECK( fc::time_point::now() - start < fc::seconds( 5 ) );
+   finished.wait();
+   BOOST_CHECK_EQUAL( admission.get_stats().calls_in_flight, 0u );
+   // nothing to wait for
+   start = fc::time_point::now();
+   admission.wait_for_slot( "get", start + fc::seconds( 10 ) );
+   BOOST_CHECK( fc::time_point::now() - start < fc::seconds( 5 ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
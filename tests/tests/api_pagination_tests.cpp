@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/csaf_object.hpp>
+
+#include <graphene/app/api.hpp>
+#include <graphene/app/api_admission.hpp>
+#include <graphene/app/database_api.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( api_pagination_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( api_pagination_test )
+{ try {
+   // the blocks go through the fork database, so that they can be popped
+   generate_block( ~database::skip_fork_db );
+   graphene::app::database_api api( db );
+
+   for( account_uid_type to = 100; to < 125; ++to )
+      db.create<csaf_lease_object>( [&]( csaf_lease_object& o ) {
+         o.from = 1;
+         o.to = to;
+         o.amount = to;
+      });
+   db.create<csaf_lease_object>( [&]( csaf_lease_object& o ) {
+      o.from = 2;
+      o.to = 100;
+   });
+
+   // the pages resume exactly where the previous ones stopped
+   vector<account_uid_type> seen;
+   optional<string> cursor;
+   uint32_t pages = 0;
+   do
+   {
+      const auto page = api.get_csaf_leases_by_from_page( 1, cursor, 10 );
+      BOOST_CHECK( !page.reorganized );
+      BOOST_CHECK_EQUAL( page.head_block_num, db.head_block_num() );
+      BOOST_CHECK_LE( page.items.size(), 10u );
+      for( const auto& lease : page.items )
+         seen.push_back( lease.to );
+      cursor = page.next_cursor;
+      ++pages;
+      if( pages == 1 )
+      {
+         // a lease added before the cursor is not seen, one added after it is
+         db.create<csaf_lease_object>( [&]( csaf_lease_object& o ) { o.from = 1; o.to = 99; } );
+         db.create<csaf_lease_object>( [&]( csaf_lease_object& o ) { o.from = 1; o.to = 200; } );
+      }
+   }
+   while( cursor.valid() );
+   BOOST_CHECK_EQUAL( pages, 3u );
+   BOOST_REQUIRE_EQUAL( seen.size(), 26u );
+   for( uint32_t i = 0; i < 25; ++i )
+      BOOST_CHECK_EQUAL( seen[i], 100 + i );
+   BOOST_CHECK_EQUAL( seen.back(), 200 );
+
+   // a page which ends at the last object has no cursor
+   BOOST_CHECK( !api.get_csaf_leases_by_to_page( 100, optional<string>(), 2 ).next_cursor.valid() );
+   BOOST_CHECK_EQUAL( api.get_csaf_leases_by_to_page( 100, optional<string>(), 2 ).items.size(), 2u );
+   BOOST_CHECK_THROW( api.get_csaf_leases_by_from_page( 1, optional<string>(), 1001 ), fc::exception );
+   BOOST_CHECK_THROW( api.get_csaf_leases_by_from_page( 1, optional<string>( string( "xyz" ) ), 10 ), fc::exception );
+
+   // the cursor tells when the block it was issued at left the chain
+   cursor = api.get_csaf_leases_by_from_page( 1, optional<string>(), 1 ).next_cursor;
+   BOOST_REQUIRE( cursor.valid() );
+   generate_block( ~database::skip_fork_db );
+   BOOST_CHECK( !api.get_csaf_leases_by_from_page( 1, cursor, 1 ).reorganized );
+   const auto issued = api.get_csaf_leases_by_from_page( 1, cursor, 1 ).next_cursor;
+   BOOST_REQUIRE( issued.valid() );
+   db.pop_block();
+   BOOST_CHECK( api.get_csaf_leases_by_from_page( 1, issued, 1 ).reorganized );
+   // another block at the same height
+   generate_block( ~0, generate_private_key( "null_key" ), 1 );
+   BOOST_CHECK( api.get_csaf_leases_by_from_page( 1, issued, 1 ).reorganized );
+   BOOST_CHECK( !api.get_csaf_leases_by_from_page( 1, cursor, 1 ).reorganized );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( history_stream_admission_test )
+{ try {
+   ACTOR(1000);
+   for( int i = 0; i < 4; ++i )
+      fund( u_1000, asset( 1000 ) );
+   generate_block();
+   const uint32_t total_ops = db.get_account_statistics_by_uid( u_1000_id ).total_ops;
+   BOOST_REQUIRE_GE( total_ops, 5u );
+
+   // each page costs the whole burst, the export waits for the bucket to refill
+   graphene::app::api_admission_config config;
+   config.method_costs["stream_relative_account_history_page"] = 1;
+   config.quota_per_second = 200;
+   config.quota_burst = 1;
+   auto& admission = app.get_api_admission_controller();
+   admission.set_config( config );
+
+   graphene::app::history_api api( app, "exporter" );
+   uint32_t received = 0;
+   uint32_t finished = 0;
+   typedef graphene::app::api_page<std::pair<uint32_t,operation_history_object>> history_page;
+   auto callback = [&received,&finished]( const variant& v ) {
+      const auto page = v.as<history_page>( GRAPHENE_MAX_NESTED_OBJECTS );
+      received += page.items.size();
+      if( !page.next_cursor.valid() )
+         ++finished;
+   };
+   for( uint32_t i = 0; i < graphene::app::history_api::max_streams_per_connection; ++i )
+      api.stream_relative_account_history( callback, u_1000_id, optional<uint16_t>(), 1 );
+   BOOST_CHECK_THROW( api.stream_relative_account_history( callback, u_1000_id, optional<uint16_t>(), 1 ),
+                      fc::exception );
+
+   const fc::time_point give_up = fc::time_point::now() + fc::seconds( 10 );
+   while( finished < graphene::app::history_api::max_streams_per_connection && fc::time_point::now() < give_up )
+      fc::usleep( fc::milliseconds( 5 ) );
+   BOOST_REQUIRE_EQUAL( finished, graphene::app::history_api::max_streams_per_connection );
+   BOOST_CHECK_EQUAL( received, total_ops * graphene::app::history_api::max_streams_per_connection );
+   auto stats = admission.get_stats();
+   BOOST_CHECK_EQUAL( stats.admitted, total_ops * graphene::app::history_api::max_streams_per_connection );
+   BOOST_CHECK_GT( stats.rejected_over_quota, 0u );
+   BOOST_CHECK_EQUAL( stats.calls_in_flight, 0u );
+
+   // the exports which ended make room for another one
+   api.stream_relative_account_history( callback, u_1000_id, optional<uint16_t>(), 1000 );
+   while( finished <= graphene::app::history_api::max_streams_per_connection && fc::time_point::now() < give_up )
+      fc::usleep( fc::milliseconds( 5 ) );
+   BOOST_CHECK_EQUAL( finished, graphene::app::history_api::max_streams_per_connection + 1 );
+   admission.set_config( graphene::app::api_admission_config() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/applied_operation_log.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( applied_operation_log_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( applied_operation_log_test )
+{ try {
+   vector<operation> ops;
+   for( uint32_t i = 0; i < 4; ++i )
+   {
+      transfer_operation op;
+      op.from = 100 + i;
+      op.to = 200;
+      op.amount = asset( i + 1 );
+      ops.push_back( op );
+   }
+
+   applied_operation_log log;
+   // the operations of the block are referenced, the others are copied
+   log.push( ops[0], true );
+   log.push( ops[1], false );
+   BOOST_CHECK( log[0].op == &ops[0] );
+   BOOST_CHECK( !log[0].owned );
+   BOOST_CHECK( log[1].op != &ops[1] );
+   BOOST_CHECK( log[1].owned );
+   BOOST_CHECK_EQUAL( log.copied(), 1u );
+   const operation* copy = log[1].op;
+
+   // copies do not move as operations are added, and are dropped with their entries
+   for( uint32_t i = 0; i < 100; ++i )
+      log.push( ops[2 + i % 2], i % 3 == 0 );
+   BOOST_CHECK( log[1].op == copy );
+   BOOST_CHECK( log[1].op->get<transfer_operation>().amount == asset( 2 ) );
+   log.truncate( 2 );
+   BOOST_CHECK_EQUAL( log.size(), 2u );
+   BOOST_CHECK_EQUAL( log.copied(), 1u );
+   BOOST_CHECK( log[1].op == copy );
+
+   log[1].result = object_id_type( 1, 2, 3 );
+   log[1].virtual_op = 5;
+   operation_history_object h;
+   log[1].copy_to( h );
+   BOOST_CHECK( h.op.get<transfer_operation>().amount == asset( 2 ) );
+   BOOST_CHECK( h.result.get<object_id_type>() == object_id_type( 1, 2, 3 ) );
+   BOOST_CHECK_EQUAL( h.virtual_op, 5 );
+
+   log.clear();
+   BOOST_CHECK( log.empty() );
+   BOOST_CHECK_EQUAL( log.copied(), 0u );
+
+   // the log is cleared once the observers of the block were called
+   generate_block();
+   BOOST_CHECK( db.get_applied_operations().empty() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
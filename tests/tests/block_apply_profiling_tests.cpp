@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( block_apply_profiling_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( block_apply_profiling_test )
+{ try {
+   ACTORS((1400)(1500));
+   fund( u_1400, asset( 1000000 ) );
+   generate_block();
+   for( uint32_t i = 0; i < 5; ++i )
+   {
+      transfer( u_1400, u_1500, asset( 100 + i ) );
+      transfer( u_1500, u_1400, asset( 10 ) );
+      generate_block();
+   }
+
+   auto balances = []( const database& d ) -> string {
+      string result = fc::json::to_string( d.get_dynamic_global_properties() );
+      for( const auto& o : d.get_index_type<account_balance_index>().indices() )
+         result += fc::json::to_string( o );
+      for( const auto& o : d.get_index_type<account_index>().indices() )
+         result += fc::json::to_string( o );
+      return result;
+   };
+   // the fixture's transactions are not signed
+   const uint32_t skip = database::skip_transaction_signatures | database::skip_authority_check |
+                         database::skip_undo_history_check;
+   auto replay = [&]( bool profiled, block_apply_profile& profile ) -> string {
+      fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+      database node;
+      node.open( dir.path(), [this]{ return genesis_state; }, "test" );
+      node.set_block_apply_profiling( profiled );
+      for( uint32_t n = 1; n <= db.head_block_num(); ++n )
+         node.push_block( *db.fetch_block_by_number( n ), skip );
+      profile = node.take_block_apply_profile();
+      BOOST_CHECK( node.head_block_id() == db.head_block_id() );
+      const string result = balances( node );
+      node.close();
+      return result;
+   };
+   auto total = []( const block_apply_profile& p ) -> int64_t {
+      return ( p.header + p.authorities + p.evaluation + p.maintenance + p.undo + p.notifications ).count();
+   };
+
+   block_apply_profile plain, profiled;
+   const string without_profiling = replay( false, plain );
+   const string with_profiling = replay( true, profiled );
+   BOOST_CHECK_EQUAL( with_profiling, without_profiling );
+   BOOST_CHECK_EQUAL( with_profiling, balances( db ) );
+   BOOST_CHECK_EQUAL( total( plain ), 0 );
+   BOOST_CHECK_GT( total( profiled ), 0 );
+   BOOST_CHECK_GT( profiled.evaluation.count(), 0 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/applied_operation_log.hpp>
+#include <graphene/chain/block_journal.hpp>
+#include <graphene/chain/impacted.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( block_journal_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( block_journal_test )
+{ try {
+   applied_operation_log applied;
+   for( uint32_t i = 0; i < 4; ++i )
+   {
+      transfer_operation op;
+      op.from = 100 + i;
+      op.to = 200 + i;
+      op.amount = asset( 1 );
+      applied_operation& a = applied.push( op, false );
+      a.block_num = 7;
+      a.trx_in_block = i / 2;
+      a.op_in_trx = i % 2;
+      a.virtual_op = i;
+   }
+
+   block_journal journal;
+   journal.reset( 7 );
+   journal.add_operations( applied );
+   BOOST_REQUIRE_EQUAL( journal.operations.size(), applied.size() );
+   for( uint32_t i = 0; i < 4; ++i )
+   {
+      flat_set<account_uid_type> impacted;
+      operation_get_impacted_account_uids( *applied[i].op, impacted );
+      BOOST_CHECK( journal.operations[i].impacted == impacted );
+      BOOST_CHECK( journal.operations[i].authorities.count( 100 + i ) );
+      BOOST_CHECK( journal.find_operation( i / 2, i % 2, i ) == &journal.operations[i] );
+   }
+   BOOST_CHECK( journal.find_operation( 0, 0, 9 ) == nullptr );
+
+   // the history objects of the block are found in the journal, the others are visited
+   operation_history_object h;
+   applied[3].copy_to( h );
+   h.id = operation_history_id_type( 1 );
+   flat_set<account_uid_type> expected, found;
+   get_relevant_accounts( &h, expected );
+   journal.add_created( &h );
+   BOOST_CHECK( journal.created_accounts == expected );
+   h.block_num = 6;
+   journal.get_relevant_accounts( &h, found );
+   BOOST_CHECK( found == expected );
+   BOOST_REQUIRE_EQUAL( journal.created.size(), 1u );
+   BOOST_CHECK( journal.created[0].id == h.id );
+
+   journal.reset( 8 );
+   BOOST_CHECK( journal.operations.empty() && journal.created.empty() && journal.created_accounts.empty() );
+   BOOST_CHECK( journal.find_operation( 0, 0, 0 ) == nullptr );
+
+   // the database only journals the parts something reads, the account history plugin reads the operations
+   ACTORS((1000));
+   fund( u_1000, asset( 1000 ) );
+   generate_block();
+   BOOST_CHECK_EQUAL( db.get_block_journal().block_num, db.head_block_num() );
+   BOOST_CHECK( db.get_block_journal().find_operation( 0, 0, 0 ) != nullptr );
+   BOOST_CHECK( db.get_block_journal().modified.empty() );
+
+   uint32_t changed = 0;
+   auto connection = db.changed_objects.connect( [&]( const vector<object_id_type>& ids,
+                                                      const flat_set<account_uid_type>& ) { changed += ids.size(); } );
+   db.set_journal_operations( false );
+   fund( u_1000, asset( 1000 ) );
+   generate_block();
+   const block_journal& last = db.get_block_journal();
+   BOOST_CHECK_EQUAL( last.block_num, db.head_block_num() );
+   BOOST_CHECK( last.operations.empty() );
+   BOOST_CHECK( !last.modified.empty() );
+   BOOST_CHECK_EQUAL( last.modified.size(), changed );
+   BOOST_CHECK( last.created.empty() );
+   connection.disconnect();
+   db.set_journal_operations( true );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/coin_seconds.hpp>
+
+#include <fc/uint128.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( coin_seconds_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( coin_seconds_property_test )
+{
+   // the formulas as they were written with fc::uint128_t, the optimized arithmetic must give the same bits
+   auto reference_average = []( uint64_t average, uint64_t balance, uint64_t window, uint64_t delta_seconds ) {
+      fc::uint128_t old_coin_seconds = fc::uint128_t( average ) * ( window - delta_seconds );
+      fc::uint128_t new_coin_seconds = fc::uint128_t( balance ) * delta_seconds;
+      return ( ( old_coin_seconds + new_coin_seconds ) / window ).to_uint64();
+   };
+   auto reference_compute = []( const account_statistics_object& s, uint64_t window, fc::time_point_sec now ) {
+      fc::time_point_sec now_rounded( ( now.sec_since_epoch() / 60 ) * 60 );
+      share_type new_average_coins;
+      fc::uint128_t max_coin_seconds;
+      share_type effective_balance = s.core_balance + s.core_leased_in - s.core_leased_out;
+      if( now_rounded <= s.average_coins_last_update )
+         new_average_coins = s.average_coins;
+      else
+      {
+         uint64_t delta_seconds = ( now_rounded - s.average_coins_last_update ).to_seconds();
+         if( delta_seconds >= window )
+            new_average_coins = effective_balance;
+         else
+         {
+            uint64_t old_seconds = window - delta_seconds;
+            fc::uint128_t old_coin_seconds = fc::uint128_t( s.average_coins.value ) * old_seconds;
+            fc::uint128_t new_coin_seconds = fc::uint128_t( effective_balance.value ) * delta_seconds;
+            max_coin_seconds = old_coin_seconds + new_coin_seconds;
+            new_average_coins = ( max_coin_seconds / window ).to_uint64();
+         }
+      }
+      max_coin_seconds = fc::uint128_t( new_average_coins.value ) * window;
+      fc::uint128_t new_coin_seconds_earned;
+      if( now_rounded <= s.coin_seconds_earned_last_update )
+         new_coin_seconds_earned = s.coin_seconds_earned;
+      else
+      {
+         int64_t delta_seconds = ( now_rounded - s.coin_seconds_earned_last_update ).to_seconds();
+         fc::uint128_t delta_coin_seconds = effective_balance.value;
+         delta_coin_seconds *= delta_seconds;
+         new_coin_seconds_earned = s.coin_seconds_earned + delta_coin_seconds;
+      }
+      if( new_coin_seconds_earned > max_coin_seconds )
+         new_coin_seconds_earned = max_coin_seconds;
+      return std::make_pair( new_coin_seconds_earned, new_average_coins );
+   };
+
+   std::mt19937_64 rng( 64 );
+   // small, typical and huge values, so every arithmetic path is taken
+   auto random_amount = [&rng]() -> int64_t {
+      switch( rng() % 4 )
+      {
+         case 0:  return rng() % 1000;
+         case 1:  return rng() % ( int64_t( 1 ) << 40 );
+         case 2:  return rng() % GRAPHENE_MAX_SHARE_SUPPLY;
+         default: return rng() >> 1;
+      }
+   };
+   const uint64_t windows[] = { 1, 60, 86400, 604800, 2592000, uint64_t( 1 ) << 40 };
+
+   for( uint64_t i = 0; i < 100000; ++i )
+   {
+      const uint64_t window = windows[ rng() % 6 ];
+      const uint64_t delta_seconds = rng() % window;
+      const uint64_t average = random_amount(), balance = random_amount();
+      BOOST_REQUIRE_EQUAL( coin_seconds::average_after( average, balance, window, delta_seconds ),
+                           reference_average( average, balance, window, delta_seconds ) );
+   }
+
+   // randomized histories of balance changes, leases and collections of an account
+   for( uint32_t history = 0; history < 200; ++history )
+   {
+      const uint64_t window = windows[ 1 + rng() % 4 ];
+      account_statistics_object s;
+      fc::time_point_sec now( 1500000000 );
+      s.average_coins_last_update = now;
+      s.coin_seconds_earned_last_update = now;
+      for( uint32_t step = 0; step < 200; ++step )
+      {
+         now += rng() % 3 == 0 ? uint32_t( rng() % ( 2 * window ) ) : uint32_t( rng() % 600 );
+         const auto expected = reference_compute( s, window, now );
+         const auto actual = s.compute_coin_seconds_earned( window, now );
+         BOOST_REQUIRE( actual.first == expected.first );
+         BOOST_REQUIRE( actual.second == expected.second );
+
+         switch( rng() % 4 )
+         {
+            case 0: // balance change
+            {
+               const int64_t balance = random_amount();
+               s.update_coin_seconds_earned( window, now );
+               s.core_balance = balance;
+               s.core_leased_out = std::min<int64_t>( s.core_leased_out.value, balance );
+               break;
+            }
+            case 1: // lease in or out
+            {
+               s.update_coin_seconds_earned( window, now );
+               if( rng() % 2 )
+                  s.core_leased_in = random_amount() % ( GRAPHENE_MAX_SHARE_SUPPLY / 2 );
+               else
+                  s.core_leased_out = s.core_balance.value == 0 ? 0 : int64_t( rng() % s.core_balance.value );
+               break;
+            }
+            case 2: // collect
+            {
+               const fc::uint128_t collected = actual.first / 2;
+               s.set_coin_seconds_earned( actual.first - collected, now );
+               break;
+            }
+            default:
+               break;
+         }
+      }
+   }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <fstream>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( double_production_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( double_production_test )
+{ try {
+   vector<double_production_evidence> detected;
+   boost::signals2::scoped_connection connection = db.double_production_detected.connect(
+         [&]( const double_production_evidence& e ) { detected.push_back( e ); } );
+   const uint32_t skip = database::skip_undo_history_check;
+
+   // the witness signs a second block for the same slot, on a fork which is not applied
+   const signed_block first = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1),
+                                                 init_account_priv_key, skip );
+   signed_block second = first;
+   second.transaction_merkle_root = checksum_type::hash( std::string( "another block" ) );
+   second.sign( init_account_priv_key );
+   BOOST_CHECK( !db.push_block( second, skip ) );
+   BOOST_CHECK( db.head_block_id() == first.id() );
+
+   BOOST_REQUIRE_EQUAL( db.get_double_production_evidence().size(), 1u );
+   const auto& evidence = db.get_double_production_evidence().front();
+   BOOST_CHECK_EQUAL( evidence.witness, first.witness );
+   BOOST_CHECK( evidence.timestamp == first.timestamp );
+   BOOST_CHECK( evidence.first.id() == first.id() );
+   BOOST_CHECK( evidence.second.id() == second.id() );
+   BOOST_CHECK( evidence.first.signee() == evidence.second.signee() );
+   BOOST_REQUIRE_EQUAL( detected.size(), 1u );
+   BOOST_CHECK( detected.front().second.id() == second.id() );
+
+   // one evidence per slot
+   signed_block third = first;
+   third.transaction_merkle_root = checksum_type::hash( std::string( "yet another block" ) );
+   third.sign( init_account_priv_key );
+   db.push_block( third, skip );
+   BOOST_CHECK_EQUAL( db.get_double_production_evidence().size(), 1u );
+
+   // a block which the witness did not sign is no evidence
+   const signed_block next = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1),
+                                                init_account_priv_key, skip );
+   signed_block forged = next;
+   forged.transaction_merkle_root = checksum_type::hash( std::string( "forged block" ) );
+   forged.sign( generate_private_key( "forger" ) );
+   db.push_block( forged, skip );
+   BOOST_CHECK_EQUAL( db.get_double_production_evidence().size(), 1u );
+   BOOST_CHECK_EQUAL( detected.size(), 1u );
+   BOOST_CHECK( db.head_block_id() == next.id() );
+
+   // the forged block does not hide a second block the witness signed for that slot
+   signed_block genuine = next;
+   genuine.transaction_merkle_root = checksum_type::hash( std::string( "second block" ) );
+   genuine.sign( init_account_priv_key );
+   db.push_block( genuine, skip );
+   BOOST_REQUIRE_EQUAL( db.get_double_production_evidence().size(), 2u );
+   BOOST_CHECK( db.get_double_production_evidence().back().first.id() == next.id() );
+   BOOST_CHECK( db.get_double_production_evidence().back().second.id() == genuine.id() );
+
+   // the evidence is saved
+   std::ifstream saved( ( data_dir->path() / "database" / "double_production_evidence.json" ).generic_string() );
+   std::string line;
+   BOOST_REQUIRE( std::getline( saved, line ) );
+   const auto loaded = fc::json::from_string( line ).as<double_production_evidence>( GRAPHENE_MAX_NESTED_OBJECTS );
+   BOOST_CHECK( loaded.first.id() == first.id() );
+   BOOST_CHECK( loaded.second.id() == second.id() );
+   BOOST_REQUIRE( std::getline( saved, line ) );
+   BOOST_CHECK( fc::json::from_string( line ).as<double_production_evidence>( GRAPHENE_MAX_NESTED_OBJECTS ).second.id()
+                == genuine.id() );
+   BOOST_CHECK( !std::getline( saved, line ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
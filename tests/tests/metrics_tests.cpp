@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+
+#include <graphene/utilities/metrics.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( metrics_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( metrics_registry_test )
+{
+   using graphene::utilities::metrics_registry;
+   auto& registry = metrics_registry::instance();
+
+   auto& c = registry.get_counter( "test_requests_total", "Requests" );
+   c.increment();
+   c.increment( 2 );
+   BOOST_CHECK_EQUAL( &c, &registry.get_counter( "test_requests_total", "Requests" ) );
+   registry.get_gauge( "test_queue_size", "Queue size", { { "queue", "a\"b" } } ).set( -5 );
+   auto& h = registry.get_histogram( "test_latency_seconds", "Latency", { 0.1, 1 } );
+   h.observe( 0.05 );
+   h.observe( 0.5 );
+   h.observe( 5 );
+   int owner = 0;
+   registry.add_callback_gauge( &owner, "test_callback", "Callback", []() -> double { return 42; } );
+   GRAPHENE_CHECK_THROW( registry.get_gauge( "test_requests_total", "Requests" ), fc::exception );
+
+   const std::string text = registry.render_text();
+   auto contains = [&text]( const std::string& line ) { return text.find( line + "\n" ) != std::string::npos; };
+   BOOST_CHECK( contains( "# TYPE test_requests_total counter" ) );
+   BOOST_CHECK( contains( "test_requests_total 3" ) );
+   BOOST_CHECK( contains( "test_queue_size{queue=\"a\\\"b\"} -5" ) );
+   BOOST_CHECK( contains( "test_latency_seconds_bucket{le=\"0.1\"} 1" ) );
+   BOOST_CHECK( contains( "test_latency_seconds_bucket{le=\"1\"} 2" ) );
+   BOOST_CHECK( contains( "test_latency_seconds_bucket{le=\"+Inf\"} 3" ) );
+   BOOST_CHECK( contains( "test_latency_seconds_count 3" ) );
+   BOOST_CHECK( contains( "test_callback 42" ) );
+
+   registry.remove_callbacks( &owner );
+   BOOST_CHECK( registry.render_text().find( "test_callback" ) == std::string::npos );
+
+   // removing a callback waits until it is no longer called
+   std::atomic<bool> running( false ), finished( false );
+   registry.add_callback_gauge( &owner, "test_slow_callback", "Slow callback", [&running, &finished]() -> double
+   {
+      running = true;
+      std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+      finished = true;
+      return 1;
+   } );
+   std::thread renderer( [&registry]() { registry.render_text(); } );
+   while( !running )
+      std::this_thread::yield();
+   registry.remove_callbacks( &owner );
+   BOOST_CHECK( finished );
+   renderer.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/pending_transaction_pool.hpp>
+#include <graphene/chain/transfer_evaluator.hpp>
+
+#include <chrono>
+#include <thread>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( pending_transaction_pool_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( pending_transaction_pool_test )
+{ try {
+   const time_point_sec now( 1000000 );
+   auto make_trx = [&]( account_uid_type from, share_type fee, uint32_t expires_in ) {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = from;
+      op.to = from + 1;
+      op.amount = asset( 1 );
+      op.fee = fee_type( asset( fee ) );
+      tx.operations.push_back( op );
+      tx.expiration = now + expires_in;
+      return tx;
+   };
+   auto push = []( pending_transaction_pool& pool, const signed_transaction& tx ) {
+      auto e = pool.admit( tx );
+      e.trx = processed_transaction( tx );
+      pool.insert( std::move( e ) );
+   };
+
+   pending_transaction_pool pool;
+   const signed_transaction low = make_trx( 100, 10, 60 );
+   const signed_transaction high = make_trx( 200, 1000, 60 );
+   const signed_transaction mid = make_trx( 300, 100, 60 );
+   push( pool, low );
+   push( pool, high );
+   push( pool, mid );
+   BOOST_CHECK_EQUAL( pool.size(), 3u );
+
+   // chosen by fee per byte when they don't all fit, in arrival order
+   const uint64_t size = fc::raw::pack_size( low );
+   block_generation_stats gen;
+   auto ids = []( const vector<const pending_transaction_pool::entry*>& entries ) -> vector<transaction_id_type> {
+      vector<transaction_id_type> result;
+      for( const auto* e : entries )
+         result.push_back( e->id );
+      return result;
+   };
+   BOOST_CHECK( ( ids( pool.select( size * 3, fc::microseconds::maximum(), fc::time_point::maximum(), gen ) )
+                  == vector<transaction_id_type>{ low.id(), high.id(), mid.id() } ) );
+   BOOST_CHECK( ( ids( pool.select( size * 2, fc::microseconds::maximum(), fc::time_point::maximum(), gen ) )
+                  == vector<transaction_id_type>{ high.id(), mid.id() } ) );
+   BOOST_CHECK_EQUAL( gen.postponed_for_size, 1u );
+
+   // per account quota
+   pool.set_limits( 0, 2 );
+   push( pool, make_trx( 100, 10, 61 ) );
+   GRAPHENE_CHECK_THROW( pool.admit( make_trx( 100, 10, 62 ) ), fc::exception );
+   BOOST_CHECK_EQUAL( pool.get_stats().rejected, 1u );
+
+   // a full pool evicts the lowest fee per byte, and refuses transactions paying less than everything in it
+   pool.set_limits( size * 4, 0 );
+   GRAPHENE_CHECK_THROW( pool.admit( make_trx( 400, 1, 60 ) ), fc::exception );
+   const signed_transaction higher = make_trx( 400, 5000, 120 );
+   push( pool, higher );
+   auto stats = pool.get_stats();
+   BOOST_CHECK_EQUAL( stats.transactions, 4u );
+   BOOST_CHECK_EQUAL( stats.evicted, 1u );
+   BOOST_CHECK_EQUAL( stats.accounts, 4u );
+   BOOST_CHECK( ( ids( pool.select( size, fc::microseconds::maximum(), fc::time_point::maximum(), gen ) )
+                  == vector<transaction_id_type>{ higher.id() } ) );
+
+   // releasing drops the expired transactions and keeps the arrival order
+   vector<processed_transaction> released = pool.release( now + 60 );
+   BOOST_CHECK( pool.empty() );
+   BOOST_REQUIRE_EQUAL( released.size(), 1u );
+   BOOST_CHECK_EQUAL( pool.get_stats().expired, 3u );
+
+   // a transaction is only chosen with the earlier ones of its payer, even if they pay less
+   pool.set_limits( 0, 0 );
+   const signed_transaction first = make_trx( 500, 1, 60 );
+   const signed_transaction other = make_trx( 600, 100, 60 );
+   const signed_transaction second = make_trx( 500, 5000, 60 );
+   push( pool, first );
+   push( pool, other );
+   push( pool, second );
+   BOOST_CHECK( ( ids( pool.select( size, fc::microseconds::maximum(), fc::time_point::maximum(), gen ) )
+                  == vector<transaction_id_type>{ other.id() } ) );
+   BOOST_CHECK( ( ids( pool.select( size * 2, fc::microseconds::maximum(), fc::time_point::maximum(), gen ) )
+                  == vector<transaction_id_type>{ first.id(), second.id() } ) );
+   released = pool.release( now );
+   BOOST_REQUIRE_EQUAL( released.size(), 3u );
+   BOOST_CHECK( released[0].id() == first.id() );
+   BOOST_CHECK( released[1].id() == other.id() );
+   BOOST_CHECK( released[2].id() == second.id() );
+
+   // the choice stops at the deadline, the rest is skipped for time
+   for( uint32_t i = 0; i < 100; ++i )
+      push( pool, make_trx( 700 + i, 10, 60 ) );
+   block_generation_stats late;
+   const auto some = pool.select( size * 200, fc::microseconds::maximum(), fc::time_point::now(), late );
+   BOOST_CHECK_LT( some.size(), 100u );
+   BOOST_CHECK_EQUAL( some.size() + late.skipped_for_time, 100u );
+} FC_LOG_AND_RETHROW() }
+
+namespace {
+
+/// evaluates transfers by only taking time, for a pool of expensive transactions
+class slow_transfer_evaluator : public evaluator<slow_transfer_evaluator>
+{
+   public:
+      typedef transfer_operation operation_type;
+
+      static constexpr uint32_t delay_ms = 20;
+
+      void_result do_evaluate( const transfer_operation& )
+      {
+         std::this_thread::sleep_for( std::chrono::milliseconds( delay_ms ) );
+         return void_result();
+      }
+      void_result do_apply( const transfer_operation& ) { return void_result(); }
+};
+
+}
+
+BOOST_AUTO_TEST_CASE( block_generation_deadline_test )
+{ try {
+   ACTORS((1000)(2000));
+   fund( u_1000, asset( 10000000 ) );
+   generate_block();
+
+   db.register_evaluator<slow_transfer_evaluator>();
+   const uint32_t count = 10;
+   for( uint32_t i = 0; i < count; ++i )
+   {
+      transfer_operation op;
+      op.from = u_1000_id;
+      op.to = u_2000_id;
+      op.amount = asset( i + 1 );
+      trx.operations.push_back( op );
+      for( auto& o : trx.operations ) db.current_fee_schedule().set_fee( o );
+      set_expiration( db, trx );
+      db.push_transaction( trx, ~0 );
+      trx.clear();
+   }
+   BOOST_REQUIRE_EQUAL( db.get_pending_transaction_pool_stats().transactions, count );
+
+   const uint32_t skip = ~0 | database::skip_undo_history_check;
+   auto generate = [&]( fc::time_point deadline ) {
+      return db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, skip, deadline );
+   };
+
+   // a deadline in the past leaves every transaction pending
+   signed_block b = generate( fc::time_point::now() );
+   auto stats = db.get_last_block_generation_stats();
+   BOOST_CHECK( b.transactions.empty() );
+   BOOST_CHECK_EQUAL( stats.included, 0u );
+   BOOST_CHECK_EQUAL( stats.skipped_for_time, count );
+   BOOST_CHECK_EQUAL( db.get_pending_transaction_pool_stats().transactions, count );
+
+   // each transaction takes at least delay_ms, so at most 3 of them fit in 3.5 times that, and the ones which would
+   // overrun are not even tried
+   b = generate( fc::time_point::now() + fc::microseconds( slow_transfer_evaluator::delay_ms * 3500 ) );
+   stats = db.get_last_block_generation_stats();
+   BOOST_CHECK_EQUAL( b.transactions.size(), stats.included );
+   BOOST_CHECK_LE( stats.included, 3u );
+   BOOST_CHECK_EQUAL( stats.included + stats.skipped_for_time, count );
+   BOOST_CHECK_EQUAL( stats.failed, 0u );
+   BOOST_CHECK_EQUAL( stats.postponed_for_size, 0u );
+   BOOST_CHECK_EQUAL( db.get_pending_transaction_pool_stats().transactions, stats.skipped_for_time );
+
+   // without a deadline the rest is included
+   const uint32_t left = stats.skipped_for_time;
+   b = generate( fc::time_point::maximum() );
+   stats = db.get_last_block_generation_stats();
+   BOOST_CHECK_EQUAL( stats.included, left );
+   BOOST_CHECK_EQUAL( stats.skipped_for_time, 0u );
+   BOOST_CHECK_EQUAL( b.transactions.size(), left );
+   BOOST_CHECK_EQUAL( db.get_pending_transaction_pool_stats().transactions, 0u );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( dependent_pending_transactions_test )
+{ try {
+   ACTORS((1100)(1200)(1300));
+   fund( u_1100, asset( 100000 ) );
+   generate_block();
+
+   // the second transfer spends what the first one brings, and pays a higher fee
+   transfer_operation op;
+   op.from = u_1100_id;
+   op.to = u_1200_id;
+   op.amount = asset( 5000 );
+   trx.operations.push_back( op );
+   for( auto& o : trx.operations ) db.current_fee_schedule().set_fee( o );
+   set_expiration( db, trx );
+   db.push_transaction( trx, ~0 );
+   const transaction_id_type first = trx.id();
+   trx.clear();
+
+   op.from = u_1200_id;
+   op.to = u_1300_id;
+   op.amount = asset( 3000 );
+   op.fee = fee_type( asset( 1000 ) );
+   trx.operations.push_back( op );
+   set_expiration( db, trx );
+   db.push_transaction( trx, ~0 );
+   const transaction_id_type second = trx.id();
+   trx.clear();
+   BOOST_REQUIRE_EQUAL( db.get_pending_transaction_pool_stats().transactions, 2u );
+
+   // a block without them rebuilds the pending state, both still apply
+   const uint32_t skip = ~0 | database::skip_undo_history_check;
+   signed_block b = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, skip,
+                                       fc::time_point::now() );
+   BOOST_CHECK( b.transactions.empty() );
+   BOOST_CHECK_EQUAL( db.get_pending_transaction_pool_stats().transactions, 2u );
+   BOOST_CHECK( db.is_known_transaction( second ) );
+
+   // and they are packed in arrival order
+   b = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key, skip );
+   BOOST_CHECK_EQUAL( db.get_last_block_generation_stats().failed, 0u );
+   BOOST_REQUIRE_EQUAL( b.transactions.size(), 2u );
+   BOOST_CHECK( b.transactions[0].id() == first );
+   BOOST_CHECK( b.transactions[1].id() == second );
+   BOOST_CHECK_EQUAL( db.get_balance( u_1300_id, GRAPHENE_CORE_ASSET_AID ).amount.value, 3000 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/content_object.hpp>
+
+#include <graphene/post_search/post_search_plugin.hpp>
+#include <graphene/post_search/search_index.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( post_search_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( post_search_index_test )
+{
+   using namespace graphene::post_search;
+   post_search_index index;
+   auto make = []( uint64_t instance, account_uid_type platform, uint32_t time, const std::string& title,
+                   const std::string& body, const std::string& extra_data ) {
+      search_document doc;
+      doc.post_instance = instance;
+      doc.platform = platform;
+      doc.create_time = fc::time_point_sec( time );
+      doc.title = title;
+      doc.body = body;
+      doc.extra_data = extra_data;
+      return doc;
+   };
+   index.add( make( 1, 100, 10, "Hello World", "a post about the world", "{\"tags\":[\"Travel\",\"news\"]}" ) );
+   index.add( make( 2, 100, 20, "Another day", "hello again, world", "not json" ) );
+   index.add( make( 3, 100, 30, "Unrelated", "nothing to see", "{\"category\":\"travel\"}" ) );
+   index.add( make( 4, 200, 40, "Hello world", "on another platform", "" ) );
+
+   BOOST_CHECK( post_search_index::tokenize( "Hi, it's 2018!" ) == std::vector<std::string>( { "hi", "2018" } ) );
+
+   // all terms must match, the title weighs more than the body
+   auto hits = index.search( 100, "hello WORLD", 10 );
+   BOOST_REQUIRE_EQUAL( hits.size(), 2u );
+   BOOST_CHECK_EQUAL( hits[0].post_instance, 1u );
+   BOOST_CHECK_EQUAL( hits[0].score, 4u + 4u + 1u );
+   BOOST_CHECK_EQUAL( hits[1].post_instance, 2u );
+   BOOST_CHECK( index.search( 100, "hello nothing", 10 ).empty() );
+   BOOST_CHECK( index.search( 100, "missing", 10 ).empty() );
+   BOOST_CHECK( index.search( 100, "", 10 ).empty() );
+
+   // a '#' word only matches tags, ties are ordered newest first
+   hits = index.search( 100, "#travel", 10 );
+   BOOST_REQUIRE_EQUAL( hits.size(), 2u );
+   BOOST_CHECK_EQUAL( hits[0].post_instance, 3u );
+   BOOST_CHECK_EQUAL( hits[1].post_instance, 1u );
+   BOOST_CHECK( index.search( 100, "#world", 10 ).empty() );
+
+   // paging continues after the last hit of the previous page
+   hits = index.search( 100, "world", 1 );
+   BOOST_REQUIRE_EQUAL( hits.size(), 1u );
+   hits = index.search( 100, "world", 1, hits.back() );
+   BOOST_REQUIRE_EQUAL( hits.size(), 1u );
+   BOOST_CHECK_EQUAL( hits[0].post_instance, 2u );
+   BOOST_CHECK( index.search( 100, "world", 1, hits.back() ).empty() );
+
+   // replacing and removing posts, as modifying them and undoing blocks do
+   index.add( make( 2, 100, 20, "Another day", "changed", "" ) );
+   BOOST_CHECK_EQUAL( index.search( 100, "world", 10 ).size(), 1u );
+   index.remove( 1 );
+   BOOST_CHECK( index.search( 100, "world", 10 ).empty() );
+   BOOST_CHECK_EQUAL( index.search( 200, "world", 10 ).size(), 1u );
+   index.remove( 1 );
+   BOOST_CHECK_EQUAL( index.get_stats().documents, 3u );
+
+   // the oldest posts are dropped when the memory limit is reached
+   const uint64_t used = index.get_stats().memory_bytes;
+   index.set_max_memory( used - 1 );
+   BOOST_CHECK_EQUAL( index.get_stats().documents, 2u );
+   BOOST_CHECK_EQUAL( index.get_stats().evicted_documents, 1u );
+   BOOST_CHECK( !index.contains( 2 ) );
+   BOOST_CHECK( index.contains( 3 ) && index.contains( 4 ) );
+   BOOST_CHECK( index.get_stats().memory_bytes <= used - 1 );
+
+   index.clear();
+   BOOST_CHECK_EQUAL( index.get_stats().postings, 0u );
+
+   // a modified post is tokenized again when its text changed
+   post_search_secondary_index secondary;
+   post_object post;
+   post.id = post_id_type( 5 );
+   post.platform = 100;
+   post.title = "first";
+   secondary.object_inserted( post );
+   secondary.about_to_modify( post );
+   post.title = "second";
+   secondary.object_modified( post );
+   BOOST_CHECK( secondary.index.search( 100, "first", 10 ).empty() );
+   BOOST_CHECK_EQUAL( secondary.index.search( 100, "second", 10 ).size(), 1u );
+   secondary.about_to_modify( post );
+   post.body = "more text";
+   secondary.object_modified( post );
+   BOOST_CHECK_EQUAL( secondary.index.search( 100, "second text", 10 ).size(), 1u );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/proposal_object.hpp>
+
+#include <random>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( proposal_authorization_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( proposal_authorization_test )
+{ try {
+   vector<fc::ecc::private_key> keys;
+   vector<account_uid_type> uids;
+   for( uint32_t i = 0; i < 6; ++i )
+   {
+      keys.push_back( generate_private_key( "auth" + fc::to_string( i ) ) );
+      uids.push_back( create_account( 2000 + i, "auth" + fc::to_string( i ), keys.back().get_public_key() ).uid );
+   }
+   keys.push_back( generate_private_key( "unrelated" ) );
+   const account_uid_type m = uids[0];
+   typedef authority::account_uid_auth_type uid_auth;
+
+   // m needs 3 of: its key 1, active of uids[1] 1, active of uids[2] 2 which is the active of uids[4], secondary of
+   // uids[3] 2
+   authority multisig;
+   multisig.weight_threshold = 3;
+   multisig.key_auths[ keys[0].get_public_key() ] = 1;
+   multisig.account_uid_auths[ uid_auth( uids[1], authority::active_auth ) ] = 1;
+   multisig.account_uid_auths[ uid_auth( uids[2], authority::active_auth ) ] = 1;
+   multisig.account_uid_auths[ uid_auth( uids[3], authority::secondary_auth ) ] = 2;
+   auto set_authorities = [&]( account_uid_type uid, const authority& auth ) {
+      db.modify( db.get_account_by_uid( uid ), [&]( account_object& a ) {
+         a.active = auth;
+         a.secondary = auth;
+      });
+   };
+   set_authorities( m, multisig );
+   set_authorities( uids[2], authority( 1, uid_auth( uids[4], authority::active_auth ), 1 ) );
+
+   transfer_operation op;
+   op.from = m;
+   op.to = uids[5];
+   op.amount = asset( 1 );
+   transfer_operation op2 = op;
+   op2.from = uids[5];
+   op2.to = m;
+   const proposal_id_type pid = db.create<proposal_object>( [&]( proposal_object& p ) {
+      p.expiration_time = db.head_block_time() + 3600;
+      p.proposed_transaction.operations.push_back( op );
+      p.proposed_transaction.operations.push_back( op2 );
+   }).id;
+
+   auto toggle = [&]( const uid_auth* a, const public_key_type* k ) {
+      db.modify( pid( db ), [&]( proposal_object& p ) {
+         if( k != nullptr )
+         {
+            if( !p.available_key_approvals.erase( *k ) )
+               p.available_key_approvals.insert( *k );
+            return;
+         }
+         auto& s = a->auth_type == authority::owner_auth ? p.available_owner_approvals
+                 : a->auth_type == authority::active_auth ? p.available_active_approvals
+                 : p.available_secondary_approvals;
+         if( !s.erase( a->uid ) )
+            s.insert( a->uid );
+      });
+   };
+   auto clear = [&]() {
+      db.modify( pid( db ), [&]( proposal_object& p ) {
+         p.available_owner_approvals.clear();
+         p.available_active_approvals.clear();
+         p.available_secondary_approvals.clear();
+         p.available_key_approvals.clear();
+      });
+   };
+   const auto& index = dynamic_cast<const primary_index<proposal_index>&>( db.get_index_type<proposal_index>() )
+                          .get_secondary_index<proposal_authorization_index>();
+   auto check = [&]() -> bool {
+      const proposal_object& p = pid( db );
+      const bool authorized = p.verify_authorization( db );
+      BOOST_CHECK_EQUAL( p.is_authorized_to_execute( db ), authorized );
+      // never rules out a proposal the full check accepts
+      BOOST_CHECK( index.could_be_authorized( p ) || !authorized );
+      return authorized;
+   };
+   const public_key_type k5 = keys[5].get_public_key();
+   const public_key_type k0 = keys[0].get_public_key();
+   const uid_auth c_secondary( uids[3], authority::secondary_auth );
+
+   // nothing approves m, known without walking its authority
+   toggle( nullptr, &k5 );
+   BOOST_CHECK( !index.could_be_authorized( pid( db ) ) );
+   BOOST_CHECK( !check() );
+   toggle( &c_secondary, nullptr );
+   BOOST_CHECK( index.could_be_authorized( pid( db ) ) );
+   BOOST_CHECK( !check() );
+   toggle( nullptr, &k0 );
+   BOOST_CHECK( check() );
+   // removing an approval is taken back
+   toggle( &c_secondary, nullptr );
+   BOOST_CHECK( !check() );
+   // nested approvals: the key of uids[4] approves uids[2] through its active authority
+   const public_key_type k4 = keys[4].get_public_key();
+   toggle( nullptr, &k4 );
+   BOOST_CHECK( !check() );
+   toggle( nullptr, &k0 );
+   BOOST_CHECK( !check() );
+   toggle( &c_secondary, nullptr );
+   BOOST_CHECK( check() );
+
+   // the state follows the authorities of the accounts
+   clear();
+   toggle( nullptr, &k5 );
+   const uid_auth u5_active( uids[5], authority::active_auth );
+   toggle( &u5_active, nullptr );
+   BOOST_CHECK( !index.could_be_authorized( pid( db ) ) );
+   set_authorities( m, authority( 1, u5_active, 1 ) );
+   BOOST_CHECK( index.could_be_authorized( pid( db ) ) );
+   BOOST_CHECK( check() );
+   set_authorities( m, multisig );
+   BOOST_CHECK( !check() );
+   // a nested authority, uids[4] is only reached through uids[2]
+   toggle( &u5_active, nullptr );
+   const uid_auth d_active( uids[4], authority::active_auth );
+   toggle( &d_active, nullptr );
+   BOOST_CHECK( !check() );
+   set_authorities( uids[4], authority( 0, k5, 1 ) );
+   check();
+
+   // random approvals, authority changes and undone changes
+   vector<uid_auth> accounts;
+   for( auto uid : uids )
+      for( auto type : { authority::owner_auth, authority::active_auth, authority::secondary_auth } )
+         accounts.emplace_back( uid, type );
+   std::mt19937 rng( 71 );
+   uint32_t authorized = 0, ruled_out = 0;
+   for( uint32_t step = 0; step < 2000; ++step )
+   {
+      if( step % 16 == 0 )
+         clear();
+      const uint32_t r = rng() % 40;
+      if( r < accounts.size() )
+         toggle( &accounts[r], nullptr );
+      else if( r < accounts.size() + keys.size() )
+      {
+         const public_key_type k = keys[r - accounts.size()].get_public_key();
+         toggle( nullptr, &k );
+      }
+      else if( r == 39 )
+         set_authorities( uids[1 + rng() % 4], authority( rng() % 3, keys[rng() % keys.size()].get_public_key(), 1 ) );
+      else
+      {
+         auto session = db._undo_db.start_undo_session();
+         toggle( &accounts[rng() % accounts.size()], nullptr );
+         set_authorities( uids[1 + rng() % 4], authority( 1, accounts[rng() % accounts.size()], 1 ) );
+         check();
+      }
+      if( check() )
+         ++authorized;
+      if( !index.could_be_authorized( pid( db ) ) )
+         ++ruled_out;
+   }
+   BOOST_CHECK_GT( authorized, 0u );
+   BOOST_CHECK_GT( ruled_out, 0u );
+
+   // removed with the proposal
+   db.remove( pid( db ) );
+   BOOST_CHECK( index.could_be_authorized( proposal_object() ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
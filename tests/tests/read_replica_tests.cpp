@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( read_replica_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( push_blocks_from_test )
+{ try {
+   // the primary node has validated the blocks already
+   const uint32_t skip = database::skip_witness_signature | database::skip_transaction_signatures |
+                         database::skip_tapos_check | database::skip_authority_check |
+                         database::skip_merkle_check | database::skip_undo_history_check;
+   generate_blocks( 30 );
+
+   // the block database of the primary node, and the view of the replica on it
+   fc::temp_directory primary_dir( graphene::utilities::temp_directory_path() );
+   block_database primary;
+   primary.open( primary_dir.path() / "block_num_to_block" );
+   for( uint32_t n = 1; n <= db.head_block_num(); ++n )
+   {
+      const signed_block b = *db.fetch_block_by_number( n );
+      primary.store( b.id(), b );
+   }
+   primary.flush();
+   block_database source;
+   source.open( primary_dir.path() / "block_num_to_block", true );
+
+   fc::temp_directory replica_dir( graphene::utilities::temp_directory_path() );
+   database replica;
+   replica.open( replica_dir.path(), [this]{ return genesis_state; }, "test" );
+   BOOST_CHECK_EQUAL( replica.push_blocks_from( source, skip, 10 ), 10u );
+   BOOST_CHECK_EQUAL( replica.head_block_num(), 10u );
+   BOOST_CHECK_EQUAL( replica.push_blocks_from( source, skip, 1000 ), db.head_block_num() - 10 );
+   BOOST_CHECK( replica.head_block_id() == db.head_block_id() );
+   BOOST_CHECK_EQUAL( replica.push_blocks_from( source, skip, 1000 ), 0u );
+
+   // the primary switches to a longer branch, which starts after the irreversible block of the replica
+   const uint32_t head = replica.head_block_num();
+   const uint32_t fork = replica.get_dynamic_global_properties().last_irreversible_block_num + 1;
+   BOOST_REQUIRE( fork < head );
+   fc::temp_directory other_dir( graphene::utilities::temp_directory_path() );
+   database other;
+   other.open( other_dir.path(), [this]{ return genesis_state; }, "test" );
+   for( uint32_t n = 1; n <= fork; ++n )
+      other.push_block( *db.fetch_block_by_number( n ), skip );
+   std::vector<signed_block> branch;
+   for( uint32_t n = fork; n <= head; ++n )
+   {
+      const uint32_t slot = branch.empty() ? 2 : 1;
+      branch.push_back( other.generate_block( other.get_slot_time( slot ), other.get_scheduled_witness( slot ),
+                                              init_account_priv_key, database::skip_undo_history_check ) );
+   }
+   // the blocks of the new branch are saved as the primary switches to it
+   for( const auto& b : branch )
+      primary.store( b.id(), b );
+   primary.flush();
+
+   BOOST_CHECK_EQUAL( replica.push_blocks_from( source, skip, 1000 ), branch.size() );
+   BOOST_CHECK_EQUAL( replica.head_block_num(), head + 1 );
+   BOOST_CHECK( replica.head_block_id() == branch.back().id() );
+   BOOST_CHECK( replica.get_dynamic_global_properties().head_block_id == other.head_block_id() );
+   BOOST_CHECK( replica._popped_tx.empty() );
+
+   other.close();
+   replica.close();
+   source.close();
+   primary.close();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
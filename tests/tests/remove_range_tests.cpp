@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/transaction_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( remove_range_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( remove_range_test )
+{ try {
+   auto& trx_idx = const_cast< primary_index<transaction_index>& >( db.get_index_type< primary_index<transaction_index> >() );
+   const auto& by_exp = trx_idx.indices().get<by_expiration>();
+   const size_t initial = trx_idx.indices().size();
+   const fc::time_point_sec base = db.head_block_time() + 3600;
+
+   auto session = db._undo_db.start_undo_session();
+   vector<transaction_id_type> ids;
+   {
+      // the objects exist before the session under test
+      auto create_session = db._undo_db.start_undo_session();
+      for( uint32_t i = 0; i < 100; ++i )
+      {
+         const auto& t = db.create<transaction_object>( [&]( transaction_object& o ) {
+            o.trx.expiration = base + i % 10;
+            o.trx.ref_block_num = i;
+            o.trx_id = o.trx.id();
+         });
+         ids.push_back( t.trx_id );
+      }
+      create_session.merge();
+   }
+   const auto& by_trx_id = trx_idx.indices().get<by_trx_id>();
+   {
+      auto remove_session = db._undo_db.start_undo_session();
+      // a modified object must be restored with its value from before the modification
+      db.modify( *by_trx_id.find( ids[0] ), []( transaction_object& o ) { o.trx.ref_prefix = 42; } );
+      const auto end = by_exp.lower_bound( base + 5 );
+      BOOST_CHECK_EQUAL( trx_idx.remove_range( by_exp.lower_bound( base ), end ), 50u );
+      BOOST_CHECK_EQUAL( trx_idx.indices().size(), initial + 50 );
+      BOOST_CHECK( by_exp.lower_bound( base ) == by_exp.lower_bound( base + 5 ) );
+      BOOST_CHECK_EQUAL( trx_idx.remove_range( end, end ), 0u );
+   }
+   BOOST_CHECK_EQUAL( trx_idx.indices().size(), initial + 100 );
+   for( uint32_t i = 0; i < 100; ++i )
+   {
+      auto itr = by_trx_id.find( ids[i] );
+      BOOST_REQUIRE( itr != by_trx_id.end() );
+      BOOST_CHECK( itr->trx.expiration == base + i % 10 );
+      BOOST_CHECK_EQUAL( itr->trx.ref_block_num, i );
+      BOOST_CHECK_EQUAL( itr->trx.ref_prefix, 0u );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
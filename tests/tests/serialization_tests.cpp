@@ -25,6 +25,9 @@
 #include <boost/test/unit_test.hpp>
 
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/protocol/packed_block.hpp>
+#include <graphene/net/core_messages.hpp>
+#include <graphene/utilities/tempdir.hpp>
 
 
 #include <fc/crypto/digest.hpp>
@@ -122,4 +125,89 @@ BOOST_AUTO_TEST_CASE( extended_public_key_type_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( packed_block_test )
+{
+   try {
+      ACTORS((1000)(2000));
+      fund( u_1000, asset( 1000000 ) );
+      for( int64_t i = 1; i <= 5; ++i )
+         transfer( u_1000, u_2000, asset( i ) );
+      const signed_block b = generate_block();
+      BOOST_REQUIRE_GT( b.transactions.size(), 0u );
+      const vector<char> bytes = fc::raw::pack( b );
+
+      // packing and reading the bytes give the same header, ID and block
+      for( const packed_block& p : { packed_block( b ), packed_block( bytes ) } )
+      {
+         BOOST_CHECK( p.bytes() == bytes );
+         BOOST_CHECK( p.id() == b.id() );
+         BOOST_CHECK_EQUAL( p.block_num(), b.block_num() );
+         BOOST_CHECK( p.header().previous == b.previous );
+         BOOST_CHECK( p.header().timestamp == b.timestamp );
+         BOOST_CHECK( p.header().witness_signature == b.witness_signature );
+         BOOST_CHECK( p.header().digest() == b.digest() );
+         BOOST_CHECK_EQUAL( p.transaction_count(), b.transactions.size() );
+         BOOST_CHECK( fc::raw::pack( p.block() ) == bytes );
+         BOOST_CHECK( fc::raw::pack( p.decode() ) == bytes );
+         BOOST_CHECK( p.block().calculate_merkle_root() == b.transaction_merkle_root );
+      }
+      GRAPHENE_REQUIRE_THROW( packed_block( vector<char>( bytes.begin(), bytes.begin() + 10 ) ), fc::exception );
+
+      // the block database stores and returns the bytes unchanged
+      auto stored = db.fetch_packed_block_by_id( b.id() );
+      BOOST_REQUIRE( stored.valid() );
+      BOOST_CHECK( stored->bytes() == bytes );
+      BOOST_CHECK( !db.fetch_packed_block_by_id( block_id_type() ).valid() );
+
+      // a block message made of the bytes is the message made by packing the block, and decodes back to them
+      const graphene::net::message m = graphene::net::block_message::to_message( *stored );
+      const graphene::net::message expected = graphene::net::block_message( b );
+      BOOST_CHECK( m.data == expected.data );
+      BOOST_CHECK_EQUAL( m.size, expected.size );
+      BOOST_CHECK_EQUAL( m.msg_type, expected.msg_type );
+      const auto received = graphene::net::block_message::from_message( m );
+      BOOST_CHECK( received.block_id == b.id() );
+      BOOST_REQUIRE( received.packed );
+      BOOST_CHECK( received.packed->bytes() == bytes );
+      BOOST_CHECK( fc::raw::pack( received.block ) == bytes );
+
+      // a message whose ID does not match its block keeps no bytes
+      graphene::net::block_message forged( b );
+      forged.block_id = block_id_type();
+      BOOST_CHECK( !graphene::net::block_message::from_message( graphene::net::message( forged ) ).packed );
+
+      // nor does a message with data after the block, even when the ID matches
+      graphene::net::message padded = m;
+      const vector<char> id = fc::raw::pack( b.id() );
+      padded.data.insert( padded.data.end(), 4, 0 );
+      padded.data.insert( padded.data.end(), id.begin(), id.end() );
+      padded.size = (uint32_t)padded.data.size();
+      const auto padded_received = graphene::net::block_message::from_message( padded );
+      BOOST_CHECK( padded_received.block_id == b.id() );
+      BOOST_CHECK( !padded_received.packed );
+      BOOST_CHECK( fc::raw::pack( padded_received.block ) == bytes );
+
+      // a block pushed with its bytes is stored as them
+      BOOST_REQUIRE_EQUAL( b.block_num(), db.head_block_num() );
+      database db2;
+      fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+      db2.open( dir.path(), [this]{ return genesis_state; }, "test" );
+      for( uint32_t num = 1; num <= db.head_block_num(); ++num )
+      {
+         auto block = db.fetch_block_by_number( num );
+         BOOST_REQUIRE( block.valid() );
+         db2.push_block( packed_block( fc::raw::pack( *block ) ), ~0 );
+      }
+      BOOST_CHECK( db2.head_block_id() == db.head_block_id() );
+      const signed_block previous = *db.fetch_block_by_number( b.block_num() - 1 );
+      auto stored_previous = db2.fetch_packed_block_by_id( previous.id() );
+      BOOST_REQUIRE( stored_previous.valid() );
+      BOOST_CHECK( stored_previous->bytes() == fc::raw::pack( previous ) );
+      auto stored2 = db2.fetch_packed_block_by_id( b.id() );
+      BOOST_REQUIRE( stored2.valid() );
+      BOOST_CHECK( stored2->bytes() == bytes );
+      db2.close();
+   } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
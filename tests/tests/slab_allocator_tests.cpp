@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include <graphene/db/slab_allocator.hpp>
+
+#include <algorithm>
+#include <array>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( slab_allocator_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( slab_allocator_test )
+{ try {
+   graphene::db::slab_pool pool( "test" );
+   graphene::db::slab_allocator<uint64_t> alloc( &pool );
+
+   uint64_t* first = alloc.allocate( 1 );
+   BOOST_CHECK_EQUAL( pool.get_stats().slot_size, sizeof(uint64_t) );
+   BOOST_CHECK_EQUAL( pool.get_stats().slabs, 1u );
+   BOOST_CHECK_EQUAL( pool.get_stats().in_use, 1u );
+   uint64_t* second = alloc.allocate( 1 );
+   BOOST_CHECK( second != first );
+   alloc.deallocate( first, 1 );
+   BOOST_CHECK_EQUAL( pool.get_stats().in_use, 1u );
+
+   // the freed slot is served again
+   BOOST_CHECK( alloc.allocate( 1 ) == first );
+   BOOST_CHECK_EQUAL( pool.get_stats().in_use, 2u );
+   BOOST_CHECK_EQUAL( pool.get_stats().peak_in_use, 2u );
+   BOOST_CHECK_EQUAL( pool.get_stats().total_allocations, 3u );
+
+   // arrays and nodes of another size go to the heap
+   uint64_t* array = alloc.allocate( 4 );
+   alloc.deallocate( array, 4 );
+   graphene::db::slab_allocator< std::array<char,64> > other( &pool );
+   auto* large = other.allocate( 1 );
+   other.deallocate( large, 1 );
+   BOOST_CHECK_EQUAL( pool.get_stats().in_use, 2u );
+   BOOST_CHECK_EQUAL( pool.get_stats().total_allocations, 3u );
+   alloc.deallocate( first, 1 );
+   alloc.deallocate( second, 1 );
+   BOOST_CHECK_EQUAL( pool.get_stats().in_use, 0u );
+   BOOST_CHECK_EQUAL( pool.get_stats().slabs, 1u );
+
+   // each index has its own pool, the stats of the database count the nodes of its own indexes
+   const auto& balances = db.get_index_type<account_balance_index>().indices();
+   const auto stats = db.get_memory_pool_stats();
+   auto itr = std::find_if( stats.begin(), stats.end(), []( const graphene::db::slab_pool_stats& s ) -> bool {
+      return s.object_type.find( "account_balance_object" ) != std::string::npos;
+   });
+   BOOST_REQUIRE( itr != stats.end() );
+   BOOST_CHECK_EQUAL( itr->in_use, balances.size() + 1 ); // and the header node of the container
+
+   fc::temp_directory other_dir( graphene::utilities::temp_directory_path() );
+   {
+      database other_db;
+      other_db.open( other_dir.path(), [this]{ return genesis_state; }, "test" );
+      const graphene::db::slab_pool* mine = db.get_index_type<account_balance_index>().get_slab_pool();
+      const graphene::db::slab_pool* theirs = other_db.get_index_type<account_balance_index>().get_slab_pool();
+      BOOST_REQUIRE( mine != nullptr && theirs != nullptr );
+      BOOST_CHECK( mine != theirs );
+      const uint64_t in_use = theirs->get_stats().in_use;
+      fund( create_account( 3300u, "poolowner" ), asset( 1000 ) );
+      BOOST_CHECK_EQUAL( mine->get_stats().in_use, balances.size() + 1 );
+      BOOST_CHECK_EQUAL( theirs->get_stats().in_use, in_use );
+      BOOST_CHECK_EQUAL( theirs->get_stats().in_use,
+                         other_db.get_index_type<account_balance_index>().indices().size() + 1 );
+      other_db.close();
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
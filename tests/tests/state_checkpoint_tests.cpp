@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <graphene/chain/database.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( state_checkpoint_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( state_checkpoint_restart_test )
+{ try {
+   const uint32_t skip = database::skip_undo_history_check;
+   generate_blocks( 40 );
+
+   fc::temp_directory node_dir( graphene::utilities::temp_directory_path() );
+   database node;
+   node.open( node_dir.path(), [this]{ return genesis_state; }, "test" );
+   node.set_state_checkpoint_interval( 5 );
+   uint32_t pushed = 0;
+   while( !fc::exists( node_dir.path() / "object_database" ) && pushed < db.head_block_num() )
+   {
+      node.push_block( *db.fetch_block_by_number( ++pushed ), skip );
+      node.wait_for_state_checkpoint();
+   }
+   BOOST_REQUIRE( fc::exists( node_dir.path() / "object_database" ) );
+   const uint32_t head = node.head_block_num();
+   const uint32_t irreversible = node.get_dynamic_global_properties().last_irreversible_block_num;
+   BOOST_REQUIRE( irreversible + 1 < head );
+
+   // the node crashes right after the checkpoint
+   fc::temp_directory crash_dir( graphene::utilities::temp_directory_path() );
+   const boost::filesystem::path from( node_dir.path().generic_string() );
+   const boost::filesystem::path to( crash_dir.path().generic_string() );
+   for( boost::filesystem::recursive_directory_iterator itr( from ), end; itr != end; ++itr )
+   {
+      const boost::filesystem::path target = to / itr->path().generic_string().substr( from.generic_string().size() );
+      if( boost::filesystem::is_directory( itr->path() ) )
+         boost::filesystem::create_directories( target );
+      else
+         boost::filesystem::copy_file( itr->path(), target );
+   }
+
+   // the saved state is the irreversible one, the blocks after it are replayed and can be popped again
+   database restarted;
+   restarted.open( crash_dir.path(), [this]{ return genesis_state; }, "test" );
+   BOOST_CHECK_EQUAL( restarted.head_block_num(), head );
+   BOOST_CHECK( restarted.head_block_id() == node.head_block_id() );
+
+   // another node forks off right after the irreversible block and builds a longer branch
+   fc::temp_directory other_dir( graphene::utilities::temp_directory_path() );
+   database other;
+   other.open( other_dir.path(), [this]{ return genesis_state; }, "test" );
+   for( uint32_t n = 1; n <= irreversible + 1; ++n )
+      other.push_block( *db.fetch_block_by_number( n ), skip );
+   std::vector<signed_block> branch;
+   for( uint32_t n = irreversible + 1; n <= head; ++n )
+   {
+      const uint32_t slot = branch.empty() ? 2 : 1;
+      branch.push_back( other.generate_block( other.get_slot_time( slot ), other.get_scheduled_witness( slot ),
+                                              init_account_priv_key, skip ) );
+   }
+   for( const auto& b : branch )
+      restarted.push_block( b, skip );
+   BOOST_CHECK_EQUAL( restarted.head_block_num(), head + 1 );
+   BOOST_CHECK( restarted.head_block_id() == branch.back().id() );
+   BOOST_CHECK( restarted.fetch_block_by_number( irreversible + 2 )->id() == branch.front().id() );
+
+   other.close();
+   restarted.close();
+   node.close();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
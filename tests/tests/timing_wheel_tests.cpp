@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+
+#include <graphene/db/timing_wheel.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( timing_wheel_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( timing_wheel_test )
+{
+   timing_wheel<uint32_t, 4> wheel; // 16 slots so the overflow level is exercised
+
+   wheel.schedule( 3, 30 );
+   wheel.schedule( 3, 31 );
+   wheel.schedule( 10, 100 );
+   wheel.schedule( 40, 400 );   // beyond the window
+   wheel.schedule( 1000, 1 );
+   BOOST_CHECK_EQUAL( wheel.size(), 5u );
+
+   BOOST_CHECK( wheel.due( 2 ).empty() );
+   BOOST_CHECK( ( wheel.due( 3 ) == vector<uint32_t>{ 30, 31 } ) );
+
+   wheel.cancel( 3, 30 );
+   BOOST_CHECK( ( wheel.due( 5 ) == vector<uint32_t>{ 31 } ) );
+   wheel.cancel( 3, 31 );
+
+   // cascade from the overflow level
+   BOOST_CHECK( ( wheel.due( 39 ) == vector<uint32_t>{ 100 } ) );
+   wheel.cancel( 10, 100 );
+   BOOST_CHECK( ( wheel.due( 40 ) == vector<uint32_t>{ 400 } ) );
+
+   // move backwards, as after popping blocks
+   wheel.schedule( 35, 350 );
+   BOOST_CHECK( wheel.due( 34 ).empty() );
+   BOOST_CHECK( ( wheel.due( 36 ) == vector<uint32_t>{ 350 } ) );
+   BOOST_CHECK( ( wheel.due( 40 ) == vector<uint32_t>{ 350, 400 } ) );
+   wheel.cancel( 35, 350 );
+   wheel.cancel( 40, 400 );
+
+   BOOST_CHECK( wheel.due( 999 ).empty() );
+   BOOST_CHECK( ( wheel.due( 5000 ) == vector<uint32_t>{ 1 } ) );
+   wheel.cancel( 1000, 1 );
+   BOOST_CHECK_EQUAL( wheel.size(), 0u );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+
+#include <graphene/utilities/transaction_tracer.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( transaction_tracer_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( transaction_tracer_test )
+{
+   using graphene::utilities::transaction_tracer;
+   auto& tracer = transaction_tracer::instance();
+   const auto a = fc::ripemd160::hash( std::string( "a" ) );
+   const auto b = fc::ripemd160::hash( std::string( "b" ) );
+   const auto c = fc::ripemd160::hash( std::string( "c" ) );
+
+   tracer.record( a, transaction_tracer::received_stage );
+   BOOST_CHECK( !tracer.enabled() );
+   BOOST_CHECK( !tracer.get_trace( a ).valid() );
+
+   tracer.configure( 1, 2 );
+   // a trace starts when the transaction is first seen
+   tracer.record( a, transaction_tracer::included_stage, 5 );
+   BOOST_CHECK( !tracer.get_trace( a ).valid() );
+   tracer.record( a, transaction_tracer::received_stage );
+   tracer.record( b, transaction_tracer::validated_stage );
+   tracer.record( b, transaction_tracer::advertised_stage );
+   tracer.record( b, transaction_tracer::included_stage, 10 );
+   tracer.record( b, transaction_tracer::reapplied_stage );
+   tracer.record( b, transaction_tracer::reapplied_stage );
+
+   auto trace = tracer.get_trace( b );
+   BOOST_REQUIRE( trace.valid() );
+   BOOST_CHECK( trace->received == fc::time_point() );
+   BOOST_CHECK( trace->validated != fc::time_point() );
+   BOOST_CHECK( trace->advertised >= trace->validated );
+   BOOST_CHECK( trace->included >= trace->advertised );
+   BOOST_CHECK_EQUAL( trace->block_num, 10u );
+   BOOST_CHECK_EQUAL( trace->reapply_count, 2u );
+
+   tracer.record_irreversible( 9 );
+   BOOST_CHECK( tracer.get_trace( b )->irreversible == fc::time_point() );
+   tracer.record_irreversible( 10 );
+   BOOST_CHECK( tracer.get_trace( b )->irreversible >= trace->included );
+
+   // the oldest trace is dropped when the buffer is full
+   tracer.record( c, transaction_tracer::received_stage );
+   BOOST_CHECK( !tracer.get_trace( a ).valid() );
+   auto recent = tracer.get_recent_traces( 10 );
+   BOOST_REQUIRE_EQUAL( recent.size(), 2u );
+   BOOST_CHECK( recent[0].trx_id == c );
+   BOOST_CHECK( recent[1].trx_id == b );
+   BOOST_CHECK_EQUAL( tracer.get_recent_traces( 1 ).size(), 1u );
+
+   tracer.configure( 2, 10 );
+   BOOST_CHECK_EQUAL( tracer.is_sampled( a ), a._hash[0] % 2 == 0 );
+   BOOST_CHECK_EQUAL( tracer.is_sampled( b ), b._hash[0] % 2 == 0 );
+
+   tracer.configure( 0, 0 );
+   BOOST_CHECK( !tracer.enabled() );
+   BOOST_CHECK( tracer.get_recent_traces( 10 ).empty() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
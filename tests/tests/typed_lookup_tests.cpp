@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/block_summary_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( typed_lookup_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( typed_lookup_test )
+{ try {
+   create_account( 1001, "lookup1" );
+   create_account( 1002, "lookup2" );
+
+   // registered types are found through their concrete index, check it agrees with the polymorphic path
+   for( const auto& a : db.get_index_type<account_index>().indices() )
+   {
+      BOOST_CHECK( db.find<account_object>( a.id ) == &a );
+      BOOST_CHECK( db.find_object( a.id ) == &a );
+      BOOST_CHECK( &db.get( a.statistics ) == db.find_object( a.statistics ) );
+   }
+   BOOST_CHECK( &db.get( block_summary_id_type( 1 ) ) == db.find_object( block_summary_id_type( 1 ) ) );
+
+   const object_id_type next_id = db.get_index_type<account_index>().get_next_id();
+   BOOST_CHECK( db.find<account_object>( next_id ) == nullptr );
+   BOOST_CHECK_THROW( db.get<account_object>( next_id ), fc::exception );
+
+   // the dense instance table follows undo
+   {
+      auto session = db._undo_db.start_undo_session();
+      const account_object& a = db.create<account_object>( [&]( account_object& o ) {
+         o.uid = graphene::chain::calc_account_uid( 1003 );
+         o.name = "lookup3";
+      });
+      BOOST_CHECK( a.id == next_id );
+      BOOST_CHECK( db.find<account_object>( next_id ) == &a );
+   }
+   BOOST_CHECK( db.find<account_object>( next_id ) == nullptr );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
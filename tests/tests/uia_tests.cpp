@@ -34,6 +34,9 @@
 
 #include <fc/crypto/digest.hpp>
 
+#include <algorithm>
+#include <random>
+
 #include "../common/database_fixture.hpp"
 
 using namespace graphene::chain;
@@ -453,4 +456,114 @@ BOOST_AUTO_TEST_CASE( asset_name_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( asset_holder_aggregates_test )
+{ try {
+   ACTORS( (1000)(1001)(1002)(1003)(1004)(1005)(1006)(1007) );
+   const account_uid_type actors[] = { u_1000_id, u_1001_id, u_1002_id, u_1003_id,
+                                       u_1004_id, u_1005_id, u_1006_id, u_1007_id };
+   const asset_object& token = create_user_issued_asset( "HOLDERS", u_1000, 0 );
+   const asset_aid_type token_id = token.asset_id;
+
+   const auto& bal_idx = db.get_index_type< account_balance_index >();
+   const auto& holders = dynamic_cast<const primary_index< account_balance_index >&>( bal_idx )
+                            .get_secondary_index< asset_holder_index >();
+
+   // compares the maintained aggregates of every asset with a full scan of the balances
+   auto check_aggregates = [&]() {
+      map< asset_aid_type, asset_holder_stats > expected;
+      for( const account_balance_object& b : bal_idx.indices() )
+      {
+         asset_holder_stats& stats = expected[b.asset_type];
+         if( b.balance != 0 )
+            ++stats.holders;
+         stats.total_balance += b.balance;
+      }
+      for( const auto& e : expected )
+      {
+         const asset_holder_stats stats = holders.get_stats( e.first );
+         BOOST_CHECK_EQUAL( stats.holders, e.second.holders );
+         BOOST_CHECK( stats.total_balance == e.second.total_balance );
+      }
+      for( const auto& s : holders.get_all_stats() )
+      {
+         if( expected.find( s.first ) == expected.end() )
+         {
+            BOOST_CHECK_EQUAL( s.second.holders, 0u );
+            BOOST_CHECK( s.second.total_balance == 0 );
+         }
+      }
+   };
+
+   BOOST_CHECK_EQUAL( holders.get_stats( token_id ).holders, 0u );
+   issue_uia( u_1001, token.amount( 1000 ) );
+   issue_uia( u_1002, token.amount( 500 ) );
+   BOOST_CHECK_EQUAL( holders.get_stats( token_id ).holders, 2u );
+   BOOST_CHECK( holders.get_stats( token_id ).total_balance == 1500 );
+   check_aggregates();
+   // the blocks go through the fork database, so that the last one can be popped
+   generate_block( ~database::skip_fork_db );
+
+   std::mt19937 rng( 1234 );
+   auto random_transfers = [&]( uint32_t count ) {
+      for( uint32_t i = 0; i < count; ++i )
+      {
+         const account_uid_type from = actors[ rng() % 8 ];
+         const account_uid_type to   = actors[ rng() % 8 ];
+         const share_type balance = db.get_balance( from, token_id ).amount;
+         if( balance == 0 || from == to )
+            continue;
+         // moving the whole balance now and then empties accounts
+         const share_type amount = ( rng() % 4 == 0 ) ? balance : share_type( 1 + rng() % balance.value );
+         db.adjust_balance( from, asset( -amount, token_id ) );
+         db.adjust_balance( to, asset( amount, token_id ) );
+      }
+   };
+
+   // transfers which are kept
+   {
+      auto session = db._undo_db.start_undo_session();
+      random_transfers( 300 );
+      check_aggregates();
+      session.merge();
+   }
+   check_aggregates();
+   const asset_holder_stats kept = holders.get_stats( token_id );
+   BOOST_CHECK( kept.total_balance == 1500 );
+
+   // transfers and a removed balance which are undone
+   {
+      auto session = db._undo_db.start_undo_session();
+      random_transfers( 300 );
+      auto itr = bal_idx.indices().get<by_asset_balance>().lower_bound( token_id );
+      BOOST_REQUIRE( itr != bal_idx.indices().get<by_asset_balance>().end() && itr->asset_type == token_id );
+      db.remove( *itr );
+      check_aggregates();
+   }
+   check_aggregates();
+   BOOST_CHECK_EQUAL( holders.get_stats( token_id ).holders, kept.holders );
+   BOOST_CHECK( holders.get_stats( token_id ).total_balance == kept.total_balance );
+
+   // a block which is popped, as when switching forks
+   const asset_holder_stats before_block = holders.get_stats( token_id );
+   issue_uia( u_1007, token.amount( 250 ) );
+   issue_uia( u_1006, token.amount( 250 ) );
+   generate_block( ~database::skip_fork_db );
+   BOOST_CHECK( holders.get_stats( token_id ).total_balance == before_block.total_balance + 500 );
+   check_aggregates();
+   db.pop_block();
+   db.clear_pending();
+   check_aggregates();
+   BOOST_CHECK_EQUAL( holders.get_stats( token_id ).holders, before_block.holders );
+   BOOST_CHECK( holders.get_stats( token_id ).total_balance == before_block.total_balance );
+
+   // the top holders are the largest non-zero balances, largest first
+   const auto& by_balance = bal_idx.indices().get<by_asset_balance>();
+   vector< share_type > top;
+   for( auto itr = by_balance.lower_bound( token_id ); itr != by_balance.end() && itr->asset_type == token_id; ++itr )
+      if( itr->balance != 0 )
+         top.push_back( itr->balance );
+   BOOST_CHECK_EQUAL( top.size(), holders.get_stats( token_id ).holders );
+   BOOST_CHECK( std::is_sorted( top.begin(), top.end(), std::greater< share_type >() ) );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/csaf_object.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <limits>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( undo_spill_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( undo_spill_test )
+{ try {
+   generate_block();
+   auto& undo = db._undo_db;
+   // irreversibility stalls, all the states are kept
+   undo.set_max_size( 1000 );
+   undo.set_spill_limits( 4, 0 );
+   const size_t base = undo.size();
+
+   vector<csaf_lease_id_type> leases;
+   auto snapshot = [&]() -> map<csaf_lease_id_type, share_type> {
+      map<csaf_lease_id_type, share_type> amounts;
+      for( const auto& id : leases )
+      {
+         const csaf_lease_object* lease = db.find( id );
+         if( lease != nullptr )
+            amounts[id] = lease->amount;
+      }
+      return amounts;
+   };
+   vector<map<csaf_lease_id_type, share_type>> snapshots;
+   for( uint32_t b = 0; b < 40; ++b )
+   {
+      snapshots.push_back( snapshot() );
+      auto session = undo.start_undo_session();
+      leases.push_back( db.create<csaf_lease_object>( [&]( csaf_lease_object& o ) {
+         o.from = 1;
+         o.to = 100 + b;
+         o.amount = b;
+      }).id );
+      if( b > 0 && db.find( leases[b - 1] ) != nullptr )
+         db.modify( leases[b - 1]( db ), [&]( csaf_lease_object& o ) { o.amount += 1000; } );
+      if( b > 1 && b % 5 == 0 )
+         db.remove( leases[b - 2]( db ) );
+      session.commit();
+      // memory stays flat
+      BOOST_CHECK_LE( undo.memory_size(), 4u );
+   }
+   BOOST_CHECK_EQUAL( undo.size(), base + 40 );
+   BOOST_CHECK_GE( undo.spilled_size(), 36u );
+   BOOST_CHECK( fc::exists( db.get_data_dir() / "undo_spill" ) );
+
+   // undone deeper than the states kept in memory, the spilled states are read back
+   for( uint32_t b = 40; b > 25; --b )
+   {
+      undo.pop_commit();
+      BOOST_CHECK( snapshot() == snapshots[b - 1] );
+   }
+   BOOST_CHECK_EQUAL( undo.size(), base + 25 );
+
+   // states spilled again after some were read back, and a session merged into a spilled state
+   for( uint32_t b = 25; b < 30; ++b )
+   {
+      auto session = undo.start_undo_session();
+      db.modify( leases[0]( db ), [&]( csaf_lease_object& o ) { o.amount += 1; } );
+      session.commit();
+   }
+   undo.set_spill_limits( 1, 0 );
+   {
+      auto session = undo.start_undo_session();
+      db.modify( leases[0]( db ), [&]( csaf_lease_object& o ) { o.amount += 1; } );
+      session.merge();
+   }
+   BOOST_CHECK_EQUAL( undo.size(), base + 30 );
+   for( uint32_t b = 30; b > 25; --b )
+      undo.pop_commit();
+   BOOST_CHECK( snapshot() == snapshots[25] );
+
+   // a budget in bytes
+   undo.set_spill_limits( 0, 1 );
+   {
+      auto session = undo.start_undo_session();
+      db.modify( leases[1]( db ), [&]( csaf_lease_object& o ) { o.amount += 1; } );
+      session.commit();
+   }
+   {
+      auto session = undo.start_undo_session();
+      BOOST_CHECK_LE( undo.memory_size(), 2u );
+   }
+   undo.pop_commit();
+   BOOST_CHECK( snapshot() == snapshots[25] );
+   while( undo.size() > base )
+      undo.pop_commit();
+   BOOST_CHECK( snapshot() == snapshots[0] );
+
+   // in steady state the states dropped make room in the spill file for the new ones, and the sizes tracked as the
+   // states change are those measured from scratch
+   const fc::path spill_file = db.get_data_dir() / "undo_spill";
+   vector<csaf_lease_id_type> steady;
+   for( uint32_t i = 0; i < 50; ++i )
+      steady.push_back( db.create<csaf_lease_object>( [&]( csaf_lease_object& o ) {
+         o.from = 2;
+         o.to = 100 + i;
+      }).id );
+   undo.set_max_size( base + 20 );
+   undo.set_spill_limits( 2, std::numeric_limits<uint64_t>::max() );
+   uint64_t warm_file_size = 0;
+   for( uint32_t b = 0; b < 400; ++b )
+   {
+      auto session = undo.start_undo_session();
+      for( const auto& id : steady )
+         db.modify( id( db ), [&]( csaf_lease_object& o ) { o.amount += 1; } );
+      if( b % 3 == 0 )
+      {
+         auto nested = undo.start_undo_session();
+         db.remove( steady[b % steady.size()]( db ) );
+         steady[b % steady.size()] = db.create<csaf_lease_object>( [&]( csaf_lease_object& o ) {
+            o.from = 2;
+            o.to = 1000 + b;
+         }).id;
+         nested.merge();
+      }
+      session.commit();
+      if( b == 100 )
+         warm_file_size = fc::file_size( spill_file );
+   }
+   BOOST_CHECK_LE( undo.size(), base + 21 );
+   BOOST_CHECK_LE( undo.memory_size(), 2u );
+   BOOST_CHECK_GT( warm_file_size, 0u );
+   BOOST_CHECK_LT( fc::file_size( spill_file ), 3 * warm_file_size );
+   const uint64_t tracked = undo.bytes_in_memory();
+   BOOST_CHECK_GT( tracked, 0u );
+   undo.set_spill_limits( 0, 0 );
+   undo.set_spill_limits( 0, std::numeric_limits<uint64_t>::max() );
+   BOOST_CHECK_EQUAL( undo.bytes_in_memory(), tracked );
+   undo.set_max_size( 1000 );
+
+   // blocks popped below the ones whose history is in memory, they go through the fork database to be popped
+   undo.set_spill_limits( 1, 0 );
+   const uint32_t head = db.head_block_num();
+   generate_block( ~database::skip_fork_db );
+   generate_block( ~database::skip_fork_db );
+   generate_block( ~database::skip_fork_db );
+   db.pop_block();
+   db.pop_block();
+   BOOST_CHECK_EQUAL( db.head_block_num(), head + 1 );
+   generate_block( ~database::skip_fork_db );
+   BOOST_CHECK_EQUAL( db.head_block_num(), head + 2 );
+   undo.set_spill_limits( 0, 0 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
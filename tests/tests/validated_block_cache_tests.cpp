@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/validated_block_cache.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( validated_block_cache_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( validated_block_cache_test )
+{ try {
+   const uint32_t skip = database::skip_undo_history_check;
+   auto next_block = [&]( database& d, uint32_t slot ) -> signed_block {
+      return d.generate_block( d.get_slot_time( slot ), d.get_scheduled_witness( slot ), init_account_priv_key, skip );
+   };
+   // two other nodes, each building a branch from a common block
+   fc::temp_directory mine_dir( graphene::utilities::temp_directory_path() );
+   fc::temp_directory theirs_dir( graphene::utilities::temp_directory_path() );
+   database mine_db, theirs_db;
+   mine_db.open( mine_dir.path(), [this]{ return genesis_state; }, "test" );
+   theirs_db.open( theirs_dir.path(), [this]{ return genesis_state; }, "test" );
+
+   const signed_block common = next_block( db, 1 );
+   mine_db.push_block( common, skip );
+   theirs_db.push_block( common, skip );
+   vector<signed_block> mine, theirs;
+   for( uint32_t i = 0; i < 4; ++i )
+      mine.push_back( next_block( mine_db, 1 ) );
+   for( uint32_t i = 0; i < 3; ++i )
+      theirs.push_back( next_block( theirs_db, i == 0 ? 2 : 1 ) );
+   for( uint32_t i = 0; i < 2; ++i )
+      db.push_block( mine[i], skip );
+
+   const validated_block_cache& cache = db.get_validated_block_cache();
+   const size_t cached = cache.size();
+
+   // a block of the other branch which is not signed by its witness is not checked further
+   signed_block forged = theirs[0];
+   forged.sign( generate_private_key( "forged" ) );
+   BOOST_CHECK( !db.push_block( forged, skip ) );
+   BOOST_CHECK_EQUAL( cache.size(), cached );
+
+   // blocks of the other branch are checked as they arrive
+   BOOST_CHECK( !db.push_block( theirs[0], skip ) );
+   BOOST_CHECK( !db.push_block( theirs[1], skip ) );
+   BOOST_CHECK_EQUAL( cache.size(), cached + 2 );
+   BOOST_CHECK( db.head_block_id() == mine[1].id() );
+
+   // the blocks popped and those applied again come from the cache
+   uint64_t hits = cache.hits;
+   BOOST_CHECK( db.push_block( theirs[2], skip ) );
+   BOOST_CHECK( db.head_block_id() == theirs[2].id() );
+   BOOST_CHECK_EQUAL( cache.hits - hits, 4u );
+
+   // and switching back does not check the blocks of the first branch again
+   hits = cache.hits;
+   BOOST_CHECK( !db.push_block( mine[2], skip ) );
+   BOOST_CHECK( db.push_block( mine[3], skip ) );
+   BOOST_CHECK( db.head_block_id() == mine[3].id() );
+   // 3 blocks popped, 2 applied before, 1 checked when it arrived
+   BOOST_CHECK_EQUAL( cache.hits - hits, 6u );
+   BOOST_CHECK_EQUAL( db.head_block_num(), common.block_num() + 4 );
+   BOOST_CHECK( db.fetch_block_by_number( common.block_num() + 2 )->id() == mine[1].id() );
+
+   // the least recently used blocks are dropped, blocks are then popped from the fork database
+   db.set_validated_block_cache_size( 2 );
+   BOOST_CHECK_EQUAL( cache.size(), 2u );
+   db.pop_block();
+   db.pop_block();
+   db.pop_block();
+   BOOST_CHECK( db.head_block_id() == mine[0].id() );
+   db.set_validated_block_cache_size( 0 );
+   BOOST_CHECK_EQUAL( cache.size(), 0u );
+   db.push_block( mine[1], skip );
+   BOOST_CHECK( db.head_block_id() == mine[1].id() );
+
+   mine_db.close();
+   theirs_db.close();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
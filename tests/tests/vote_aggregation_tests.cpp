@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2018, YOYOW Foundation PTE. LTD. and contributors.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/committee_member_object.hpp>
+#include <graphene/chain/content_object.hpp>
+#include <graphene/chain/witness_object.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::db;
+
+BOOST_FIXTURE_TEST_SUITE( vote_aggregation_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( aggregated_block_votes_test )
+{ try {
+   const auto& params = db.get_global_properties().parameters;
+   // the blocks are in the fork database, so that they can be popped
+   const uint32_t skip = ~database::skip_fork_db;
+   uint32_t nonce = 0;
+   auto push = [&]( const operation& op ) {
+      signed_transaction tx;
+      tx.operations.push_back( op );
+      test::set_expiration( db, tx );
+      // transactions which would otherwise be identical
+      tx.expiration += ++nonce;
+      db.push_transaction( tx, ~0 );
+   };
+   auto send = [&]( account_uid_type from, account_uid_type to, int64_t amount ) {
+      transfer_operation op;
+      op.from = from;
+      op.to = to;
+      op.amount = asset( amount );
+      push( op );
+   };
+
+   vector<account_uid_type> voters;
+   for( uint32_t i = 0; i < 6; ++i )
+   {
+      const account_object& acc = create_account( 3000 + i, "aggvoter" + fc::to_string( i ) );
+      fund( acc, asset( params.min_governance_voting_balance * 10 ) );
+      voters.push_back( acc.uid );
+   }
+   const account_uid_type witness = create_account( 3100u, "aggwitness" ).uid;
+   const account_uid_type committee_member = create_account( 3101u, "aggcommittee" ).uid;
+   const account_uid_type platform = create_account( 3102u, "aggplatform" ).uid;
+   fund( db.get_account_by_uid( witness ), asset( params.min_witness_pledge * 2 ) );
+   fund( db.get_account_by_uid( committee_member ), asset( params.min_committee_member_pledge * 2 ) );
+   fund( db.get_account_by_uid( platform ), asset( params.platform_min_pledge * 2 ) );
+   {
+      witness_create_operation op;
+      op.account = witness;
+      op.block_signing_key = generate_private_key( "aggwitness" ).get_public_key();
+      op.pledge = asset( params.min_witness_pledge );
+      push( op );
+   }
+   {
+      committee_member_create_operation op;
+      op.account = committee_member;
+      op.pledge = asset( params.min_committee_member_pledge );
+      push( op );
+   }
+   {
+      platform_create_operation op;
+      op.account = platform;
+      op.pledge = asset( params.platform_min_pledge );
+      op.name = "aggplatform";
+      push( op );
+   }
+   const account_uid_type other_witness = db.get_global_properties().active_witnesses.begin()->first;
+
+   // two voters by self, three voters following them through a proxy
+   for( uint32_t i = 0; i < 2; ++i )
+   {
+      witness_vote_update_operation wv;
+      wv.voter = voters[i];
+      wv.witnesses_to_add = { witness, other_witness };
+      push( wv );
+      committee_member_vote_update_operation cv;
+      cv.voter = voters[i];
+      cv.committee_members_to_add = { committee_member };
+      push( cv );
+      platform_vote_update_operation pv;
+      pv.voter = voters[i];
+      pv.platform_to_add = { platform };
+      push( pv );
+   }
+   for( uint32_t i = 2; i < 5; ++i )
+   {
+      account_update_proxy_operation op;
+      op.voter = voters[i];
+      op.proxy = voters[i < 4 ? 0 : 1];
+      push( op );
+   }
+   {
+      witness_vote_update_operation op;
+      op.voter = voters[5];
+      op.witnesses_to_add = { witness };
+      push( op );
+   }
+   generate_block( skip );
+
+   // balance changes, interleaved with a proxy change, vote updates and resignations
+   send( voters[2], voters[5], 1000 );
+   send( voters[0], voters[4], 2000 );
+   {
+      account_update_proxy_operation op;
+      op.voter = voters[3];
+      op.proxy = voters[1];
+      push( op );
+   }
+   send( voters[3], voters[1], 3000 );
+   {
+      witness_vote_update_operation op;
+      op.voter = voters[5];
+      op.witnesses_to_remove = { witness };
+      op.witnesses_to_add = { other_witness };
+      push( op );
+   }
+   send( voters[1], voters[2], 4000 );
+   {
+      committee_member_update_operation op;
+      op.account = committee_member;
+      op.new_pledge = asset( 0 );
+      push( op );
+   }
+   send( voters[4], voters[0], 5000 );
+   {
+      platform_update_operation op;
+      op.account = platform;
+      op.new_pledge = asset( 0 );
+      push( op );
+   }
+   send( voters[5], voters[3], 6000 );
+   send( voters[0], voters[2], 7000 );
+
+   auto snapshot = [&]() -> string {
+      string result;
+      for( const auto& o : db.get_index_type<witness_index>().indices() )
+         result += fc::json::to_string( o );
+      for( const auto& o : db.get_index_type<committee_member_index>().indices() )
+         result += fc::json::to_string( o );
+      for( const auto& o : db.get_index_type<platform_index>().indices() )
+         result += fc::json::to_string( o );
+      for( const auto& o : db.get_index_type<voter_index>().indices() )
+         result += fc::json::to_string( o );
+      return result;
+   };
+
+   // each change fanned out immediately
+   db.set_block_vote_aggregation( false );
+   const signed_block block = generate_block( skip );
+   const string immediate = snapshot();
+   db.pop_block();
+   db._popped_tx.clear();
+   db.clear_pending();
+   BOOST_CHECK( snapshot() != immediate );
+
+   // the same block, with the changes aggregated
+   db.set_block_vote_aggregation( true );
+   db.push_block( block, skip );
+   BOOST_CHECK( db.head_block_id() == block.id() );
+   BOOST_CHECK_EQUAL( snapshot(), immediate );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()